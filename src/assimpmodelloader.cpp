@@ -1,13 +1,102 @@
 ﻿#include "assimpmodelloader.h"
+#include "texturecache.h"
+#include "stlmeshloader.h"
+#include "gltfmodelloader.h"
+#include "tracelog.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <Qt3DExtras/QDiffuseSpecularMaterial>
+#include <Qt3DRender/QAbstractTexture>
 #include <QDebug>
 #include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
 #include <limits>
 
+namespace {
+
+struct PostProcessStep {
+    unsigned int flag;
+    const char* name;
+};
+
+// 逐步执行以便单独计时，顺序与Assimp内部的执行顺序一致
+const PostProcessStep kPostProcessSteps[] = {
+    { aiProcess_FlipUVs,               "FlipUVs" },
+    { aiProcess_RemoveComponent,       "RemoveComponent" },
+    { aiProcess_OptimizeMeshes,        "OptimizeMeshes" },
+    { aiProcess_FindDegenerates,       "FindDegenerates" },
+    { aiProcess_Triangulate,           "Triangulate" },
+    { aiProcess_SortByPType,           "SortByPType" },
+    { aiProcess_FindInvalidData,       "FindInvalidData" },
+    { aiProcess_GenNormals,            "GenNormals" },
+    { aiProcess_GenSmoothNormals,      "GenSmoothNormals" },
+    { aiProcess_CalcTangentSpace,      "CalcTangentSpace" },
+    { aiProcess_JoinIdenticalVertices, "JoinIdenticalVertices" },
+    { aiProcess_ImproveCacheLocality,  "ImproveCacheLocality" },
+};
+
+} // namespace
+
+// ==================== ImportProfile ====================
+
+ImportProfile ImportProfile::fastPreview()
+{
+    ImportProfile profile;
+    profile.name = "preview";
+    profile.postProcessSteps = aiProcess_Triangulate | aiProcess_GenNormals;
+    profile.texCoords = false;
+    profile.textures = false;
+    return profile;
+}
+
+ImportProfile ImportProfile::fullQuality()
+{
+    // 材质不使用法线贴图，因此不计算切线空间
+    ImportProfile profile;
+    profile.name = "full";
+    profile.postProcessSteps = aiProcess_Triangulate
+            | aiProcess_GenSmoothNormals
+            | aiProcess_FlipUVs
+            | aiProcess_JoinIdenticalVertices
+            | aiProcess_ImproveCacheLocality;
+    return profile;
+}
+
+ImportProfile ImportProfile::collisionOnly()
+{
+    ImportProfile profile;
+    profile.name = "collision";
+    profile.postProcessSteps = aiProcess_RemoveComponent
+            | aiProcess_Triangulate
+            | aiProcess_GenNormals
+            | aiProcess_JoinIdenticalVertices;
+    profile.removedComponents = aiComponent_NORMALS
+            | aiComponent_TANGENTS_AND_BITANGENTS
+            | aiComponent_COLORS
+            | aiComponent_TEXCOORDS;
+    profile.texCoords = false;
+    profile.textures = false;
+    return profile;
+}
+
+ImportProfile ImportProfile::byName(const QString& name)
+{
+    if (name == "preview") return fastPreview();
+    if (name == "collision") return collisionOnly();
+    return fullQuality();
+}
+
+QStringList ImportProfile::names()
+{
+    return { "preview", "full", "collision" };
+}
+
+// ==================== AssimpModelLoader ====================
+
 AssimpModelLoader::AssimpModelLoader()
     : m_minPoint(std::numeric_limits<float>::max(), 
                  std::numeric_limits<float>::max(), 
@@ -28,8 +117,68 @@ Qt3DCore::QEntity* AssimpModelLoader::loadModel(const QString& filename,
                                                  const QColor& color,
                                                  const QVector3D& scale)
 {
-    m_scale = scale;
+    if (!prepare(filename)) {
+        return nullptr;
+    }
+    return build(parent, color, scale);
+}
+
+bool AssimpModelLoader::prepare(const QString& filename)
+{
+    TRACE_SCOPE_DETAIL("AssimpModelLoader::prepare", QFileInfo(filename).fileName());
+    
     m_errorMessage.clear();
+    m_stageTimings.clear();
+    m_prepared = PreparedKind::None;
+    m_preparedFile = filename;
+    m_stlMesh = MeshData();
+    m_gltfLoader.reset();
+    m_scene = nullptr;
+    m_importer.reset();
+    
+    QFileInfo fileInfo(filename);
+    if (!fileInfo.exists()) {
+        m_errorMessage = QString("File does not exist: %1").arg(filename);
+        qWarning() << m_errorMessage;
+        return false;
+    }
+    m_modelDir = fileInfo.absolutePath();
+    
+    // STL走原生快速路径，失败时回退到Assimp
+    if (m_profile.nativeStl && StlMeshLoader::isStlFile(filename)) {
+        if (prepareStl(filename)) {
+            m_prepared = PreparedKind::Stl;
+            return true;
+        }
+        m_stageTimings.clear();
+    }
+    
+    // glTF/GLB走原生路径，不支持的扩展或缺少法线时回退到Assimp
+    if (m_profile.nativeGltf && GltfModelLoader::isGltfFile(filename)) {
+        m_gltfLoader.reset(new GltfModelLoader());
+        if (m_gltfLoader->prepare(filename, m_profile.normals)) {
+            m_stageTimings = m_gltfLoader->stageTimings();
+            m_prepared = PreparedKind::Gltf;
+            return true;
+        }
+        qWarning() << "Native glTF loader failed, falling back to Assimp:" << m_gltfLoader->getErrorMessage();
+        m_gltfLoader.reset();
+    }
+    
+    if (!prepareAssimp(filename)) {
+        return false;
+    }
+    m_prepared = PreparedKind::Assimp;
+    return true;
+}
+
+Qt3DCore::QEntity* AssimpModelLoader::build(Qt3DCore::QEntity* parent,
+                                             const QColor& color,
+                                             const QVector3D& scale)
+{
+    TRACE_SCOPE_DETAIL("AssimpModelLoader::build", QFileInfo(m_preparedFile).fileName());
+    
+    m_scale = scale;
     
     // 重置包围盒
     m_minPoint = QVector3D(std::numeric_limits<float>::max(), 
@@ -39,30 +188,45 @@ Qt3DCore::QEntity* AssimpModelLoader::loadModel(const QString& filename,
                            std::numeric_limits<float>::lowest(), 
                            std::numeric_limits<float>::lowest());
     
-    QFileInfo fileInfo(filename);
-    if (!fileInfo.exists()) {
-        m_errorMessage = QString("File does not exist: %1").arg(filename);
-        qWarning() << m_errorMessage;
-        return nullptr;
-    }
-    
-    Assimp::Importer importer;
-    
-    const aiScene* scene = importer.ReadFile(
-        filename.toStdString(),
-        aiProcess_Triangulate | 
-        aiProcess_GenSmoothNormals | 
-        aiProcess_FlipUVs |
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_CalcTangentSpace
-    );
+    const PreparedKind prepared = m_prepared;
+    m_prepared = PreparedKind::None;
     
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        m_errorMessage = QString("Assimp error: %1").arg(importer.GetErrorString());
-        qWarning() << m_errorMessage;
+    switch (prepared) {
+    case PreparedKind::Stl: {
+        Qt3DCore::QEntity* stlEntity = buildStl(parent, color, scale);
+        m_stlMesh = MeshData();
+        return stlEntity;
+    }
+    case PreparedKind::Gltf: {
+        Qt3DCore::QEntity* gltfEntity = m_gltfLoader->build(parent, color, scale);
+        if (gltfEntity) {
+            m_stageTimings = m_gltfLoader->stageTimings();
+            m_gltfLoader->getBoundingBox(m_minPoint, m_maxPoint);
+            m_gltfLoader.reset();
+            return gltfEntity;
+        }
+        
+        // 构建阶段才发现的问题（如访问器越界），在当前线程改用Assimp
+        qWarning() << "Native glTF loader failed, falling back to Assimp:" << m_gltfLoader->getErrorMessage();
+        m_gltfLoader.reset();
+        m_stageTimings.clear();
+        if (!prepareAssimp(m_preparedFile)) {
+            return nullptr;
+        }
+        break;
+    }
+    case PreparedKind::Assimp:
+        break;
+    case PreparedKind::None:
+        if (m_errorMessage.isEmpty()) {
+            m_errorMessage = "Model has not been prepared";
+        }
         return nullptr;
     }
     
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+    
     // 创建根实体
     Qt3DCore::QEntity* rootEntity = new Qt3DCore::QEntity(parent);
     
@@ -72,15 +236,51 @@ Qt3DCore::QEntity* AssimpModelLoader::loadModel(const QString& filename,
     rootEntity->addComponent(transform);
     
     // 递归处理节点
-    processNode(scene->mRootNode, scene, rootEntity, color);
+    processNode(m_scene->mRootNode, m_scene, rootEntity, color);
+    recordStage("convert", stageTimer.nsecsElapsed());
     
     // qDebug() << "Model loaded:" << filename;
     // qDebug() << "  Meshes:" << scene->mNumMeshes;
     // qDebug() << "  Bounding box:" << m_minPoint << "-" << m_maxPoint;
     
+    m_scene = nullptr;
+    m_importer.reset();
     return rootEntity;
 }
 
+bool AssimpModelLoader::prepareAssimp(const QString& filename)
+{
+    m_importer.reset(new Assimp::Importer());
+    if (m_profile.postProcessSteps & aiProcess_RemoveComponent) {
+        m_importer->SetPropertyInteger(AI_CONFIG_PP_RCV_FLAGS, m_profile.removedComponents);
+    }
+    
+    // 先只解析文件，再按配置逐个执行后处理步骤并分别计时
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+    const aiScene* scene = m_importer->ReadFile(filename.toStdString(), 0);
+    recordStage("read", stageTimer.nsecsElapsed());
+    
+    for (const PostProcessStep& step : kPostProcessSteps) {
+        if (!scene) break;
+        if (!(m_profile.postProcessSteps & step.flag)) continue;
+        
+        stageTimer.restart();
+        scene = m_importer->ApplyPostProcessing(step.flag);
+        recordStage(step.name, stageTimer.nsecsElapsed());
+    }
+    
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        m_errorMessage = QString("Assimp error: %1").arg(m_importer->GetErrorString());
+        qWarning() << m_errorMessage;
+        m_importer.reset();
+        return false;
+    }
+    
+    m_scene = scene;
+    return true;
+}
+
 void AssimpModelLoader::processNode(aiNode* node, const aiScene* scene, 
                                     Qt3DCore::QEntity* parent, const QColor& color)
 {
@@ -143,7 +343,7 @@ Qt3DCore::QEntity* AssimpModelLoader::processMesh(aiMesh* mesh, const aiScene* s
     geometry->addAttribute(positionAttribute);
     
     // ===== 法线 =====
-    if (mesh->HasNormals()) {
+    if (m_profile.normals && mesh->HasNormals()) {
         QByteArray normalData;
         normalData.resize(mesh->mNumVertices * 3 * sizeof(float));
         float* normPtr = reinterpret_cast<float*>(normalData.data());
@@ -169,6 +369,32 @@ Qt3DCore::QEntity* AssimpModelLoader::processMesh(aiMesh* mesh, const aiScene* s
         geometry->addAttribute(normalAttribute);
     }
     
+    // ===== 纹理坐标 =====
+    if (m_profile.texCoords && mesh->HasTextureCoords(0)) {
+        QByteArray texCoordData;
+        texCoordData.resize(mesh->mNumVertices * 2 * sizeof(float));
+        float* uvPtr = reinterpret_cast<float*>(texCoordData.data());
+        
+        for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+            aiVector3D& uv = mesh->mTextureCoords[0][i];
+            *uvPtr++ = uv.x;
+            *uvPtr++ = uv.y;
+        }
+        
+        Qt3DRender::QBuffer* texCoordBuffer = new Qt3DRender::QBuffer(geometry);
+        texCoordBuffer->setData(texCoordData);
+        
+        Qt3DRender::QAttribute* texCoordAttribute = new Qt3DRender::QAttribute(geometry);
+        texCoordAttribute->setName(Qt3DRender::QAttribute::defaultTextureCoordinateAttributeName());
+        texCoordAttribute->setVertexBaseType(Qt3DRender::QAttribute::Float);
+        texCoordAttribute->setVertexSize(2);
+        texCoordAttribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+        texCoordAttribute->setBuffer(texCoordBuffer);
+        texCoordAttribute->setByteStride(2 * sizeof(float));
+        texCoordAttribute->setCount(mesh->mNumVertices);
+        geometry->addAttribute(texCoordAttribute);
+    }
+    
     // ===== 索引 =====
     QByteArray indexData;
     unsigned int indexCount = 0;
@@ -203,12 +429,32 @@ Qt3DCore::QEntity* AssimpModelLoader::processMesh(aiMesh* mesh, const aiScene* s
     meshEntity->addComponent(geometryRenderer);
     
     // ===== 材质 =====
+    aiMaterial* aiMat = mesh->mMaterialIndex < scene->mNumMaterials
+            ? scene->mMaterials[mesh->mMaterialIndex] : nullptr;
+    
+    // 有纹理坐标且纹理可用时使用纹理材质（纹理由缓存共享并异步加载）
+    Qt3DRender::QAbstractTexture* texture = nullptr;
+    if (m_textureCache && m_profile.textures && m_profile.texCoords && mesh->HasTextureCoords(0)) {
+        const QString texturePath = m_overrideTexture.isEmpty() ? resolveTexturePath(aiMat) : m_overrideTexture;
+        if (!texturePath.isEmpty()) {
+            texture = m_textureCache->texture(texturePath);
+        }
+    }
+    
+    if (texture) {
+        Qt3DExtras::QDiffuseSpecularMaterial* texturedMaterial = new Qt3DExtras::QDiffuseSpecularMaterial(meshEntity);
+        texturedMaterial->setDiffuse(QVariant::fromValue(texture));
+        texturedMaterial->setSpecular(QColor(255, 255, 255));
+        texturedMaterial->setShininess(50.0f);
+        meshEntity->addComponent(texturedMaterial);
+        return meshEntity;
+    }
+    
     Qt3DExtras::QPhongMaterial* material = new Qt3DExtras::QPhongMaterial(meshEntity);
     
     // 尝试从Assimp场景获取材质颜色
     QColor diffuseColor = color;
-    if (mesh->mMaterialIndex < scene->mNumMaterials) {
-        aiMaterial* aiMat = scene->mMaterials[mesh->mMaterialIndex];
+    if (aiMat) {
         aiColor3D aiDiffuse;
         if (aiMat->Get(AI_MATKEY_COLOR_DIFFUSE, aiDiffuse) == AI_SUCCESS) {
             diffuseColor = QColor::fromRgbF(aiDiffuse.r, aiDiffuse.g, aiDiffuse.b);
@@ -224,6 +470,156 @@ Qt3DCore::QEntity* AssimpModelLoader::processMesh(aiMesh* mesh, const aiScene* s
     return meshEntity;
 }
 
+bool AssimpModelLoader::prepareStl(const QString& filename)
+{
+    // 与Assimp路径保持一致：合并顶点/平滑法线由导入配置决定
+    StlMeshLoader::Options options;
+    options.weldVertices = m_profile.postProcessSteps & aiProcess_JoinIdenticalVertices;
+    options.smoothNormals = m_profile.postProcessSteps & aiProcess_GenSmoothNormals;
+    
+    StlMeshLoader stlLoader;
+    if (!stlLoader.load(filename, m_stlMesh, options)) {
+        qWarning() << "Native STL loader failed, falling back to Assimp:" << stlLoader.getErrorMessage();
+        m_stlMesh = MeshData();
+        return false;
+    }
+    m_stageTimings = stlLoader.stageTimings();
+    return true;
+}
+
+Qt3DCore::QEntity* AssimpModelLoader::buildStl(Qt3DCore::QEntity* parent, const QColor& color,
+                                               const QVector3D& scale)
+{
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+    
+    Qt3DCore::QEntity* rootEntity = new Qt3DCore::QEntity(parent);
+    
+    Qt3DCore::QTransform* transform = new Qt3DCore::QTransform(rootEntity);
+    transform->setScale3D(scale);
+    rootEntity->addComponent(transform);
+    
+    createMeshEntity(m_stlMesh, rootEntity, color);
+    
+    // 缩放可能为负，分别取两端的最小/最大值
+    const QVector3D a = m_stlMesh.boundsMin * scale;
+    const QVector3D b = m_stlMesh.boundsMax * scale;
+    m_minPoint = QVector3D(qMin(a.x(), b.x()), qMin(a.y(), b.y()), qMin(a.z(), b.z()));
+    m_maxPoint = QVector3D(qMax(a.x(), b.x()), qMax(a.y(), b.y()), qMax(a.z(), b.z()));
+    
+    recordStage("convert", stageTimer.nsecsElapsed());
+    return rootEntity;
+}
+
+Qt3DCore::QEntity* AssimpModelLoader::createMeshEntity(const MeshData& mesh, Qt3DCore::QEntity* parent,
+                                                       const QColor& color)
+{
+    Qt3DCore::QEntity* meshEntity = new Qt3DCore::QEntity(parent);
+    Qt3DRender::QGeometry* geometry = new Qt3DRender::QGeometry(meshEntity);
+    
+    // ===== 顶点（位置与法线交错存放在同一个缓冲区，直接使用加载器输出） =====
+    Qt3DRender::QBuffer* vertexBuffer = new Qt3DRender::QBuffer(geometry);
+    vertexBuffer->setData(mesh.vertices);
+    
+    Qt3DRender::QAttribute* positionAttribute = new Qt3DRender::QAttribute(geometry);
+    positionAttribute->setName(Qt3DRender::QAttribute::defaultPositionAttributeName());
+    positionAttribute->setVertexBaseType(Qt3DRender::QAttribute::Float);
+    positionAttribute->setVertexSize(3);
+    positionAttribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+    positionAttribute->setBuffer(vertexBuffer);
+    positionAttribute->setByteStride(MeshData::kVertexStride);
+    positionAttribute->setByteOffset(0);
+    positionAttribute->setCount(mesh.vertexCount);
+    geometry->addAttribute(positionAttribute);
+    
+    Qt3DRender::QAttribute* normalAttribute = new Qt3DRender::QAttribute(geometry);
+    normalAttribute->setName(Qt3DRender::QAttribute::defaultNormalAttributeName());
+    normalAttribute->setVertexBaseType(Qt3DRender::QAttribute::Float);
+    normalAttribute->setVertexSize(3);
+    normalAttribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+    normalAttribute->setBuffer(vertexBuffer);
+    normalAttribute->setByteStride(MeshData::kVertexStride);
+    normalAttribute->setByteOffset(MeshData::kNormalOffset);
+    normalAttribute->setCount(mesh.vertexCount);
+    geometry->addAttribute(normalAttribute);
+    
+    // ===== 索引 =====
+    Qt3DRender::QBuffer* indexBuffer = new Qt3DRender::QBuffer(geometry);
+    indexBuffer->setData(mesh.indices);
+    
+    Qt3DRender::QAttribute* indexAttribute = new Qt3DRender::QAttribute(geometry);
+    indexAttribute->setVertexBaseType(Qt3DRender::QAttribute::UnsignedInt);
+    indexAttribute->setAttributeType(Qt3DRender::QAttribute::IndexAttribute);
+    indexAttribute->setBuffer(indexBuffer);
+    indexAttribute->setCount(mesh.indexCount);
+    geometry->addAttribute(indexAttribute);
+    
+    // ===== 几何渲染器 =====
+    Qt3DRender::QGeometryRenderer* geometryRenderer = new Qt3DRender::QGeometryRenderer(meshEntity);
+    geometryRenderer->setGeometry(geometry);
+    geometryRenderer->setPrimitiveType(Qt3DRender::QGeometryRenderer::Triangles);
+    meshEntity->addComponent(geometryRenderer);
+    
+    // ===== 材质（STL没有材质信息，使用URDF颜色） =====
+    Qt3DExtras::QPhongMaterial* material = new Qt3DExtras::QPhongMaterial(meshEntity);
+    material->setDiffuse(color);
+    material->setAmbient(color.darker(150));
+    material->setSpecular(QColor(255, 255, 255));
+    material->setShininess(50.0f);
+    meshEntity->addComponent(material);
+    
+    return meshEntity;
+}
+
+QString AssimpModelLoader::resolveTexturePath(aiMaterial* material) const
+{
+    if (!material || material->GetTextureCount(aiTextureType_DIFFUSE) == 0) {
+        return QString();
+    }
+    
+    aiString path;
+    if (material->GetTexture(aiTextureType_DIFFUSE, 0, &path) != AI_SUCCESS) {
+        return QString();
+    }
+    
+    QString texturePath = QString::fromUtf8(path.C_Str());
+    if (texturePath.isEmpty()) {
+        return QString();
+    }
+    
+    // 内嵌纹理（"*0"形式）暂不支持
+    if (texturePath.startsWith('*')) {
+        qDebug() << "AssimpModelLoader: 忽略内嵌纹理" << texturePath;
+        return QString();
+    }
+    
+    texturePath.replace('\\', '/');
+    QFileInfo textureInfo(texturePath);
+    if (textureInfo.isRelative()) {
+        textureInfo.setFile(m_modelDir + "/" + texturePath);
+    }
+    if (textureInfo.exists()) {
+        return QDir::cleanPath(textureInfo.absoluteFilePath());
+    }
+    
+    // 导出工具常写入绝对路径或错误的相对路径，退回到模型目录下按文件名查找
+    const QString sibling = m_modelDir + "/" + QFileInfo(texturePath).fileName();
+    if (QFileInfo::exists(sibling)) {
+        return QDir::cleanPath(sibling);
+    }
+    
+    qWarning() << "AssimpModelLoader: 找不到纹理" << texturePath;
+    return QString();
+}
+
+void AssimpModelLoader::recordStage(const QString& stage, qint64 nsec)
+{
+    ImportStageTiming timing;
+    timing.stage = stage;
+    timing.msec = nsec / 1.0e6;
+    m_stageTimings.append(timing);
+}
+
 void AssimpModelLoader::getBoundingBox(QVector3D& minPoint, QVector3D& maxPoint) const
 {
     minPoint = m_minPoint;
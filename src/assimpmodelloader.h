@@ -11,11 +11,64 @@
 #include <QVector3D>
 #include <QColor>
 #include <QString>
+#include <QStringList>
 #include <QVector>
+#include <memory>
+
+#include "meshdata.h"
 
 struct aiScene;
 struct aiNode;
 struct aiMesh;
+struct aiMaterial;
+
+namespace Assimp {
+class Importer;
+}
+
+class TextureCache;
+class GltfModelLoader;
+
+/**
+ * @brief Assimp导入配置
+ * 决定执行哪些后处理步骤以及上传哪些顶点分量，
+ * 不同机器人可选用显示效果满足要求的最低开销配置。
+ */
+struct ImportProfile {
+    QString name;
+    unsigned int postProcessSteps = 0;    // aiPostProcessSteps 组合
+    int removedComponents = 0;            // aiComponent 组合（配合 aiProcess_RemoveComponent）
+    bool normals = true;                  // 上传法线
+    bool texCoords = true;                // 上传纹理坐标
+    bool textures = true;                 // 加载纹理
+    bool nativeStl = true;                // STL使用原生加载器（不经过Assimp）
+    bool nativeGltf = true;               // glTF/GLB使用原生加载器（直接引用文件中的缓冲区）
+    
+    /**
+     * @brief 快速预览：只三角化和补全法线，不合并顶点、不加载纹理
+     */
+    static ImportProfile fastPreview();
+    
+    /**
+     * @brief 完整质量：平滑法线、合并顶点、优化顶点缓存并加载纹理（默认）
+     */
+    static ImportProfile fullQuality();
+    
+    /**
+     * @brief 仅碰撞外形：丢弃原有法线/纹理坐标/顶点色，生成面法线并合并顶点
+     */
+    static ImportProfile collisionOnly();
+    
+    /**
+     * @brief 按名称获取配置，未知名称返回完整质量
+     */
+    static ImportProfile byName(const QString& name);
+    
+    /**
+     * @brief 所有配置名称
+     */
+    static QStringList names();
+};
 
 /**
  * @brief Assimp模型加载器
@@ -40,6 +93,46 @@ public:
                                   const QColor& color = QColor(128, 128, 128),
                                   const QVector3D& scale = QVector3D(1, 1, 1));
     
+    /**
+     * @brief 准备阶段：读取并处理模型数据（STL解析、glTF映射解码或Assimp导入及后处理），
+     * 不创建Qt3D节点，可在工作线程调用
+     * @param filename 模型文件路径
+     * @return 是否成功
+     */
+    bool prepare(const QString& filename);
+    
+    /**
+     * @brief 构建阶段：按prepare()的结果创建Qt3D实体（需在主线程调用）
+     * @param parent 父实体
+     * @param color 材质颜色
+     * @param scale 缩放比例
+     * @return 加载的实体，失败返回nullptr
+     */
+    Qt3DCore::QEntity* build(Qt3DCore::QEntity* parent,
+                             const QColor& color = QColor(128, 128, 128),
+                             const QVector3D& scale = QVector3D(1, 1, 1));
+    
+    /**
+     * @brief 设置纹理缓存（未设置时忽略纹理，只使用漫反射颜色）
+     */
+    void setTextureCache(TextureCache* cache) { m_textureCache = cache; }
+    
+    /**
+     * @brief 设置覆盖纹理（如URDF材质中的texture），优先于模型自带的漫反射纹理
+     */
+    void setOverrideTexture(const QString& imagePath) { m_overrideTexture = imagePath; }
+    
+    /**
+     * @brief 设置导入配置（默认完整质量）
+     */
+    void setImportProfile(const ImportProfile& profile) { m_profile = profile; }
+    const ImportProfile& importProfile() const { return m_profile; }
+    
+    /**
+     * @brief 最近一次加载各阶段的耗时
+     */
+    QVector<ImportStageTiming> stageTimings() const { return m_stageTimings; }
+    
     /**
      * @brief 获取错误信息
      */
@@ -55,11 +148,31 @@ private:
                     Qt3DCore::QEntity* parent, const QColor& color);
     Qt3DCore::QEntity* processMesh(aiMesh* mesh, const aiScene* scene, 
                                    Qt3DCore::QEntity* parent, const QColor& color);
+    bool prepareStl(const QString& filename);
+    bool prepareAssimp(const QString& filename);
+    Qt3DCore::QEntity* buildStl(Qt3DCore::QEntity* parent, const QColor& color, const QVector3D& scale);
+    Qt3DCore::QEntity* createMeshEntity(const MeshData& mesh, Qt3DCore::QEntity* parent, const QColor& color);
+    QString resolveTexturePath(aiMaterial* material) const;
+    void recordStage(const QString& stage, qint64 nsec);
     
     QString m_errorMessage;
     QVector3D m_minPoint;
     QVector3D m_maxPoint;
     QVector3D m_scale;
+    QString m_modelDir;
+    TextureCache* m_textureCache = nullptr;
+    QString m_overrideTexture;
+    ImportProfile m_profile = ImportProfile::fullQuality();
+    QVector<ImportStageTiming> m_stageTimings;
+    
+    // prepare()的结果，由build()使用后释放
+    enum class PreparedKind { None, Stl, Gltf, Assimp };
+    PreparedKind m_prepared = PreparedKind::None;
+    QString m_preparedFile;
+    MeshData m_stlMesh;
+    std::unique_ptr<GltfModelLoader> m_gltfLoader;
+    std::unique_ptr<Assimp::Importer> m_importer;
+    const aiScene* m_scene = nullptr;
 };
 
 #endif // ASSIMPMODELLOADER_H
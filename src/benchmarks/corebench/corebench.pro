@@ -0,0 +1,12 @@
+# 核心代码微基准：URDF解析、正运动学、网格导入、轨迹、OPC UA值转换
+# 用法：corebench [--filter 名称] [--min-time-ms N] [--json result.json] [--baseline old.json [--threshold 百分比]]
+
+CONFIG   += c++17 console
+CONFIG   -= app_bundle
+
+TARGET = corebench
+
+include($$PWD/../../core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,488 @@
+﻿/**
+ * 核心代码微基准：URDF解析、Link变换计算、网格导入、轨迹更新、OPC UA值转换
+ *
+ * 用法：corebench [--filter 名称] [--min-time-ms N] [--json result.json]
+ *                 [--baseline old.json [--threshold 百分比]]
+ * 每项测试按批次重复运行（每批约10ms），至少运行 --min-time-ms（默认300）且不少于5批，
+ * 报告每次操作耗时的中位数与最小值（纳秒）。
+ * 指定 --baseline 时与上次结果对比，中位数变慢超过阈值（默认10%）的项目记为回退，退出码为1。
+ */
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtEndian>
+#include <QtMath>
+#include <Qt3DCore/QEntity>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include "urdfparser.h"
+#include "robotentity.h"
+#include "assimpmodelloader.h"
+#include "trajectoryentity.h"
+#include "baseconnector.h"
+#include "opcua/open62541.h"
+
+// 定义在opcuaconnector.cpp中
+QVariant convertUAVariantToQVariant(const UA_Variant &data);
+
+namespace {
+
+const qint64 kBatchTargetNsec = 10 * 1000 * 1000;
+const int kMinSamples = 5;
+
+// 防止编译器优化掉被测代码的结果
+volatile double g_sink = 0.0;
+
+struct BenchResult {
+    QString name;
+    double medianNs = 0.0;
+    double minNs = 0.0;
+    qint64 iterations = 0;
+    int samples = 0;
+};
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+/**
+ * @brief 暴露BaseConnector::toValidValue（受保护）用于测试
+ */
+class BenchConnector : public BaseConnector
+{
+public:
+    using BaseConnector::toValidValue;
+
+    int init(QStringList) override { return 0; }
+    int release() override { return 0; }
+    int readValue(QString, QVariant&, QString*) override { return 0; }
+    int writeValue(QString, QVariant, Type, QString*) override { return 0; }
+    int readValueList(QList<DataUnit>&, QString*) override { return 0; }
+    int writeValueList(QList<DataUnit>, QString*) override { return 0; }
+    int monitorValues(QStringList, QString*) override { return 0; }
+    QStringList monitoredValueList() override { return QStringList(); }
+    void clearMonitor() override {}
+};
+
+class BenchRunner
+{
+public:
+    BenchRunner(const QString& filter, qint64 minTimeNsec)
+        : m_filter(filter)
+        , m_minTimeNsec(minTimeNsec)
+    {
+    }
+
+    void run(const QString& name, const std::function<void()>& operation)
+    {
+        if (!m_filter.isEmpty() && !name.contains(m_filter)) return;
+
+        // 按单次耗时确定批次大小，使每批约10ms
+        QElapsedTimer timer;
+        qint64 batch = 1;
+        for (;;) {
+            timer.start();
+            for (qint64 i = 0; i < batch; ++i) operation();
+            const qint64 elapsed = timer.nsecsElapsed();
+            if (elapsed >= kBatchTargetNsec || batch >= (qint64(1) << 30)) break;
+            batch *= elapsed < kBatchTargetNsec / 10 ? 10 : 2;
+        }
+
+        QVector<double> samples;
+        qint64 totalNsec = 0;
+        BenchResult result;
+        result.name = name;
+        while (totalNsec < m_minTimeNsec || samples.size() < kMinSamples) {
+            timer.start();
+            for (qint64 i = 0; i < batch; ++i) operation();
+            const qint64 elapsed = timer.nsecsElapsed();
+            samples.append(double(elapsed) / batch);
+            totalNsec += elapsed;
+            result.iterations += batch;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        result.medianNs = samples.at(samples.size() / 2);
+        result.minNs = samples.first();
+        result.samples = samples.size();
+        m_results.append(result);
+
+        out() << QString("%1 %2 ns/op  最小 %3 ns/op  (%4 次)\n")
+                 .arg(name, -36)
+                 .arg(result.medianNs, 14, 'f', 1)
+                 .arg(result.minNs, 14, 'f', 1)
+                 .arg(result.iterations);
+        out().flush();
+    }
+
+    const QVector<BenchResult>& results() const { return m_results; }
+
+private:
+    QString m_filter;
+    qint64 m_minTimeNsec;
+    QVector<BenchResult> m_results;
+};
+
+/**
+ * @brief 生成N个Link的串联机械臂URDF（圆柱+盒体视觉，旋转关节）
+ */
+QString makeChainUrdf(int linkCount)
+{
+    QString urdf;
+    QTextStream stream(&urdf);
+    stream << "<?xml version=\"1.0\"?>\n<robot name=\"bench_chain\">\n"
+           << "  <material name=\"grey\"><color rgba=\"0.6 0.6 0.6 1\"/></material>\n";
+    for (int i = 0; i < linkCount; ++i) {
+        stream << "  <link name=\"link_" << i << "\">\n"
+               << "    <visual><origin xyz=\"0 0 0.05\" rpy=\"0 0 0\"/>"
+               << "<geometry><cylinder radius=\"0.03\" length=\"0.1\"/></geometry>"
+               << "<material name=\"grey\"/></visual>\n"
+               << "    <visual><origin xyz=\"0 0 0.1\" rpy=\"0 0 0\"/>"
+               << "<geometry><box size=\"0.05 0.05 0.02\"/></geometry></visual>\n"
+               << "    <inertial><mass value=\"1\"/>"
+               << "<inertia ixx=\"0.01\" ixy=\"0\" ixz=\"0\" iyy=\"0.01\" iyz=\"0\" izz=\"0.01\"/></inertial>\n"
+               << "  </link>\n";
+        if (i > 0) {
+            stream << "  <joint name=\"joint_" << i << "\" type=\"revolute\">\n"
+                   << "    <parent link=\"link_" << (i - 1) << "\"/><child link=\"link_" << i << "\"/>\n"
+                   << "    <origin xyz=\"0 0 0.1\" rpy=\"0 " << (i % 2 ? "0.2" : "-0.2") << " 0\"/>\n"
+                   << "    <axis xyz=\"" << (i % 2 ? "0 1 0" : "0 0 1") << "\"/>\n"
+                   << "    <limit lower=\"-3.14\" upper=\"3.14\" effort=\"10\" velocity=\"1\"/>\n"
+                   << "  </joint>\n";
+        }
+    }
+    stream << "</robot>\n";
+    stream.flush();
+    return urdf;
+}
+
+/**
+ * @brief 环面网格顶点（取模保证接缝处顶点逐位相同）
+ */
+void torusVertex(int i, int j, int segments, float* v)
+{
+    const double u = 2.0 * M_PI * (i % segments) / segments;
+    const double w = 2.0 * M_PI * (j % segments) / segments;
+    v[0] = float((0.3 + 0.1 * std::cos(w)) * std::cos(u));
+    v[1] = float((0.3 + 0.1 * std::cos(w)) * std::sin(u));
+    v[2] = float(0.1 * std::sin(w));
+}
+
+bool writeTorusStl(const QString& filePath, int segments)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QByteArray header(80, ' ');
+    file.write(header);
+    const quint32 countLe = qToLittleEndian(quint32(2 * segments * segments));
+    file.write(reinterpret_cast<const char*>(&countLe), 4);
+
+    char record[50];
+    for (int i = 0; i < segments; ++i) {
+        for (int j = 0; j < segments; ++j) {
+            float quad[4][3];
+            torusVertex(i, j, segments, quad[0]);
+            torusVertex(i + 1, j, segments, quad[1]);
+            torusVertex(i + 1, j + 1, segments, quad[2]);
+            torusVertex(i, j + 1, segments, quad[3]);
+
+            const int triangles[2][3] = { {0, 1, 2}, {0, 2, 3} };
+            for (const auto& triangle : triangles) {
+                std::memset(record, 0, sizeof(record));
+                for (int k = 0; k < 3; ++k) {
+                    std::memcpy(record + 12 + k * 12, quad[triangle[k]], 12);
+                }
+                file.write(record, sizeof(record));
+            }
+        }
+    }
+    return true;
+}
+
+bool writeTorusObj(const QString& filePath, int segments)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+    QTextStream stream(&file);
+    for (int i = 0; i < segments; ++i) {
+        for (int j = 0; j < segments; ++j) {
+            float v[3];
+            torusVertex(i, j, segments, v);
+            stream << "v " << v[0] << ' ' << v[1] << ' ' << v[2] << '\n';
+        }
+    }
+    auto index = [segments](int i, int j) { return (i % segments) * segments + (j % segments) + 1; };
+    for (int i = 0; i < segments; ++i) {
+        for (int j = 0; j < segments; ++j) {
+            stream << "f " << index(i, j) << ' ' << index(i + 1, j) << ' ' << index(i + 1, j + 1) << '\n'
+                   << "f " << index(i, j) << ' ' << index(i + 1, j + 1) << ' ' << index(i, j + 1) << '\n';
+        }
+    }
+    return true;
+}
+
+void runParserBenchmarks(BenchRunner& runner)
+{
+    for (int linkCount : { 10, 100 }) {
+        const QString urdf = makeChainUrdf(linkCount);
+        runner.run(QString("urdf/load_from_string/%1_links").arg(linkCount), [&urdf]() {
+            URDFParser parser;
+            parser.loadFromString(urdf, QDir::tempPath());
+            g_sink = g_sink + parser.getModel()->links.size();
+        });
+    }
+}
+
+void runKinematicsBenchmarks(BenchRunner& runner, const QTemporaryDir& tempDir)
+{
+    const int linkCount = 30;
+    const QString urdfFile = tempDir.filePath("chain.urdf");
+    QFile file(urdfFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return;
+    file.write(makeChainUrdf(linkCount).toUtf8());
+    file.close();
+
+    RobotEntity robot;
+    if (!robot.loadFromURDF(urdfFile)) {
+        qWarning() << "加载测试URDF失败:" << robot.getErrorMessage();
+        return;
+    }
+
+    const QString tipLink = QString("link_%1").arg(linkCount - 1);
+    runner.run("fk/link_world_transform/tip_of_30", [&robot, &tipLink]() {
+        g_sink = g_sink + robot.getLinkWorldTransform(tipLink)(0, 3);
+    });
+
+    // 每次设置不同的值，避免关节值未变化时被跳过
+    const auto joints = robot.getMovableJoints();
+    QMap<QString, double> values;
+    int step = 0;
+    runner.run("fk/set_joint_values/30_joints", [&]() {
+        const double value = 0.001 * (++step % 1000);
+        for (const auto& joint : joints) {
+            values[joint->name] = value;
+        }
+        robot.setJointValues(values);
+    });
+}
+
+void runMeshBenchmarks(BenchRunner& runner, const QTemporaryDir& tempDir)
+{
+    const QString stlFile = tempDir.filePath("torus.stl");
+    const QString objFile = tempDir.filePath("torus.obj");
+    if (!writeTorusStl(stlFile, 160) || !writeTorusObj(objFile, 160)) {
+        qWarning() << "无法生成测试网格";
+        return;
+    }
+
+    auto loadWith = [](const QString& filePath, bool nativeStl) {
+        ImportProfile profile = ImportProfile::fullQuality();
+        profile.nativeStl = nativeStl;
+        return [filePath, profile]() {
+            AssimpModelLoader loader;
+            loader.setImportProfile(profile);
+            Qt3DCore::QEntity* entity = loader.loadModel(filePath, nullptr);
+            g_sink = g_sink + (entity ? 1 : 0);
+            delete entity;
+        };
+    };
+
+    runner.run("mesh/load_model/stl_51k_tris_native", loadWith(stlFile, true));
+    runner.run("mesh/load_model/stl_51k_tris_assimp", loadWith(stlFile, false));
+    runner.run("mesh/load_model/obj_51k_tris", loadWith(objFile, false));
+}
+
+void runTrajectoryBenchmarks(BenchRunner& runner)
+{
+    TrajectoryEntity trajectory;
+    trajectory.setLifetime(24 * 3600 * 1000);   // 测试期间不过期
+    trajectory.setMaxPoints(1000);
+
+    int step = 0;
+    runner.run("trajectory/add_point/1000_max", [&]() {
+        const double t = 0.01 * ++step;
+        trajectory.addPoint(QVector3D(float(std::cos(t)), float(std::sin(t)), float(0.001 * step)));
+    });
+
+    runner.run("trajectory/update_geometry/1000_points", [&]() {
+        QMetaObject::invokeMethod(&trajectory, "updateGeometry", Qt::DirectConnection);
+    });
+}
+
+void runOpcuaBenchmarks(BenchRunner& runner)
+{
+    auto convert = [&runner](const QString& name, const void* value, const UA_DataType* type) {
+        UA_Variant variant;
+        UA_Variant_init(&variant);
+        UA_Variant_setScalarCopy(&variant, value, type);
+        runner.run(name, [&variant]() {
+            const QVariant result = convertUAVariantToQVariant(variant);
+            g_sink = g_sink + result.isValid();
+        });
+        UA_Variant_clear(&variant);
+    };
+
+    const UA_Double doubleValue = 1.25;
+    const UA_Int32 intValue = 42;
+    const UA_Boolean boolValue = true;
+    const UA_String stringValue = UA_STRING(const_cast<char*>("joint_1.position"));
+    convert("opcua/convert_variant/double", &doubleValue, &UA_TYPES[UA_TYPES_DOUBLE]);
+    convert("opcua/convert_variant/int32", &intValue, &UA_TYPES[UA_TYPES_INT32]);
+    convert("opcua/convert_variant/boolean", &boolValue, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    convert("opcua/convert_variant/string", &stringValue, &UA_TYPES[UA_TYPES_STRING]);
+
+    BenchConnector connector;
+    const QVariant source(1.75);
+    const QVariant text(QStringLiteral("123"));
+    runner.run("connector/to_valid_value/double", [&]() {
+        g_sink = g_sink + connector.toValidValue(source, BaseConnector::DOUBLE).isValid();
+    });
+    runner.run("connector/to_valid_value/int16", [&]() {
+        g_sink = g_sink + connector.toValidValue(source, BaseConnector::INT16).isValid();
+    });
+    runner.run("connector/to_valid_value/string_to_int32", [&]() {
+        g_sink = g_sink + connector.toValidValue(text, BaseConnector::INT32).isValid();
+    });
+}
+
+QJsonObject toJson(const QVector<BenchResult>& results)
+{
+    QJsonArray array;
+    for (const BenchResult& result : results) {
+        QJsonObject json;
+        json["name"] = result.name;
+        json["medianNs"] = result.medianNs;
+        json["minNs"] = result.minNs;
+        json["iterations"] = result.iterations;
+        json["samples"] = result.samples;
+        array.append(json);
+    }
+
+    QJsonObject root;
+    root["suite"] = "corebench";
+    root["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["cpu"] = QSysInfo::currentCpuArchitecture();
+    root["os"] = QSysInfo::prettyProductName();
+    root["results"] = array;
+    return root;
+}
+
+/**
+ * @brief 与基准结果对比，返回回退的项目数
+ */
+int compareWithBaseline(const QVector<BenchResult>& results, const QString& baselineFile, double thresholdPercent)
+{
+    QFile file(baselineFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "无法读取基准结果" << baselineFile;
+        return 0;
+    }
+
+    QHash<QString, double> baseline;
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).object().value("results").toArray();
+    for (const QJsonValue& value : array) {
+        const QJsonObject json = value.toObject();
+        baseline.insert(json.value("name").toString(), json.value("medianNs").toDouble());
+    }
+
+    int regressions = 0;
+    out() << "\n与基准对比 (" << QFileInfo(baselineFile).fileName() << ", 阈值 " << thresholdPercent << "%)\n";
+    for (const BenchResult& result : results) {
+        const double previous = baseline.value(result.name, 0.0);
+        if (previous <= 0.0) {
+            out() << QString("%1 %2\n").arg(result.name, -36).arg("新增");
+            continue;
+        }
+        const double change = (result.medianNs - previous) / previous * 100.0;
+        const bool regressed = change > thresholdPercent;
+        regressions += regressed ? 1 : 0;
+        out() << QString("%1 %2%  %3\n")
+                 .arg(result.name, -36)
+                 .arg(change, 8, 'f', 1)
+                 .arg(regressed ? "回退" : "");
+    }
+    out().flush();
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+#ifdef Q_OS_LINUX
+    // 无显示服务时使用offscreen平台插件
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")
+        && qEnvironmentVariableIsEmpty("DISPLAY")
+        && qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+#endif
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("核心代码微基准");
+    parser.addHelpOption();
+    QCommandLineOption filterOption("filter", "只运行名称包含该字符串的测试", "name");
+    QCommandLineOption minTimeOption("min-time-ms", "每项测试的最短运行时间（毫秒）", "N", "300");
+    QCommandLineOption jsonOption("json", "结果写入JSON文件", "file");
+    QCommandLineOption baselineOption("baseline", "与之前的JSON结果对比", "file");
+    QCommandLineOption thresholdOption("threshold", "判定回退的变慢百分比", "percent", "10");
+    parser.addOptions({ filterOption, minTimeOption, jsonOption, baselineOption, thresholdOption });
+    parser.process(app);
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qWarning() << "无法创建临时目录";
+        return 2;
+    }
+
+    BenchRunner runner(parser.value(filterOption),
+                       qMax<qint64>(1, parser.value(minTimeOption).toLongLong()) * 1000 * 1000);
+
+    runParserBenchmarks(runner);
+    runKinematicsBenchmarks(runner, tempDir);
+    runMeshBenchmarks(runner, tempDir);
+    runTrajectoryBenchmarks(runner);
+    runOpcuaBenchmarks(runner);
+
+    if (parser.isSet(jsonOption)) {
+        QFile jsonFile(parser.value(jsonOption));
+        if (jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            jsonFile.write(QJsonDocument(toJson(runner.results())).toJson());
+        } else {
+            qWarning() << "无法写入" << jsonFile.fileName();
+        }
+    }
+
+    if (parser.isSet(baselineOption)) {
+        const int regressions = compareWithBaseline(runner.results(), parser.value(baselineOption),
+                                                    parser.value(thresholdOption).toDouble());
+        if (regressions > 0) {
+            out() << regressions << " 项性能回退\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,241 @@
+﻿/**
+ * STL加载基准：对比原生STL加载器与Assimp路径（均使用完整质量导入配置）
+ *
+ * 用法：stlbench [--runs N] [--size-mb N] [--json result.json] [file.stl ...]
+ * 未指定文件时在临时目录生成约 --size-mb（默认100）MB 的二进制STL：
+ * 环面网格，相邻三角形的共享顶点逐位相同，与CAD导出的STL一致。
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <QtMath>
+#include <QTextStream>
+#include <Qt3DCore/QEntity>
+#include <Qt3DRender/QAttribute>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "assimpmodelloader.h"
+
+namespace {
+
+struct RunResult {
+    double totalMsec = 0.0;
+    int vertexCount = 0;
+    QVector<ImportStageTiming> stages;
+};
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+bool writeTorusStl(const QString& filePath, qint64 targetBytes)
+{
+    const qint64 triangleTarget = qMax<qint64>(2, (targetBytes - 84) / 50);
+    const int segments = qMax(3, int(std::sqrt(triangleTarget / 2.0)));
+    const quint32 triangleCount = quint32(2) * segments * segments;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入" << filePath;
+        return false;
+    }
+
+    QByteArray header(80, ' ');
+    header.replace(0, 13, "stlbench-torus");
+    file.write(header);
+    quint32 countLe = qToLittleEndian(triangleCount);
+    file.write(reinterpret_cast<const char*>(&countLe), 4);
+
+    const float majorRadius = 0.3f;
+    const float minorRadius = 0.1f;
+    auto vertex = [&](int i, int j, float* v) {
+        // 取模保证接缝处的顶点与起点逐位相同
+        const double u = 2.0 * M_PI * (i % segments) / segments;
+        const double w = 2.0 * M_PI * (j % segments) / segments;
+        v[0] = float((majorRadius + minorRadius * std::cos(w)) * std::cos(u));
+        v[1] = float((majorRadius + minorRadius * std::cos(w)) * std::sin(u));
+        v[2] = float(minorRadius * std::sin(w));
+    };
+
+    QByteArray row;
+    for (int i = 0; i < segments; ++i) {
+        row.resize(segments * 2 * 50);
+        char* record = row.data();
+        for (int j = 0; j < segments; ++j) {
+            float quad[4][3];
+            vertex(i, j, quad[0]);
+            vertex(i + 1, j, quad[1]);
+            vertex(i + 1, j + 1, quad[2]);
+            vertex(i, j + 1, quad[3]);
+
+            const int triangles[2][3] = { {0, 1, 2}, {0, 2, 3} };
+            for (const auto& triangle : triangles) {
+                std::memset(record, 0, 50);   // 法线置零（加载器会重新计算）
+                for (int k = 0; k < 3; ++k) {
+                    std::memcpy(record + 12 + k * 12, quad[triangle[k]], 12);
+                }
+                record += 50;
+            }
+        }
+        file.write(row);
+    }
+
+    out() << "生成测试网格: " << filePath << " (" << triangleCount << " 三角形, "
+          << QString::number(file.size() / 1048576.0, 'f', 1) << " MB)\n";
+    out().flush();
+    return true;
+}
+
+int countVertices(Qt3DCore::QEntity* root)
+{
+    int count = 0;
+    const auto attributes = root->findChildren<Qt3DRender::QAttribute*>();
+    for (Qt3DRender::QAttribute* attribute : attributes) {
+        if (attribute->name() == Qt3DRender::QAttribute::defaultPositionAttributeName()) {
+            count += int(attribute->count());
+        }
+    }
+    return count;
+}
+
+bool runOnce(const QString& filePath, bool nativeStl, RunResult& result)
+{
+    ImportProfile profile = ImportProfile::fullQuality();
+    profile.nativeStl = nativeStl;
+
+    AssimpModelLoader loader;
+    loader.setImportProfile(profile);
+
+    QElapsedTimer timer;
+    timer.start();
+    Qt3DCore::QEntity* entity = loader.loadModel(filePath, nullptr);
+    result.totalMsec = timer.nsecsElapsed() / 1.0e6;
+
+    if (!entity) {
+        qWarning() << "加载失败:" << loader.getErrorMessage();
+        return false;
+    }
+
+    result.vertexCount = countVertices(entity);
+    result.stages = loader.stageTimings();
+    delete entity;
+    return true;
+}
+
+QJsonObject benchmark(const QString& filePath, const QString& name, bool nativeStl, int runs)
+{
+    QVector<RunResult> results;
+    for (int i = 0; i < runs; ++i) {
+        RunResult result;
+        if (!runOnce(filePath, nativeStl, result)) break;
+        results.append(result);
+    }
+
+    QJsonObject json;
+    json["file"] = QFileInfo(filePath).fileName();
+    json["path"] = name;
+    if (results.isEmpty()) {
+        json["error"] = true;
+        out() << QString("  %1 加载失败\n").arg(name, -8);
+        return json;
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const RunResult& a, const RunResult& b) { return a.totalMsec < b.totalMsec; });
+    const RunResult& best = results.first();
+    const double median = results.at(results.size() / 2).totalMsec;
+
+    QJsonObject stages;
+    QStringList stageText;
+    for (const ImportStageTiming& stage : best.stages) {
+        stages[stage.stage] = stage.msec;
+        stageText << QString("%1 %2").arg(stage.stage).arg(stage.msec, 0, 'f', 1);
+    }
+
+    json["runs"] = results.size();
+    json["bestMs"] = best.totalMsec;
+    json["medianMs"] = median;
+    json["vertices"] = best.vertexCount;
+    json["stages"] = stages;
+
+    out() << QString("  %1 最快 %2 ms  中位 %3 ms  顶点 %4\n")
+             .arg(name, -8)
+             .arg(best.totalMsec, 9, 'f', 1)
+             .arg(median, 9, 'f', 1)
+             .arg(best.vertexCount)
+          << "           " << stageText.join(" | ") << "\n";
+    out().flush();
+    return json;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("STL加载基准：原生加载器 vs Assimp");
+    parser.addHelpOption();
+    QCommandLineOption runsOption("runs", "每种路径的运行次数", "N", "3");
+    QCommandLineOption sizeOption("size-mb", "未指定文件时生成的测试网格大小（MB）", "N", "100");
+    QCommandLineOption jsonOption("json", "结果写入JSON文件", "file");
+    parser.addOptions({ runsOption, sizeOption, jsonOption });
+    parser.addPositionalArgument("files", "STL文件", "[file.stl ...]");
+    parser.process(app);
+
+    const int runs = qMax(1, parser.value(runsOption).toInt());
+    QStringList files = parser.positionalArguments();
+
+    QString generatedFile;
+    if (files.isEmpty()) {
+        generatedFile = QDir::temp().filePath("stlbench_torus.stl");
+        if (!writeTorusStl(generatedFile, parser.value(sizeOption).toLongLong() * 1048576)) {
+            return 1;
+        }
+        files << generatedFile;
+    }
+
+    QJsonArray results;
+    for (const QString& filePath : files) {
+        out() << QFileInfo(filePath).fileName() << " ("
+              << QString::number(QFileInfo(filePath).size() / 1048576.0, 'f', 1) << " MB)\n";
+
+        const QJsonObject native = benchmark(filePath, "native", true, runs);
+        const QJsonObject assimp = benchmark(filePath, "assimp", false, runs);
+        results.append(native);
+        results.append(assimp);
+
+        if (native.contains("bestMs") && assimp.contains("bestMs")) {
+            out() << "  加速比 " << QString::number(assimp["bestMs"].toDouble() / native["bestMs"].toDouble(), 'f', 2)
+                  << "x\n";
+        }
+        out().flush();
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QFile jsonFile(parser.value(jsonOption));
+        if (jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            jsonFile.write(QJsonDocument(results).toJson());
+        } else {
+            qWarning() << "无法写入" << jsonFile.fileName();
+        }
+    }
+
+    if (!generatedFile.isEmpty()) {
+        QFile::remove(generatedFile);
+    }
+    return 0;
+}
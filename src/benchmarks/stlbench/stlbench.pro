@@ -0,0 +1,35 @@
+# STL加载基准：原生加载器 vs Assimp
+# 用法：stlbench [--runs N] [--size-mb N] [--json result.json] [file.stl ...]
+
+QT       += core gui 3dcore 3drender 3dextras concurrent
+CONFIG   += c++17 console
+CONFIG   -= app_bundle
+
+TARGET = stlbench
+
+SRC_DIR = $$PWD/../..
+INCLUDEPATH += $$SRC_DIR
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/assimpmodelloader.cpp \
+    $$SRC_DIR/gltfmodelloader.cpp \
+    $$SRC_DIR/stlmeshloader.cpp \
+    $$SRC_DIR/texturecache.cpp \
+    $$SRC_DIR/tracelog.cpp
+
+HEADERS += \
+    $$SRC_DIR/assimpmodelloader.h \
+    $$SRC_DIR/gltfmodelloader.h \
+    $$SRC_DIR/meshdata.h \
+    $$SRC_DIR/stlmeshloader.h \
+    $$SRC_DIR/texturecache.h \
+    $$SRC_DIR/tracelog.h
+
+win32 {
+    # assimp动态库及其依赖的动态库所在目录
+    INCLUDEPATH += $$PWD/../../../../../Assimp/include
+    LIBS += -L$$PWD/../../../../../Assimp/lib -lassimp-vc142-mt
+    LIBS += -L$$PWD/../../../../../Assimp/bin
+}
+unix: LIBS += -lassimp
@@ -62,8 +62,7 @@ int BaseConnector::state() const
 
 void BaseConnector::setState(int newState)
 {
-    if (m_state == newState)
+    if (m_state.exchange(newState) == newState)
         return;
-    m_state = newState;
     emit stateChanged();
 }
@@ -6,6 +6,7 @@
 #include <QThread>
 #include <QCoreApplication>
 #include <QtConcurrentRun>
+#include <atomic>
 
 class BaseConnector : public QObject
 {
@@ -85,7 +86,8 @@ protected:
     QVariant toValidValue(QVariant value, BaseConnector::Type type);
 
 private:
-    int m_state;
+    // OPC UA会话线程也会更新状态，用原子量
+    std::atomic<int> m_state{0};
 };
 
 #include <QTimer>
@@ -141,11 +143,11 @@ namespace MyThread {
 // 也就是说，线程在析构时才会出问题？
 // 经过测试，线程会在退出前，有可能会被重复使用。
 template <typename Function>
-auto run(Function &&f)
+auto run(Function &&f, QThread::Priority priority = QThread::TimeCriticalPriority)
 {
     MyThreadPrivate *myThread = new MyThreadPrivate(f);
     // 使用 QThread::TimeCriticalPriority 效果还可以
-    myThread->start(QThread::TimeCriticalPriority);
+    myThread->start(priority);
 
     return myThread;
 }
@@ -1,12 +1,14 @@
 QT += network concurrent
 
 DEFINES += COM_OPCUA
+DEFINES += COM_FILEREPLAY
 
 SOURCES += \
     $$PWD/baseconnector.cpp
 
 HEADERS += \
-    $$PWD/baseconnector.h
+    $$PWD/baseconnector.h \
+    $$PWD/latestvaluemailbox.h
 
 contains(DEFINES, COM_OPCUA){
 SOURCES += \
@@ -18,4 +20,12 @@ HEADERS += \
     $$PWD/opcua/open62541.h
 }
 
+contains(DEFINES, COM_FILEREPLAY){
+SOURCES += \
+    $$PWD/filereplay/filereplayconnector.cpp
+
+HEADERS += \
+    $$PWD/filereplay/filereplayconnector.h
+}
+
 INCLUDEPATH += $$PWD
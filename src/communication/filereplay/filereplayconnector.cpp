@@ -0,0 +1,402 @@
+﻿#include "filereplayconnector.h"
+
+#include <QUrl>
+#include <QUrlQuery>
+#include <QThread>
+#include <QDebug>
+
+FileReplayConnector::FileReplayConnector(QObject *parent)
+    : BaseConnector{parent}
+{
+}
+
+FileReplayConnector::~FileReplayConnector()
+{
+    qDebug() << "~FileReplayConnector()";
+    release();
+}
+
+bool FileReplayConnector::isFileSource(const QString &source)
+{
+    QString str = source.trimmed();
+    if(str.startsWith("file:", Qt::CaseInsensitive))
+    {
+        return true;
+    }
+
+    // 去掉可能带的参数再判断后缀
+    return str.section('?', 0, 0).endsWith(".csv", Qt::CaseInsensitive);
+}
+
+int FileReplayConnector::init(QStringList paramList)
+{
+    if(paramList.length() < 1 || paramList.length() > 2)
+    {
+        return -1;
+    }
+
+    release();
+
+    QString source = paramList.first().trimmed();
+    mPrefix = paramList.length() > 1 ? paramList.at(1) : QString();
+
+    // 参数放在 ? 之后，file:// 地址和普通路径都支持
+    QUrlQuery query(source.section('?', 1));
+    source = source.section('?', 0, 0);
+    mFilePath = source.startsWith("file:", Qt::CaseInsensitive) ? QUrl(source).toLocalFile() : source;
+
+    bool ok = false;
+    double speed = query.queryItemValue("speed").toDouble(&ok);
+    mSpeed = (ok && speed > 0) ? qBound(0.01, speed, 1000.0) : 1.0;
+    double rate = query.queryItemValue("rate").toDouble(&ok);
+    mRowRate = (ok && rate > 0) ? rate : 100.0;
+    QString loop = query.queryItemValue("loop");
+    mLoop = (loop == "1" || loop.compare("true", Qt::CaseInsensitive) == 0);
+
+    mFile.setFileName(mFilePath);
+    if(mFile.open(QIODevice::ReadOnly) == false)
+    {
+        qDebug() << "file replay open fail:" << mFilePath << mFile.errorString();
+        setState(0);
+        return -1;
+    }
+
+    mBuffer.clear();
+    mBufferPos = 0;
+
+    // 表头
+    QByteArray header;
+    if(nextLine(header) == false)
+    {
+        qDebug() << "file replay: empty file" << mFilePath;
+        mFile.close();
+        setState(0);
+        return -1;
+    }
+
+    mColumns.clear();
+    foreach (QByteArray name, header.split(','))
+    {
+        mColumns << QString::fromUtf8(name.trimmed());
+    }
+    QString firstColumn = mColumns.first().toLower();
+    mHasTimeColumn = (firstColumn == "time" || firstColumn == "timestamp");
+    mDataOffset = mFile.pos() - (mBuffer.size() - mBufferPos);
+
+    mValues.clear();
+    mRowsReplayed = 0;
+    mTryRelease = false;
+
+    qDebug() << "file replay:" << mFilePath << mColumns.length() << "columns,"
+             << "speed" << mSpeed << "loop" << mLoop
+             << (mHasTimeColumn ? "time column" : QString("%1 Hz").arg(mRowRate));
+
+    setState(1);
+
+    // 回放循环会一直运行到结束或释放，用独立线程，不占用全局线程池
+    mReplayThread = QThread::create([=](){ replayProcess(); });
+    mReplayThread->start();
+
+    return 0;
+}
+
+int FileReplayConnector::release()
+{
+    mTryRelease = true;
+    if(mReplayThread != nullptr)
+    {
+        mReplayThread->wait();
+        delete mReplayThread;
+        mReplayThread = nullptr;
+    }
+
+    if(mFile.isOpen())
+    {
+        mFile.close();
+    }
+    mBuffer.clear();
+    mBufferPos = 0;
+
+    if(state() == 1)
+    {
+        setState(0);
+    }
+
+    return 0;
+}
+
+int FileReplayConnector::readValue(QString path, QVariant &value, QString *errorString)
+{
+    QMutexLocker locker(&mValueMutex);
+
+    if(state() != 1 && mValues.isEmpty())
+    {
+        return -1000;
+    }
+
+    QString name = columnName(path);
+    if(mValues.contains(name) == false)
+    {
+        if(errorString != nullptr)
+        {
+            *errorString = QString("文件中没有此列：%1").arg(name);
+        }
+        return -1;
+    }
+
+    value = mValues.value(name);
+    return 0;
+}
+
+int FileReplayConnector::writeValue(QString path, QVariant value, Type type, QString *errorString)
+{
+    Q_UNUSED(path)
+    Q_UNUSED(value)
+    Q_UNUSED(type)
+
+    if(errorString != nullptr)
+    {
+        *errorString = "只读数据源";
+    }
+    return -1;
+}
+
+int FileReplayConnector::readValueList(QList<DataUnit> &dataList, QString *errorString)
+{
+    QMutexLocker locker(&mValueMutex);
+
+    if(state() != 1 && mValues.isEmpty())
+    {
+        return -1000;
+    }
+
+    int ret = 0;
+    for(int i = 0; i < dataList.length(); i++)
+    {
+        QString name = columnName(dataList.at(i).path);
+        if(mValues.contains(name))
+        {
+            dataList[i].value = mValues.value(name);
+        }
+        else
+        {
+            ret = -1;
+            if(errorString != nullptr)
+            {
+                *errorString += name + ",";
+            }
+        }
+    }
+
+    return ret;
+}
+
+int FileReplayConnector::writeValueList(QList<DataUnit> dataList, QString *errorString)
+{
+    Q_UNUSED(dataList)
+
+    if(errorString != nullptr)
+    {
+        *errorString = "只读数据源";
+    }
+    return -1;
+}
+
+int FileReplayConnector::monitorValues(QStringList pathList, QString *errorString)
+{
+    Q_UNUSED(errorString)
+
+    QMutexLocker locker(&mValueMutex);
+
+    if(state() != 1)
+    {
+        return -1;
+    }
+
+    foreach (QString varPath, pathList)
+    {
+        if(mMonVarMap.contains(varPath) == false)
+        {
+            mMonVarMap.insert(varPath, QVariant());
+        }
+    }
+
+    return 0;
+}
+
+QStringList FileReplayConnector::monitoredValueList()
+{
+    QMutexLocker locker(&mValueMutex);
+    return mMonVarMap.keys();
+}
+
+void FileReplayConnector::clearMonitor()
+{
+    QMutexLocker locker(&mValueMutex);
+    mMonVarMap.clear();
+}
+
+void FileReplayConnector::replayProcess()
+{
+    qDebug() << "file replay thread:" << QThread::currentThread();
+
+    QElapsedTimer clock;
+    clock.start();
+
+    bool hasFirstTime = false;
+    double firstTime = 0;
+    qint64 rowIndex = 0;
+
+    QByteArray line;
+    while(mTryRelease == false)
+    {
+        if(nextLine(line) == false)
+        {
+            if(mLoop == false || rewind() == false)
+            {
+                break;
+            }
+
+            // 从头回放，时间基准重新开始
+            clock.restart();
+            hasFirstTime = false;
+            rowIndex = 0;
+            continue;
+        }
+
+        if(line.trimmed().isEmpty())
+        {
+            continue;
+        }
+
+        // 计算这一行应当在回放开始后的多少毫秒出现
+        double rowTime = rowIndex / mRowRate;
+        if(mHasTimeColumn)
+        {
+            bool ok = false;
+            double t = line.left(line.indexOf(',')).trimmed().toDouble(&ok);
+            if(ok)
+            {
+                if(hasFirstTime == false)
+                {
+                    firstTime = t;
+                    hasFirstTime = true;
+                }
+                rowTime = t - firstTime;
+            }
+        }
+        rowIndex++;
+
+        qint64 dueMs = qint64(rowTime * 1000.0 / mSpeed);
+        while(mTryRelease == false && clock.elapsed() < dueMs)
+        {
+            QThread::msleep(qBound<qint64>(1, dueMs - clock.elapsed(), 10));
+        }
+        if(mTryRelease == true)
+        {
+            break;
+        }
+
+        applyRow(line);
+        mRowsReplayed++;
+    }
+
+    qInfo() << "file replay finished:" << mFilePath << mRowsReplayed.load() << "rows";
+
+    if(mTryRelease == false)
+    {
+        // 播放完毕（非循环），与连接断开一样处理
+        QMetaObject::invokeMethod(this, [=](){
+            if(state() == 1)
+            {
+                setState(0);
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+bool FileReplayConnector::nextLine(QByteArray &line)
+{
+    while(true)
+    {
+        int end = mBuffer.indexOf('\n', mBufferPos);
+        if(end >= 0)
+        {
+            line = mBuffer.mid(mBufferPos, end - mBufferPos);
+            mBufferPos = end + 1;
+            if(line.endsWith('\r'))
+            {
+                line.chop(1);
+            }
+            return true;
+        }
+
+        // 缓冲区中没有完整的一行，丢掉已处理的部分再读一块
+        mBuffer.remove(0, mBufferPos);
+        mBufferPos = 0;
+
+        QByteArray chunk = mFile.read(FILE_REPLAY_CHUNK_SIZE);
+        if(chunk.isEmpty())
+        {
+            // 文件结束，最后一行可能没有换行符
+            if(mBuffer.isEmpty())
+            {
+                return false;
+            }
+            line = mBuffer;
+            mBuffer.clear();
+            if(line.endsWith('\r'))
+            {
+                line.chop(1);
+            }
+            return true;
+        }
+        mBuffer.append(chunk);
+    }
+}
+
+bool FileReplayConnector::rewind()
+{
+    mBuffer.clear();
+    mBufferPos = 0;
+    return mFile.seek(mDataOffset);
+}
+
+void FileReplayConnector::applyRow(const QByteArray &line)
+{
+    QList<QByteArray> fields = line.split(',');
+
+    QList<QPair<QString, QVariant>> changedList;
+    {
+        QMutexLocker locker(&mValueMutex);
+
+        for(int i = 0; i < fields.length() && i < mColumns.length(); i++)
+        {
+            bool ok = false;
+            double number = fields.at(i).trimmed().toDouble(&ok);
+            mValues.insert(mColumns.at(i),
+                           ok ? QVariant(number) : QVariant(QString::fromUtf8(fields.at(i).trimmed())));
+        }
+
+        for(auto it = mMonVarMap.begin(); it != mMonVarMap.end(); ++it)
+        {
+            QVariant value = mValues.value(columnName(it.key()));
+            if(value.isValid() && value != it.value())
+            {
+                it.value() = value;
+                changedList << qMakePair(it.key(), value);
+            }
+        }
+    }
+
+    // 在锁外发信号，避免槽函数中再次读取时死锁
+    for(int i = 0; i < changedList.length(); i++)
+    {
+        emit valueChanged(changedList.at(i).first, changedList.at(i).second);
+    }
+}
+
+QString FileReplayConnector::columnName(const QString &path) const
+{
+    return mPrefix.isEmpty() ? path : mPrefix + "." + path;
+}
@@ -0,0 +1,111 @@
+﻿#ifndef FILEREPLAYCONNECTOR_H
+#define FILEREPLAYCONNECTOR_H
+
+#include "baseconnector.h"
+
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QThread>
+#include <QElapsedTimer>
+#include <atomic>
+
+#ifdef Q_OS_WIN
+#pragma execution_character_set("utf-8")
+#endif
+
+#define FILE_REPLAY_CHUNK_SIZE (256 * 1024)
+
+// 把控制器导出的CSV关节日志当作数据源，按原始时间（或缩放后的时间）逐行回放
+// 首行为表头（列名即变量路径），首列为 time/timestamp（秒）时按其定时，否则按固定频率
+// 文件按块流式读取，只保留当前一行的值，内存占用与文件大小无关
+class FileReplayConnector : public BaseConnector
+{
+    Q_OBJECT
+
+public:
+    explicit FileReplayConnector(QObject *parent = nullptr);
+    ~FileReplayConnector();
+
+    // 是否为文件数据源（file:// 地址或 .csv 文件路径）
+    static bool isFileSource(const QString &source);
+
+    // 初始化
+    // 第一个参数为文件地址，可带参数：file:///data/joints.csv?speed=2&loop=1&rate=100
+    //   speed：回放速度倍率；loop：到结尾后从头回放；rate：无时间列时的行频率（Hz）
+    // 第二个参数为变量前缀（可为空），与OPC UA一样，读取路径为 前缀.路径
+    int init(QStringList paramList);
+
+    // 释放资源，释放后，不能进行读写操作
+    Q_INVOKABLE int release();
+
+    // 读取当前回放位置的数据
+    int readValue(QString path,
+                  QVariant &value,
+                  QString *errorString = nullptr);
+
+    // 文件数据源只读
+    int writeValue(QString path,
+                   QVariant value,
+                   Type type,
+                   QString *errorString = nullptr);
+
+    // 批量读取当前回放位置的数据
+    int readValueList(QList<DataUnit> &dataList,
+                      QString *errorString = nullptr);
+
+    // 文件数据源只读
+    int writeValueList(QList<DataUnit> dataList,
+                       QString *errorString = nullptr);
+
+    // 监听数据，值变化时发出valueChanged
+    int monitorValues(QStringList pathList,
+                      QString *errorString = nullptr);
+
+    // 有哪些数据已经被监控
+    QStringList monitoredValueList();
+
+    void clearMonitor();
+
+    // 已回放的行数
+    qint64 rowsReplayed() const { return mRowsReplayed.load(); }
+
+private:
+    // 回放线程
+    void replayProcess();
+
+    // 从文件中取下一行（按块读取）；文件结束返回false
+    bool nextLine(QByteArray &line);
+
+    // 回到第一行数据
+    bool rewind();
+
+    // 应用一行数据，并对监听的变量发出valueChanged
+    void applyRow(const QByteArray &line);
+
+    QString columnName(const QString &path) const;
+
+private:
+    QString mFilePath;
+    QString mPrefix;
+    double mSpeed = 1.0;
+    double mRowRate = 100.0;
+    bool mLoop = false;
+
+    QFile mFile;
+    QByteArray mBuffer;
+    int mBufferPos = 0;
+    qint64 mDataOffset = 0;         // 第一行数据在文件中的偏移
+    QStringList mColumns;
+    bool mHasTimeColumn = false;
+
+    QMutex mValueMutex;
+    QMap<QString, QVariant> mValues;        // 当前行：列名 -> 值
+    QMap<QString, QVariant> mMonVarMap;     // 监听的变量及其上次发出的值
+
+    QThread *mReplayThread = nullptr;
+    std::atomic<bool> mTryRelease{false};
+    std::atomic<qint64> mRowsReplayed{0};
+};
+
+#endif // FILEREPLAYCONNECTOR_H
@@ -0,0 +1,47 @@
+﻿#ifndef LATESTVALUEMAILBOX_H
+#define LATESTVALUEMAILBOX_H
+
+#include <atomic>
+
+// 单生产者/单消费者的“最新值”邮箱（三缓冲），读写双方都不加锁、不等待
+// 生产者填好writeBuffer()后publish()；消费者update()返回true时换入最新的值，再用readBuffer()读取
+// 消费者来不及取走的旧值直接被覆盖，只保留最新的一份
+template <typename T>
+class LatestValueMailbox
+{
+public:
+    // 生产者
+    T &writeBuffer() { return mBuffers[mWriteIdx]; }
+
+    void publish()
+    {
+        const int previous = mMiddle.exchange(mWriteIdx | FRESH_FLAG, std::memory_order_acq_rel);
+        mWriteIdx = previous & INDEX_MASK;
+    }
+
+    // 消费者
+    bool update()
+    {
+        if((mMiddle.load(std::memory_order_relaxed) & FRESH_FLAG) == 0)
+        {
+            return false;
+        }
+
+        const int previous = mMiddle.exchange(mReadIdx, std::memory_order_acq_rel);
+        mReadIdx = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T &readBuffer() const { return mBuffers[mReadIdx]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH_FLAG = 4;
+
+    T mBuffers[3];
+    int mWriteIdx = 0;              // 只由生产者访问
+    int mReadIdx = 1;               // 只由消费者访问
+    std::atomic<int> mMiddle{2};    // 中间缓冲的序号，FRESH_FLAG表示还没被取走
+};
+
+#endif // LATESTVALUEMAILBOX_H
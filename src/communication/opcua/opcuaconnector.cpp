@@ -5,96 +5,455 @@
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QCoreApplication>
+#include <chrono>
+#include <cstring>
 
 QVariant convertUAVariantToQVariant(const UA_Variant &data);
 
+// DataValue的源时间戳转换为UTC微秒，没有时返回0
+static qint64 dataValueSourceTimeUs(const UA_DataValue &value)
+{
+    if(value.hasSourceTimestamp == false)
+    {
+        return 0;
+    }
+    return (value.sourceTimestamp - UA_DATETIME_UNIX_EPOCH) / UA_DATETIME_USEC;
+}
+
+// 客户端循环在UA_Client_run_iterate中等待socket时，可以被其它线程唤醒：
+// 每次连接建立一个连到自己的本地UDP socket，等待时同时监听它，投递操作时发送一个字节
+// 只在客户端循环调用UA_Client_run_iterate期间设置，同步服务调用照常等待响应
+static thread_local UA_SOCKET sLoopWakeSocket = UA_INVALID_SOCKET;
+
+typedef UA_StatusCode (*ConnectionRecv)(UA_Connection *connection, UA_ByteString *response, UA_UInt32 timeout);
+static std::atomic<ConnectionRecv> sTcpRecv{nullptr};
+
+static UA_SOCKET createWakeSocket()
+{
+    UA_initialize_architecture_network();
+
+    UA_SOCKET sock = UA_socket(AF_INET, SOCK_DGRAM, 0);
+    if(sock == UA_INVALID_SOCKET)
+    {
+        return UA_INVALID_SOCKET;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addrLen = sizeof(addr);
+    if(UA_bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0
+        || UA_getsockname(sock, (struct sockaddr*)&addr, &addrLen) != 0
+        || UA_connect(sock, (struct sockaddr*)&addr, addrLen) != 0)
+    {
+        UA_close(sock);
+        return UA_INVALID_SOCKET;
+    }
+    UA_socket_set_nonblocking(sock);
+
+    return sock;
+}
+
+// 替换TCP连接的recv：同时等待数据和唤醒，被唤醒时按超时返回，UA_Client_run_iterate随即结束
+static UA_StatusCode wakeableRecv(UA_Connection *connection, UA_ByteString *response, UA_UInt32 timeout)
+{
+    const ConnectionRecv tcpRecv = sTcpRecv.load();
+    const UA_SOCKET wakeSocket = sLoopWakeSocket;
+    if(wakeSocket == UA_INVALID_SOCKET || timeout == 0
+        || connection->state == UA_CONNECTIONSTATE_CLOSED)
+    {
+        return tcpRecv(connection, response, timeout);
+    }
+
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(connection->sockfd, &fdset);
+    UA_fd_set(wakeSocket, &fdset);
+    UA_UInt32 timeoutUs = timeout * 1000;
+    struct timeval tv = {(long int)(timeoutUs / 1000000), (int)(timeoutUs % 1000000)};
+    int resultSize = UA_select(qMax(connection->sockfd, wakeSocket) + 1, &fdset, NULL, NULL, &tv);
+    if(resultSize == 0)
+    {
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+    }
+    if(resultSize < 0)
+    {
+        // 出错的话交给原来的recv处理（被中断按超时返回，其它错误关闭连接）
+        return tcpRecv(connection, response, 0);
+    }
+
+    if(UA_fd_isset(wakeSocket, &fdset))
+    {
+        // 多次唤醒合并为一次
+        char buf[64];
+        while(UA_recv(wakeSocket, buf, sizeof(buf), 0) > 0)
+        {
+        }
+    }
+    if(UA_fd_isset(connection->sockfd, &fdset) == false)
+    {
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+    }
+
+    return tcpRecv(connection, response, 0);
+}
+
+static UA_Connection wakeableConnectionInit(UA_ConnectionConfig config, const UA_String endpointUrl,
+                                            UA_UInt32 timeout, const UA_Logger *logger)
+{
+    UA_Connection connection = UA_ClientConnectionTCP_init(config, endpointUrl, timeout, logger);
+    sTcpRecv = connection.recv;
+    connection.recv = wakeableRecv;
+    return connection;
+}
+
 OPCUAConnector::OPCUAConnector(QObject *parent)
     : BaseConnector{parent}
 {
-    // 周期性调用，处理opcua的各种事件
-    auto functor = [=](){
-        qDebug() << "opcua operation thread:" << QThread::currentThread();
+    // 客户端循环线程在连接成功后才启动，未连接时不占用CPU
+}
 
-        QElapsedTimer readValTimer;
-        readValTimer.start();
+OPCUAConnector::~OPCUAConnector()
+{
+    qDebug() << "~OPCUAConnector()";
 
-        while(mExited == false)
+    if(mSession != nullptr)
+    {
+        bool adopted = false;
         {
-            bool disconnected = false;
-            // 已打算释放的话，就不要继续处理了
-            if(mClient != nullptr && state() == 1 && mTryRelease == false)
+            QMutexLocker locker(&mSession->mutex);
+            mSession->owner = nullptr;
+            mSession->exit = true;
+            adopted = mSession->adopted;
+            if(adopted == false)
             {
-                // 一定要放在这里，不然一直阻塞
-                QMutexLocker locker(&mClientMutex);
+                mSession->markReleased();
+            }
+            mSession->wake();
+        }
 
-                // 设置为0好像也是可以的 https://github.com/open62541/open62541/issues/3817
-                if(mClient)
-                {
-                    // https://blog.csdn.net/whahu1989/article/details/102905028
-                    // UA_Client_run_iterate()的第二个参数1000表示1000ms，
-                    // 意思是发送完Publish请求后，Server要在1000ms内回复，不是回复被监测变量值，
-                    // 而是回复已收到该Publish请求。也可以设置为0，这样就不用等Server的回复了，属于异步写法。
-                    // 设置非0值会导致线程堵塞相应的时间
-                    auto ret = UA_Client_run_iterate(mClient, 0); // 这个函数需要周期性调用，否则无法实现监听
-
-                    UA_StatusCode statusCode;
-
-                    UA_Client_getState(mClient, NULL, NULL, &statusCode);
-                    // qDebug() << "status code:" << QString::number(statusCode, 16);
-                    if(UA_StatusCode_isGood(statusCode) == false)
-                    {
-                        disconnected = true;
-                        mTryRelease  = true;
-                        qDebug() << "opcaua disconnected";
-                    }
-                }
+        // 正在连接的后台线程不再访问本对象，连接结束后自行断开，不等它；
+        // 客户端循环很快就会发现退出标志，只等它从连接器上摘下客户端，断开连接在它的线程中继续
+        if(adopted)
+        {
+            mSession->releasedFuture.wait();
+        }
+        else if(mSession->previous.valid())
+        {
+            // 上一次连接的循环可能还在清理
+            mSession->previous.wait();
+        }
+    }
 
-                if(mClient == nullptr) continue;
+    {
+        QMutexLocker locker(&mClientMutex);
+        clearNodeIdCache(false);
+    }
 
-#ifdef USE_OPCUA_SUBSCRIPTION
-#else
-                if(readValTimer.elapsed() >= 100) // 100ms读一次就好，不要太快
-                {
-                    readValTimer.restart();
+    // this->release();
+
+    qDebug() << "release completed";
+}
+
+OPCUAConnector::Session::~Session()
+{
+    if(wakeSocket != UA_INVALID_SOCKET)
+    {
+        UA_close(wakeSocket);
+    }
+}
 
-                    // QElapsedTimer timer1;
-                    // timer1.start();
+void OPCUAConnector::Session::wake()
+{
+    if(wakeSocket != UA_INVALID_SOCKET)
+    {
+        char byte = 0;
+        UA_send(wakeSocket, &byte, 1, 0);
+    }
+}
 
-                    customSubsProcess(); // 用周期性读取来替代opcua的订阅
+void OPCUAConnector::Session::markReleased()
+{
+    if(releasedSet == false)
+    {
+        releasedSet = true;
+        released.set_value();
+    }
+}
 
-                    // qDebug() << "readAllSubscribValue interval:" << timer1.elapsed() << mMonVarMap.count() << this;
-                }
-#endif
+std::shared_ptr<OPCUAConnector::Session> OPCUAConnector::startSession(const QString &hostInfo, bool notify)
+{
+    stopSession();
+
+    std::shared_ptr<Session> session = std::make_shared<Session>();
+    session->owner = this;
+    session->notify = notify;
+    session->hostInfo = hostInfo;
+    session->resultFuture = session->result.get_future().share();
+    session->releasedFuture = session->released.get_future().share();
+    session->wakeSocket = createWakeSocket();
+    // 上一次连接在它自己的线程中断开，这次连接成功后要等它不再访问连接器才能接管
+    if(mSession != nullptr)
+    {
+        session->previous = mSession->releasedFuture;
+    }
+    mSession = session;
+
+    // 循环大部分时间阻塞在socket上，不需要TimeCriticalPriority
+    MyThread::run([session](){ sessionThread(session); }, QThread::HighPriority);
+
+    return session;
+}
+
+void OPCUAConnector::stopSession()
+{
+    if(mSession == nullptr)
+    {
+        return;
+    }
+
+    // 只设置标志，不等待：循环退出后自己断开连接，正在连接的话连接结束后直接断开
+    // 之后投递的操作留给下一次连接
+    QMutexLocker locker(&mSession->mutex);
+    mSession->exit = true;
+    if(mSession->adopted == false)
+    {
+        // 还没交给连接器，之后也不会再访问连接器
+        mSession->markReleased();
+    }
+    mSession->wake();
+}
+
+// 连接（UA_Client_connect和读取OperationLimits都会阻塞）、客户端循环、断开连接都在这个线程中进行
+void OPCUAConnector::sessionThread(std::shared_ptr<Session> session)
+{
+    qDebug() << "opcua operation thread:" << QThread::currentThread();
+
+    // 连接过程中不持有连接器的任何锁，连接器可以随时释放或析构
+    OperationLimits limits;
+    UA_Client *client = connectClient(session->hostInfo, limits);
+
+    // 上一次连接的循环可能还在清理连接器，等它结束再接管
+    if(client != nullptr && session->previous.valid())
+    {
+        session->previous.wait();
+    }
+
+    OPCUAConnector *owner = nullptr;
+    {
+        QMutexLocker locker(&session->mutex);
+
+        int ret = (client == nullptr) ? -1 : 0;
+        if(session->owner != nullptr && session->exit == false)
+        {
+            if(client != nullptr)
+            {
+                owner = session->owner;
+                session->adopted = true;
+                owner->adoptClient(client, limits);
+            }
+            else
+            {
+                session->markReleased();
             }
 
-            if(disconnected == true)
+            if(session->notify)
             {
-                QMetaObject::invokeMethod(this, "release", Qt::QueuedConnection);
-                // release();
+                // 回到连接器所在的线程通知；连接器析构后不再送达
+                OPCUAConnector *obj = session->owner;
+                QMetaObject::invokeMethod(obj, [obj, session, ret](){
+                    // 结果送达前又释放或者重新连接过的话不再通知
+                    if(obj->mSession != session || session->exit)
+                    {
+                        return;
+                    }
+                    obj->mConnectPending = false;
+                    if(ret != 0)
+                    {
+                        obj->setState(0);
+                    }
+                    emit obj->connectFinished(ret);
+                }, Qt::QueuedConnection);
             }
+        }
+        else
+        {
+            // 连接过程中已释放或析构
+            session->markReleased();
+            ret = -2;
+        }
 
-            // QThread::usleep(1);
-            QThread::msleep(1);
+        session->result.set_value(ret);
+    }
+
+    if(owner == nullptr)
+    {
+        if(client != nullptr)
+        {
+            UA_Client_disconnect(client);
+            UA_Client_delete(client);
         }
+        return;
+    }
 
-        qInfo() << "UA_Client_run_iterate finished";
-    };
-    // mFunture = QtConcurrent::run(functor);
-    MyThread::run(functor);
+    owner->clientLoop(*session);
 }
 
-OPCUAConnector::~OPCUAConnector()
+void OPCUAConnector::adoptClient(UA_Client *client, const OperationLimits &limits)
 {
-    qDebug() << "~OPCUAConnector()";
-    mExited = true;
-    // mFunture.waitForFinished();
+    QMutexLocker locker(&mClientMutex);
 
-    // 稍微延时一下，等待子线程退出
-    QThread::msleep(20);
+    mClient = client;
+    mMaxNodesPerRead = limits.maxNodesPerRead;
+    mMaxNodesPerWrite = limits.maxNodesPerWrite;
+    mMaxMonitoredItemsPerCall = limits.maxMonitoredItemsPerCall;
+    mMaxNodesPerRegister = limits.maxNodesPerRegister;
 
-    // this->release();
+    // 重新注册之前注册过的变量（重连后旧句柄已失效），在客户端循环中进行
+    mNodeIdCacheStale = true;
+    mConnectionLost = false;
+    mLoopWakeups = 0;
 
-    qDebug() << "release completed";
+    // 交给连接器之后，回调才访问连接器
+    UA_Client_getConfig(client)->clientContext = this;
+
+    // mClientConnected = true;
+    setState(1);
+    qDebug() << "++++++++++++client connect finished";
+}
+
+// 处理opcua的各种事件：在socket上等待数据（订阅通知、异步响应）或下一个定时任务，
+// 等待时间还受采样流的读取周期限制；投递操作时立即唤醒，空闲时大约每秒唤醒一次
+// 收到退出通知或者连接断开时，在本线程中断开连接，GUI线程不会因此阻塞
+void OPCUAConnector::clientLoop(Session &session)
+{
+    QElapsedTimer readValTimer;
+    readValTimer.start();
+
+    while(session.exit == false && mConnectionLost == false)
+    {
+        // 同步接口正在等待客户端时先让它执行，避免被下一次socket等待拖住
+        while(mClientWaiters > 0 && session.exit == false)
+        {
+            QThread::yieldCurrentThread();
+        }
+
+        // 其它线程投递过来的操作（切换监听方式、启停采样流、更换命名空间、注册变量等）
+        runCommands(session);
+
+        QMutexLocker locker(&mClientMutex);
+        if(mClient == nullptr)
+        {
+            break;
+        }
+
+        // 连接或更换命名空间后，按记录的变量重新注册
+        ensureNodeIdCache();
+
+        // 计算本次最多等待多久
+        qint64 timeout = LOOP_MAX_WAIT;
+        {
+            QMutexLocker commandLocker(&mCommandMutex);
+            if(mCommands.isEmpty() == false)
+            {
+                timeout = 0;
+            }
+        }
+        if(mResubscribe || mClientWaiters > 0)
+        {
+            timeout = 0;
+        }
+        // 在途请求已满时只等响应，不按采样周期唤醒
+        // 采样流刚开始（或重新开始）时还没有读过，立即发出第一次读取
+        if(mStream.active && mUseSubscription == false && mStream.dataList.isEmpty() == false
+            && mReadsInFlight.size() < mMaxReadsInFlight)
+        {
+            const qint64 due = mStream.timer.isValid() ? mStream.intervalMs - mStream.timer.elapsed() : 0;
+            timeout = qMin<qint64>(timeout, due);
+        }
+        if(mUseSubscription == false && mMonVarMap.isEmpty() == false)
+        {
+            timeout = qMin<qint64>(timeout, 100 - readValTimer.elapsed());
+        }
+
+        // https://blog.csdn.net/whahu1989/article/details/102905028
+        // UA_Client_run_iterate()的第二个参数是在socket上等待数据的最长时间（毫秒），
+        // 收到任何消息（Publish响应、异步响应）或者到了内部定时任务的时间就会返回
+        // 投递操作或通知退出时会唤醒等待
+        sLoopWakeSocket = session.wakeSocket;
+        UA_Client_run_iterate(mClient, UA_UInt32(qMax<qint64>(0, timeout))); // 这个函数需要周期性调用，否则无法实现监听
+        sLoopWakeSocket = UA_INVALID_SOCKET;
+        mLoopWakeups.fetch_add(1, std::memory_order_relaxed);
+
+        UA_StatusCode statusCode;
+
+        UA_Client_getState(mClient, NULL, NULL, &statusCode);
+        // qDebug() << "status code:" << QString::number(statusCode, 16);
+        if(UA_StatusCode_isGood(statusCode) == false)
+        {
+            qDebug() << "opcaua disconnected";
+            break;
+        }
+
+        if(mResubscribe)
+        {
+            // 服务器删除了不活跃的订阅，按原来的变量重新订阅
+            mResubscribe = false;
+            resubscribe();
+        }
+
+        // 采样流：批量读取，或者发布订阅通知更新后的快照
+        sampleStreamProcess();
+
+        if(mUseSubscription == false && readValTimer.elapsed() >= 100) // 100ms读一次就好，不要太快
+        {
+            readValTimer.restart();
+
+            customSubsProcess(); // 用周期性读取来替代opcua的订阅
+        }
+    }
+
+    // 先在锁内把客户端从连接器上摘下来，之后断开连接时不再访问连接器
+    UA_Client *client = nullptr;
+    {
+        QMutexLocker locker(&mClientMutex);
+
+        client = mClient;
+        mClient = nullptr;
+        if(client != nullptr)
+        {
+            // 断开时的回调（状态变化、未完成的异步请求）据此不再访问连接器
+            UA_Client_getConfig(client)->clientContext = nullptr;
+        }
+
+        // 订阅和注册的句柄随会话一起关闭，不用逐个删除、注销
+        mMonIdxMap.clear();
+        mSubId = -1;
+        mMonVarMap.clear();
+        clearNodeIdCache(false);
+        mNodeIdCacheStale = true;
+
+        // 未完成的异步请求在断开时以BadShutdown回调，这里直接清掉记录
+        mReadsInFlight.clear();
+        mStream.reads.clear();
+
+        setState(0);
+    }
+    {
+        QMutexLocker locker(&session.mutex);
+        session.markReleased();
+    }
+
+    if(client != nullptr)
+    {
+        UA_StatusCode ret = UA_Client_disconnect(client); // 断开连接并释放会话资源
+        qInfo() << "UA_Client_disconnect" << UA_StatusCode_name(ret) << ret;
+        UA_Client_delete(client); // 释放对象
+    }
+
+    qInfo() << "UA_Client_run_iterate finished";
 }
 
 void customLogger(void *context,
@@ -109,30 +468,64 @@ void subscriptionInactivity(UA_Client *client,
 
 int OPCUAConnector::init(QStringList paramList)
 {
-    if(paramList.length() != 2)
+    if(paramList.length() != 2 || isConnecting())
     {
         return -1;
     }
 
-    if(mClient != nullptr)
+    release();
+
+    mHostInfo = paramList.first();
+    // 前缀在工作线程中更换，连接后按新前缀重新注册
+    const QString prefix = paramList.at(1);
+    postCommand([this, prefix](){
+        mPrefix = prefix;
+    });
+
+    // 同步初始化：等待后台线程的连接结果
+    std::shared_ptr<Session> session = startSession(mHostInfo, false);
+    int ret = session->resultFuture.get();
+    if(ret != 0)
+    {
+        setState(0);
+    }
+
+    return ret;
+}
+
+int OPCUAConnector::connectAsync(QStringList paramList)
+{
+    if(paramList.length() != 2 || isConnecting())
     {
-        release();
+        return -1;
     }
 
+    release();
+
     mHostInfo = paramList.first();
-    mPrefix =  paramList.at(1);
+    const QString prefix = paramList.at(1);
+    postCommand([this, prefix](){
+        mPrefix = prefix;
+    });
 
-    QMutexLocker locker(&mClientMutex);
+    mConnectPending = true;
+    startSession(mHostInfo, true);
+
+    return 0;
+}
 
-    mClient = UA_Client_new();
-    UA_ClientConfig *config = UA_Client_getConfig(mClient);
+UA_Client *OPCUAConnector::connectClient(const QString &hostInfo, OperationLimits &limits)
+{
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *config = UA_Client_getConfig(client);
     UA_ClientConfig_setDefault(config); // 进行了一些默认设置
 
     // config->timeout = 1000;
     // config->secureChannelLifeTime = 10 * 24 * 60 * 60 * 1000; // 没必要设置太久，因为到时会renew
     config->stateCallback = onStateChanged;
     // config->logger.log = customLogger; // 自定义日志处理函数
-    config->clientContext = this;
+    config->clientContext = nullptr; // 交给连接器时才设置，连接过程中的回调不访问连接器
+    config->initConnectionFunc = wakeableConnectionInit; // 客户端循环等待时可以被唤醒
     config->subscriptionInactivityCallback = subscriptionInactivity; // 订阅失效时的回调函数
 
 
@@ -142,19 +535,16 @@ int OPCUAConnector::init(QStringList paramList)
     //          << config->requestedSessionTimeout
     //          << config->connectivityCheckInterval;
 
-    // qDebug() << "try connect:" << mHostInfo;
+    // qDebug() << "try connect:" << hostInfo;
     // 释放时，要调用 UA_Client_disconnect(client)
-    UA_StatusCode status = UA_Client_connect(mClient, mHostInfo.toStdString().c_str());
+    UA_StatusCode status = UA_Client_connect(client, hostInfo.toStdString().c_str());
     // UA_StatusCode status = UA_Client_connectUsername(client, "opc.tcp://127.0.0.1:4840", "1", "1");;
     if(status != UA_STATUSCODE_GOOD)
     {
         qDebug() << "-----------client connect not finished" << QString::number(status, 16).toUpper();
 
-        UA_Client_delete(mClient);
-        mClient = nullptr;
-
-        setState(0);
-        return -1;
+        UA_Client_delete(client);
+        return nullptr;
     }
     else
     {
@@ -166,22 +556,22 @@ int OPCUAConnector::init(QStringList paramList)
                                                  UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD);
             UA_Variant var;
             UA_Variant_init(&var);
-            UA_StatusCode ret = UA_Client_readValueAttribute(mClient,
+            UA_StatusCode ret = UA_Client_readValueAttribute(client,
                                                              nodeId,
                                                              &var);
             if(UA_StatusCode_isGood(ret))
             {
                 QVariant value = convertUAVariantToQVariant(var);
-                mMaxNodesPerRead = value.toInt();
+                limits.maxNodesPerRead = value.toInt();
             }
 
             UA_Variant_clear(&var);
             qDebug() << "++++++++++++mMaxNodesPerRead:"
                      << UA_StatusCode_name(ret)
-                     << mMaxNodesPerRead;
-            if(mMaxNodesPerRead == 0)
+                     << limits.maxNodesPerRead;
+            if(limits.maxNodesPerRead == 0)
             {
-                mMaxNodesPerRead = MAX_SIZE_PER_OPERATION;
+                limits.maxNodesPerRead = MAX_SIZE_PER_OPERATION;
             }
         }
 
@@ -191,23 +581,23 @@ int OPCUAConnector::init(QStringList paramList)
                                                  UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERWRITE);
             UA_Variant var;
             UA_Variant_init(&var);
-            UA_StatusCode ret = UA_Client_readValueAttribute(mClient,
+            UA_StatusCode ret = UA_Client_readValueAttribute(client,
                                                              nodeId,
                                                              &var);
             if(UA_StatusCode_isGood(ret))
             {
                 QVariant value = convertUAVariantToQVariant(var);
-                mMaxNodesPerWrite = value.toInt();
+                limits.maxNodesPerWrite = value.toInt();
             }
 
             UA_Variant_clear(&var);
 
             qDebug() << "++++++++++++mMaxNodesPerWrite:"
                      << UA_StatusCode_name(ret)
-                     << mMaxNodesPerWrite;
-            if(mMaxNodesPerWrite)
+                     << limits.maxNodesPerWrite;
+            if(limits.maxNodesPerWrite)
             {
-                mMaxNodesPerWrite = MAX_SIZE_PER_OPERATION;
+                limits.maxNodesPerWrite = MAX_SIZE_PER_OPERATION;
             }
         }
 
@@ -217,89 +607,249 @@ int OPCUAConnector::init(QStringList paramList)
                                                  UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXMONITOREDITEMSPERCALL);
             UA_Variant var;
             UA_Variant_init(&var);
-            UA_StatusCode ret = UA_Client_readValueAttribute(mClient,
+            UA_StatusCode ret = UA_Client_readValueAttribute(client,
                                                              nodeId,
                                                              &var);
             if(UA_StatusCode_isGood(ret))
             {
                 QVariant value = convertUAVariantToQVariant(var);
-                mMaxMonitoredItemsPerCall = value.toInt();
+                limits.maxMonitoredItemsPerCall = value.toInt();
             }
 
             UA_Variant_clear(&var);
             qDebug() << "++++++++++++mMaxMonitoredItemsPerCall:"
                      << UA_StatusCode_name(ret)
-                     << mMaxMonitoredItemsPerCall;
-            if(mMaxMonitoredItemsPerCall)
+                     << limits.maxMonitoredItemsPerCall;
+            if(limits.maxMonitoredItemsPerCall == 0)
             {
-                mMaxMonitoredItemsPerCall = MAX_SIZE_PER_OPERATION;
+                limits.maxMonitoredItemsPerCall = MAX_SIZE_PER_OPERATION;
             }
         }
 
-        // mClientConnected = true;
-        setState(1);
-        qDebug() << "++++++++++++client connect finished";
+        // MaxNodesPerRegisterNodes
+        {
+            UA_NodeId nodeId = UA_NODEID_NUMERIC(0,
+                                                 UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREGISTERNODES);
+            UA_Variant var;
+            UA_Variant_init(&var);
+            UA_StatusCode ret = UA_Client_readValueAttribute(client,
+                                                             nodeId,
+                                                             &var);
+            if(UA_StatusCode_isGood(ret))
+            {
+                QVariant value = convertUAVariantToQVariant(var);
+                limits.maxNodesPerRegister = value.toInt();
+            }
+
+            UA_Variant_clear(&var);
+            qDebug() << "++++++++++++mMaxNodesPerRegister:"
+                     << UA_StatusCode_name(ret)
+                     << limits.maxNodesPerRegister;
+            if(limits.maxNodesPerRegister == 0)
+            {
+                limits.maxNodesPerRegister = MAX_SIZE_PER_OPERATION;
+            }
+        }
     }
 
-    mTryRelease = false;
+    return client;
+}
+
+int OPCUAConnector::setNamespaceIndex(int idx)
+{
+    postCommand([this, idx](){
+        if(mDefaultNsIdx != idx)
+        {
+            // 句柄是按旧命名空间注册的，按新命名空间重新注册
+            clearNodeIdCache(true);
+            mNodeIdCacheStale = true;
+        }
+        mDefaultNsIdx = idx;
+    });
 
     return 0;
 }
 
-int OPCUAConnector::setNamespaceIndex(int idx)
+int OPCUAConnector::registerNodes(QStringList pathList, QString *errorString)
 {
-    mDefaultNsIdx = idx;
+    Q_UNUSED(errorString);
+
+    postCommand([this, pathList](){
+        // 先记下来，句柄失效（还没连接、重新连接、更换命名空间）时由ensureNodeIdCache一起注册
+        foreach (QString path, pathList)
+        {
+            if(mRegisteredPaths.contains(path) == false)
+            {
+                mRegisteredPaths << path;
+            }
+        }
+
+        if(mClient != nullptr && mNodeIdCacheStale == false)
+        {
+            // 服务器不支持时退回字符串NodeId，不影响之后的访问
+            __registerNodes(pathList);
+        }
+    });
 
     return 0;
 }
 
-int OPCUAConnector::release()
+int OPCUAConnector::__registerNodes(const QStringList &pathList)
 {
-    if(state() != 1 || mClient == nullptr)
+    // 只注册还没有句柄的变量
+    QStringList newList;
+    foreach (QString path, pathList)
+    {
+        if(mNodeIdCache.contains(path) == false && newList.contains(path) == false)
+        {
+            newList << path;
+        }
+    }
+    if(newList.isEmpty() || mClient == nullptr)
     {
         return 0;
     }
 
-    // 这个大括号是用来控制locker的生命周期的
+    int ret = 0;
+    const int batchSize = qMax<int>(1, mMaxNodesPerRegister);
+    for(int curIdx = 0; curIdx < newList.length(); curIdx += batchSize)
     {
-        QMutexLocker locker(&mClientMutex);
+        QStringList tmpList = newList.mid(curIdx, batchSize);
+        size_t idsCount = tmpList.length();
 
-        // // 释放
-        // Delete the subscription
-        // if(UA_Client_Subscriptions_deleteSingle(client, subId) == UA_STATUSCODE_GOOD)
-        //     printf("Subscription removed\n");
+        UA_NodeId *ids = (UA_NodeId*)UA_Array_new(idsCount, &UA_TYPES[UA_TYPES_NODEID]);
+        for(size_t i = 0; i < idsCount; i++)
+        {
+            QString nodeString = mPrefix + "." + tmpList.at(int(i));
+            ids[i] = UA_NODEID_STRING_ALLOC(mDefaultNsIdx, nodeString.toStdString().data());
+        }
 
-        clearMonitor();
+        UA_RegisterNodesRequest request;
+        UA_RegisterNodesRequest_init(&request);
+        request.nodesToRegister     = ids;
+        request.nodesToRegisterSize = idsCount;
 
-        UA_StatusCode ret = UA_Client_disconnect(mClient); // 断开连接并释放会话资源
-        qInfo() << "UA_Client_disconnect" << UA_StatusCode_name(ret) << ret;
-        UA_Client_delete(mClient); // 释放对象
-        mClient = nullptr;
+        UA_RegisterNodesResponse response = UA_Client_Service_registerNodes(mClient, request);
+        const bool registered = (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD
+                                 && response.registeredNodeIdsSize == idsCount);
+        if(registered == false)
+        {
+            // 服务器不支持时退回字符串NodeId，仍然缓存下来，免得每次重新构建
+            qDebug() << "register nodes fail:"
+                     << QString::number(response.responseHeader.serviceResult, 16).toUpper()
+                     << tmpList;
+            ret = -1;
+        }
 
-        setState(0);
+        for(size_t i = 0; i < idsCount; i++)
+        {
+            UA_NodeId nodeId;
+            UA_NodeId_copy(registered ? &response.registeredNodeIds[i] : &ids[i], &nodeId);
+            mNodeIdCache.insert(tmpList.at(int(i)), nodeId);
+        }
+
+        UA_RegisterNodesResponse_clear(&response);
+        UA_Array_delete(ids, idsCount, &UA_TYPES[UA_TYPES_NODEID]);
+    }
+
+    foreach (QString path, newList)
+    {
+        if(mRegisteredPaths.contains(path) == false)
+        {
+            mRegisteredPaths << path;
+        }
+    }
+
+    return ret;
+}
+
+UA_NodeId OPCUAConnector::nodeIdFor(const QString &path)
+{
+    auto it = mNodeIdCache.constFind(path);
+    if(it == mNodeIdCache.constEnd())
+    {
+        __registerNodes(QStringList() << path);
+        it = mNodeIdCache.constFind(path);
+    }
+
+    if(it == mNodeIdCache.constEnd())
+    {
+        return UA_NODEID_NULL;
+    }
+    return it.value();
+}
+
+void OPCUAConnector::ensureNodeIdCache()
+{
+    if(mNodeIdCacheStale == false || mClient == nullptr)
+    {
+        return;
+    }
+
+    // 会话重建后旧句柄失效（不用注销），按记录的变量重新注册
+    clearNodeIdCache(false);
+    mNodeIdCacheStale = false;
+    __registerNodes(mRegisteredPaths);
+}
+
+void OPCUAConnector::clearNodeIdCache(bool unregister)
+{
+    // 读取请求里复制了句柄，一起作废
+    clearReadRequestCache();
+
+    if(mNodeIdCache.isEmpty())
+    {
+        return;
+    }
+
+    if(unregister && mClient != nullptr && state() == 1)
+    {
+        QList<UA_NodeId> idList = mNodeIdCache.values();
+
+        UA_UnregisterNodesRequest request;
+        UA_UnregisterNodesRequest_init(&request);
+        request.nodesToUnregister     = idList.data();
+        request.nodesToUnregisterSize = idList.length();
+
+        UA_UnregisterNodesResponse response = UA_Client_Service_unregisterNodes(mClient, request);
+        UA_UnregisterNodesResponse_clear(&response);
+    }
+
+    for(auto it = mNodeIdCache.begin(); it != mNodeIdCache.end(); ++it)
+    {
+        UA_NodeId_clear(&it.value());
     }
+    mNodeIdCache.clear();
+}
 
-    // 由于线程锁的影响，释放完后，在线程中运行的周期函数还没执行
-    // 因此这里需要稍微延时一会，让其执行完毕
-    QThread::msleep(10);
+int OPCUAConnector::release()
+{
+    if(mSession == nullptr)
+    {
+        return 0;
+    }
 
-    // 已经释放完毕
-    mTryRelease = false;
+    // 只通知后台线程退出，这里不等待网络：
+    // 客户端循环在它的线程中断开连接，正在连接的话连接结束后直接断开
+    mConnectPending = false;
+    stopSession();
+    setState(0);
 
     return 0;
 }
 
 int OPCUAConnector::readValue(QString path, QVariant &value, QString *errorString)
 {
-    QMutexLocker locker(&mClientMutex);
+    ClientLocker locker(this);
 
     if(mClient == nullptr)
     {
         return -1000;
     }
 
-    QString nodeString = mPrefix + "." + path;
-    UA_NodeId nodeId = UA_NODEID_STRING_ALLOC(mDefaultNsIdx, nodeString.toStdString().data());
+    // 使用已注册的句柄，不用每次构建字符串NodeId
+    ensureNodeIdCache();
+    UA_NodeId nodeId = nodeIdFor(path);
 
     UA_Variant var;
     UA_Variant_init(&var);
@@ -313,13 +863,10 @@ int OPCUAConnector::readValue(QString path, QVariant &value, QString *errorStrin
     else
     {
         qDebug() << "read value fail:"
-                 << nodeString
+                 << mPrefix + "." + path
                  << QString("0x%1").arg(QString::number(ret, 16));
     }
 
-    // 凡是通过UA_NODEID_STRING_ALLOC，都要通过调用此函数清理
-    UA_NodeId_clear(&nodeId);
-
     // 不清理的话会内存溢出
     // 释放 Variant 中的 data/arrayDimensions
     // 因为这个数据是UA_Client_readValueAttribute给allocate出来的
@@ -349,7 +896,7 @@ int OPCUAConnector::writeValue(QString path,
                                Type type,
                                QString *errorString)
 {
-    QMutexLocker locker(&mClientMutex);
+    ClientLocker locker(this);
 
     if(mClient == nullptr)
     {
@@ -359,8 +906,8 @@ int OPCUAConnector::writeValue(QString path,
     // 经过QVaraint的智能转换一下，免得内存空间对不上
     QVariant tmpVar = toValidValue(value, type);
 
-    QString nodeString = mPrefix + "." + path;
-    UA_NodeId nodeId = UA_NODEID_STRING_ALLOC(mDefaultNsIdx, nodeString.toStdString().data());
+    ensureNodeIdCache();
+    UA_NodeId nodeId = nodeIdFor(path);
 
     UA_Variant var;
     UA_Variant_setScalar(&var,
@@ -382,7 +929,6 @@ int OPCUAConnector::writeValue(QString path,
                                                       &var);
 
     // UA_Variant_clear(&var);
-    UA_NodeId_clear(&nodeId);
     if(UA_StatusCode_isGood(ret))
     {
         convertUAVariantToQVariant(var);
@@ -395,7 +941,7 @@ int OPCUAConnector::writeValue(QString path,
     else
     {
         qDebug() << "write value fail:"
-                 << nodeString
+                 << mPrefix + "." + path
                  << QString("0x%1").arg(QString::number(ret, 16));
     }
 
@@ -404,7 +950,7 @@ int OPCUAConnector::writeValue(QString path,
 
 int OPCUAConnector::readValueList(QList<DataUnit> &dataList, QString *errorString)
 {
-    QMutexLocker locker(&mClientMutex);
+    ClientLocker locker(this);
 
     return __readValueList(dataList, errorString);
 }
@@ -412,7 +958,7 @@ int OPCUAConnector::readValueList(QList<DataUnit> &dataList, QString *errorStrin
 // 此函数存在内存泄漏风险，后续要跟踪一下
 int OPCUAConnector::writeValueList(QList<DataUnit> dataList, QString *errorString)
 {
-    QMutexLocker locker(&mClientMutex);
+    ClientLocker locker(this);
 
     if(mClient == nullptr)
     {
@@ -434,237 +980,638 @@ int OPCUAConnector::writeValueList(QList<DataUnit> dataList, QString *errorStrin
 
     // qDebug() << "batch write:" << batchWriteList.length() << mMaxNodesPerWrite;
 
+    // 一次注册所有还没有句柄的变量
+    ensureNodeIdCache();
+    QStringList pathList;
+    foreach (const DataUnit &unit, dataList)
+    {
+        pathList << unit.path;
+    }
+    __registerNodes(pathList);
+
     foreach (auto dataList, batchWriteList) {
         // 定义写的节点列表
         int valCount = dataList.length();
         // UA_WriteValue* wValArray = (UA_WriteValue*)UA_Array_new(valCount, &UA_TYPES[UA_TYPES_WRITEVALUE]);
         UA_WriteValue* wValArray = new UA_WriteValue[valCount];
 
-        // 得把数据收集起来，最后统一释放
-        QList<UA_NodeId> nodeIdList;
+        // 得把数据收集起来，最后统一释放（NodeId是缓存的句柄，不用释放）
         QList<UA_String> uaStringList;
         for(int i = 0; i < valCount; i++)
         {
-            UA_WriteValue_init(&wValArray[i]);
-            wValArray[i].attributeId = UA_ATTRIBUTEID_VALUE;
-
             // 一定要用引用才能访问到原始数据
-            DataUnit &dataItem = dataList[i];
-            dataItem.value = toValidValue(dataItem.value, dataItem.type);
+            fillWriteValue(dataList[i], wValArray[i], uaStringList);
+        }
+
+        // for(int i = 0; i < valCount; i++)
+        // {
+        //     qDebug() << "data:" <<*(double*) wValArray[i].value.value.data;
+        // }
+
+        // 初始化写请求
+        UA_WriteRequest wReq;
+        UA_WriteRequest_init(&wReq);
+        wReq.nodesToWrite = &wValArray[0];
+        wReq.nodesToWriteSize = valCount;
+
+        // 发送写请求
+        UA_WriteResponse wResp = UA_Client_Service_write(mClient, wReq);
+        auto retval = wResp.responseHeader.serviceResult;
+        if (retval == UA_STATUSCODE_GOOD) {
+            if (wResp.resultsSize == valCount) {
+                for (int i = 0; i < valCount; ++i) {
+                    if (wResp.results[i] == UA_STATUSCODE_GOOD) {
+                        // qDebug("Node %d written successfully\n", i + 1);
+                    } else {
+                        qCritical() << QString("Node %1 write failed with status code %2")
+                        .arg(i + 1)
+                            .arg(QString::number(wResp.results[i], 16));
+                    }
+                }
+            } else {
+                qCritical("Unexpected number of results\n");
+                return -2;
+            }
+        } else {
+            qCritical() << QString("Write request failed with status code %1")
+            .arg(QString::number(retval, 16));
+            return -3;
+        }
+
+        // // 也无法执行
+        // // 清理请求
+        // UA_WriteRequest_clear(&wReq);
+
+        // 清理响应
+        UA_WriteResponse_clear(&wResp);
+
+        // 清理
+        // // 执行了这个主对象的清理，就不需要其子成员清理了， 比如id，string
+        // // 执行这个函数会报错
+        // UA_WriteValue_clear(&wValArray[i]);
+        for (int i = 0; i < uaStringList.length(); ++i) {
+            UA_String_clear(&uaStringList[i]);
+        }
+
+        // UA_Array_delete(wValArray, valCount, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+        delete[] wValArray;
+    }
+
+    return 0;
+}
+
+void OPCUAConnector::fillWriteValue(DataUnit &dataItem, UA_WriteValue &wValue, QList<UA_String> &uaStringList)
+{
+    UA_WriteValue_init(&wValue);
+    wValue.attributeId = UA_ATTRIBUTEID_VALUE;
+
+    // 值直接引用dataItem中的数据，请求发送前dataItem要一直有效
+    dataItem.value = toValidValue(dataItem.value, dataItem.type);
+
+    wValue.nodeId = nodeIdFor(dataItem.path);
+
+    UA_Variant var;
+    UA_Variant_init(&var);
+    UA_Variant_setScalar(&var,
+                         (void*)dataItem.value.data(),
+                         mQATypeMap[dataItem.type]);
+    if(dataItem.type == STRING)
+    {
+        std::string str = dataItem.value.toString().toStdString();
+        UA_String uaStr = UA_STRING_ALLOC(str.c_str());
+        uaStringList << uaStr;
+        UA_Variant_setScalar(&var, &uaStringList.last(), &UA_TYPES[UA_TYPES_STRING]);
+    }
+
+    wValue.value.value = var;
+    wValue.value.hasValue = true;
+
+    // 执行这个会崩溃
+    // UA_Variant_clear(&var);
+}
 
-            QString nodeString = mPrefix + "." + dataItem.path;
-            UA_NodeId nodeId = UA_NODEID_STRING_ALLOC(mDefaultNsIdx, nodeString.toStdString().data());
+void OPCUAConnector::setPipelineDepth(int maxReads)
+{
+    postCommand([=](){
+        mMaxReadsInFlight = qMax(1, maxReads);
+    });
+}
+
+int OPCUAConnector::monitorValues(QStringList pathList, QString *errorString)
+{
+    ClientLocker locker(this);
+
+    return __monitorValues(pathList, errorString);
+}
+
+int OPCUAConnector::__monitorValues(const QStringList &pathList, QString *errorString)
+{
+    if(mClient == nullptr)
+    {
+        return -1;
+    }
+    if(state() != 1)
+    {
+        return -1;
+    }
+
+    int ret = 0;
+
+    if(mUseSubscription)
+    {
+        QStringList failList;
+
+        if(0)
+        {
+            // 逐个订阅
+            for(int i = 0; i < pathList.length(); i++)
+            {
+                QString varName = pathList.at(i);
+
+                // 不重复订阅
+                if(monitoredValueList().contains(varName))
+                {
+                    continue;
+                }
+
+                QString name = mPrefix + "." + varName;
+                ret = subscribeVariant(mDefaultNsIdx, name, varName);
+                if(ret != 0)
+                {
+                    qDebug() << "订阅失败：" << varName;
+                    failList << varName;
+                }
+            }
+        }
+        else
+        {
+            // 批量订阅
+            // mMaxMonitoredItemsPerCall
+
+            // 去掉已经订阅的
+            QList<QString> tmpStrList;
+            for(int i = 0; i < pathList.length(); i++)
+            {
+                QString varName = pathList.at(i);
+                if(monitoredValueList().contains(varName))
+                {
+                    continue;
+                }
+
+                tmpStrList << varName;
+            }
+
+            QList<QMap<QString, QString>> subMapList;
+            int curIdx = 0;
+            do{
+                QMap<QString, QString> varMap;
+                QStringList tmpList = tmpStrList.mid(curIdx, mMaxMonitoredItemsPerCall);
+                foreach (QString varName, tmpList) {
+                    QString name = mPrefix + "." + varName;
+                    varMap.insert(name, varName);
+                }
+                subMapList << varMap;
+
+                curIdx += mMaxMonitoredItemsPerCall;
+            }while(curIdx < tmpStrList.length());
+
+            for(int i = 0; i < subMapList.length(); i++)
+            {
+                if(subMapList.at(i).isEmpty())
+                {
+                    continue;
+                }
+                subscribeVariantList(mDefaultNsIdx, subMapList.at(i), failList);
+
+                // // 这里稍作延时，留时间给回调函数做处理，
+                // // 防止出现：Could not process a notification with clienthandle。。。。
+                // QThread::msleep(100);
+            }
+        }
+
+        if(failList.length() > 0)
+        {
+            qDebug() << "订阅失败：" << failList;
+
+            ret = -2;
+            if(errorString != nullptr)
+            {
+                foreach (QString str, failList) {
+                    *errorString += str + ",";
+                }
+            }
+        }
+    }
+    else
+    {
+        foreach (QString varPath, pathList)
+        {
+            if(mMonVarMap.contains(varPath) == false)
+            {
+                mMonVarMap.insert(varPath, QVariant());
+            }
+        }
+    }
+
+    return ret;
+}
+
+QStringList OPCUAConnector::monitoredValueList()
+{
+    if(mUseSubscription)
+    {
+        return mMonIdxMap.values();
+    }
+    return mMonVarMap.keys();
+}
+
+void OPCUAConnector::setSubscriptionEnabled(bool enabled)
+{
+    postCommand([this, enabled](){
+        if(mUseSubscription == enabled)
+        {
+            return;
+        }
+
+        // 切换模式前清掉已有的监听
+        __clearMonitor();
+        mUseSubscription = enabled;
+    });
+}
+
+void OPCUAConnector::setSubscriptionParameters(double publishingInterval,
+                                               double samplingInterval,
+                                               quint32 queueSize,
+                                               double deadband)
+{
+    postCommand([=](){
+        mPublishingInterval = qMax(0.0, publishingInterval);
+        mSamplingInterval = qMax(0.0, samplingInterval);
+        mQueueSize = qMax<quint32>(1, queueSize);
+        mDeadband = qMax(0.0, deadband);
+    });
+}
+
+quint32 OPCUAConnector::startSampleStream(const QList<DataUnit> &dataList, int intervalMs)
+{
+    const quint32 generation = ++mStreamGeneration;
+    mSnapshotSignalled = false;
+    postCommand([=](){
+        applySampleStream(generation, dataList, intervalMs);
+    });
+
+    return generation;
+}
+
+void OPCUAConnector::stopSampleStream()
+{
+    ++mStreamGeneration;
+    postCommand([this](){
+        if(mStream.active && mUseSubscription)
+        {
+            __clearMonitor();
+        }
+        mStream = SampleStream();
+    });
+}
+
+const OPCUAConnector::Snapshot *OPCUAConnector::takeSnapshot()
+{
+    // 先清除标记再取：之后发布的快照一定会再通知一次
+    mSnapshotSignalled = false;
+    if(mSnapshotMailbox.update() == false)
+    {
+        return nullptr;
+    }
+
+    // 已停止或被替换的采样流留下的快照不再使用
+    const Snapshot &snapshot = mSnapshotMailbox.readBuffer();
+    if(snapshot.generation != mStreamGeneration.load())
+    {
+        return nullptr;
+    }
+
+    return &snapshot;
+}
 
-            // qDebug() << nodeString;
+void OPCUAConnector::postCommand(std::function<void()> command)
+{
+    {
+        QMutexLocker locker(&mCommandMutex);
+        mCommands << command;
+    }
 
-            // 收集数据
-            nodeIdList << nodeId;
+    // 客户端循环可能正阻塞在socket上，唤醒它立即执行
+    if(mSession != nullptr)
+    {
+        mSession->wake();
+    }
+}
+
+OPCUAConnector::ClientLocker::ClientLocker(OPCUAConnector *connector)
+    : mLocker(announce(connector))
+{
+    connector->mClientWaiters--;
+}
+
+QMutex *OPCUAConnector::ClientLocker::announce(OPCUAConnector *connector)
+{
+    // 先登记再唤醒，循环醒来后看到有人等待就不会马上再进入socket等待
+    connector->mClientWaiters++;
+    if(connector->mSession != nullptr)
+    {
+        connector->mSession->wake();
+    }
+    return &connector->mClientMutex;
+}
+
+void OPCUAConnector::runCommands(Session &session)
+{
+    QList<std::function<void()>> commands;
+    {
+        // 已通知退出的连接不再取走操作，留给下一次连接
+        QMutexLocker sessionLocker(&session.mutex);
+        QMutexLocker locker(&mCommandMutex);
+        if(session.exit || mCommands.isEmpty())
+        {
+            return;
+        }
+        commands.swap(mCommands);
+    }
 
-            wValArray[i].nodeId = nodeIdList.last();
+    QMutexLocker locker(&mClientMutex);
+    foreach (const std::function<void()> &command, commands)
+    {
+        command();
+    }
+}
 
-            UA_Variant var;
-            UA_Variant_init(&var);
-            UA_Variant_setScalar(&var,
-                                 (void*)dataItem.value.data(),
-                                 mQATypeMap[dataItem.type]);
-            if(dataItem.type == STRING)
-            {
-                std::string str = dataItem.value.toString().toStdString();
-                UA_String uaStr = UA_STRING_ALLOC(str.c_str());
-                uaStringList << uaStr;
-                UA_Variant_setScalar(&var, &uaStringList.last(), &UA_TYPES[UA_TYPES_STRING]);
-            }
+void OPCUAConnector::applySampleStream(quint32 generation, const QList<DataUnit> &dataList, int intervalMs)
+{
+    if(mStream.active && mUseSubscription)
+    {
+        __clearMonitor();
+    }
 
-            wValArray[i].value.value = var;
-            wValArray[i].value.hasValue = true;
+    mStream = SampleStream();
+    mStream.active = true;
+    mStream.generation = generation;
+    mStream.intervalMs = qMax(1, intervalMs);
+    mStream.dataList = dataList;
+    for(int i = 0; i < dataList.length(); i++)
+    {
+        mStream.indexMap[dataList.at(i).path] << i;
+    }
 
-            // 执行这个会崩溃
-            // UA_Variant_clear(&var);
+    if(mUseSubscription && mClient != nullptr && state() == 1)
+    {
+        // 通知在handler_paramsChanged中写入mStream，由工作线程发布
+        QString errorString;
+        if(__monitorValues(mStream.indexMap.keys(), &errorString) != 0)
+        {
+            emit errorOccured("订阅失败：" + errorString);
         }
+    }
+}
 
-        // for(int i = 0; i < valCount; i++)
-        // {
-        //     qDebug() << "data:" <<*(double*) wValArray[i].value.value.data;
-        // }
-
-        // 初始化写请求
-        UA_WriteRequest wReq;
-        UA_WriteRequest_init(&wReq);
-        wReq.nodesToWrite = &wValArray[0];
-        wReq.nodesToWriteSize = valCount;
+void OPCUAConnector::sampleStreamProcess()
+{
+    if(mStream.active == false || mStream.dataList.isEmpty())
+    {
+        return;
+    }
 
-        // 发送写请求
-        UA_WriteResponse wResp = UA_Client_Service_write(mClient, wReq);
-        auto retval = wResp.responseHeader.serviceResult;
-        if (retval == UA_STATUSCODE_GOOD) {
-            if (wResp.resultsSize == valCount) {
-                for (int i = 0; i < valCount; ++i) {
-                    if (wResp.results[i] == UA_STATUSCODE_GOOD) {
-                        // qDebug("Node %d written successfully\n", i + 1);
-                    } else {
-                        qCritical() << QString("Node %1 write failed with status code %2")
-                        .arg(i + 1)
-                            .arg(QString::number(wResp.results[i], 16));
-                    }
-                }
-            } else {
-                qCritical("Unexpected number of results\n");
-                return -2;
-            }
-        } else {
-            qCritical() << QString("Write request failed with status code %1")
-            .arg(QString::number(retval, 16));
-            return -3;
+    if(mUseSubscription)
+    {
+        if(mStream.dirty)
+        {
+            publishSnapshot(0, mStream.sourceTimeUs);
         }
+        return;
+    }
 
-        // // 也无法执行
-        // // 清理请求
-        // UA_WriteRequest_clear(&wReq);
+    // 按采样周期发出读取请求，不等上一次的响应；在途的请求达到上限时等待响应
+    if(mStream.timer.isValid() && mStream.timer.elapsed() < mStream.intervalMs)
+    {
+        return;
+    }
+    if(mReadsInFlight.size() >= mMaxReadsInFlight)
+    {
+        return;
+    }
+    mStream.timer.start();
 
-        // 清理响应
-        UA_WriteResponse_clear(&wResp);
+    sendStreamRead();
+}
 
-        // 清理
-        for (int i = 0; i < nodeIdList.length(); ++i) {
-            // // 执行了这个主对象的清理，就不需要其子成员清理了， 比如id，string
-            // // 执行这个函数会报错
-            // UA_WriteValue_clear(&wValArray[i]);
+void OPCUAConnector::sendStreamRead()
+{
+    QStringList varPathList;
+    foreach (const DataUnit &unit, mStream.dataList)
+    {
+        varPathList << unit.path;
+    }
 
-            // 这个也无法执行
-            // UA_Variant_clear(&(wValArray[i].value.value));
+    ensureNodeIdCache();
+    const ReadRequestCache &cache = preparedReadRequest(varPathList);
 
-            UA_NodeId_clear(&nodeIdList[i]);
-        }
-        for (int i = 0; i < uaStringList.length(); ++i) {
-            UA_String_clear(&uaStringList[i]);
+    // 一次采样可能按MaxNodesPerRead分成多个请求，全部响应后才是完整的快照
+    const quint64 sequence = ++mStream.readSequence;
+    StreamRead read;
+    read.dataList = mStream.dataList;
+    read.remaining = cache.batches.length();
+    read.timer.start();
+
+    int offset = 0;
+    for(int batchIdx = 0; batchIdx < cache.batches.length(); batchIdx++)
+    {
+        const ReadBatch &batch = cache.batches.at(batchIdx);
+
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead     = batch.ids;
+        request.nodesToReadSize = batch.count;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+
+        // 请求在发送时就已编码，之后ids可以继续复用
+        UA_UInt32 requestId = 0;
+        UA_StatusCode ret = UA_Client_sendAsyncReadRequest(mClient, &request,
+                                                           handler_readResponse, NULL, &requestId);
+        if(ret != UA_STATUSCODE_GOOD)
+        {
+            // 已发出的部分在响应时找不到这次采样，直接丢弃
+            qCritical() << "send read request fail:" << UA_StatusCode_name(ret);
+            return;
         }
 
-        // UA_Array_delete(wValArray, valCount, &UA_TYPES[UA_TYPES_WRITEVALUE]);
-        delete[] wValArray;
+        InFlightRead inFlight;
+        inFlight.generation = mStream.generation;
+        inFlight.sequence = sequence;
+        inFlight.offset = offset;
+        inFlight.count = int(batch.count);
+        mReadsInFlight.insert(requestId, inFlight);
+
+        offset += int(batch.count);
     }
 
-    return 0;
+    mStream.reads.insert(sequence, read);
 }
 
-int OPCUAConnector::monitorValues(QStringList pathList, QString *errorString)
+// 异步读取的响应，在UA_Client_run_iterate（或其它同步服务调用）中回调，此时持有mClientMutex
+// 断开连接时未完成的请求也会回调，此时客户端已从连接器上摘下，clientContext为空
+void OPCUAConnector::handler_readResponse(UA_Client *client,
+                                          void *userdata,
+                                          UA_UInt32 requestId,
+                                          UA_ReadResponse *response)
 {
-    QMutexLocker locker(&mClientMutex);
+    Q_UNUSED(userdata);
 
-    if(mClient == nullptr)
+    OPCUAConnector *obj = (OPCUAConnector*)UA_Client_getConfig(client)->clientContext;
+    if(obj == nullptr)
     {
-        return -1;
+        return;
     }
-    if(state() != 1)
+    auto inFlightIt = obj->mReadsInFlight.find(requestId);
+    if(inFlightIt == obj->mReadsInFlight.end())
     {
-        return -1;
+        return;
     }
+    const InFlightRead inFlight = inFlightIt.value();
+    obj->mReadsInFlight.erase(inFlightIt);
 
-    int ret = 0;
+    // 采样流已重启，或者这次采样已经因为其它部分失败被丢弃
+    SampleStream &stream = obj->mStream;
+    auto readIt = stream.reads.find(inFlight.sequence);
+    if(inFlight.generation != stream.generation || readIt == stream.reads.end())
+    {
+        return;
+    }
 
-#ifdef USE_OPCUA_SUBSCRIPTION
-    QStringList failList;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+    {
+        qCritical() << "multi read error:"
+                    << QString::number(response->responseHeader.serviceResult, 16).toUpper()
+                    << inFlight.count;
+        stream.reads.erase(readIt);
+        return;
+    }
 
-    if(0)
+    // 单个节点失败时其值为无效，其它节点照常填充
+    StreamRead &read = readIt.value();
+    for(int i = 0; i < inFlight.count; i++)
     {
-        // 逐个订阅
-        for(int i = 0; i < pathList.length(); i++)
+        DataUnit &unit = read.dataList[inFlight.offset + i];
+        const UA_Variant *uaVar = (size_t(i) < response->resultsSize) ? &response->results[i].value : nullptr;
+        if(uaVar != nullptr && UA_Variant_isEmpty(uaVar) == false)
         {
-            QString varName = pathList.at(i);
-
-            // 不重复订阅
-            if(monitoredValueList().contains(varName))
-            {
-                continue;
-            }
-
-            QString name = mPrefix + "." + varName;
-            ret = subscribeVariant(mDefaultNsIdx, name, varName);
-            if(ret != 0)
-            {
-                qDebug() << "订阅失败：" << varName;
-                failList << varName;
-            }
+            unit.value = convertUAVariantToQVariant(*uaVar);
+            read.sourceTimeUs = qMax(read.sourceTimeUs, dataValueSourceTimeUs(response->results[i]));
         }
-    }
-    else
-    {
-        // 批量订阅
-        // mMaxMonitoredItemsPerCall
-
-        // 去掉已经订阅的
-        QList<QString> tmpStrList;
-        for(int i = 0; i < pathList.length(); i++)
+        else
         {
-            QString varName = pathList.at(i);
-            if(monitoredValueList().contains(varName))
-            {
-                continue;
-            }
-
-            tmpStrList << varName;
+            unit.value = QVariant();
         }
+    }
 
-        QList<QMap<QString, QString>> subMapList;
-        int curIdx = 0;
-        do{
-            QMap<QString, QString> varMap;
-            QStringList tmpList = tmpStrList.mid(curIdx, mMaxMonitoredItemsPerCall);
-            foreach (QString varName, tmpList) {
-                QString name = mPrefix + "." + varName;
-                varMap.insert(name, varName);
-            }
-            subMapList << varMap;
-
-            curIdx += mMaxMonitoredItemsPerCall;
-        }while(curIdx < tmpStrList.length());
+    if(--read.remaining > 0)
+    {
+        return;
+    }
 
-        for(int i = 0; i < subMapList.length(); i++)
+    // 比已经发布的更旧的采样（响应乱序）直接丢弃
+    const qint64 latencyUs = read.timer.nsecsElapsed() / 1000;
+    if(inFlight.sequence > stream.publishedSequence)
+    {
+        stream.publishedSequence = inFlight.sequence;
+        for(int i = 0; i < stream.dataList.length() && i < read.dataList.length(); i++)
         {
-            subscribeVariantList(mDefaultNsIdx, subMapList.at(i), failList);
-
-            // // 这里稍作延时，留时间给回调函数做处理，
-            // // 防止出现：Could not process a notification with clienthandle。。。。
-            // QThread::msleep(100);
+            stream.dataList[i].value = read.dataList.at(i).value;
         }
+        obj->publishSnapshot(latencyUs, read.sourceTimeUs);
     }
+    stream.reads.erase(readIt);
 
-    if(failList.length() > 0)
+    // 比这次更早、还没凑齐的采样已经没有用了
+    for(auto it = stream.reads.begin(); it != stream.reads.end();)
     {
-        qDebug() << "订阅失败：" << failList;
-
-        ret = -2;
-        if(errorString != nullptr)
+        if(it.key() < inFlight.sequence)
         {
-            foreach (QString str, failList) {
-                *errorString += str + ",";
-            }
+            it = stream.reads.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
-#else
-    foreach (QString varPath, pathList)
+}
+
+void OPCUAConnector::publishSnapshot(qint64 latencyUs, qint64 sourceTimeUs)
+{
+    const qint64 nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    Snapshot &snapshot = mSnapshotMailbox.writeBuffer();
+    snapshot.generation = mStream.generation;
+    // 服务器读取的时刻大约在一次往返的中间
+    snapshot.timeUs = nowUs - latencyUs / 2;
+    snapshot.latencyUs = latencyUs;
+    snapshot.sourceTimeUs = sourceTimeUs;
+
+    // 逐个复制值，缓冲区中的列表不与mStream共享，避免每次发布都重新分配
+    if(snapshot.dataList.length() == mStream.dataList.length())
     {
-        if(mMonVarMap.contains(varPath) == false)
+        for(int i = 0; i < mStream.dataList.length(); i++)
         {
-            mMonVarMap.insert(varPath, QVariant());
+            snapshot.dataList[i].value = mStream.dataList.at(i).value;
         }
     }
-#endif
+    else
+    {
+        snapshot.dataList = mStream.dataList;
+        snapshot.dataList.detach();
+    }
 
-    return ret;
+    mSnapshotMailbox.publish();
+    mStream.dirty = false;
+
+    // GUI线程还没取走上一个快照时不再排队通知，取的时候总是拿到最新的
+    if(mSnapshotSignalled.exchange(true) == false)
+    {
+        emit snapshotReady();
+    }
 }
 
-QStringList OPCUAConnector::monitoredValueList()
+int OPCUAConnector::resubscribe()
 {
-#ifdef USE_OPCUA_SUBSCRIPTION
-    return mMonIdxMap.values();
-#else
-    return mMonVarMap.keys();
-#endif
+    QStringList pathList = mMonIdxMap.values();
+    mMonIdxMap.clear();
+    mSubId = -1;
+    if(pathList.isEmpty() || mClient == nullptr)
+    {
+        return 0;
+    }
+
+    QMap<QString, QString> varMap;
+    foreach (QString varName, pathList) {
+        varMap.insert(mPrefix + "." + varName, varName);
+    }
+
+    QStringList failList;
+    int ret = subscribeVariantList(mDefaultNsIdx, varMap, failList);
+    qDebug() << "resubscribe:" << ret << pathList.length() << failList;
+    return ret;
 }
 
 void OPCUAConnector::clearMonitor()
 {
-    if(mSubId != -1)
+    ClientLocker locker(this);
+
+    __clearMonitor();
+}
+
+void OPCUAConnector::__clearMonitor()
+{
+    if(mSubId != -1 && mClient != nullptr)
     {
         if(UA_Client_Subscriptions_deleteSingle(mClient, mSubId) == UA_STATUSCODE_GOOD)
         {
@@ -692,7 +1639,11 @@ void OPCUAConnector::onStateChanged(UA_Client *client,
     // qDebug() << "client context:" << config->clientContext;
 
     OPCUAConnector *com = (OPCUAConnector*)config->clientContext;
-
+    // 客户端循环断开连接时已从连接器上摘下
+    if(com == nullptr)
+    {
+        return;
+    }
 
     // qInfo() << "--> status code:" << UA_StatusCode_name(connectStatus) << channelState << sessionState;
 
@@ -711,12 +1662,11 @@ void OPCUAConnector::onStateChanged(UA_Client *client,
                  << sessionState
                  << com;
 
-        // release中有UA_Client_delete，而这个函数是在client内部执行的，这样子操作相当于自杀。不能这样操作。释放要放在此回调函数之外才行
-        // 貌似不是自杀的问题，是顺序的问题
+        // 不能在回调中UA_Client_delete（相当于自杀），由客户端循环退出后在它的线程中释放
         // if(sessionState == UA_SESSIONSTATE_CLOSED) // 不用加此判断
         {
             qCritical() << "x--> status code:" << UA_StatusCode_name(connectStatus) << channelState << sessionState;
-            QMetaObject::invokeMethod(com, "release", Qt::QueuedConnection);
+            com->mConnectionLost = true;
         }
     }
 
@@ -728,6 +1678,9 @@ void OPCUAConnector::onStateChanged(UA_Client *client,
         {
             // 这里可以写重连完成、或者连接完成后的初始化操作
             qDebug() << "opcua connect complete";
+
+            // 会话是新建的，之前注册的句柄失效，下次访问时重新注册
+            com->mNodeIdCacheStale = true;
         }
     }
 
@@ -737,9 +1690,14 @@ void subscriptionInactivity(UA_Client *client,
                             UA_UInt32 subscriptionId,
                             void *subContext)
 {
-    // 重新订阅？
+    qCritical() << "---------------------->opcua subscriptionInactivity" << subscriptionId;
 
-    qCritical() << "---------------------->opcua subscriptionInactivity";
+    // 在工作线程的下一次循环中重新订阅（回调中不能再调用订阅服务）
+    OPCUAConnector *com = (OPCUAConnector*)UA_Client_getConfig(client)->clientContext;
+    if(com != nullptr)
+    {
+        com->requestResubscribe();
+    }
 }
 
 
@@ -800,16 +1758,35 @@ void OPCUAConnector::handler_paramsChanged(UA_Client *client,
                                            void *monContext,
                                            UA_DataValue *value)
 {
-    if(monContext != NULL && value != NULL)
+    // 断开连接时客户端已从连接器上摘下，不再使用monContext
+    OPCUAConnector *obj = (OPCUAConnector*)UA_Client_getConfig(client)->clientContext;
+    if(obj != nullptr && monContext != NULL && value != NULL)
     {
         if(value->hasValue == false)
         {
             return;
         }
-        OPCUAConnector *obj = (OPCUAConnector*)monContext;
+        if(value->hasStatus && UA_StatusCode_isGood(value->status) == false)
+        {
+            return;
+        }
 
         QString monName = obj->mMonIdxMap[monId];
 
+        // 采样流的变量只更新快照，由工作线程在本轮处理完后一起发布
+        auto it = obj->mStream.indexMap.constFind(monName);
+        if(obj->mStream.active && it != obj->mStream.indexMap.constEnd())
+        {
+            const QVariant var = convertUAVariantToQVariant(value->value);
+            foreach (int idx, it.value())
+            {
+                obj->mStream.dataList[idx].value = var;
+            }
+            obj->mStream.sourceTimeUs = qMax(obj->mStream.sourceTimeUs, dataValueSourceTimeUs(*value));
+            obj->mStream.dirty = true;
+            return;
+        }
+
         // switch (value->value.type->typeKind) {
         // case UA_DATATYPEKIND_BOOLEAN:
 
@@ -832,55 +1809,84 @@ void OPCUAConnector::handler_paramsChanged(UA_Client *client,
 // https://www.cnblogs.com/davisdabing/p/17841124.html
 // 最短采样间隔：设置 OPC UA 服务器记录 CPU 变量值并与以前值相比较检查是否发生变更的时间间隔。
 // 最短发布间隔：变量值发生改变时,服务器将新值向客户端发送消息的时间间隔。
+int OPCUAConnector::createSubscription()
+{
+    // PublishingInterval：数据发布的间隔时间。
+    // LifetimeCount：服务器在判定订阅不活跃前，允许丢失的最大心跳包数。
+    // MaxKeepAliveCount：服务器发送心跳包的最大次数（若在此期间无数据变化，发送空通知）
+    // 关键规则：LifetimeCount > MaxKeepAliveCount（通常设为 3-5 倍）
+    /* Create a subscription */
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    request.requestedPublishingInterval = mPublishingInterval; // 服务器会按自身限制修正
+    // request.requestedMaxKeepAliveCount  = 10; // 10
+    // request.requestedLifetimeCount = request.requestedMaxKeepAliveCount * 5; // 最小只能设置 MaxKeepAliveCount * 3
+    /* uaexpert的配方*/
+    // request.requestedLifetimeCount = 2400;
+    // request.requestedMaxKeepAliveCount = 10;
+    // request.priority = 0;
+    // request.maxNotificationsPerPublish = 0;
+    UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(mClient, request,
+                                                                            NULL, NULL, NULL);
+    qDebug() << "revised sub data:"
+             << response.revisedPublishingInterval // 实际的发布周期 ms
+             << response.revisedLifetimeCount      // 创建订阅后，必须要在多少个周期内发起monitor，否则关闭此订阅
+             << response.revisedMaxKeepAliveCount  // 最多服务器跳过多少次无数据的发布
+        ;
+
+    mSubId = response.subscriptionId;
+    if(response.responseHeader.serviceResult == UA_STATUSCODE_GOOD)
+    {
+        qDebug("Create subscription succeeded, id %u\n", mSubId);
+    }
+    else
+    {
+        qDebug() << "Create subscription fail:" << mSubId;
+        mSubId = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+void OPCUAConnector::applyMonitoringParameters(UA_MonitoredItemCreateRequest &monRequest,
+                                               UA_DataChangeFilter &filter)
+{
+    monRequest.requestedParameters.samplingInterval = mSamplingInterval;
+    monRequest.requestedParameters.queueSize = mQueueSize;
+    monRequest.requestedParameters.discardOldest = true;
+
+    // 绝对死区：变化小于死区的值不上报，静止的轴不产生通信
+    if(mDeadband > 0)
+    {
+        UA_DataChangeFilter_init(&filter);
+        filter.trigger = UA_DATACHANGETRIGGER_STATUSVALUE;
+        filter.deadbandType = UA_DEADBANDTYPE_ABSOLUTE;
+        filter.deadbandValue = mDeadband;
+
+        monRequest.requestedParameters.filter.encoding = UA_EXTENSIONOBJECT_DECODED;
+        monRequest.requestedParameters.filter.content.decoded.type = &UA_TYPES[UA_TYPES_DATACHANGEFILTER];
+        monRequest.requestedParameters.filter.content.decoded.data = &filter;
+    }
+}
+
 int OPCUAConnector::subscribeVariant(int nsIdx, QString name, QString desc)
 {
     // 要弄清楚 subscribe 和 monitor 的区别
     // 建立一次Subscription后，可以在这个Subscription上，进行多个变量的monitor
     // 每次的Subscription，都有一些参数可以设定。由于monitor是建立在subscribe之上的，因此会继承subscribe的一些属性
     // 可以简单理解为分组。分组管理的话，方便批量控制。
-    if(mSubId == -1)
-    {
-        // PublishingInterval：数据发布的间隔时间。
-        // LifetimeCount：服务器在判定订阅不活跃前，允许丢失的最大心跳包数。
-        // MaxKeepAliveCount：服务器发送心跳包的最大次数（若在此期间无数据变化，发送空通知）
-        // 关键规则：LifetimeCount > MaxKeepAliveCount（通常设为 3-5 倍）
-        /* Create a subscription */
-        UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
-        request.requestedPublishingInterval = 1; // ---配合后面，好像服务器限制，最小好像是100ms
-        // request.requestedMaxKeepAliveCount  = 10; // 10
-        // request.requestedLifetimeCount = request.requestedMaxKeepAliveCount * 5; // 最小只能设置 MaxKeepAliveCount * 3
-        /* uaexpert的配方*/
-        // request.requestedLifetimeCount = 2400;
-        // request.requestedMaxKeepAliveCount = 10;
-        // request.priority = 0;
-        // request.maxNotificationsPerPublish = 0;
-        UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(mClient, request,
-                                                                                NULL, NULL, NULL);
-        qDebug() << "revised sub data:"
-                 << response.revisedPublishingInterval // 实际的发布周期 ms
-                 << response.revisedLifetimeCount      // 创建订阅后，必须要在多少个周期内发起monitor，否则关闭此订阅
-                 << response.revisedMaxKeepAliveCount  // 最多服务器跳过多少次无数据的发布
-            ;
-
-        mSubId = response.subscriptionId;
-        if(response.responseHeader.serviceResult == UA_STATUSCODE_GOOD)
-        {
-            qDebug("Create subscription succeeded, id %u\n", mSubId);
-        }
-        else
-        {
-            qDebug() << "Create subscription fail:" << mSubId;
-            mSubId = -1;
-            return -1;
-        }
+    if(mSubId == -1 && createSubscription() != 0)
+    {
+        return -1;
     }
 
     // 这个 requestedParameters.samplingInterval 要和前面的 request.requestedPublishingInterval 一起配合使用才有效果
-    auto nodeId = UA_NODEID_STRING_ALLOC(nsIdx, name.toStdString().data());
+    // desc即变量路径，使用已注册的句柄
+    UA_NodeId nodeId = nodeIdFor(desc);
     UA_MonitoredItemCreateRequest monRequest =
         UA_MonitoredItemCreateRequest_default(nodeId);
-    monRequest.requestedParameters.samplingInterval = 10; // --配合前面， 好像服务器限制，最小好像是100ms
-    monRequest.requestedParameters.queueSize = 1; // 10
+    UA_DataChangeFilter filter;
+    applyMonitoringParameters(monRequest, filter);
     // monRequest.monitoringMode = UA_MONITORINGMODE_REPORTING;
     UA_MonitoredItemCreateResult monResponse =
         UA_Client_MonitoredItems_createDataChange(mClient, mSubId,
@@ -892,8 +1898,6 @@ int OPCUAConnector::subscribeVariant(int nsIdx, QString name, QString desc)
              << QString::number(monResponse.statusCode, 16);
     qDebug() << "revised mon data:" << monResponse.revisedSamplingInterval << monResponse.revisedQueueSize;
 
-    UA_NodeId_clear(&nodeId);
-
     if(monResponse.statusCode == UA_STATUSCODE_GOOD)
     {
         // qDebug("Monitoring %s, id %u\n", name.toStdString().c_str(), monResponse.monitoredItemId);
@@ -913,35 +1917,21 @@ int OPCUAConnector::subscribeVariant(int nsIdx, QString name, QString desc)
 int OPCUAConnector::subscribeVariantList(int nsIdx, QMap<QString, QString> varMap, QStringList &failList)
 {
     int ret = 0;
-    if(mSubId == -1)
+    if(mSubId == -1 && createSubscription() != 0)
     {
-        UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
-        request.requestedPublishingInterval = 1; // ---配合后面，好像服务器限制，最小好像是100ms
-
-        UA_CreateSubscriptionResponse response =
-            UA_Client_Subscriptions_create(mClient, request, NULL, NULL, NULL);
-
-        mSubId = response.subscriptionId;
-        if(response.responseHeader.serviceResult == UA_STATUSCODE_GOOD)
-        {
-            qDebug("Create subscription succeeded, id %u\n", mSubId);
-        }
-        else
-        {
-            qDebug() << "Create subscription fail:" << mSubId;
-            mSubId = -1;
-            return -1;
-        }
+        return -1;
     }
 
     std::vector<UA_MonitoredItemCreateRequest> reqList;
     QStringList nameList = varMap.keys();
+    __registerNodes(varMap.values());
+    // 所有请求共用一个过滤器（请求中只保存指针）
+    UA_DataChangeFilter filter;
     for (int i = 0; i < nameList.length(); ++i) {
         QString name = nameList.at(i);
-        auto nodeId = UA_NODEID_STRING_ALLOC(nsIdx, name.toStdString().data());
+        UA_NodeId nodeId = nodeIdFor(varMap[name]);
         UA_MonitoredItemCreateRequest monRequest = UA_MonitoredItemCreateRequest_default(nodeId);
-        monRequest.requestedParameters.samplingInterval = 10;
-        monRequest.requestedParameters.queueSize = 2;
+        applyMonitoringParameters(monRequest, filter);
         // monRequest.monitoringMode = UA_MONITORINGMODE_REPORTING;
 
         reqList.push_back(monRequest);
@@ -1044,14 +2034,10 @@ int OPCUAConnector::__readValueList(QList<DataUnit> &dataList, QString *errorStr
         return -1000;
     }
 
-    // 缓存读取到的数据
-    QMap<QString, QVariant> tmpVarMap;
-
     // 统计需要读取的数据
     QStringList varPathList;
     for (int i = 0; i < dataList.length(); ++i) {
-        DataUnit unit = dataList.at(i);
-        varPathList << unit.path;
+        varPathList << dataList.at(i).path;
     }
 
     if(varPathList.length() == 0)
@@ -1059,98 +2045,134 @@ int OPCUAConnector::__readValueList(QList<DataUnit> &dataList, QString *errorStr
         return -1;
     }
 
-    // qDebug() << varPathList << varPathList.length();
-
-    // 根据MaxNodesPerRead，来分批读取
-    QList<QStringList> batchReadList;
-    int curIdx = 0;
-    do{
-        batchReadList << varPathList.mid(curIdx, mMaxNodesPerRead);
-        curIdx += mMaxNodesPerRead;
-    }while(curIdx < varPathList.length());
+    // 同一组变量（例如每个采样周期读取的关节）复用已构建的请求数组，
+    // 不用每次都为每个节点重新分配NodeId字符串
+    ensureNodeIdCache();
+    const ReadRequestCache &cache = preparedReadRequest(varPathList);
 
-    if(batchReadList.length() > 0)
+    int ret = 0;
+    int resultIdx = 0;
+    for(int batchIdx = 0; batchIdx < cache.batches.length(); batchIdx++)
     {
-        for(int batchIdx = 0; batchIdx < batchReadList.length(); batchIdx++)
-        {
-            QStringList tmpList = batchReadList.at(batchIdx);
-
-            UA_ReadRequest request;
-            UA_ReadRequest_init(&request);
+        const ReadBatch &batch = cache.batches.at(batchIdx);
 
-            // 定义要读取的节点列表
-            int idsCount = tmpList.length();
-            // UA_ReadValueId *ids = new UA_ReadValueId[idsCount];
-            UA_ReadValueId* ids = (UA_ReadValueId*)UA_Array_new(idsCount, &UA_TYPES[UA_TYPES_READVALUEID]);
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead     = batch.ids;
+        request.nodesToReadSize = batch.count;
 
-            for(int i = 0; i < idsCount; i++)
-            {
-                UA_ReadValueId_init(&ids[i]);
+        // 执行批量读取（请求不接管ids，不能对其调用UA_ReadRequest_clear）
+        UA_ReadResponse response = UA_Client_Service_read(mClient, request);
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+            qCritical() << "multi read error:"
+                        << QString::number(response.responseHeader.serviceResult, 16).toUpper()
+                        << batch.count << cache.batches.length();
 
-                QString nodeString = mPrefix + "." + tmpList.at(i);
-                UA_NodeId nodeId = UA_NODEID_STRING_ALLOC(mDefaultNsIdx, nodeString.toStdString().data());
+            UA_ReadResponse_clear(&response);
+            return -1002;
+        }
 
-                ids[i].nodeId = nodeId;
-                ids[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        for (size_t i = 0; i < batch.count; i++, resultIdx++) {
+            // 处理每个节点的值；单个节点失败不影响同一批的其它节点
+            const UA_Variant *uaVar = (i < response.resultsSize) ? &response.results[i].value : nullptr;
+            if(uaVar != nullptr && UA_Variant_isEmpty(uaVar) == false)
+            {
+                dataList[resultIdx].value = convertUAVariantToQVariant(*uaVar);
             }
+            else
+            {
+                dataList[resultIdx].value = QVariant();
 
-            request.nodesToRead     = ids;
-            request.nodesToReadSize = idsCount;
-
-            // 执行批量读取
-            UA_ReadResponse response = UA_Client_Service_read(mClient, request);
-            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD) {
-                for (size_t i = 0; i < response.resultsSize; i++) {
-                    // 处理每个节点的值
-                    UA_Variant uaVar = response.results[i].value;
-                    QString varPath = tmpList.at(i);
-                    // qDebug() << varPath;
-                    if(UA_Variant_isEmpty(&uaVar) == false)
-                    {
-                        QVariant var = convertUAVariantToQVariant(uaVar);
-                        // qDebug() << varPath << var;
+                QString info = QString("read controller value fail:") + "\r\n" +
+                               varPathList.at(resultIdx) + "\r\n" +
+                               QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
+                qCritical() << info;
+                emit errorOccured(info);
 
-                        tmpVarMap[varPath] = var;
-                    }
-                    else
-                    {
-                        QString info = QString("read controller value fail:") + "\r\n" +
-                                       varPath + "\r\n" +
-                                       QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
-                        qCritical() << info;
-                        emit errorOccured(info);
-                        return -1001;
-                    }
+                if(errorString != nullptr)
+                {
+                    *errorString += varPathList.at(resultIdx) + ",";
                 }
+                ret = -1001;
             }
-            else
-            {
-                qCritical() << "multi read error:"
-                            << QString::number(response.responseHeader.serviceResult, 16).toUpper()
-                            << tmpList << batchReadList.length();
+        }
 
-                return -1002;
-            }
-            UA_ReadResponse_clear(&response);
+        UA_ReadResponse_clear(&response);
+    }
+
+    return ret;
+}
 
-            // qDebug() << "multi read values:" << response.responseHeader.serviceResult;
+const OPCUAConnector::ReadRequestCache &OPCUAConnector::preparedReadRequest(const QStringList &varPathList)
+{
+    const QString key = varPathList.join('\n');
 
-            for(int i = 0; i < idsCount; i++)
-            {
-                UA_ReadValueId_clear(&ids[i]);
-            }
-            // delete[] ids;
-            UA_Array_delete(ids, idsCount, &UA_TYPES[UA_TYPES_READVALUEID]);
+    auto it = mReadRequestCache.find(key);
+    if(it != mReadRequestCache.end() && it->nsIdx == mDefaultNsIdx && it->prefix == mPrefix)
+    {
+        return it.value();
+    }
+
+    // 变量组合一般只有少数几种（采样绑定、监听列表），过多时全部重建
+    if(it != mReadRequestCache.end())
+    {
+        freeReadRequest(it.value());
+        mReadRequestCache.erase(it);
+    }
+    if(mReadRequestCache.size() >= MAX_READ_REQUEST_CACHE)
+    {
+        clearReadRequestCache();
+    }
+
+    ReadRequestCache cache;
+    cache.nsIdx = mDefaultNsIdx;
+    cache.prefix = mPrefix;
+
+    // 请求中使用已注册的句柄（复制一份，随请求一起释放）
+    __registerNodes(varPathList);
+
+    // 根据MaxNodesPerRead，来分批读取
+    const int batchSize = qMax<int>(1, mMaxNodesPerRead);
+    for(int curIdx = 0; curIdx < varPathList.length(); curIdx += batchSize)
+    {
+        QStringList tmpList = varPathList.mid(curIdx, batchSize);
+
+        ReadBatch batch;
+        batch.count = tmpList.length();
+        batch.ids = (UA_ReadValueId*)UA_Array_new(batch.count, &UA_TYPES[UA_TYPES_READVALUEID]);
+
+        for(size_t i = 0; i < batch.count; i++)
+        {
+            UA_ReadValueId_init(&batch.ids[i]);
+
+            UA_NodeId nodeId = nodeIdFor(tmpList.at(int(i)));
+            UA_NodeId_copy(&nodeId, &batch.ids[i].nodeId);
+            batch.ids[i].attributeId = UA_ATTRIBUTEID_VALUE;
         }
+
+        cache.batches << batch;
     }
 
-    // 将数据填充回到list
-    for (int i = 0; i < dataList.length(); ++i) {
-        DataUnit unit = dataList.at(i);
-        dataList[i].value = tmpVarMap[unit.path];
+    return mReadRequestCache.insert(key, cache).value();
+}
+
+void OPCUAConnector::freeReadRequest(ReadRequestCache &cache)
+{
+    for(int i = 0; i < cache.batches.length(); i++)
+    {
+        // UA_Array_delete 会逐个清理元素（包括ALLOC出来的NodeId字符串）
+        UA_Array_delete(cache.batches.at(i).ids, cache.batches.at(i).count, &UA_TYPES[UA_TYPES_READVALUEID]);
     }
+    cache.batches.clear();
+}
 
-    return 0;
+void OPCUAConnector::clearReadRequestCache()
+{
+    for(auto it = mReadRequestCache.begin(); it != mReadRequestCache.end(); ++it)
+    {
+        freeReadRequest(it.value());
+    }
+    mReadRequestCache.clear();
 }
 
 // https://blog.csdn.net/love_xiaoqiner/article/details/129864786
@@ -2,6 +2,7 @@
 #define OPCUACONNECTOR_H
 
 #include "baseconnector.h"
+#include "latestvaluemailbox.h"
 
 #include "open62541.h"
 #include <QThread>
@@ -9,19 +10,36 @@
 #include <QMutexLocker>
 #include <QThread>
 #include <QFuture>
+#include <QHash>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
 
 #ifdef Q_OS_WIN
 #pragma execution_character_set("utf-8")
 #endif
 
-// #define USE_OPCUA_SUBSCRIPTION
 #define MAX_SIZE_PER_OPERATION 100
+#define MAX_READ_REQUEST_CACHE 8
+#define LOOP_MAX_WAIT 1000  // 客户端循环在socket上最长的等待时间（毫秒），投递操作时会被唤醒
 
 class OPCUAConnector : public BaseConnector
 {
     Q_OBJECT
 
 public:
+    // 采样流的一次完整快照
+    struct Snapshot {
+        quint32 generation = 0;     // 对应startSampleStream的返回值，用于丢弃旧采样流的快照
+        qint64 timeUs = 0;          // 得到数据的时刻（steady_clock，微秒）
+        qint64 latencyUs = 0;       // 批量读取耗时，订阅模式为0
+        qint64 sourceTimeUs = 0;    // 数据中最新的源时间戳（UTC，微秒），服务器没有提供时为0
+        QList<DataUnit> dataList;
+    };
+
     explicit OPCUAConnector(QObject *parent = nullptr);
     ~OPCUAConnector();
 
@@ -29,10 +47,22 @@ public:
     // 传递两个字符串进来；第一个是连接的主机信息，第二个是变量前缀
     int init(QStringList paramList);
 
-    // 设置默认命名空间序号
+    // 在后台线程中连接（参数同init），不阻塞调用者，结果由connectFinished通知
+    // 连接过程中调用release()会放弃这次连接（连接结束后在后台断开），不再通知
+    int connectAsync(QStringList paramList);
+    bool isConnecting() const { return mConnectPending; }
+
+    // 设置默认命名空间序号；由工作线程执行，不阻塞调用者
     int setNamespaceIndex(int idx = 4);
 
+    // 通过RegisterNodes服务注册要频繁读写的变量，之后的读写、监听都使用服务器返回的句柄；
+    // 注册过的变量在重新连接后会自动重新注册（未注册的变量在第一次访问时注册）
+    // 由工作线程执行，不阻塞调用者；未连接时只记录下来，在下次连接时注册
+    int registerNodes(QStringList pathList,
+                      QString *errorString = nullptr);
+
     // 释放资源，释放后，不能进行读写操作
+    // 不等待网络：由客户端循环线程退出时断开连接
     Q_INVOKABLE int release();
 
     // 从PLC读取数据
@@ -54,6 +84,10 @@ public:
     int writeValueList(QList<DataUnit> dataList,
                        QString *errorString = nullptr);
 
+    // 流水线深度：采样流同时在途的读取请求数
+    // 链路延迟较大时，采样频率不再受往返时间限制
+    void setPipelineDepth(int maxReads);
+
     // 监听数据，即告知PLC要监听哪些数据
     int monitorValues(QStringList pathList,
                       QString *errorString = nullptr);
@@ -63,9 +97,56 @@ public:
 
     void clearMonitor();
 
+    // 监听方式：true为OPC UA订阅（服务器推送数据变化），false为工作线程每100ms批量读取后比较
+    // 切换时会清除已有的监听；由工作线程执行，不阻塞调用者
+    void setSubscriptionEnabled(bool enabled);
+    bool subscriptionEnabled() const { return mUseSubscription; }
+
+    // 订阅参数，在下一次monitorValues时生效；由工作线程执行，不阻塞调用者
+    // publishingInterval：发布间隔（毫秒）；samplingInterval：服务器采样间隔（毫秒）
+    // queueSize：服务器端每个变量的队列长度；deadband：绝对死区，0表示任何变化都上报
+    void setSubscriptionParameters(double publishingInterval,
+                                   double samplingInterval,
+                                   quint32 queueSize,
+                                   double deadband);
+
+    // 订阅被服务器删除时（订阅失效回调）由工作线程重新订阅
+    void requestResubscribe() { mResubscribe = true; }
+
+    // 采样流：所有读取（或订阅）都在工作线程中进行，每得到一组完整的数据就放入邮箱，
+    // 调用线程只通过takeSnapshot()取最新的快照，不会因为网络而阻塞
+    // 轮询模式按intervalMs批量读取；订阅模式监听这些变量，通知到达后更新快照
+    // 返回本次采样流的代号
+    quint32 startSampleStream(const QList<DataUnit> &dataList, int intervalMs);
+    void stopSampleStream();
+
+    // 只能在同一个线程（一般是GUI线程）中调用；没有新快照时返回nullptr
+    // 返回的指针在下一次调用前有效
+    // 收到snapshotReady后应调用一次，否则之后发布的快照不再通知
+    const Snapshot *takeSnapshot();
+
+    // 客户端循环累计唤醒次数，用于统计每秒唤醒次数（空闲时应接近 1000/LOOP_MAX_WAIT，即每秒一次）
+    quint64 loopWakeups() const { return mLoopWakeups.load(std::memory_order_relaxed); }
+
 signals:
+    // connectAsync的结果，0为成功
+    void connectFinished(int ret);
+
+    // 采样流发布了新快照，在工作线程中发出；调用takeSnapshot之前不会重复通知
+    void snapshotReady();
 
 private:
+    // 服务器的OperationLimits
+    struct OperationLimits {
+        quint32 maxNodesPerRead = 1;
+        quint32 maxNodesPerWrite = 1;
+        quint32 maxMonitoredItemsPerCall = 1;
+        quint32 maxNodesPerRegister = MAX_SIZE_PER_OPERATION;
+    };
+
+    // 建立连接并读取服务器的OperationLimits，不访问连接器；失败时返回nullptr
+    static UA_Client *connectClient(const QString &hostInfo, OperationLimits &limits);
+
     // 连接状态变化
     static void onStateChanged(UA_Client *client,
                                UA_SecureChannelState channelState,
@@ -78,6 +159,85 @@ private:
                                       UA_UInt32 monId,
                                       void *monContext,
                                       UA_DataValue *value);
+
+    // 一次连接：后台线程依次完成连接、客户端循环和断开，调用者不等待网络
+    // 由后台线程和连接器共同持有
+    struct Session {
+        QMutex mutex;                           // 保护owner、adopted，以及exit的设置
+        OPCUAConnector *owner = nullptr;        // 连接器析构时置空
+        std::atomic<bool> exit{false};          // 通知退出，连接中的话连接结束后直接断开
+        bool adopted = false;                   // 连接成功并已交给连接器
+        bool notify = true;                     // 是否以connectFinished通知结果
+        QString hostInfo;
+        std::shared_future<void> previous;      // 上一次连接不再访问连接器
+        std::promise<int> result;
+        std::shared_future<int> resultFuture;
+        std::promise<void> released;            // 本次连接不再访问连接器时置位
+        std::shared_future<void> releasedFuture;
+        bool releasedSet = false;
+        UA_SOCKET wakeSocket = UA_INVALID_SOCKET;   // 唤醒客户端循环，创建失败时只按超时等待
+
+        ~Session();
+        void wake();
+
+        // 需持有mutex
+        void markReleased();
+    };
+
+    // 启动一次连接；release时通知退出（不等待），连接中的话由后台线程连接结束后自行断开
+    std::shared_ptr<Session> startSession(const QString &hostInfo, bool notify);
+    void stopSession();
+    static void sessionThread(std::shared_ptr<Session> session);
+
+    // 连接成功后由后台线程交给连接器，之后开始客户端循环
+    void adoptClient(UA_Client *client, const OperationLimits &limits);
+
+    // 客户端循环，退出时在本线程中断开连接并释放客户端
+    void clientLoop(Session &session);
+
+    // 异步读取的响应
+    static void handler_readResponse(UA_Client *client,
+                                     void *userdata,
+                                     UA_UInt32 requestId,
+                                     UA_ReadResponse *response);
+
+    // 按当前参数创建订阅
+    int createSubscription();
+
+    // 按当前参数设置监听项（采样间隔、队列长度、死区过滤器），filter需在请求发送前一直有效
+    void applyMonitoringParameters(UA_MonitoredItemCreateRequest &monRequest,
+                                   UA_DataChangeFilter &filter);
+
+    // 按已监听的变量重新建立订阅
+    int resubscribe();
+
+    // 不带线程锁
+    void __clearMonitor();
+    int __monitorValues(const QStringList &pathList, QString *errorString);
+
+    // 投递给工作线程执行的操作，执行时持有mClientMutex；投递后唤醒客户端循环
+    void postCommand(std::function<void()> command);
+    void runCommands(Session &session);
+
+    // 同步接口（一般在GUI线程中调用）取得mClientMutex：
+    // 先登记并唤醒阻塞在socket上的客户端循环，循环看到有人等待时立即让出锁
+    class ClientLocker {
+    public:
+        explicit ClientLocker(OPCUAConnector *connector);
+    private:
+        static QMutex *announce(OPCUAConnector *connector);
+        QMutexLocker mLocker;
+    };
+
+    // 以下采样流函数只在持有mClientMutex时调用
+    void applySampleStream(quint32 generation, const QList<DataUnit> &dataList, int intervalMs);
+    void sampleStreamProcess();
+    void sendStreamRead();
+    void publishSnapshot(qint64 latencyUs, qint64 sourceTimeUs);
+
+    // 以下函数需持有mClientMutex
+    void fillWriteValue(DataUnit &dataItem, UA_WriteValue &wValue, QList<UA_String> &uaStringList);
+
     // 单个订阅
     int subscribeVariant(int nsIdx, QString name, QString desc);
 
@@ -85,9 +245,33 @@ private:
     int subscribeVariantList(int nsIdx, QMap<QString, QString> varMap, QStringList &failList);
 
     // 不带线程锁
+    // 某个节点读取失败时，其值置为无效，其它节点照常填充，返回-1001
     int __readValueList(QList<DataUnit> &dataList,
                         QString *errorString = nullptr);
 
+    // 预先构建好的批量读取请求（按MaxNodesPerRead分批）
+    struct ReadBatch {
+        UA_ReadValueId *ids = nullptr;
+        size_t count = 0;
+    };
+    struct ReadRequestCache {
+        int nsIdx = 0;
+        QString prefix;
+        QList<ReadBatch> batches;
+    };
+
+    // 变量路径 -> 已注册的NodeId句柄，以下函数都需持有mClientMutex
+    // 返回的NodeId是缓存的浅拷贝，不能clear，缓存清空前有效
+    UA_NodeId nodeIdFor(const QString &path);
+    int __registerNodes(const QStringList &pathList);
+    void ensureNodeIdCache();
+    void clearNodeIdCache(bool unregister);
+
+    // 取得（必要时构建）一组变量的读取请求，需持有mClientMutex
+    const ReadRequestCache &preparedReadRequest(const QStringList &varPathList);
+    void freeReadRequest(ReadRequestCache &cache);
+    void clearReadRequestCache();
+
     // 批量读取变量，用于替代opcua自身的订阅
     int customSubsProcess();
 
@@ -100,8 +284,12 @@ private:
 
     QFuture<void> mFunture;
 
-    bool mTryRelease = false;
-    bool mExited = false;
+    // 最近一次连接，结果送达之前都算正在连接
+    std::shared_ptr<Session> mSession;
+    bool mConnectPending = false;
+    std::atomic<bool> mConnectionLost{false};   // 状态回调发现连接断开，由循环退出并释放
+    std::atomic<quint64> mLoopWakeups{0};
+    std::atomic<int> mClientWaiters{0};         // 等待mClientMutex的同步调用数
 
     int mDefaultNsIdx = 4;
     qint32 mSubId = -1;
@@ -110,7 +298,66 @@ private:
     quint32 mMaxNodesPerRead = 1;
     quint32 mMaxNodesPerWrite = 1;
     quint32 mMaxMonitoredItemsPerCall = 1;
+    quint32 mMaxNodesPerRegister = MAX_SIZE_PER_OPERATION;
+
+    // 订阅模式及参数
+    std::atomic<bool> mUseSubscription{false};
+    double mPublishingInterval = 50;
+    double mSamplingInterval = 20;
+    quint32 mQueueSize = 4;
+    double mDeadband = 0;
+    std::atomic<bool> mResubscribe{false};
     QMap<QString, QVariant> mMonVarMap;
+
+    // 变量路径列表 -> 读取请求，在release()中释放
+    QHash<QString, ReadRequestCache> mReadRequestCache;
+
+    // 变量路径 -> 已注册的NodeId；会话重建（重连）后句柄失效，置mNodeIdCacheStale后重新注册
+    QHash<QString, UA_NodeId> mNodeIdCache;
+    QStringList mRegisteredPaths;
+    bool mNodeIdCacheStale = true;
+
+    // 待工作线程执行的操作，mCommandMutex只保护队列本身，不会在网络请求期间持有
+    QMutex mCommandMutex;
+    QList<std::function<void()>> mCommands;
+
+    // 采样流，由持有mClientMutex的线程访问
+    // 轮询模式下一次采样的异步读取，所有分批的响应都到达后发布
+    struct StreamRead {
+        QList<DataUnit> dataList;
+        int remaining = 0;
+        qint64 sourceTimeUs = 0;
+        QElapsedTimer timer;
+    };
+    struct SampleStream {
+        bool active = false;
+        quint32 generation = 0;
+        int intervalMs = 0;
+        QList<DataUnit> dataList;
+        QHash<QString, QList<int>> indexMap;    // 变量路径 -> dataList中的位置
+        bool dirty = false;                     // 订阅通知更新了还未发布的值
+        qint64 sourceTimeUs = 0;                // 订阅通知中最新的源时间戳
+        QElapsedTimer timer;
+        quint64 readSequence = 0;               // 最近发出的采样序号
+        quint64 publishedSequence = 0;          // 最近发布的采样序号，更旧的响应丢弃
+        QMap<quint64, StreamRead> reads;        // 采样序号 -> 还没凑齐的采样
+    };
+    SampleStream mStream;
+    std::atomic<quint32> mStreamGeneration{0};
+
+    // 在途的异步读取，按requestId匹配响应
+    struct InFlightRead {
+        quint32 generation = 0;
+        quint64 sequence = 0;
+        int offset = 0;     // 在采样dataList中的起始位置
+        int count = 0;
+    };
+    QHash<UA_UInt32, InFlightRead> mReadsInFlight;
+    int mMaxReadsInFlight = 4;
+
+    // 工作线程（持有mClientMutex）发布，GUI线程读取
+    LatestValueMailbox<Snapshot> mSnapshotMailbox;
+    std::atomic<bool> mSnapshotSignalled{false};
 };
 
 #endif // OPCUACONNECTOR_H
@@ -0,0 +1,87 @@
+# 核心源码（URDF解析、网格导入、场景实体、OPC UA通信），供主程序与基准测试共用
+# 用法：include($$PWD/core.pri)
+
+QT       += core gui xml concurrent
+QT       += 3dcore 3drender 3dinput 3dextras 3dlogic
+QT       += qml quick
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/urdfparser.cpp \
+    $$PWD/assimpmodelloader.cpp \
+    $$PWD/robotentity.cpp \
+    $$PWD/robotscene.cpp \
+    $$PWD/trajectoryentity.cpp \
+    $$PWD/settingsmanager.cpp \
+    $$PWD/viewoptions.cpp \
+    $$PWD/opcuabindingmodel.cpp \
+    $$PWD/endeffectorconfigmodel.cpp \
+    $$PWD/orbitcameracontroller.cpp \
+    $$PWD/offscreenrenderer.cpp \
+    $$PWD/snapshotbatch.cpp \
+    $$PWD/syntheticrobot.cpp \
+    $$PWD/stresstest.cpp \
+    $$PWD/jointlog.cpp \
+    $$PWD/jointrecorder.cpp \
+    $$PWD/jointlogreader.cpp \
+    $$PWD/jointreplay.cpp \
+    $$PWD/jointjitterbuffer.cpp \
+    $$PWD/performancemonitor.cpp \
+    $$PWD/linkpicker.cpp \
+    $$PWD/texturecache.cpp \
+    $$PWD/stlmeshloader.cpp \
+    $$PWD/gltfmodelloader.cpp \
+    $$PWD/primitivemeshcache.cpp \
+    $$PWD/tracelog.cpp
+
+HEADERS += \
+    $$PWD/commontypes.h \
+    $$PWD/urdfparser.h \
+    $$PWD/assimpmodelloader.h \
+    $$PWD/robotentity.h \
+    $$PWD/robotscene.h \
+    $$PWD/trajectoryentity.h \
+    $$PWD/settingsmanager.h \
+    $$PWD/viewoptions.h \
+    $$PWD/opcuabindingmodel.h \
+    $$PWD/endeffectorconfigmodel.h \
+    $$PWD/orbitcameracontroller.h \
+    $$PWD/offscreenrenderer.h \
+    $$PWD/snapshotbatch.h \
+    $$PWD/syntheticrobot.h \
+    $$PWD/stresstest.h \
+    $$PWD/jointlog.h \
+    $$PWD/jointrecorder.h \
+    $$PWD/jointlogreader.h \
+    $$PWD/jointreplay.h \
+    $$PWD/jointjitterbuffer.h \
+    $$PWD/performancemonitor.h \
+    $$PWD/linkpicker.h \
+    $$PWD/texturecache.h \
+    $$PWD/meshdata.h \
+    $$PWD/stlmeshloader.h \
+    $$PWD/gltfmodelloader.h \
+    $$PWD/primitivemeshcache.h \
+    $$PWD/tracelog.h
+
+win32 {
+    # assimp动态库及其依赖的动态库所在目录
+    INCLUDEPATH += $$PWD/../../../Assimp/include
+    LIBS += -L$$PWD/../../../Assimp/lib -lassimp-vc142-mt
+    LIBS += -L$$PWD/../../../Assimp/bin
+
+
+    # 这是使用vcpkg安装assimp后的配置
+    INCLUDEPATH += F:/reposities/vcpkg/installed/x64-windows/include
+    LIBS += -LF:/reposities/vcpkg/installed/x64-windows/lib -lassimp-vc142-mt
+    LIBS += -LF:/reposities/vcpkg/installed\x64-windows/bin
+
+}
+unix: LIBS += -lassimp
+win32: LIBS += -lws2_32 -liphlpapi -lpsapi
+win32: DEFINES += WIN32_LEAN_AND_MEAN
+
+include($$PWD/communication/communication.pri)
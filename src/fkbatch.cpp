@@ -0,0 +1,348 @@
+﻿#include "fkbatch.h"
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QQueue>
+#include <QQuaternion>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <cstdio>
+
+namespace {
+
+QString argumentValue(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc - 1; ++i) {
+        if (qstrcmp(argv[i], name) == 0) {
+            return QString::fromLocal8Bit(argv[i + 1]);
+        }
+    }
+    return QString();
+}
+
+/**
+ * @brief 位置参数（跳过选项及其取值）
+ */
+QStringList positionalArguments(int argc, char* argv[])
+{
+    QStringList positional;
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg.startsWith('-') && arg != "-") {
+            ++i;    // 所有选项都带一个取值
+            continue;
+        }
+        positional << QString::fromLocal8Bit(argv[i]);
+    }
+    return positional;
+}
+
+void appendNumber(QByteArray& line, double value)
+{
+    line += ',';
+    line += QByteArray::number(value, 'f', 6);
+}
+
+} // namespace
+
+FkBatch::FkBatch()
+{
+}
+
+bool FkBatch::loadUrdf(const QString& urdfFile)
+{
+    TRACE_SCOPE_DETAIL("FkBatch::loadUrdf", urdfFile);
+
+    URDFParser parser;
+    if (!parser.loadFromFile(urdfFile)) {
+        m_errorMessage = parser.getErrorMessage();
+        return false;
+    }
+    m_model = parser.getModel();
+
+    // 从根Link广度优先展开，保证父Link先于子Link计算
+    m_chain.clear();
+    ChainLink root;
+    root.name = m_model->rootLink;
+    m_chain.append(root);
+    for (int i = 0; i < m_chain.size(); ++i) {
+        const QString linkName = m_chain.at(i).name;
+        for (const auto& joint : m_model->getChildJoints(linkName)) {
+            ChainLink link;
+            link.name = joint->childLink;
+            link.parent = i;
+            link.joint = joint;
+            link.origin = joint->origin.toMatrix();
+            m_chain.append(link);
+        }
+    }
+
+    if (m_chain.size() != m_model->links.size()) {
+        qWarning() << "FkBatch: 有" << m_model->links.size() - m_chain.size() << "个Link无法从根Link到达，已忽略";
+    }
+
+    m_outputLinks.clear();
+    for (int i = 0; i < m_chain.size(); ++i) {
+        m_outputLinks.append(i);
+    }
+    return true;
+}
+
+bool FkBatch::setOutputLinks(const QStringList& linkNames)
+{
+    if (linkNames.isEmpty()) {
+        m_outputLinks.clear();
+        for (int i = 0; i < m_chain.size(); ++i) {
+            m_outputLinks.append(i);
+        }
+        return true;
+    }
+
+    QVector<int> indices;
+    for (const QString& name : linkNames) {
+        int index = -1;
+        for (int i = 0; i < m_chain.size(); ++i) {
+            if (m_chain.at(i).name == name) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            m_errorMessage = QString("未找到Link: %1").arg(name);
+            return false;
+        }
+        indices.append(index);
+    }
+    m_outputLinks = indices;
+    return true;
+}
+
+bool FkBatch::parseHeader(const QByteArray& header)
+{
+    const QList<QByteArray> columns = header.trimmed().split(',');
+    m_columnCount = columns.size();
+    m_hasTimeColumn = !columns.isEmpty() && columns.first().trimmed().toLower() == "time";
+
+    for (ChainLink& link : m_chain) {
+        link.column = -1;
+    }
+
+    int matched = 0;
+    for (int c = m_hasTimeColumn ? 1 : 0; c < columns.size(); ++c) {
+        const QString jointName = QString::fromUtf8(columns.at(c).trimmed());
+        bool found = false;
+        for (ChainLink& link : m_chain) {
+            if (link.joint && link.joint->name == jointName) {
+                if (link.joint->isMovable()) {
+                    link.column = c;
+                }
+                found = true;
+                ++matched;
+                break;
+            }
+        }
+        if (!found) {
+            qWarning() << "FkBatch: 模型中没有关节" << jointName << "，该列被忽略";
+        }
+    }
+
+    if (matched == 0) {
+        m_errorMessage = "输入表头中没有与模型匹配的关节列";
+        return false;
+    }
+    return true;
+}
+
+QByteArray FkBatch::computeChunk(const QVector<QByteArray>& lines, qint64 firstRow) const
+{
+    QVector<QMatrix4x4> world(m_chain.size());
+    QVector<double> values(m_columnCount);
+
+    QByteArray output;
+    output.reserve(lines.size() * (16 + m_outputLinks.size() * 7 * 11));
+
+    qint64 row = firstRow;
+    for (const QByteArray& line : lines) {
+        const QList<QByteArray> fields = line.split(',');
+        for (int c = 0; c < m_columnCount; ++c) {
+            values[c] = c < fields.size() ? fields.at(c).toDouble() : 0.0;
+        }
+
+        for (int i = 0; i < m_chain.size(); ++i) {
+            const ChainLink& link = m_chain.at(i);
+            if (link.parent < 0) {
+                world[i].setToIdentity();
+                continue;
+            }
+            world[i] = world.at(link.parent) * link.origin;
+            if (link.column >= 0) {
+                world[i] *= link.joint->getTransform(values.at(link.column));
+            }
+        }
+
+        if (m_hasTimeColumn) {
+            output += fields.value(0).trimmed();
+        } else {
+            output += QByteArray::number(row);
+        }
+        for (int index : m_outputLinks) {
+            const QMatrix4x4& pose = world.at(index);
+            const QQuaternion rotation = QQuaternion::fromRotationMatrix(pose.toGenericMatrix<3, 3>());
+            appendNumber(output, pose(0, 3));
+            appendNumber(output, pose(1, 3));
+            appendNumber(output, pose(2, 3));
+            appendNumber(output, rotation.scalar());
+            appendNumber(output, rotation.x());
+            appendNumber(output, rotation.y());
+            appendNumber(output, rotation.z());
+        }
+        output += '\n';
+        ++row;
+    }
+    return output;
+}
+
+bool FkBatch::process(QIODevice* input, QIODevice* output)
+{
+    TRACE_SCOPE("FkBatch::process");
+
+    if (m_chain.isEmpty()) {
+        m_errorMessage = "未加载URDF";
+        return false;
+    }
+
+    if (!parseHeader(input->readLine())) {
+        return false;
+    }
+
+    QByteArray header = m_hasTimeColumn ? "time" : "row";
+    for (int index : m_outputLinks) {
+        const QByteArray name = m_chain.at(index).name.toUtf8();
+        for (const char* suffix : { "_x", "_y", "_z", "_qw", "_qx", "_qy", "_qz" }) {
+            header += ',' + name + suffix;
+        }
+    }
+    output->write(header + '\n');
+
+    // 顺序读入、并行计算、按提交顺序写出；在途块数有上限，读到上限时等待最早的块
+    const int maxInFlight = m_maxChunksInFlight > 0
+            ? m_maxChunksInFlight : qMax(2, QThreadPool::globalInstance()->maxThreadCount() * 2);
+    QQueue<QFuture<QByteArray>> inFlight;
+    m_rowsProcessed = 0;
+    bool writeFailed = false;
+
+    auto writeOldest = [&]() {
+        const QByteArray chunk = inFlight.dequeue().result();
+        if (!writeFailed && output->write(chunk) != chunk.size()) {
+            writeFailed = true;
+        }
+    };
+
+    bool endOfInput = false;
+    while (!endOfInput && !writeFailed) {
+        QVector<QByteArray> lines;
+        lines.reserve(m_chunkRows);
+        while (lines.size() < m_chunkRows) {
+            const QByteArray line = input->readLine();
+            if (line.isEmpty()) {
+                endOfInput = true;   // readLine只在无数据时返回空，空行至少包含换行符
+                break;
+            }
+            const QByteArray trimmed = line.trimmed();
+            if (!trimmed.isEmpty()) {
+                lines.append(trimmed);
+            }
+        }
+        if (lines.isEmpty()) break;
+
+        const qint64 firstRow = m_rowsProcessed;
+        m_rowsProcessed += lines.size();
+        if (inFlight.size() >= maxInFlight) {
+            writeOldest();
+        }
+        inFlight.enqueue(QtConcurrent::run([this, lines, firstRow]() { return computeChunk(lines, firstRow); }));
+    }
+
+    while (!inFlight.isEmpty()) {
+        writeOldest();
+    }
+
+    if (writeFailed) {
+        m_errorMessage = QString("写出失败: %1").arg(output->errorString());
+        return false;
+    }
+    return true;
+}
+
+int FkBatch::run(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    TraceLog::startFromArguments(argc, argv);
+
+    const QStringList positional = positionalArguments(argc, argv);
+    if (positional.size() < 2) {
+        qCritical() << "用法: fkbatch <robot.urdf> <joints.csv|-> [-o poses.csv] [--links a,b,...]"
+                       " [--chunk 行数] [--threads N] [--trace trace.json]";
+        return 2;
+    }
+
+    FkBatch batch;
+    if (!batch.loadUrdf(positional.at(0))) {
+        qCritical() << "加载URDF失败:" << batch.getErrorMessage();
+        return 1;
+    }
+
+    const QString links = argumentValue(argc, argv, "--links");
+    if (!batch.setOutputLinks(links.split(',', Qt::SkipEmptyParts))) {
+        qCritical() << batch.getErrorMessage();
+        return 1;
+    }
+
+    const int chunkRows = argumentValue(argc, argv, "--chunk").toInt();
+    if (chunkRows > 0) batch.setChunkRows(chunkRows);
+
+    const int threads = argumentValue(argc, argv, "--threads").toInt();
+    if (threads > 0) QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    QFile input;
+    const QString inputPath = positional.at(1);
+    const bool inputOpened = inputPath == "-"
+            ? input.open(stdin, QIODevice::ReadOnly)
+            : (input.setFileName(inputPath), input.open(QIODevice::ReadOnly));
+    if (!inputOpened) {
+        qCritical() << "无法打开关节数据:" << inputPath;
+        return 1;
+    }
+
+    QFile output;
+    const QString outputPath = argumentValue(argc, argv, "-o");
+    const bool outputOpened = outputPath.isEmpty() || outputPath == "-"
+            ? output.open(stdout, QIODevice::WriteOnly)
+            : (output.setFileName(outputPath), output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    if (!outputOpened) {
+        qCritical() << "无法写入:" << outputPath;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = batch.process(&input, &output);
+    output.close();
+
+    const double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+    if (!ok) {
+        qCritical() << "正运动学批处理失败:" << batch.getErrorMessage();
+    } else {
+        qDebug().noquote() << QString("正运动学批处理: %1 行, %2 s, %3 行/分钟")
+                              .arg(batch.rowsProcessed())
+                              .arg(seconds, 0, 'f', 2)
+                              .arg(batch.rowsProcessed() / seconds * 60.0, 0, 'f', 0);
+    }
+
+    TraceLog::finish();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#ifndef FKBATCH_H
+#define FKBATCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMatrix4x4>
+#include <QByteArray>
+#include <memory>
+
+#include "urdfparser.h"
+
+class QIODevice;
+
+/**
+ * @brief 无界面正运动学批处理：把关节CSV逐块并行计算为Link位姿CSV
+ *
+ * 只依赖URDF解析（不创建QML/Qt3D），按块读取输入、线程池并行计算、按原顺序写出，
+ * 同时在途的块数有上限，因此内存占用与输入长度无关。
+ *
+ * 输入：首行为表头 time,关节名,...（time列可省略），其余每行一个采样（弧度/米）
+ * 输出：time,<link>_x,<link>_y,<link>_z,<link>_qw,<link>_qx,<link>_qy,<link>_qz,...
+ *       位姿为Link坐标系在URDF根Link坐标系中的位置和姿态（四元数）
+ */
+class FkBatch
+{
+public:
+    FkBatch();
+
+    /**
+     * @brief 加载URDF并预计算运动学链
+     */
+    bool loadUrdf(const QString& urdfFile);
+
+    /**
+     * @brief 指定输出的Link（为空时输出全部Link）
+     */
+    bool setOutputLinks(const QStringList& linkNames);
+
+    /**
+     * @brief 每块的行数
+     */
+    void setChunkRows(int rows) { m_chunkRows = qMax(1, rows); }
+
+    /**
+     * @brief 同时计算的块数上限（<=0表示按CPU核数的两倍）
+     */
+    void setMaxChunksInFlight(int chunks) { m_maxChunksInFlight = chunks; }
+
+    /**
+     * @brief 处理整个输入流
+     * @param input 关节CSV
+     * @param output 位姿CSV
+     * @return 是否成功
+     */
+    bool process(QIODevice* input, QIODevice* output);
+
+    qint64 rowsProcessed() const { return m_rowsProcessed; }
+    QString getErrorMessage() const { return m_errorMessage; }
+
+    /**
+     * @brief 命令行入口
+     *   fkbatch <robot.urdf> <joints.csv|-> [-o poses.csv] [--links a,b,...] [--chunk N] [--threads N]
+     * @return 进程退出码
+     */
+    static int run(int argc, char* argv[]);
+
+private:
+    /**
+     * @brief 按父子顺序排列的Link（父Link总在子Link之前）
+     */
+    struct ChainLink {
+        QString name;
+        int parent = -1;                    // 父Link在m_chain中的下标，根为-1
+        std::shared_ptr<URDFJoint> joint;   // 连接父Link的关节
+        QMatrix4x4 origin;                  // 关节原点变换（预计算）
+        int column = -1;                    // 关节值在输入行中的列下标，-1表示固定
+    };
+
+    bool parseHeader(const QByteArray& header);
+    QByteArray computeChunk(const QVector<QByteArray>& lines, qint64 firstRow) const;
+
+    std::shared_ptr<URDFModel> m_model;
+    QVector<ChainLink> m_chain;
+    QVector<int> m_outputLinks;             // 输出的Link在m_chain中的下标
+    bool m_hasTimeColumn = true;
+    int m_columnCount = 0;
+    int m_chunkRows = 4096;
+    int m_maxChunksInFlight = 0;
+    qint64 m_rowsProcessed = 0;
+    QString m_errorMessage;
+};
+
+#endif // FKBATCH_H
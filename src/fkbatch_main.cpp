@@ -0,0 +1,9 @@
+﻿#include "fkbatch.h"
+
+#pragma execution_character_set("utf-8")
+
+// 无界面正运动学批处理入口（不依赖QML/Qt3D，见 tools/fkbatch/fkbatch.pro）
+int main(int argc, char *argv[])
+{
+    return FkBatch::run(argc, argv);
+}
@@ -0,0 +1,1285 @@
+﻿#include "gltfmodelloader.h"
+
+#include <Qt3DCore/QTransform>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QQuaternion>
+#include <QUrl>
+#include <QtEndian>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const quint32 kGlbMagic = 0x46546C67;      // "glTF"
+const quint32 kChunkJson = 0x4E4F534A;     // "JSON"
+const quint32 kChunkBin = 0x004E4942;      // "BIN\0"
+
+const int kComponentByte = 5120;
+const int kComponentUnsignedByte = 5121;
+const int kComponentShort = 5122;
+const int kComponentUnsignedShort = 5123;
+const int kComponentUnsignedInt = 5125;
+const int kComponentFloat = 5126;
+
+const int kMaxNodeDepth = 256;
+
+// 不影响几何数据或已支持的必需扩展
+const char* const kSupportedExtensions[] = {
+    "KHR_mesh_quantization",
+    "EXT_meshopt_compression",
+    "KHR_meshopt_compression",
+    "KHR_texture_transform",
+    "KHR_materials_unlit",
+};
+
+int componentSize(int componentType)
+{
+    switch (componentType) {
+    case kComponentByte:
+    case kComponentUnsignedByte: return 1;
+    case kComponentShort:
+    case kComponentUnsignedShort: return 2;
+    case kComponentUnsignedInt:
+    case kComponentFloat: return 4;
+    default: return 0;
+    }
+}
+
+int componentCount(const QString& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+Qt3DRender::QAttribute::VertexBaseType vertexBaseType(int componentType)
+{
+    switch (componentType) {
+    case kComponentByte: return Qt3DRender::QAttribute::Byte;
+    case kComponentUnsignedByte: return Qt3DRender::QAttribute::UnsignedByte;
+    case kComponentShort: return Qt3DRender::QAttribute::Short;
+    case kComponentUnsignedShort: return Qt3DRender::QAttribute::UnsignedShort;
+    case kComponentUnsignedInt: return Qt3DRender::QAttribute::UnsignedInt;
+    default: return Qt3DRender::QAttribute::Float;
+    }
+}
+
+/**
+ * @brief 读取一个分量并转换为浮点（normalized按glTF规范映射到[-1,1]/[0,1]）
+ */
+float readComponent(const char* p, int componentType, bool normalized)
+{
+    switch (componentType) {
+    case kComponentByte: {
+        const float v = float(qint8(*p));
+        return normalized ? qMax(v / 127.0f, -1.0f) : v;
+    }
+    case kComponentUnsignedByte: {
+        const float v = float(quint8(*p));
+        return normalized ? v / 255.0f : v;
+    }
+    case kComponentShort: {
+        const float v = float(qFromLittleEndian<qint16>(p));
+        return normalized ? qMax(v / 32767.0f, -1.0f) : v;
+    }
+    case kComponentUnsignedShort: {
+        const float v = float(qFromLittleEndian<quint16>(p));
+        return normalized ? v / 65535.0f : v;
+    }
+    case kComponentUnsignedInt:
+        return float(qFromLittleEndian<quint32>(p));
+    default:
+        return qFromLittleEndian<float>(p);
+    }
+}
+
+quint32 readLe32(const uchar* p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+// ==================== meshopt 解码（编码格式版本0，见EXT_meshopt_compression规范） ====================
+
+namespace meshopt {
+
+const int kVertexBlockSizeBytes = 8192;
+const int kVertexBlockMaxSize = 256;
+const int kByteGroupSize = 16;
+const int kByteGroupDecodeLimit = 24;
+const int kTailMinSize = 32;
+
+const uchar kVertexHeader = 0xa0;
+const uchar kIndexHeader = 0xe0;
+const uchar kSequenceHeader = 0xd0;
+
+int vertexBlockSize(int vertexSize)
+{
+    int result = kVertexBlockSizeBytes / vertexSize;
+    result &= ~(kByteGroupSize - 1);
+    return result < kVertexBlockMaxSize ? result : kVertexBlockMaxSize;
+}
+
+const uchar* decodeBytesGroup(const uchar* data, uchar* buffer, int bitslog2)
+{
+    switch (bitslog2) {
+    case 0:
+        std::memset(buffer, 0, kByteGroupSize);
+        return data;
+    case 1: {
+        // 每字节4个2位值（高位在前），值3表示后续跟随一个原始字节
+        const uchar* dataVar = data + 4;
+        for (int i = 0; i < 4; ++i) {
+            uchar byte = data[i];
+            for (int j = 0; j < 4; ++j) {
+                const uchar enc = byte >> 6;
+                byte = uchar(byte << 2);
+                buffer[i * 4 + j] = (enc == 3) ? *dataVar++ : enc;
+            }
+        }
+        return dataVar;
+    }
+    case 2: {
+        // 每字节2个4位值，值15表示后续跟随一个原始字节
+        const uchar* dataVar = data + 8;
+        for (int i = 0; i < 8; ++i) {
+            uchar byte = data[i];
+            for (int j = 0; j < 2; ++j) {
+                const uchar enc = byte >> 4;
+                byte = uchar(byte << 4);
+                buffer[i * 2 + j] = (enc == 15) ? *dataVar++ : enc;
+            }
+        }
+        return dataVar;
+    }
+    default:
+        std::memcpy(buffer, data, kByteGroupSize);
+        return data + kByteGroupSize;
+    }
+}
+
+const uchar* decodeBytes(const uchar* data, const uchar* dataEnd, uchar* buffer, int bufferSize)
+{
+    const int headerSize = ((bufferSize / kByteGroupSize) + 3) / 4;
+    if (dataEnd - data < headerSize) return nullptr;
+
+    const uchar* header = data;
+    data += headerSize;
+
+    for (int i = 0; i < bufferSize; i += kByteGroupSize) {
+        if (dataEnd - data < kByteGroupDecodeLimit) return nullptr;
+
+        const int headerOffset = i / kByteGroupSize;
+        const int bitslog2 = (header[headerOffset / 4] >> ((headerOffset % 4) * 2)) & 3;
+        data = decodeBytesGroup(data, buffer + i, bitslog2);
+    }
+    return data;
+}
+
+const uchar* decodeVertexBlock(const uchar* data, const uchar* dataEnd, uchar* vertexData,
+                               int vertexCount, int vertexSize, uchar lastVertex[256])
+{
+    uchar buffer[kVertexBlockMaxSize];
+    uchar transposed[kVertexBlockSizeBytes];
+
+    const int vertexCountAligned = (vertexCount + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+
+    // 按字节通道解码，再用zigzag差分还原
+    for (int k = 0; k < vertexSize; ++k) {
+        data = decodeBytes(data, dataEnd, buffer, vertexCountAligned);
+        if (!data) return nullptr;
+
+        uchar p = lastVertex[k];
+        for (int i = 0; i < vertexCount; ++i) {
+            const uchar v = uchar(-(buffer[i] & 1)) ^ uchar(buffer[i] >> 1);
+            p = uchar(p + v);
+            transposed[i * vertexSize + k] = p;
+        }
+    }
+
+    std::memcpy(vertexData, transposed, size_t(vertexCount) * vertexSize);
+    std::memcpy(lastVertex, &transposed[vertexSize * (vertexCount - 1)], size_t(vertexSize));
+    return data;
+}
+
+bool decodeVertexBuffer(uchar* destination, int vertexCount, int vertexSize,
+                        const uchar* buffer, qint64 bufferSize)
+{
+    if (vertexSize <= 0 || vertexSize > 256 || vertexSize % 4 != 0) return false;
+
+    const uchar* data = buffer;
+    const uchar* dataEnd = buffer + bufferSize;
+    if (dataEnd - data < 1 + vertexSize) return false;
+
+    const uchar header = *data++;
+    if ((header & 0xf0) != kVertexHeader || (header & 0x0f) != 0) return false;
+
+    // 首个“上一顶点”存放在数据尾部
+    uchar lastVertex[256];
+    std::memcpy(lastVertex, dataEnd - vertexSize, size_t(vertexSize));
+
+    const int blockSize = vertexBlockSize(vertexSize);
+    for (int offset = 0; offset < vertexCount; offset += blockSize) {
+        const int count = qMin(blockSize, vertexCount - offset);
+        data = decodeVertexBlock(data, dataEnd, destination + qint64(offset) * vertexSize,
+                                 count, vertexSize, lastVertex);
+        if (!data) return false;
+    }
+
+    const int tailSize = vertexSize < kTailMinSize ? kTailMinSize : vertexSize;
+    return dataEnd - data == tailSize;
+}
+
+quint32 decodeVByte(const uchar*& data)
+{
+    const uchar lead = *data++;
+    if (lead < 128) return lead;
+
+    // 最多5字节，每字节7位
+    quint32 result = lead & 127;
+    int shift = 7;
+    for (int i = 0; i < 4; ++i) {
+        const uchar group = *data++;
+        result |= quint32(group & 127) << shift;
+        shift += 7;
+        if (group < 128) break;
+    }
+    return result;
+}
+
+quint32 decodeIndex(const uchar*& data, quint32 last)
+{
+    const quint32 v = decodeVByte(data);
+    const quint32 d = (v >> 1) ^ -qint32(v & 1);
+    return last + d;
+}
+
+void writeTriangle(uchar* destination, int offset, int indexSize, quint32 a, quint32 b, quint32 c)
+{
+    if (indexSize == 2) {
+        quint16* out = reinterpret_cast<quint16*>(destination) + offset;
+        out[0] = quint16(a);
+        out[1] = quint16(b);
+        out[2] = quint16(c);
+    } else {
+        quint32* out = reinterpret_cast<quint32*>(destination) + offset;
+        out[0] = a;
+        out[1] = b;
+        out[2] = c;
+    }
+}
+
+bool decodeIndexBuffer(uchar* destination, int indexCount, int indexSize,
+                       const uchar* buffer, qint64 bufferSize)
+{
+    if (indexCount % 3 != 0 || (indexSize != 2 && indexSize != 4)) return false;
+    if (bufferSize < 1 + indexCount / 3 + 16) return false;
+    if ((buffer[0] & 0xf0) != kIndexHeader) return false;
+
+    const int version = buffer[0] & 0x0f;
+    if (version > 1) return false;
+
+    // 解码顺序必须与编码器的边/顶点FIFO更新完全一致
+    quint32 edgeFifo[16][2];
+    quint32 vertexFifo[16];
+    std::memset(edgeFifo, -1, sizeof(edgeFifo));
+    std::memset(vertexFifo, -1, sizeof(vertexFifo));
+    int edgeFifoOffset = 0;
+    int vertexFifoOffset = 0;
+
+    auto pushEdge = [&](quint32 a, quint32 b) {
+        edgeFifo[edgeFifoOffset][0] = a;
+        edgeFifo[edgeFifoOffset][1] = b;
+        edgeFifoOffset = (edgeFifoOffset + 1) & 15;
+    };
+    auto pushVertex = [&](quint32 v, bool advance) {
+        vertexFifo[vertexFifoOffset] = v;
+        vertexFifoOffset = (vertexFifoOffset + (advance ? 1 : 0)) & 15;
+    };
+
+    quint32 next = 0;
+    quint32 last = 0;
+    const int fecMax = version >= 1 ? 13 : 15;
+
+    const uchar* code = buffer + 1;
+    const uchar* data = code + indexCount / 3;
+    const uchar* dataSafeEnd = buffer + bufferSize - 16;
+    const uchar* codeauxTable = dataSafeEnd;
+
+    for (int i = 0; i < indexCount; i += 3) {
+        if (data > dataSafeEnd) return false;
+
+        const uchar codetri = *code++;
+
+        if (codetri < 0xf0) {
+            const int fe = codetri >> 4;
+            const quint32 a = edgeFifo[(edgeFifoOffset - 1 - fe) & 15][0];
+            const quint32 b = edgeFifo[(edgeFifoOffset - 1 - fe) & 15][1];
+            const int fec = codetri & 15;
+
+            if (fec < fecMax) {
+                const quint32 cf = vertexFifo[(vertexFifoOffset - 1 - fec) & 15];
+                const quint32 c = (fec == 0) ? next : cf;
+                const bool fec0 = fec == 0;
+                next += fec0 ? 1 : 0;
+
+                writeTriangle(destination, i, indexSize, a, b, c);
+                pushVertex(c, fec0);
+                pushEdge(c, b);
+                pushEdge(a, c);
+            } else {
+                // 版本1中13、14分别表示上一个自由索引-1、+1
+                const quint32 c = last = (fec != 15) ? last + quint32(fec - (fec ^ 3)) : decodeIndex(data, last);
+
+                writeTriangle(destination, i, indexSize, a, b, c);
+                pushVertex(c, true);
+                pushEdge(c, b);
+                pushEdge(a, c);
+            }
+        } else if (codetri < 0xfe) {
+            const uchar codeaux = codeauxTable[codetri & 15];
+            const int feb = codeaux >> 4;
+            const int fec = codeaux & 15;
+
+            const quint32 a = next++;
+
+            const quint32 bf = vertexFifo[(vertexFifoOffset - feb) & 15];
+            const quint32 b = (feb == 0) ? next : bf;
+            const bool feb0 = feb == 0;
+            next += feb0 ? 1 : 0;
+
+            const quint32 cf = vertexFifo[(vertexFifoOffset - fec) & 15];
+            const quint32 c = (fec == 0) ? next : cf;
+            const bool fec0 = fec == 0;
+            next += fec0 ? 1 : 0;
+
+            writeTriangle(destination, i, indexSize, a, b, c);
+            pushVertex(a, true);
+            pushVertex(b, feb0);
+            pushVertex(c, fec0);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        } else {
+            const uchar codeaux = *data++;
+            const int fea = codetri == 0xfe ? 0 : 15;
+            const int feb = codeaux >> 4;
+            const int fec = codeaux & 15;
+
+            if (codeaux == 0) next = 0;
+
+            quint32 a = (fea == 0) ? next++ : 0;
+            quint32 b = (feb == 0) ? next++ : vertexFifo[(vertexFifoOffset - feb) & 15];
+            quint32 c = (fec == 0) ? next++ : vertexFifo[(vertexFifoOffset - fec) & 15];
+
+            if (fea == 15) last = a = decodeIndex(data, last);
+            if (feb == 15) last = b = decodeIndex(data, last);
+            if (fec == 15) last = c = decodeIndex(data, last);
+
+            writeTriangle(destination, i, indexSize, a, b, c);
+            pushVertex(a, true);
+            pushVertex(b, feb == 0 || feb == 15);
+            pushVertex(c, fec == 0 || fec == 15);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+    }
+
+    return data == dataSafeEnd;
+}
+
+bool decodeIndexSequence(uchar* destination, int indexCount, int indexSize,
+                         const uchar* buffer, qint64 bufferSize)
+{
+    if (indexSize != 2 && indexSize != 4) return false;
+    if (bufferSize < 1 + indexCount + 4) return false;
+    if ((buffer[0] & 0xf0) != kSequenceHeader || (buffer[0] & 0x0f) != 0) return false;
+
+    const uchar* data = buffer + 1;
+    const uchar* dataSafeEnd = buffer + bufferSize - 4;
+    quint32 last[2] = { 0, 0 };
+
+    for (int i = 0; i < indexCount; ++i) {
+        if (data >= dataSafeEnd) return false;
+
+        quint32 v = decodeVByte(data);
+        // 最低位选择两个基线之一
+        const int current = v & 1;
+        v >>= 1;
+        const quint32 d = (v >> 1) ^ -qint32(v & 1);
+        const quint32 index = last[current] + d;
+        last[current] = index;
+
+        if (indexSize == 2) {
+            reinterpret_cast<quint16*>(destination)[i] = quint16(index);
+        } else {
+            reinterpret_cast<quint32*>(destination)[i] = index;
+        }
+    }
+
+    return data == dataSafeEnd;
+}
+
+template <typename T>
+void decodeFilterOctahedral(T* data, int count)
+{
+    const float maxValue = float((1 << (sizeof(T) * 8 - 1)) - 1);
+    for (int i = 0; i < count; ++i) {
+        // z分量编码1.0，据此还原八面体展开前的z
+        float x = float(data[i * 4 + 0]);
+        float y = float(data[i * 4 + 1]);
+        const float z = float(data[i * 4 + 2]) - std::fabs(x) - std::fabs(y);
+
+        const float t = (z >= 0.0f) ? 0.0f : z;
+        x += (x >= 0.0f) ? t : -t;
+        y += (y >= 0.0f) ? t : -t;
+
+        const float length = std::sqrt(x * x + y * y + z * z);
+        const float s = length > 0.0f ? maxValue / length : 0.0f;
+
+        data[i * 4 + 0] = T(int(x * s + (x >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + 1] = T(int(y * s + (y >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + 2] = T(int(z * s + (z >= 0.0f ? 0.5f : -0.5f)));
+    }
+}
+
+void decodeFilterQuaternion(qint16* data, int count)
+{
+    const float scale = 1.0f / std::sqrt(2.0f);
+    for (int i = 0; i < count; ++i) {
+        qint16* q = data + i * 4;
+
+        // 最大分量的序号存放在w的低2位，其余位为缩放
+        const int sf = q[3] | 3;
+        const float ss = scale / float(sf);
+        const float x = float(q[0]) * ss;
+        const float y = float(q[1]) * ss;
+        const float z = float(q[2]) * ss;
+        const float ww = 1.0f - x * x - y * y - z * z;
+        const float w = std::sqrt(ww >= 0.0f ? ww : 0.0f);
+
+        const int qc = q[3] & 3;
+        q[(qc + 1) & 3] = qint16(int(x * 32767.0f + (x >= 0.0f ? 0.5f : -0.5f)));
+        q[(qc + 2) & 3] = qint16(int(y * 32767.0f + (y >= 0.0f ? 0.5f : -0.5f)));
+        q[(qc + 3) & 3] = qint16(int(z * 32767.0f + (z >= 0.0f ? 0.5f : -0.5f)));
+        q[(qc + 0) & 3] = qint16(int(w * 32767.0f + 0.5f));
+    }
+}
+
+void decodeFilterExponential(quint32* data, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        // 高8位为有符号指数，低24位为有符号尾数
+        const quint32 v = data[i];
+        const qint32 m = qint32(v << 8) >> 8;
+        const qint32 e = qint32(v) >> 24;
+        const float f = std::ldexp(float(m), e);
+        std::memcpy(&data[i], &f, sizeof(float));
+    }
+}
+
+} // namespace meshopt
+
+} // namespace
+
+GltfModelLoader::GltfModelLoader()
+{
+}
+
+GltfModelLoader::~GltfModelLoader()
+{
+    releaseBuffers();
+}
+
+bool GltfModelLoader::isGltfFile(const QString& filename)
+{
+    const QString suffix = QFileInfo(filename).suffix().toLower();
+    return suffix == "glb" || suffix == "gltf";
+}
+
+Qt3DCore::QEntity* GltfModelLoader::loadModel(const QString& filename,
+                                              Qt3DCore::QEntity* parent,
+                                              const QColor& color,
+                                              const QVector3D& scale,
+                                              bool loadNormals)
+{
+    if (!prepare(filename, loadNormals)) {
+        return nullptr;
+    }
+    return build(parent, color, scale);
+}
+
+bool GltfModelLoader::prepare(const QString& filename, bool loadNormals)
+{
+    m_errorMessage.clear();
+    m_stageTimings.clear();
+    m_modelDir = QFileInfo(filename).absolutePath();
+    m_loadNormals = loadNormals;
+    m_decodeNsec = 0;
+    releaseBuffers();
+
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+
+    QByteArray json;
+    if (!mapFile(filename, json)) {
+        releaseBuffers();
+        return false;
+    }
+    recordStage("map", stageTimer.nsecsElapsed());
+
+    stageTimer.restart();
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        fail(QString("glTF JSON error: %1").arg(parseError.errorString()));
+        releaseBuffers();
+        return false;
+    }
+    m_json = document.object();
+    recordStage("parse", stageTimer.nsecsElapsed());
+
+    const QString version = m_json.value("asset").toObject().value("version").toString();
+    if (!version.startsWith("2")) {
+        fail(QString("Unsupported glTF version: %1").arg(version));
+        releaseBuffers();
+        return false;
+    }
+
+    if (!checkRequiredExtensions() || !resolveBuffers() || !predecodeMeshViews()) {
+        releaseBuffers();
+        return false;
+    }
+
+    if (m_decodeNsec > 0) {
+        recordStage("decode", m_decodeNsec);
+    }
+    return true;
+}
+
+Qt3DCore::QEntity* GltfModelLoader::build(Qt3DCore::QEntity* parent, const QColor& color, const QVector3D& scale)
+{
+    m_minPoint = QVector3D(std::numeric_limits<float>::max(),
+                           std::numeric_limits<float>::max(),
+                           std::numeric_limits<float>::max());
+    m_maxPoint = QVector3D(std::numeric_limits<float>::lowest(),
+                           std::numeric_limits<float>::lowest(),
+                           std::numeric_limits<float>::lowest());
+    m_color = color;
+
+    if (m_json.isEmpty()) {
+        fail("glTF file has not been prepared");
+        return nullptr;
+    }
+
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+
+    m_rootEntity = new Qt3DCore::QEntity(parent);
+
+    Qt3DCore::QTransform* transform = new Qt3DCore::QTransform(m_rootEntity);
+    transform->setScale3D(scale);
+    m_rootEntity->addComponent(transform);
+
+    QMatrix4x4 rootMatrix;
+    rootMatrix.scale(scale);
+
+    // 默认场景的根节点；没有场景时取所有不被引用的节点
+    const QJsonArray scenes = m_json.value("scenes").toArray();
+    QVector<int> rootNodes;
+    if (!scenes.isEmpty()) {
+        const int sceneIndex = qBound(0, m_json.value("scene").toInt(0), scenes.size() - 1);
+        for (const QJsonValue& node : scenes.at(sceneIndex).toObject().value("nodes").toArray()) {
+            rootNodes.append(node.toInt());
+        }
+    } else {
+        const QJsonArray nodes = m_json.value("nodes").toArray();
+        QVector<bool> isChild(nodes.size(), false);
+        for (const QJsonValue& node : nodes) {
+            for (const QJsonValue& child : node.toObject().value("children").toArray()) {
+                if (child.toInt() >= 0 && child.toInt() < nodes.size()) isChild[child.toInt()] = true;
+            }
+        }
+        for (int i = 0; i < nodes.size(); ++i) {
+            if (!isChild[i]) rootNodes.append(i);
+        }
+    }
+
+    bool ok = true;
+    for (int nodeIndex : rootNodes) {
+        if (!processNode(nodeIndex, rootMatrix, m_rootEntity, 0)) {
+            ok = false;
+            break;
+        }
+    }
+
+    if (ok && m_renderers.isEmpty()) {
+        ok = fail("glTF file contains no renderable meshes");
+    }
+
+    Qt3DCore::QEntity* result = m_rootEntity;
+    if (!ok) {
+        delete m_rootEntity;
+        result = nullptr;
+    }
+
+    // 数据已复制到Qt3D缓冲区，可以解除映射
+    releaseBuffers();
+
+    recordStage("convert", stageTimer.nsecsElapsed());
+    return result;
+}
+
+bool GltfModelLoader::predecodeMeshViews()
+{
+    // 提前检查必需属性并解码网格用到的meshopt视图，使build()只剩创建Qt3D节点
+    const QJsonArray meshes = m_json.value("meshes").toArray();
+    const QJsonArray accessors = m_json.value("accessors").toArray();
+    for (int m = 0; m < meshes.size(); ++m) {
+        const QJsonArray primitives = meshes.at(m).toObject().value("primitives").toArray();
+        for (int p = 0; p < primitives.size(); ++p) {
+            const QJsonObject primitive = primitives.at(p).toObject();
+            const QJsonObject attributes = primitive.value("attributes").toObject();
+            if (!attributes.contains("POSITION")) {
+                return fail(QString("Mesh %1 primitive %2 has no POSITION").arg(m).arg(p));
+            }
+            if (m_loadNormals && !attributes.contains("NORMAL")) {
+                // 交给Assimp按导入配置生成法线
+                return fail(QString("Mesh %1 primitive %2 has no NORMAL").arg(m).arg(p));
+            }
+
+            QVector<int> accessorIndices = { attributes.value("POSITION").toInt(-1) };
+            if (m_loadNormals) accessorIndices.append(attributes.value("NORMAL").toInt(-1));
+            if (primitive.contains("indices")) accessorIndices.append(primitive.value("indices").toInt(-1));
+
+            for (int accessorIndex : accessorIndices) {
+                const int viewIndex = accessors.at(accessorIndex).toObject().value("bufferView").toInt(-1);
+                View view;
+                if (viewIndex >= 0 && !resolveView(viewIndex, view)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool GltfModelLoader::mapFile(const QString& filename, QByteArray& json)
+{
+    QFile* file = new QFile(filename);
+    m_mappedFiles.append(file);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return fail(QString("Cannot open file: %1").arg(filename));
+    }
+
+    const qint64 size = file->size();
+    const uchar* data = size > 0 ? file->map(0, size) : nullptr;
+    if (!data) {
+        return fail(QString("Cannot map file: %1").arg(filename));
+    }
+
+    if (size < 12 || readLe32(data) != kGlbMagic) {
+        // .gltf：整个文件就是JSON
+        json = QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(qMin<qint64>(size, INT_MAX)));
+        return true;
+    }
+
+    // GLB：12字节文件头 + JSON块 + 可选的BIN块，每块前有 长度/类型 两个uint32
+    if (readLe32(data + 4) != 2) {
+        return fail(QString("Unsupported GLB version: %1").arg(readLe32(data + 4)));
+    }
+    const qint64 length = qMin<qint64>(readLe32(data + 8), size);
+
+    qint64 offset = 12;
+    while (offset + 8 <= length) {
+        const qint64 chunkLength = readLe32(data + offset);
+        const quint32 chunkType = readLe32(data + offset + 4);
+        offset += 8;
+        if (offset + chunkLength > length) {
+            return fail("GLB chunk exceeds file size");
+        }
+
+        const char* chunk = reinterpret_cast<const char*>(data + offset);
+        if (chunkType == kChunkJson && json.isNull()) {
+            json = QByteArray::fromRawData(chunk, int(chunkLength));
+        } else if (chunkType == kChunkBin && !m_binChunk.data) {
+            m_binChunk.data = chunk;
+            m_binChunk.size = chunkLength;
+        }
+        offset += (chunkLength + 3) & ~qint64(3);
+    }
+
+    if (json.isNull()) {
+        return fail("GLB file has no JSON chunk");
+    }
+    return true;
+}
+
+bool GltfModelLoader::resolveBuffers()
+{
+    const QJsonArray buffers = m_json.value("buffers").toArray();
+    m_buffers.resize(buffers.size());
+
+    for (int i = 0; i < buffers.size(); ++i) {
+        const QJsonObject buffer = buffers.at(i).toObject();
+        const qint64 byteLength = qint64(buffer.value("byteLength").toDouble());
+        const QString uri = buffer.value("uri").toString();
+
+        BufferSource& source = m_buffers[i];
+        if (uri.isEmpty()) {
+            // 没有uri的第一个缓冲区指向GLB的BIN块；其他的可能是meshopt回退缓冲区，用到时再报错
+            if (i == 0 && m_binChunk.data) {
+                source = m_binChunk;
+            }
+        } else if (uri.startsWith("data:")) {
+            const int comma = uri.indexOf(',');
+            if (comma < 0 || !uri.left(comma).endsWith(";base64")) {
+                return fail(QString("Unsupported data URI in buffer %1").arg(i));
+            }
+            m_ownedBuffers.append(QByteArray::fromBase64(uri.mid(comma + 1).toLatin1()));
+            source.data = m_ownedBuffers.last().constData();
+            source.size = m_ownedBuffers.last().size();
+        } else {
+            const QString path = QDir(m_modelDir).filePath(QUrl::fromPercentEncoding(uri.toUtf8()));
+            QFile* file = new QFile(path);
+            m_mappedFiles.append(file);
+            if (!file->open(QIODevice::ReadOnly) || file->size() <= 0) {
+                return fail(QString("Cannot open buffer file: %1").arg(path));
+            }
+            const uchar* data = file->map(0, file->size());
+            if (!data) {
+                return fail(QString("Cannot map buffer file: %1").arg(path));
+            }
+            source.data = reinterpret_cast<const char*>(data);
+            source.size = file->size();
+        }
+
+        if (source.data && source.size < byteLength) {
+            return fail(QString("Buffer %1 is shorter than its byteLength").arg(i));
+        }
+    }
+    return true;
+}
+
+void GltfModelLoader::releaseBuffers()
+{
+    // QFile析构时自动解除映射
+    qDeleteAll(m_mappedFiles);
+    m_mappedFiles.clear();
+    m_ownedBuffers.clear();
+    m_buffers.clear();
+    m_binChunk = BufferSource();
+    m_decodedViews.clear();
+    m_viewBuffers.clear();
+    m_renderers.clear();
+    m_primitiveBounds.clear();
+    m_materials.clear();
+    m_json = QJsonObject();
+    m_rootEntity = nullptr;
+}
+
+bool GltfModelLoader::checkRequiredExtensions()
+{
+    for (const QJsonValue& value : m_json.value("extensionsRequired").toArray()) {
+        const QString extension = value.toString();
+        bool supported = false;
+        for (const char* name : kSupportedExtensions) {
+            if (extension == QLatin1String(name)) {
+                supported = true;
+                break;
+            }
+        }
+        if (!supported) {
+            return fail(QString("Unsupported required glTF extension: %1").arg(extension));
+        }
+    }
+    return true;
+}
+
+bool GltfModelLoader::readAccessor(int index, Accessor& accessor)
+{
+    const QJsonArray accessors = m_json.value("accessors").toArray();
+    if (index < 0 || index >= accessors.size()) {
+        return fail(QString("Invalid accessor index: %1").arg(index));
+    }
+
+    const QJsonObject object = accessors.at(index).toObject();
+    if (object.contains("sparse")) {
+        return fail(QString("Sparse accessors are not supported (accessor %1)").arg(index));
+    }
+
+    accessor.bufferView = object.value("bufferView").toInt(-1);
+    accessor.byteOffset = qint64(object.value("byteOffset").toDouble(0));
+    accessor.componentType = object.value("componentType").toInt();
+    accessor.componentSize = componentSize(accessor.componentType);
+    accessor.components = componentCount(object.value("type").toString());
+    accessor.count = object.value("count").toInt();
+    accessor.normalized = object.value("normalized").toBool(false);
+
+    if (accessor.bufferView < 0 || accessor.componentSize == 0 || accessor.components == 0 || accessor.count <= 0) {
+        return fail(QString("Invalid accessor: %1").arg(index));
+    }
+    return true;
+}
+
+bool GltfModelLoader::resolveView(int index, View& view)
+{
+    const QJsonArray views = m_json.value("bufferViews").toArray();
+    if (index < 0 || index >= views.size()) {
+        return fail(QString("Invalid bufferView index: %1").arg(index));
+    }
+    const QJsonObject object = views.at(index).toObject();
+
+    // meshopt压缩的视图：解码一次后缓存
+    QJsonObject extensions = object.value("extensions").toObject();
+    QJsonObject meshopt = extensions.value("EXT_meshopt_compression").toObject();
+    if (meshopt.isEmpty()) {
+        meshopt = extensions.value("KHR_meshopt_compression").toObject();
+    }
+    if (!meshopt.isEmpty()) {
+        if (!m_decodedViews.contains(index) && !decodeMeshoptView(index, meshopt)) {
+            return false;
+        }
+        const QByteArray& decoded = m_decodedViews[index];
+        view.data = decoded.constData();
+        view.size = decoded.size();
+        view.byteStride = meshopt.value("byteStride").toInt();
+        return true;
+    }
+
+    const int bufferIndex = object.value("buffer").toInt(-1);
+    if (bufferIndex < 0 || bufferIndex >= m_buffers.size() || !m_buffers.at(bufferIndex).data) {
+        return fail(QString("bufferView %1 has no buffer data").arg(index));
+    }
+
+    const BufferSource& source = m_buffers.at(bufferIndex);
+    const qint64 byteOffset = qint64(object.value("byteOffset").toDouble(0));
+    const qint64 byteLength = qint64(object.value("byteLength").toDouble(0));
+    if (byteOffset < 0 || byteLength <= 0 || byteOffset + byteLength > source.size) {
+        return fail(QString("bufferView %1 is out of range").arg(index));
+    }
+
+    view.data = source.data + byteOffset;
+    view.size = byteLength;
+    view.byteStride = object.value("byteStride").toInt(0);
+    return true;
+}
+
+bool GltfModelLoader::decodeMeshoptView(int index, const QJsonObject& extension)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int bufferIndex = extension.value("buffer").toInt(-1);
+    if (bufferIndex < 0 || bufferIndex >= m_buffers.size() || !m_buffers.at(bufferIndex).data) {
+        return fail(QString("meshopt bufferView %1 has no buffer data").arg(index));
+    }
+
+    const BufferSource& source = m_buffers.at(bufferIndex);
+    const qint64 byteOffset = qint64(extension.value("byteOffset").toDouble(0));
+    const qint64 byteLength = qint64(extension.value("byteLength").toDouble(0));
+    const int byteStride = extension.value("byteStride").toInt();
+    const int count = extension.value("count").toInt();
+    const QString mode = extension.value("mode").toString();
+    const QString filter = extension.value("filter").toString("NONE");
+
+    if (byteOffset < 0 || byteLength <= 0 || byteOffset + byteLength > source.size
+        || byteStride <= 0 || count <= 0 || qint64(count) * byteStride > INT_MAX) {
+        return fail(QString("meshopt bufferView %1 is invalid").arg(index));
+    }
+
+    QByteArray decoded(count * byteStride, Qt::Uninitialized);
+    uchar* destination = reinterpret_cast<uchar*>(decoded.data());
+    const uchar* compressed = reinterpret_cast<const uchar*>(source.data + byteOffset);
+
+    bool ok = false;
+    if (mode == "ATTRIBUTES") {
+        ok = meshopt::decodeVertexBuffer(destination, count, byteStride, compressed, byteLength);
+    } else if (mode == "TRIANGLES") {
+        ok = meshopt::decodeIndexBuffer(destination, count, byteStride, compressed, byteLength);
+    } else if (mode == "INDICES") {
+        ok = meshopt::decodeIndexSequence(destination, count, byteStride, compressed, byteLength);
+    }
+    if (!ok) {
+        return fail(QString("meshopt decoding failed for bufferView %1 (mode %2)").arg(index).arg(mode));
+    }
+
+    if (filter == "OCTAHEDRAL") {
+        if (byteStride == 4) {
+            meshopt::decodeFilterOctahedral(reinterpret_cast<qint8*>(destination), count);
+        } else if (byteStride == 8) {
+            meshopt::decodeFilterOctahedral(reinterpret_cast<qint16*>(destination), count);
+        } else {
+            return fail(QString("Invalid OCTAHEDRAL filter stride in bufferView %1").arg(index));
+        }
+    } else if (filter == "QUATERNION") {
+        if (byteStride != 8) {
+            return fail(QString("Invalid QUATERNION filter stride in bufferView %1").arg(index));
+        }
+        meshopt::decodeFilterQuaternion(reinterpret_cast<qint16*>(destination), count);
+    } else if (filter == "EXPONENTIAL") {
+        if (byteStride % 4 != 0) {
+            return fail(QString("Invalid EXPONENTIAL filter stride in bufferView %1").arg(index));
+        }
+        meshopt::decodeFilterExponential(reinterpret_cast<quint32*>(destination), count * byteStride / 4);
+    } else if (filter != "NONE") {
+        return fail(QString("Unsupported meshopt filter: %1").arg(filter));
+    }
+
+    m_decodedViews.insert(index, decoded);
+    m_decodeNsec += timer.nsecsElapsed();
+    return true;
+}
+
+Qt3DRender::QBuffer* GltfModelLoader::viewBuffer(int index, const View& view)
+{
+    auto it = m_viewBuffers.constFind(index);
+    if (it != m_viewBuffers.constEnd()) {
+        return it.value();
+    }
+
+    // 一个bufferView对应一个Qt3D缓冲区，被多个访问器（交错顶点、多个图元）共享；
+    // 映射内存只在这里复制一次，解码后的视图直接共享QByteArray
+    Qt3DRender::QBuffer* buffer = new Qt3DRender::QBuffer(m_rootEntity);
+    if (m_decodedViews.contains(index)) {
+        buffer->setData(m_decodedViews.value(index));
+    } else {
+        buffer->setData(QByteArray(view.data, int(view.size)));
+    }
+    m_viewBuffers.insert(index, buffer);
+    return buffer;
+}
+
+bool GltfModelLoader::processNode(int nodeIndex, const QMatrix4x4& parentMatrix,
+                                  Qt3DCore::QEntity* parent, int depth)
+{
+    const QJsonArray nodes = m_json.value("nodes").toArray();
+    if (nodeIndex < 0 || nodeIndex >= nodes.size()) {
+        return fail(QString("Invalid node index: %1").arg(nodeIndex));
+    }
+    if (depth > kMaxNodeDepth) {
+        return fail("glTF node hierarchy is too deep (cyclic?)");
+    }
+
+    const QJsonObject node = nodes.at(nodeIndex).toObject();
+
+    // 节点变换：matrix（列主序）或 TRS
+    QMatrix4x4 localMatrix;
+    const QJsonArray matrix = node.value("matrix").toArray();
+    if (matrix.size() == 16) {
+        float values[16];
+        for (int i = 0; i < 16; ++i) {
+            values[i] = float(matrix.at(i).toDouble());
+        }
+        localMatrix = QMatrix4x4(values).transposed();
+    } else {
+        const QJsonArray t = node.value("translation").toArray();
+        const QJsonArray r = node.value("rotation").toArray();
+        const QJsonArray s = node.value("scale").toArray();
+        if (t.size() == 3) {
+            localMatrix.translate(float(t.at(0).toDouble()), float(t.at(1).toDouble()), float(t.at(2).toDouble()));
+        }
+        if (r.size() == 4) {
+            localMatrix.rotate(QQuaternion(float(r.at(3).toDouble()), float(r.at(0).toDouble()),
+                                           float(r.at(1).toDouble()), float(r.at(2).toDouble())));
+        }
+        if (s.size() == 3) {
+            localMatrix.scale(float(s.at(0).toDouble()), float(s.at(1).toDouble()), float(s.at(2).toDouble()));
+        }
+    }
+
+    const int meshIndex = node.value("mesh").toInt(-1);
+    const QJsonArray children = node.value("children").toArray();
+    if (meshIndex < 0 && children.isEmpty()) {
+        return true;
+    }
+
+    const QMatrix4x4 worldMatrix = parentMatrix * localMatrix;
+
+    Qt3DCore::QEntity* nodeEntity = new Qt3DCore::QEntity(parent);
+    if (!localMatrix.isIdentity()) {
+        Qt3DCore::QTransform* transform = new Qt3DCore::QTransform(nodeEntity);
+        transform->setMatrix(localMatrix);
+        nodeEntity->addComponent(transform);
+    }
+
+    if (meshIndex >= 0) {
+        const QJsonArray meshes = m_json.value("meshes").toArray();
+        if (meshIndex >= meshes.size()) {
+            return fail(QString("Invalid mesh index: %1").arg(meshIndex));
+        }
+        const QJsonArray primitives = meshes.at(meshIndex).toObject().value("primitives").toArray();
+
+        // 被多个节点引用的网格共享同一份几何体和材质
+        for (int p = 0; p < primitives.size(); ++p) {
+            Qt3DRender::QGeometryRenderer* renderer = primitiveRenderer(meshIndex, p);
+            if (!renderer) {
+                return false;
+            }
+
+            const QPair<QVector3D, QVector3D> bounds = m_primitiveBounds.value(qMakePair(meshIndex, p));
+            expandBounds(bounds.first, bounds.second, worldMatrix);
+
+            Qt3DCore::QEntity* primitiveEntity = new Qt3DCore::QEntity(nodeEntity);
+            primitiveEntity->addComponent(renderer);
+            primitiveEntity->addComponent(material(primitives.at(p).toObject().value("material").toInt(-1)));
+        }
+    }
+
+    for (const QJsonValue& child : children) {
+        if (!processNode(child.toInt(-1), worldMatrix, nodeEntity, depth + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Qt3DRender::QGeometryRenderer* GltfModelLoader::primitiveRenderer(int meshIndex, int primitiveIndex)
+{
+    const QPair<int, int> key(meshIndex, primitiveIndex);
+    auto it = m_renderers.constFind(key);
+    if (it != m_renderers.constEnd()) {
+        return it.value();
+    }
+
+    const QJsonObject primitive = m_json.value("meshes").toArray().at(meshIndex).toObject()
+            .value("primitives").toArray().at(primitiveIndex).toObject();
+    const QJsonObject attributes = primitive.value("attributes").toObject();
+
+    Qt3DRender::QGeometry* geometry = new Qt3DRender::QGeometry(m_rootEntity);
+
+    QVector3D boundsMin;
+    QVector3D boundsMax;
+    if (!createVertexAttribute(attributes.value("POSITION").toInt(-1),
+                               Qt3DRender::QAttribute::defaultPositionAttributeName(),
+                               geometry, &boundsMin, &boundsMax)) {
+        return nullptr;
+    }
+    if (m_loadNormals
+        && !createVertexAttribute(attributes.value("NORMAL").toInt(-1),
+                                  Qt3DRender::QAttribute::defaultNormalAttributeName(),
+                                  geometry, nullptr, nullptr)) {
+        return nullptr;
+    }
+    if (primitive.contains("indices") && !createIndexAttribute(primitive.value("indices").toInt(-1), geometry)) {
+        return nullptr;
+    }
+
+    // glTF的mode取值与OpenGL图元类型相同，QGeometryRenderer::PrimitiveType也一致
+    const int mode = primitive.value("mode").toInt(4);
+    if (mode < 0 || mode > 6) {
+        fail(QString("Invalid primitive mode: %1").arg(mode));
+        return nullptr;
+    }
+
+    Qt3DRender::QGeometryRenderer* renderer = new Qt3DRender::QGeometryRenderer(m_rootEntity);
+    renderer->setGeometry(geometry);
+    renderer->setPrimitiveType(Qt3DRender::QGeometryRenderer::PrimitiveType(mode));
+
+    m_renderers.insert(key, renderer);
+    m_primitiveBounds.insert(key, qMakePair(boundsMin, boundsMax));
+    return renderer;
+}
+
+Qt3DRender::QAttribute* GltfModelLoader::createVertexAttribute(int accessorIndex, const QString& name,
+                                                               Qt3DRender::QGeometry* geometry,
+                                                               QVector3D* boundsMin, QVector3D* boundsMax)
+{
+    Accessor accessor;
+    View view;
+    if (!readAccessor(accessorIndex, accessor) || !resolveView(accessor.bufferView, view)) {
+        return nullptr;
+    }
+    if (accessor.components < 3) {
+        fail(QString("Accessor %1 has too few components for %2").arg(accessorIndex).arg(name));
+        return nullptr;
+    }
+
+    const int elementSize = accessor.componentSize * accessor.components;
+    const int stride = view.byteStride > 0 ? view.byteStride : elementSize;
+    if (accessor.byteOffset < 0
+        || accessor.byteOffset + qint64(stride) * (accessor.count - 1) + elementSize > view.size) {
+        fail(QString("Accessor %1 is out of range").arg(accessorIndex));
+        return nullptr;
+    }
+
+    const bool isPosition = name == Qt3DRender::QAttribute::defaultPositionAttributeName();
+    const char* base = view.data + accessor.byteOffset;
+
+    Qt3DRender::QAttribute* attribute = new Qt3DRender::QAttribute(geometry);
+    attribute->setName(name);
+    attribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+    attribute->setVertexSize(3);
+    attribute->setCount(uint(accessor.count));
+
+    if (isPosition && accessor.componentType != kComponentFloat) {
+        // QAttribute没有normalized标志，量化位置无法确定GPU端是否归一化，
+        // 这里展开为浮点（同时供拾取使用）；量化法线在着色器中会被重新归一化，可直接上传
+        QByteArray expanded(accessor.count * 3 * int(sizeof(float)), Qt::Uninitialized);
+        float* out = reinterpret_cast<float*>(expanded.data());
+        QVector3D minPoint(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                           std::numeric_limits<float>::max());
+        QVector3D maxPoint(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                           std::numeric_limits<float>::lowest());
+        for (int i = 0; i < accessor.count; ++i) {
+            const char* element = base + qint64(i) * stride;
+            const QVector3D p(readComponent(element, accessor.componentType, accessor.normalized),
+                              readComponent(element + accessor.componentSize, accessor.componentType, accessor.normalized),
+                              readComponent(element + 2 * accessor.componentSize, accessor.componentType, accessor.normalized));
+            *out++ = p.x();
+            *out++ = p.y();
+            *out++ = p.z();
+            minPoint = QVector3D(qMin(minPoint.x(), p.x()), qMin(minPoint.y(), p.y()), qMin(minPoint.z(), p.z()));
+            maxPoint = QVector3D(qMax(maxPoint.x(), p.x()), qMax(maxPoint.y(), p.y()), qMax(maxPoint.z(), p.z()));
+        }
+
+        Qt3DRender::QBuffer* buffer = new Qt3DRender::QBuffer(geometry);
+        buffer->setData(expanded);
+        attribute->setBuffer(buffer);
+        attribute->setVertexBaseType(Qt3DRender::QAttribute::Float);
+        attribute->setByteStride(3 * sizeof(float));
+        attribute->setByteOffset(0);
+        if (boundsMin) *boundsMin = minPoint;
+        if (boundsMax) *boundsMax = maxPoint;
+        geometry->addAttribute(attribute);
+        return attribute;
+    }
+
+    // 按文件中的步长和偏移直接引用bufferView
+    attribute->setBuffer(viewBuffer(accessor.bufferView, view));
+    attribute->setVertexBaseType(vertexBaseType(accessor.componentType));
+    attribute->setByteStride(uint(stride));
+    attribute->setByteOffset(uint(accessor.byteOffset));
+    geometry->addAttribute(attribute);
+
+    if (boundsMin && boundsMax) {
+        // 规范要求POSITION提供min/max；缺失时扫描数据
+        const QJsonObject object = m_json.value("accessors").toArray().at(accessorIndex).toObject();
+        const QJsonArray minArray = object.value("min").toArray();
+        const QJsonArray maxArray = object.value("max").toArray();
+        if (minArray.size() >= 3 && maxArray.size() >= 3) {
+            *boundsMin = QVector3D(float(minArray.at(0).toDouble()), float(minArray.at(1).toDouble()),
+                                   float(minArray.at(2).toDouble()));
+            *boundsMax = QVector3D(float(maxArray.at(0).toDouble()), float(maxArray.at(1).toDouble()),
+                                   float(maxArray.at(2).toDouble()));
+        } else {
+            *boundsMin = QVector3D(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                                   std::numeric_limits<float>::max());
+            *boundsMax = QVector3D(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                                   std::numeric_limits<float>::lowest());
+            for (int i = 0; i < accessor.count; ++i) {
+                const char* element = base + qint64(i) * stride;
+                const QVector3D p(qFromLittleEndian<float>(element),
+                                  qFromLittleEndian<float>(element + 4),
+                                  qFromLittleEndian<float>(element + 8));
+                *boundsMin = QVector3D(qMin(boundsMin->x(), p.x()), qMin(boundsMin->y(), p.y()), qMin(boundsMin->z(), p.z()));
+                *boundsMax = QVector3D(qMax(boundsMax->x(), p.x()), qMax(boundsMax->y(), p.y()), qMax(boundsMax->z(), p.z()));
+            }
+        }
+    }
+    return attribute;
+}
+
+Qt3DRender::QAttribute* GltfModelLoader::createIndexAttribute(int accessorIndex, Qt3DRender::QGeometry* geometry)
+{
+    Accessor accessor;
+    View view;
+    if (!readAccessor(accessorIndex, accessor) || !resolveView(accessor.bufferView, view)) {
+        return nullptr;
+    }
+    if (accessor.components != 1
+        || (accessor.componentType != kComponentUnsignedByte
+            && accessor.componentType != kComponentUnsignedShort
+            && accessor.componentType != kComponentUnsignedInt)) {
+        fail(QString("Invalid index accessor: %1").arg(accessorIndex));
+        return nullptr;
+    }
+    if (accessor.byteOffset < 0 || accessor.byteOffset + qint64(accessor.count) * accessor.componentSize > view.size) {
+        fail(QString("Index accessor %1 is out of range").arg(accessorIndex));
+        return nullptr;
+    }
+
+    Qt3DRender::QAttribute* attribute = new Qt3DRender::QAttribute(geometry);
+    attribute->setAttributeType(Qt3DRender::QAttribute::IndexAttribute);
+    attribute->setVertexBaseType(vertexBaseType(accessor.componentType));
+    attribute->setBuffer(viewBuffer(accessor.bufferView, view));
+    attribute->setByteOffset(uint(accessor.byteOffset));
+    attribute->setCount(uint(accessor.count));
+    geometry->addAttribute(attribute);
+    return attribute;
+}
+
+Qt3DExtras::QPhongMaterial* GltfModelLoader::material(int materialIndex)
+{
+    auto it = m_materials.constFind(materialIndex);
+    if (it != m_materials.constEnd()) {
+        return it.value();
+    }
+
+    // 只使用baseColorFactor，没有时使用URDF颜色
+    QColor diffuseColor = m_color;
+    const QJsonArray materials = m_json.value("materials").toArray();
+    if (materialIndex >= 0 && materialIndex < materials.size()) {
+        const QJsonArray factor = materials.at(materialIndex).toObject()
+                .value("pbrMetallicRoughness").toObject().value("baseColorFactor").toArray();
+        if (factor.size() >= 3) {
+            diffuseColor = QColor::fromRgbF(qBound(0.0, factor.at(0).toDouble(), 1.0),
+                                            qBound(0.0, factor.at(1).toDouble(), 1.0),
+                                            qBound(0.0, factor.at(2).toDouble(), 1.0));
+        }
+    }
+
+    Qt3DExtras::QPhongMaterial* phongMaterial = new Qt3DExtras::QPhongMaterial(m_rootEntity);
+    phongMaterial->setDiffuse(diffuseColor);
+    phongMaterial->setAmbient(diffuseColor.darker(150));
+    phongMaterial->setSpecular(QColor(255, 255, 255));
+    phongMaterial->setShininess(50.0f);
+    m_materials.insert(materialIndex, phongMaterial);
+    return phongMaterial;
+}
+
+void GltfModelLoader::expandBounds(const QVector3D& localMin, const QVector3D& localMax,
+                                   const QMatrix4x4& worldMatrix)
+{
+    for (int i = 0; i < 8; ++i) {
+        const QVector3D corner(i & 1 ? localMax.x() : localMin.x(),
+                               i & 2 ? localMax.y() : localMin.y(),
+                               i & 4 ? localMax.z() : localMin.z());
+        const QVector3D p = worldMatrix.map(corner);
+        m_minPoint = QVector3D(qMin(m_minPoint.x(), p.x()), qMin(m_minPoint.y(), p.y()), qMin(m_minPoint.z(), p.z()));
+        m_maxPoint = QVector3D(qMax(m_maxPoint.x(), p.x()), qMax(m_maxPoint.y(), p.y()), qMax(m_maxPoint.z(), p.z()));
+    }
+}
+
+bool GltfModelLoader::fail(const QString& message)
+{
+    m_errorMessage = message;
+    qWarning() << "GltfModelLoader:" << message;
+    return false;
+}
+
+void GltfModelLoader::recordStage(const QString& stage, qint64 nsec)
+{
+    ImportStageTiming timing;
+    timing.stage = stage;
+    timing.msec = nsec / 1.0e6;
+    m_stageTimings.append(timing);
+}
+
+void GltfModelLoader::getBoundingBox(QVector3D& minPoint, QVector3D& maxPoint) const
+{
+    minPoint = m_minPoint;
+    maxPoint = m_maxPoint;
+}
@@ -0,0 +1,159 @@
+#ifndef GLTFMODELLOADER_H
+#define GLTFMODELLOADER_H
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QGeometry>
+#include <Qt3DRender/QGeometryRenderer>
+#include <Qt3DRender/QAttribute>
+#include <Qt3DExtras/QPhongMaterial>
+#include <QByteArray>
+#include <QColor>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QMatrix4x4>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+
+#include "meshdata.h"
+
+/**
+ * @brief glTF 2.0 / GLB 原生加载器
+ * 内存映射文件（GLB的BIN块或外部.bin），每个bufferView只复制一次到Qt3D缓冲区，
+ * 访问器按文件中的步长和偏移直接交给QAttribute，不再逐元素转换。
+ * 支持 KHR_mesh_quantization（量化访问器）与 EXT/KHR_meshopt_compression（meshopt压缩）。
+ */
+class GltfModelLoader
+{
+public:
+    GltfModelLoader();
+    ~GltfModelLoader();
+
+    /**
+     * @brief 加载glTF/GLB文件
+     * @param filename 文件路径
+     * @param parent 父实体
+     * @param color 材质颜色（文件中没有材质颜色时使用）
+     * @param scale 缩放比例
+     * @param loadNormals 是否上传法线
+     * @return 加载的实体，失败返回nullptr（调用方可回退到Assimp）
+     */
+    Qt3DCore::QEntity* loadModel(const QString& filename,
+                                 Qt3DCore::QEntity* parent,
+                                 const QColor& color,
+                                 const QVector3D& scale,
+                                 bool loadNormals = true);
+
+    /**
+     * @brief 准备阶段：映射文件、解析JSON、解码meshopt视图（不创建Qt3D节点，可在工作线程调用）
+     * @param filename 文件路径
+     * @param loadNormals 是否上传法线（缺少法线时失败，以便回退到Assimp生成）
+     * @return 是否成功
+     */
+    bool prepare(const QString& filename, bool loadNormals = true);
+
+    /**
+     * @brief 构建阶段：按prepare()的结果创建Qt3D实体（需在主线程调用），完成后释放映射
+     * @return 加载的实体，失败返回nullptr
+     */
+    Qt3DCore::QEntity* build(Qt3DCore::QEntity* parent, const QColor& color, const QVector3D& scale);
+
+    /**
+     * @brief 最近一次加载各阶段耗时（map、parse、decode、convert）
+     */
+    QVector<ImportStageTiming> stageTimings() const { return m_stageTimings; }
+
+    /**
+     * @brief 获取错误信息
+     */
+    QString getErrorMessage() const { return m_errorMessage; }
+
+    /**
+     * @brief 获取模型的包围盒（已包含节点变换和缩放）
+     */
+    void getBoundingBox(QVector3D& minPoint, QVector3D& maxPoint) const;
+
+    /**
+     * @brief 是否为glTF/GLB文件（按扩展名判断）
+     */
+    static bool isGltfFile(const QString& filename);
+
+private:
+    /**
+     * @brief 访问器描述（对应glTF accessors[i]）
+     */
+    struct Accessor {
+        int bufferView = -1;
+        qint64 byteOffset = 0;
+        int componentType = 0;
+        int componentSize = 0;
+        int components = 0;
+        int count = 0;
+        bool normalized = false;
+    };
+
+    /**
+     * @brief bufferView解析结果（meshopt压缩的视图为解码后的数据）
+     */
+    struct View {
+        const char* data = nullptr;
+        qint64 size = 0;
+        int byteStride = 0;
+    };
+
+    /**
+     * @brief 缓冲区数据来源（映射内存、BIN块或data URI解码结果）
+     */
+    struct BufferSource {
+        const char* data = nullptr;
+        qint64 size = 0;
+    };
+
+    bool mapFile(const QString& filename, QByteArray& json);
+    bool resolveBuffers();
+    void releaseBuffers();
+    bool checkRequiredExtensions();
+    bool readAccessor(int index, Accessor& accessor);
+    bool resolveView(int index, View& view);
+    bool decodeMeshoptView(int index, const QJsonObject& extension);
+    bool predecodeMeshViews();
+    Qt3DRender::QBuffer* viewBuffer(int index, const View& view);
+
+    bool processNode(int nodeIndex, const QMatrix4x4& parentMatrix, Qt3DCore::QEntity* parent, int depth);
+    Qt3DRender::QGeometryRenderer* primitiveRenderer(int meshIndex, int primitiveIndex);
+    Qt3DRender::QAttribute* createVertexAttribute(int accessorIndex, const QString& name,
+                                                  Qt3DRender::QGeometry* geometry,
+                                                  QVector3D* boundsMin, QVector3D* boundsMax);
+    Qt3DRender::QAttribute* createIndexAttribute(int accessorIndex, Qt3DRender::QGeometry* geometry);
+    Qt3DExtras::QPhongMaterial* material(int materialIndex);
+    void expandBounds(const QVector3D& localMin, const QVector3D& localMax, const QMatrix4x4& worldMatrix);
+    bool fail(const QString& message);
+    void recordStage(const QString& stage, qint64 nsec);
+
+    QString m_errorMessage;
+    QVector<ImportStageTiming> m_stageTimings;
+    QVector3D m_minPoint;
+    QVector3D m_maxPoint;
+    QString m_modelDir;
+    QColor m_color;
+    bool m_loadNormals = true;
+    qint64 m_decodeNsec = 0;
+
+    QJsonObject m_json;
+    QList<QFile*> m_mappedFiles;
+    BufferSource m_binChunk;
+    QVector<BufferSource> m_buffers;
+    QVector<QByteArray> m_ownedBuffers;
+
+    Qt3DCore::QEntity* m_rootEntity = nullptr;
+    QHash<int, QByteArray> m_decodedViews;
+    QHash<int, Qt3DRender::QBuffer*> m_viewBuffers;
+    QHash<QPair<int, int>, Qt3DRender::QGeometryRenderer*> m_renderers;
+    QHash<QPair<int, int>, QPair<QVector3D, QVector3D>> m_primitiveBounds;
+    QHash<int, Qt3DExtras::QPhongMaterial*> m_materials;
+};
+
+#endif // GLTFMODELLOADER_H
@@ -0,0 +1,131 @@
+﻿#include "jointjitterbuffer.h"
+
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+JointJitterBuffer::JointJitterBuffer()
+{
+}
+
+void JointJitterBuffer::setJoints(const QVector<std::shared_ptr<URDFJoint>>& joints)
+{
+    m_joints.clear();
+    m_jointIndex.clear();
+    for (const auto& joint : joints) {
+        if (!joint || !joint->isMovable()) continue;
+
+        JointInfo info;
+        info.name = joint->name;
+        info.continuous = joint->type == JointType::Continuous;
+        info.limited = !info.continuous && joint->limits.upper > joint->limits.lower;
+        info.lower = joint->limits.lower;
+        info.upper = joint->limits.upper;
+        m_jointIndex.insert(info.name, m_joints.size());
+        m_joints.append(info);
+    }
+    clear();
+}
+
+void JointJitterBuffer::clear()
+{
+    m_samples.clear();
+    m_received.fill(false, m_joints.size());
+}
+
+void JointJitterBuffer::push(qint64 timeUs, const QMap<QString, double>& values)
+{
+    if (m_joints.isEmpty()) return;
+    if (!m_samples.isEmpty() && timeUs <= m_samples.last().timeUs) return;
+
+    Sample sample;
+    sample.timeUs = timeUs;
+    sample.values = m_samples.isEmpty() ? QVector<double>(m_joints.size(), 0.0) : m_samples.last().values;
+
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        const int index = m_jointIndex.value(it.key(), -1);
+        if (index < 0) continue;
+
+        double value = it.value();
+        if (m_joints.at(index).continuous && m_received.at(index)) {
+            // 展开到离前一个值最近的等价角度
+            const double previous = sample.values.at(index);
+            value = previous + std::remainder(value - previous, 2.0 * M_PI);
+        } else if (!m_received.at(index)) {
+            // 第一次收到的关节，之前的采样都取这个值，避免从0插值过来
+            for (Sample& earlier : m_samples) {
+                earlier.values[index] = value;
+            }
+        }
+        sample.values[index] = value;
+        m_received[index] = true;
+    }
+
+    m_samples.append(sample);
+    if (m_samples.size() > kMaxSamples) {
+        m_samples.remove(0, m_samples.size() - kMaxSamples);
+    }
+}
+
+double JointJitterBuffer::tangent(int index, int joint) const
+{
+    // 非均匀间隔的中心差分，两端退化为单侧差分
+    const int prev = qMax(0, index - 1);
+    const int next = qMin(m_samples.size() - 1, index + 1);
+    if (prev == next) return 0.0;
+
+    const double dt = (m_samples.at(next).timeUs - m_samples.at(prev).timeUs) / 1.0e6;
+    return (m_samples.at(next).values.at(joint) - m_samples.at(prev).values.at(joint)) / dt;
+}
+
+bool JointJitterBuffer::sample(qint64 timeUs, QMap<QString, double>* values) const
+{
+    if (m_samples.isEmpty()) return false;
+
+    QVector<double> result;
+    const Sample& last = m_samples.last();
+
+    if (timeUs >= last.timeUs) {
+        // 外推：按最后两个采样的速度，最多外推 m_extrapolationUs
+        result = last.values;
+        if (m_samples.size() >= 2 && m_extrapolationUs > 0) {
+            const Sample& previous = m_samples.at(m_samples.size() - 2);
+            const double dt = (last.timeUs - previous.timeUs) / 1.0e6;
+            const double ahead = qMin(timeUs - last.timeUs, m_extrapolationUs) / 1.0e6;
+            for (int j = 0; j < result.size(); ++j) {
+                result[j] += (last.values.at(j) - previous.values.at(j)) / dt * ahead;
+            }
+        }
+    } else if (timeUs <= m_samples.first().timeUs) {
+        result = m_samples.first().values;
+    } else {
+        // 最后一个 timeUs <= 给定时间的采样
+        auto it = std::upper_bound(m_samples.cbegin(), m_samples.cend(), timeUs,
+                                   [](qint64 t, const Sample& s) { return t < s.timeUs; });
+        const int i = int(it - m_samples.cbegin()) - 1;
+        const Sample& a = m_samples.at(i);
+        const Sample& b = m_samples.at(i + 1);
+
+        const double h = (b.timeUs - a.timeUs) / 1.0e6;
+        const double s = double(timeUs - a.timeUs) / double(b.timeUs - a.timeUs);
+        const double s2 = s * s;
+        const double s3 = s2 * s;
+        const double h00 = 2 * s3 - 3 * s2 + 1;
+        const double h10 = s3 - 2 * s2 + s;
+        const double h01 = -2 * s3 + 3 * s2;
+        const double h11 = s3 - s2;
+
+        result.resize(a.values.size());
+        for (int j = 0; j < result.size(); ++j) {
+            result[j] = h00 * a.values.at(j) + h10 * h * tangent(i, j)
+                      + h01 * b.values.at(j) + h11 * h * tangent(i + 1, j);
+        }
+    }
+
+    for (int j = 0; j < m_joints.size(); ++j) {
+        if (!m_received.at(j)) continue;
+        const JointInfo& joint = m_joints.at(j);
+        values->insert(joint.name, joint.limited ? qBound(joint.lower, result.at(j), joint.upper) : result.at(j));
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef JOINTJITTERBUFFER_H
+#define JOINTJITTERBUFFER_H
+
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+#include "urdfparser.h"
+
+/**
+ * @brief 关节抖动缓冲：保存带时间戳的稀疏关节采样，按显示帧率插值出平滑的关节值
+ *
+ * 显示时间比最新采样滞后 delay，落在两个采样之间时用三次Hermite样条插值
+ * （切线取相邻采样的差分，非均匀时间间隔）；超出最新采样时按最后的速度线性外推，
+ * 外推时长不超过 extrapolationLimit，之后保持不动。
+ * 连续关节入缓冲时相对前一采样展开到最短弧，±π处不会反向绕一整圈；
+ * 有限位的关节插值结果限制在限位内，避免样条过冲。
+ */
+class JointJitterBuffer
+{
+public:
+    JointJitterBuffer();
+
+    /**
+     * @brief 设置参与插值的关节（清空缓冲）
+     */
+    void setJoints(const QVector<std::shared_ptr<URDFJoint>>& joints);
+    void clear();
+
+    /**
+     * @brief 加入一个采样，时间戳须单调递增，否则丢弃
+     */
+    void push(qint64 timeUs, const QMap<QString, double>& values);
+
+    /**
+     * @brief 计算指定时间的关节值（只包含至少收到过一次的关节）
+     * @return 缓冲为空时返回false
+     */
+    bool sample(qint64 timeUs, QMap<QString, double>* values) const;
+
+    bool isEmpty() const { return m_samples.isEmpty(); }
+    qint64 lastTimeUs() const { return m_samples.isEmpty() ? 0 : m_samples.last().timeUs; }
+
+    /**
+     * @brief 最长外推时间（微秒），0表示不外推
+     */
+    void setExtrapolationLimit(qint64 us) { m_extrapolationUs = qMax<qint64>(0, us); }
+    qint64 extrapolationLimit() const { return m_extrapolationUs; }
+
+private:
+    static const int kMaxSamples = 64;
+
+    struct Sample {
+        qint64 timeUs = 0;
+        QVector<double> values;
+    };
+
+    struct JointInfo {
+        QString name;
+        bool continuous = false;
+        bool limited = false;
+        double lower = 0;
+        double upper = 0;
+    };
+
+    double tangent(int index, int joint) const;
+
+    QVector<JointInfo> m_joints;
+    QMap<QString, int> m_jointIndex;
+    QVector<Sample> m_samples;      // 按时间升序
+    QVector<bool> m_received;       // 关节是否收到过值
+    qint64 m_extrapolationUs = 50000;
+};
+
+#endif // JOINTJITTERBUFFER_H
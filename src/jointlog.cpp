@@ -0,0 +1,326 @@
+﻿#include "jointlog.h"
+
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char kFileMagic[4] = { 'R', 'V', 'J', 'L' };
+
+template <typename T>
+void appendLe(QByteArray& out, T value)
+{
+    const T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&le), sizeof(T));
+}
+
+void appendDouble(QByteArray& out, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLe<quint64>(out, bits);
+}
+
+/**
+ * @brief 带边界检查的顺序读取
+ */
+class Cursor
+{
+public:
+    Cursor(const char* data, qint64 size)
+        : m_p(reinterpret_cast<const uchar*>(data)), m_end(m_p + size) {}
+
+    bool ok() const { return m_ok; }
+    qint64 offset(const char* base) const { return reinterpret_cast<const char*>(m_p) - base; }
+
+    template <typename T>
+    T read()
+    {
+        if (m_end - m_p < qint64(sizeof(T))) {
+            m_ok = false;
+            return T();
+        }
+        const T value = qFromLittleEndian<T>(m_p);
+        m_p += sizeof(T);
+        return value;
+    }
+
+    double readDouble()
+    {
+        const quint64 bits = read<quint64>();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    QString readString()
+    {
+        const quint16 length = read<quint16>();
+        if (!m_ok || m_end - m_p < length) {
+            m_ok = false;
+            return QString();
+        }
+        const QString text = QString::fromUtf8(reinterpret_cast<const char*>(m_p), length);
+        m_p += length;
+        return text;
+    }
+
+    quint64 readVarint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_p >= m_end) break;
+            const uchar byte = *m_p++;
+            value |= quint64(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        m_ok = false;
+        return 0;
+    }
+
+private:
+    const uchar* m_p;
+    const uchar* m_end;
+    bool m_ok = true;
+};
+
+void appendString(QByteArray& out, const QString& text)
+{
+    const QByteArray utf8 = text.toUtf8().left(0xFFFF);
+    appendLe<quint16>(out, quint16(utf8.size()));
+    out.append(utf8);
+}
+
+inline quint64 zigzag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+inline qint64 unzigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    char buffer[10];
+    int length = 0;
+    while (value >= 0x80) {
+        buffer[length++] = char(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = char(value);
+    out.append(buffer, length);
+}
+
+/**
+ * @brief 二阶差分编码一列整数
+ */
+class ColumnEncoder
+{
+public:
+    void append(QByteArray& out, qint64 value)
+    {
+        const qint64 delta = value - m_previous;
+        appendVarint(out, zigzag(m_count < 2 ? (m_count == 0 ? value : delta) : delta - m_previousDelta));
+        m_previousDelta = delta;
+        m_previous = value;
+        ++m_count;
+    }
+
+private:
+    qint64 m_previous = 0;
+    qint64 m_previousDelta = 0;
+    int m_count = 0;
+};
+
+class ColumnDecoder
+{
+public:
+    qint64 next(Cursor& cursor)
+    {
+        const qint64 coded = unzigzag(cursor.readVarint());
+        qint64 value;
+        if (m_count == 0) {
+            value = coded;
+            m_previousDelta = 0;
+        } else {
+            m_previousDelta = m_count == 1 ? coded : m_previousDelta + coded;
+            value = m_previous + m_previousDelta;
+        }
+        m_previous = value;
+        ++m_count;
+        return value;
+    }
+
+private:
+    qint64 m_previous = 0;
+    qint64 m_previousDelta = 0;
+    int m_count = 0;
+};
+
+inline qint64 quantize(double value, double quantum)
+{
+    return std::isfinite(value) ? qint64(std::llround(value / quantum)) : 0;
+}
+
+} // namespace
+
+QByteArray JointLog::encodeFileHeader(const FileHeader& header)
+{
+    QByteArray out;
+    out.append(kFileMagic, 4);
+    appendLe<quint16>(out, kVersion);
+    appendLe<quint32>(out, 0);      // 头长度，最后回填
+    appendLe<qint64>(out, header.startTimeUs);
+    appendDouble(out, header.valueQuantum);
+    appendDouble(out, header.poseQuantum);
+    appendLe<quint16>(out, quint16(header.jointNames.size()));
+    appendLe<quint16>(out, quint16(header.poseLinks.size()));
+    for (const QString& name : header.jointNames) {
+        appendString(out, name);
+    }
+    for (const QString& name : header.poseLinks) {
+        appendString(out, name);
+    }
+
+    const quint32 totalSize = quint32(out.size() + 4);
+    qToLittleEndian<quint32>(totalSize, out.data() + 6);
+    appendLe<quint32>(out, crc32(out.constData(), out.size()));
+    return out;
+}
+
+bool JointLog::decodeFileHeader(const char* data, qint64 size, FileHeader* header, qint64* headerSize)
+{
+    if (size < 10 || std::memcmp(data, kFileMagic, 4) != 0) {
+        return false;
+    }
+
+    Cursor cursor(data + 4, size - 4);
+    const quint16 version = cursor.read<quint16>();
+    const quint32 totalSize = cursor.read<quint32>();
+    if (version != kVersion || totalSize < 10 || totalSize > size) {
+        return false;
+    }
+    if (crc32(data, totalSize - 4) != qFromLittleEndian<quint32>(data + totalSize - 4)) {
+        return false;
+    }
+
+    FileHeader result;
+    result.startTimeUs = cursor.read<qint64>();
+    result.valueQuantum = cursor.readDouble();
+    result.poseQuantum = cursor.readDouble();
+    const quint16 jointCount = cursor.read<quint16>();
+    const quint16 poseCount = cursor.read<quint16>();
+    for (int i = 0; i < jointCount && cursor.ok(); ++i) {
+        result.jointNames << cursor.readString();
+    }
+    for (int i = 0; i < poseCount && cursor.ok(); ++i) {
+        result.poseLinks << cursor.readString();
+    }
+    if (!cursor.ok() || result.valueQuantum <= 0.0 || result.poseQuantum <= 0.0) {
+        return false;
+    }
+
+    *header = result;
+    *headerSize = totalSize;
+    return true;
+}
+
+QByteArray JointLog::encodeBlock(const FileHeader& header, const Sample* samples, int count)
+{
+    const int columns = header.columnCount();
+    const int jointCount = header.jointNames.size();
+
+    QByteArray payload;
+    payload.reserve(count * (columns + 1) * 2);
+
+    ColumnEncoder timeColumn;
+    for (int i = 0; i < count; ++i) {
+        timeColumn.append(payload, samples[i].timeUs);
+    }
+    for (int c = 0; c < columns; ++c) {
+        const double quantum = c < jointCount ? header.valueQuantum : header.poseQuantum;
+        ColumnEncoder column;
+        for (int i = 0; i < count; ++i) {
+            column.append(payload, quantize(samples[i].values.value(c), quantum));
+        }
+    }
+
+    QByteArray out;
+    out.reserve(kBlockHeaderSize + payload.size());
+    appendLe<quint32>(out, kBlockMagic);
+    appendLe<quint32>(out, quint32(payload.size()));
+    appendLe<quint32>(out, quint32(count));
+    appendLe<qint64>(out, count > 0 ? samples[0].timeUs : 0);
+    appendLe<qint64>(out, count > 0 ? samples[count - 1].timeUs : 0);
+    appendLe<quint32>(out, crc32(payload.constData(), payload.size()));
+    out.append(payload);
+    return out;
+}
+
+bool JointLog::decodeBlockHeader(const char* data, qint64 size, BlockHeader* block)
+{
+    Cursor cursor(data, size);
+    if (cursor.read<quint32>() != kBlockMagic) {
+        return false;
+    }
+    block->payloadSize = cursor.read<quint32>();
+    block->sampleCount = cursor.read<quint32>();
+    block->firstTimeUs = cursor.read<qint64>();
+    block->lastTimeUs = cursor.read<qint64>();
+    block->crc = cursor.read<quint32>();
+    return cursor.ok();
+}
+
+bool JointLog::decodeBlock(const FileHeader& header, const BlockHeader& block,
+                           const char* payload, QVector<Sample>* samples)
+{
+    if (crc32(payload, block.payloadSize) != block.crc) {
+        return false;
+    }
+
+    const int count = int(block.sampleCount);
+    const int columns = header.columnCount();
+    const int jointCount = header.jointNames.size();
+    samples->resize(count);
+
+    Cursor cursor(payload, block.payloadSize);
+    ColumnDecoder timeColumn;
+    for (int i = 0; i < count; ++i) {
+        Sample& sample = (*samples)[i];
+        sample.timeUs = timeColumn.next(cursor);
+        sample.values.resize(columns);
+    }
+    for (int c = 0; c < columns; ++c) {
+        const double quantum = c < jointCount ? header.valueQuantum : header.poseQuantum;
+        ColumnDecoder column;
+        for (int i = 0; i < count; ++i) {
+            (*samples)[i].values[c] = column.next(cursor) * quantum;
+        }
+    }
+    return cursor.ok();
+}
+
+quint32 JointLog::crc32(const char* data, qint64 size)
+{
+    static const QVector<quint32> table = []() {
+        QVector<quint32> t(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[int(i)] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    const uchar* p = reinterpret_cast<const uchar*>(data);
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table.at((crc ^ p[i]) & 0xFF) ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,84 @@
+#ifndef JOINTLOG_H
+#define JOINTLOG_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 关节记录文件（.rvlog）的格式定义与编解码
+ *
+ * 文件 = 文件头 + 若干独立的数据块，所有整数均为小端序：
+ *   文件头：  "RVJL" | 版本 u16 | 头长度 u32 | 起始时间 i64(微秒) | 关节量化步长 f64 | 位姿量化步长 f64
+ *             | 关节数 u16 | 位姿Link数 u16 | 名称（u16长度 + UTF-8）... | CRC32 u32
+ *   数据块头：块标记 u32 | 负载长度 u32 | 采样数 u32 | 首时间 i64 | 末时间 i64 | 负载CRC32 u32
+ *   负载：    按列存放，时间列在前，随后每个关节一列、每个位姿Link七列（x y z qw qx qy qz）；
+ *             每列的值先量化为整数，再存储二阶差分的zigzag变长整数（匀速运动和固定采样周期都只占1字节）
+ *
+ * 每个数据块独立可解码且带校验，进程崩溃时最多丢失未写完的最后一块，
+ * 读取时遇到截断或校验失败的块即视为文件结束。
+ */
+class JointLog
+{
+public:
+    static const quint32 kBlockMagic = 0x424A5652;     // "RVJB"
+    static const quint16 kVersion = 1;
+    static const int kBlockHeaderSize = 32;
+    static const int kPoseComponents = 7;
+
+    struct FileHeader {
+        QStringList jointNames;
+        QStringList poseLinks;          // 记录位姿的Link（末端执行器）
+        qint64 startTimeUs = 0;         // 记录开始时的UTC时间（微秒）
+        double valueQuantum = 1e-6;     // 关节值量化步长（弧度或米）
+        double poseQuantum = 1e-6;      // 位姿量化步长（米/四元数分量）
+
+        int columnCount() const { return jointNames.size() + poseLinks.size() * kPoseComponents; }
+    };
+
+    struct BlockHeader {
+        quint32 payloadSize = 0;
+        quint32 sampleCount = 0;
+        qint64 firstTimeUs = 0;
+        qint64 lastTimeUs = 0;
+        quint32 crc = 0;
+    };
+
+    /**
+     * @brief 一次采样：关节值（按文件头顺序），随后是各位姿Link的七个分量
+     */
+    struct Sample {
+        qint64 timeUs = 0;
+        QVector<double> values;
+    };
+
+    static QByteArray encodeFileHeader(const FileHeader& header);
+
+    /**
+     * @brief 解码文件头
+     * @param headerSize 返回文件头占用的字节数（第一个数据块的偏移）
+     */
+    static bool decodeFileHeader(const char* data, qint64 size, FileHeader* header, qint64* headerSize);
+
+    /**
+     * @brief 编码一个数据块（块头 + 负载）
+     */
+    static QByteArray encodeBlock(const FileHeader& header, const Sample* samples, int count);
+
+    /**
+     * @brief 解码块头（不校验负载）
+     */
+    static bool decodeBlockHeader(const char* data, qint64 size, BlockHeader* block);
+
+    /**
+     * @brief 校验并解码块负载
+     * @param payload 块头之后的负载
+     */
+    static bool decodeBlock(const FileHeader& header, const BlockHeader& block,
+                            const char* payload, QVector<Sample>* samples);
+
+    static quint32 crc32(const char* data, qint64 size);
+};
+
+#endif // JOINTLOG_H
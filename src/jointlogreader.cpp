@@ -0,0 +1,223 @@
+﻿#include "jointlogreader.h"
+#include "tracelog.h"
+
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const int kMaxRangeBlocks = 256;    // 范围查询最多解码的块数，更长的范围按块抽取
+
+} // namespace
+
+JointLogReader::JointLogReader()
+{
+}
+
+JointLogReader::~JointLogReader()
+{
+    close();
+}
+
+bool JointLogReader::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorMessage = QString("无法打开记录文件: %1").arg(filePath);
+        return false;
+    }
+
+    m_size = m_file.size();
+    uchar* mapped = m_file.map(0, m_size);
+    if (!mapped) {
+        m_errorMessage = QString("无法映射记录文件: %1").arg(m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    m_data = reinterpret_cast<const char*>(mapped);
+
+    if (!JointLog::decodeFileHeader(m_data, m_size, &m_header, &m_dataOffset)) {
+        m_errorMessage = QString("不是有效的关节记录文件: %1").arg(filePath);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void JointLogReader::close()
+{
+    if (m_data) {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_dataOffset = 0;
+    m_header = JointLog::FileHeader();
+    m_index.clear();
+    m_cache.clear();
+}
+
+bool JointLogReader::buildIndex(const std::atomic_bool* cancel)
+{
+    TRACE_SCOPE_DETAIL("JointLogReader::buildIndex", m_file.fileName());
+
+    QVector<IndexEntry> index;
+    qint64 offset = m_dataOffset;
+    qint64 sampleCount = 0;
+
+    while (offset + JointLog::kBlockHeaderSize <= m_size) {
+        if (cancel && cancel->load()) {
+            return false;
+        }
+
+        JointLog::BlockHeader block;
+        if (!JointLog::decodeBlockHeader(m_data + offset, m_size - offset, &block)) {
+            break;
+        }
+        const qint64 end = offset + JointLog::kBlockHeaderSize + block.payloadSize;
+        if (end > m_size || block.sampleCount == 0) {
+            break;  // 写到一半的块
+        }
+
+        IndexEntry entry;
+        entry.offset = offset;
+        entry.firstTimeUs = block.firstTimeUs;
+        entry.lastTimeUs = block.lastTimeUs;
+        entry.firstSample = sampleCount;
+        entry.sampleCount = block.sampleCount;
+        index.append(entry);
+
+        sampleCount += block.sampleCount;
+        offset = end;
+    }
+
+    if (offset < m_size) {
+        qWarning() << "JointLogReader: 忽略文件尾部" << m_size - offset << "字节（记录可能被中断）";
+    }
+
+    m_index = index;
+    m_cache.clear();
+    if (m_index.isEmpty()) {
+        m_errorMessage = "记录文件中没有有效的数据块";
+        return false;
+    }
+    return true;
+}
+
+qint64 JointLogReader::sampleCount() const
+{
+    return m_index.isEmpty() ? 0 : m_index.last().firstSample + m_index.last().sampleCount;
+}
+
+int JointLogReader::findBlock(qint64 timeUs) const
+{
+    // 最后一个 firstTimeUs <= timeUs 的块
+    auto it = std::upper_bound(m_index.cbegin(), m_index.cend(), timeUs,
+                               [](qint64 t, const IndexEntry& entry) { return t < entry.firstTimeUs; });
+    return qMax(0, int(it - m_index.cbegin()) - 1);
+}
+
+const QVector<JointLog::Sample>* JointLogReader::decodedBlock(int block)
+{
+    for (int i = 0; i < m_cache.size(); ++i) {
+        if (m_cache.at(i).block == block) {
+            if (i > 0) {
+                m_cache.move(i, 0);
+            }
+            return &m_cache.first().samples;
+        }
+    }
+
+    const IndexEntry& entry = m_index.at(block);
+    JointLog::BlockHeader header;
+    CachedBlock cached;
+    cached.block = block;
+    if (!JointLog::decodeBlockHeader(m_data + entry.offset, m_size - entry.offset, &header)
+            || !JointLog::decodeBlock(m_header, header, m_data + entry.offset + JointLog::kBlockHeaderSize,
+                                      &cached.samples)
+            || cached.samples.isEmpty()) {
+        qWarning() << "JointLogReader: 数据块校验失败" << block;
+        return nullptr;
+    }
+
+    m_cache.prepend(cached);
+    if (m_cache.size() > kCachedBlocks) {
+        m_cache.removeLast();
+    }
+    return &m_cache.first().samples;
+}
+
+bool JointLogReader::sampleAt(qint64 timeUs, JointLog::Sample* sample)
+{
+    if (m_index.isEmpty()) return false;
+
+    timeUs = qBound(startTimeUs(), timeUs, endTimeUs());
+    const int block = findBlock(timeUs);
+    const QVector<JointLog::Sample>* samples = decodedBlock(block);
+    if (!samples) return false;
+
+    auto it = std::upper_bound(samples->cbegin(), samples->cend(), timeUs,
+                               [](qint64 t, const JointLog::Sample& s) { return t < s.timeUs; });
+    if (it == samples->cbegin()) {
+        *sample = samples->first();
+        return true;
+    }
+
+    // 复制前一个采样：解码下一块可能使samples失效
+    const JointLog::Sample previous = *(it - 1);
+    JointLog::Sample next;
+    if (it != samples->cend()) {
+        next = *it;
+    } else if (block + 1 < m_index.size()) {
+        const QVector<JointLog::Sample>* following = decodedBlock(block + 1);
+        next = following ? following->first() : previous;
+    } else {
+        next = previous;
+    }
+
+    if (next.timeUs <= previous.timeUs || next.values.size() != previous.values.size()) {
+        *sample = previous;
+        return true;
+    }
+
+    const double t = double(timeUs - previous.timeUs) / double(next.timeUs - previous.timeUs);
+    sample->timeUs = timeUs;
+    sample->values.resize(previous.values.size());
+    for (int i = 0; i < previous.values.size(); ++i) {
+        sample->values[i] = previous.values.at(i) + (next.values.at(i) - previous.values.at(i)) * t;
+    }
+    return true;
+}
+
+QVector<JointLog::Sample> JointLogReader::samplesInRange(qint64 fromUs, qint64 toUs, int maxSamples)
+{
+    QVector<JointLog::Sample> result;
+    if (m_index.isEmpty() || toUs < fromUs || maxSamples <= 0) return result;
+
+    const int first = findBlock(fromUs);
+    const int last = findBlock(toUs);
+    const int blockCount = last - first + 1;
+    const int blockStep = qMax(1, (blockCount + kMaxRangeBlocks - 1) / kMaxRangeBlocks);
+
+    qint64 total = 0;
+    for (int b = first; b <= last; b += blockStep) {
+        total += m_index.at(b).sampleCount;
+    }
+    const qint64 sampleStep = qMax<qint64>(1, (total + maxSamples - 1) / maxSamples);
+
+    result.reserve(int(qMin<qint64>(total, maxSamples)) + 1);
+    for (int b = first; b <= last; b += blockStep) {
+        const QVector<JointLog::Sample>* samples = decodedBlock(b);
+        if (!samples) continue;
+        for (int i = 0; i < samples->size(); i += int(sampleStep)) {
+            const JointLog::Sample& s = samples->at(i);
+            if (s.timeUs >= fromUs && s.timeUs <= toUs) {
+                result.append(s);
+            }
+        }
+    }
+    return result;
+}
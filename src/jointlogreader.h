@@ -0,0 +1,86 @@
+#ifndef JOINTLOGREADER_H
+#define JOINTLOGREADER_H
+
+#include <QFile>
+#include <QVector>
+#include <atomic>
+
+#include "jointlog.h"
+
+/**
+ * @brief 关节记录文件读取器：内存映射整个文件，不把数据读入内存
+ *
+ * buildIndex() 只扫描块头（按负载长度跳转），得到每块一项的稀疏时间索引；
+ * 按时间定位时先在索引上二分查找数据块，再在解码后的块内二分查找，均为O(log n)。
+ * 最近解码的若干块被缓存，拖动时间轴时相邻位置不会重复解码。
+ * buildIndex() 可在工作线程中运行，其余接口只应在同一个线程中使用。
+ */
+class JointLogReader
+{
+public:
+    struct IndexEntry {
+        qint64 offset = 0;          // 块头在文件中的偏移
+        qint64 firstTimeUs = 0;
+        qint64 lastTimeUs = 0;
+        qint64 firstSample = 0;     // 块内第一个采样的全局序号
+        quint32 sampleCount = 0;
+    };
+
+    JointLogReader();
+    ~JointLogReader();
+
+    /**
+     * @brief 映射文件并解析文件头（不建立索引）
+     */
+    bool open(const QString& filePath);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    /**
+     * @brief 扫描块头建立时间索引；遇到截断或损坏的块时停止（记录中断时的尾部）
+     * @param cancel 非空且置位时提前结束
+     * @return 是否至少有一个有效数据块
+     */
+    bool buildIndex(const std::atomic_bool* cancel = nullptr);
+
+    const JointLog::FileHeader& header() const { return m_header; }
+    const QVector<IndexEntry>& index() const { return m_index; }
+    qint64 fileSize() const { return m_size; }
+    qint64 sampleCount() const;
+    qint64 startTimeUs() const { return m_index.isEmpty() ? 0 : m_index.first().firstTimeUs; }
+    qint64 endTimeUs() const { return m_index.isEmpty() ? 0 : m_index.last().lastTimeUs; }
+
+    /**
+     * @brief 取指定时间的采样（相邻两个采样之间线性插值）
+     */
+    bool sampleAt(qint64 timeUs, JointLog::Sample* sample);
+
+    /**
+     * @brief 取时间范围内的采样，超过maxSamples时均匀抽取
+     */
+    QVector<JointLog::Sample> samplesInRange(qint64 fromUs, qint64 toUs, int maxSamples);
+
+    QString getErrorMessage() const { return m_errorMessage; }
+
+private:
+    static const int kCachedBlocks = 4;
+
+    struct CachedBlock {
+        int block = -1;
+        QVector<JointLog::Sample> samples;
+    };
+
+    int findBlock(qint64 timeUs) const;
+    const QVector<JointLog::Sample>* decodedBlock(int block);
+
+    QFile m_file;
+    const char* m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_dataOffset = 0;
+    JointLog::FileHeader m_header;
+    QVector<IndexEntry> m_index;
+    QVector<CachedBlock> m_cache;   // 最近使用的在前
+    QString m_errorMessage;
+};
+
+#endif // JOINTLOGREADER_H
@@ -0,0 +1,155 @@
+﻿#include "jointrecorder.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <QDebug>
+
+JointRecorder::JointRecorder(QObject* parent)
+    : QObject(parent)
+{
+}
+
+JointRecorder::~JointRecorder()
+{
+    stop();
+}
+
+bool JointRecorder::start(const QString& filePath, const QStringList& jointNames, const QStringList& poseLinks)
+{
+    stop();
+
+    if (jointNames.isEmpty()) {
+        m_errorMessage = tr("没有可记录的关节");
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_errorMessage = tr("无法创建记录文件: %1").arg(filePath);
+        return false;
+    }
+
+    m_header = JointLog::FileHeader();
+    m_header.jointNames = jointNames;
+    m_header.poseLinks = poseLinks;
+    m_header.startTimeUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+
+    const QByteArray header = JointLog::encodeFileHeader(m_header);
+    if (m_file.write(header) != header.size() || !m_file.flush()) {
+        m_errorMessage = tr("写入记录文件失败: %1").arg(m_file.errorString());
+        m_file.close();
+        return false;
+    }
+
+    m_pending.clear();
+    m_pending.reserve(kBlockSamples);
+    m_stopping = false;
+    m_errorMessage.clear();
+    m_sampleCount = 0;
+    m_droppedCount = 0;
+    m_bytesWritten = header.size();
+    m_failed = false;
+
+    m_writer = QThread::create([this]() { writerLoop(); });
+    m_writer->setObjectName("JointRecorder");
+    m_writer->start(QThread::LowPriority);
+    m_recording = true;
+
+    qDebug() << "JointRecorder: 开始记录" << filePath << jointNames.size() << "个关节," << poseLinks.size() << "个位姿";
+    return true;
+}
+
+void JointRecorder::stop()
+{
+    if (!m_recording) return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+
+    m_file.close();
+    m_recording = false;
+
+    qDebug() << "JointRecorder: 记录结束" << m_file.fileName() << m_sampleCount.load() << "个采样,"
+             << m_bytesWritten.load() << "字节, 丢弃" << m_droppedCount.load();
+}
+
+void JointRecorder::append(qint64 timeUs, const QVector<double>& values)
+{
+    if (m_failed.load(std::memory_order_relaxed)) return;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_pending.size() >= kMaxPendingSamples) {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    JointLog::Sample sample;
+    sample.timeUs = timeUs;
+    sample.values = values;
+    m_pending.append(sample);
+    if (m_pending.size() >= kBlockSamples) {
+        m_wake.wakeOne();
+    }
+}
+
+QString JointRecorder::getErrorMessage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_errorMessage;
+}
+
+void JointRecorder::writerLoop()
+{
+    QVector<JointLog::Sample> batch;
+    bool stopping = false;
+
+    while (!stopping) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_stopping && m_pending.size() < kBlockSamples) {
+                m_wake.wait(&m_mutex, kFlushInterval);
+            }
+            stopping = m_stopping;
+            batch.swap(m_pending);
+            m_pending.reserve(kBlockSamples);
+        }
+
+        if (!batch.isEmpty() && !m_failed.load()) {
+            if (!writeSamples(batch)) {
+                m_failed = true;
+                const QString error = tr("写入记录文件失败: %1").arg(m_file.errorString());
+                {
+                    QMutexLocker locker(&m_mutex);
+                    m_errorMessage = error;
+                }
+                qWarning() << "JointRecorder:" << error;
+                emit writeFailed(error);
+            }
+        }
+        batch.clear();
+    }
+}
+
+bool JointRecorder::writeSamples(const QVector<JointLog::Sample>& samples)
+{
+    for (int offset = 0; offset < samples.size(); offset += kBlockSamples) {
+        const int count = qMin(kBlockSamples, samples.size() - offset);
+        const QByteArray block = JointLog::encodeBlock(m_header, samples.constData() + offset, count);
+        if (m_file.write(block) != block.size()) {
+            return false;
+        }
+        m_sampleCount.fetch_add(count);
+        m_bytesWritten.fetch_add(block.size());
+    }
+    // 每批刷新到系统，进程崩溃时已写出的块完整保留
+    return m_file.flush();
+}
@@ -0,0 +1,87 @@
+#ifndef JOINTRECORDER_H
+#define JOINTRECORDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <atomic>
+
+#include "jointlog.h"
+
+class QThread;
+
+/**
+ * @brief 关节状态记录器：把带时间戳的关节向量（可选末端位姿）追加到二进制记录文件（格式见JointLog）
+ *
+ * append() 可在任意线程调用，只在互斥锁内追加到内存队列，编码和写盘都在独立的写线程中完成；
+ * 写线程跟不上时丢弃新采样并计数，调用方永远不会因磁盘而阻塞。
+ * 每积累 kBlockSamples 个采样或每隔 kFlushInterval 写出一个独立数据块并刷新到系统。
+ */
+class JointRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int kBlockSamples = 4096;
+    static const int kFlushInterval = 1000;         // 毫秒
+    static const int kMaxPendingSamples = 1 << 20;  // 写线程积压上限
+
+    explicit JointRecorder(QObject* parent = nullptr);
+    ~JointRecorder();
+
+    /**
+     * @brief 创建记录文件并启动写线程
+     * @param jointNames 每个采样中关节值的顺序
+     * @param poseLinks 记录位姿的Link（每个采样在关节值之后追加x y z qw qx qy qz）
+     */
+    bool start(const QString& filePath, const QStringList& jointNames, const QStringList& poseLinks = QStringList());
+
+    /**
+     * @brief 写出剩余采样并关闭文件
+     */
+    void stop();
+
+    /**
+     * @brief 追加一个采样（线程安全，不阻塞）
+     * @param timeUs UTC时间（微秒）
+     * @param values 关节值及位姿分量，长度应为 jointNames + 7 × poseLinks
+     */
+    void append(qint64 timeUs, const QVector<double>& values);
+
+    bool isRecording() const { return m_recording; }
+    QString filePath() const { return m_file.fileName(); }
+    qint64 sampleCount() const { return m_sampleCount.load(); }
+    qint64 droppedCount() const { return m_droppedCount.load(); }
+    qint64 bytesWritten() const { return m_bytesWritten.load(); }
+    QString getErrorMessage() const;
+
+signals:
+    /**
+     * @brief 写盘失败（在写线程中发出，记录随即停止写入）
+     */
+    void writeFailed(const QString& error);
+
+private:
+    void writerLoop();
+    bool writeSamples(const QVector<JointLog::Sample>& samples);
+
+    JointLog::FileHeader m_header;
+    QFile m_file;
+    QThread* m_writer = nullptr;
+    bool m_recording = false;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QVector<JointLog::Sample> m_pending;
+    bool m_stopping = false;
+    QString m_errorMessage;
+
+    std::atomic<qint64> m_sampleCount{0};
+    std::atomic<qint64> m_droppedCount{0};
+    std::atomic<qint64> m_bytesWritten{0};
+    std::atomic<bool> m_failed{false};
+};
+
+#endif // JOINTRECORDER_H
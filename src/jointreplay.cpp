@@ -0,0 +1,240 @@
+﻿#include "jointreplay.h"
+#include "robotscene.h"
+#include "robotentity.h"
+#include "trajectoryentity.h"
+
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+namespace {
+
+const int kTickInterval = 16;           // 播放刷新周期（毫秒）
+const int kTrajectoryInterval = 100;    // 轨迹重建的最小间隔（毫秒）
+const int kTrajectoryPoints = 2000;     // 每条轨迹的最多点数
+
+} // namespace
+
+JointReplay::JointReplay(QObject* parent)
+    : QObject(parent)
+{
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(kTickInterval);
+    connect(m_timer, &QTimer::timeout, this, &JointReplay::onTick);
+    connect(&m_indexWatcher, &QFutureWatcher<bool>::finished, this, &JointReplay::onIndexFinished);
+}
+
+JointReplay::~JointReplay()
+{
+    close();
+}
+
+bool JointReplay::open(const QString& filePath)
+{
+    close();
+
+    if (!m_reader.open(filePath)) {
+        m_errorMessage = m_reader.getErrorMessage();
+        return false;
+    }
+    m_filePath = filePath;
+
+    // 索引只扫描块头，但10GB级文件仍需一定时间，放到工作线程
+    m_cancelIndex = std::make_shared<std::atomic_bool>(false);
+    JointLogReader* reader = &m_reader;
+    std::shared_ptr<std::atomic_bool> cancel = m_cancelIndex;
+    m_indexWatcher.setFuture(QtConcurrent::run([reader, cancel]() {
+        return reader->buildIndex(cancel.get());
+    }));
+    return true;
+}
+
+void JointReplay::close()
+{
+    if (!m_reader.isOpen()) return;
+
+    if (m_indexWatcher.isRunning()) {
+        m_cancelIndex->store(true);
+        m_indexWatcher.waitForFinished();
+    }
+
+    pause();
+    clearTrajectories();
+    m_reader.close();
+    m_ready = false;
+    m_filePath.clear();
+    m_jointValues.clear();
+    emit closed();
+}
+
+void JointReplay::onIndexFinished()
+{
+    if (!m_reader.isOpen() || m_cancelIndex->load()) return;
+
+    if (!m_indexWatcher.result()) {
+        m_errorMessage = m_reader.getErrorMessage();
+        close();
+        emit failed(m_errorMessage);
+        return;
+    }
+
+    const JointLog::FileHeader& header = m_reader.header();
+    qDebug() << "JointReplay:" << m_filePath << m_reader.sampleCount() << "个采样,"
+             << m_reader.index().size() << "个数据块," << duration() << "秒";
+
+    // 记录了位姿的Link各用一条固定轨迹显示时间窗口
+    if (m_scene && !header.poseLinks.isEmpty()) {
+        static const QColor colors[] = {
+            QColor(255, 255, 0), QColor(0, 255, 255), QColor(255, 0, 255), QColor(255, 128, 0)
+        };
+        for (int i = 0; i < header.poseLinks.size(); ++i) {
+            TrajectoryEntity* trajectory = new TrajectoryEntity(m_scene->worldEntity());
+            trajectory->setColor(colors[i % 4]);
+            m_trajectories.append(trajectory);
+        }
+    }
+
+    m_ready = true;
+    m_positionUs = m_reader.startTimeUs();
+    applyPosition();
+    emit ready();
+}
+
+double JointReplay::duration() const
+{
+    return m_ready ? (m_reader.endTimeUs() - m_reader.startTimeUs()) / 1.0e6 : 0.0;
+}
+
+double JointReplay::position() const
+{
+    return m_ready ? (m_positionUs - m_reader.startTimeUs()) / 1.0e6 : 0.0;
+}
+
+void JointReplay::setSpeed(double speed)
+{
+    if (qFuzzyIsNull(speed)) speed = 1.0;
+    speed = speed < 0 ? -qBound(0.01, -speed, 1000.0) : qBound(0.01, speed, 1000.0);
+    if (qFuzzyCompare(m_speed, speed)) return;
+
+    m_speed = speed;
+    emit speedChanged();
+}
+
+void JointReplay::setTrajectoryWindow(double seconds)
+{
+    m_trajectoryWindow = qMax(0.1, seconds);
+    rebuildTrajectories();
+}
+
+void JointReplay::play()
+{
+    if (!m_ready || m_playing) return;
+
+    // 已在终点时从头（倒放时从尾）开始
+    if (m_speed > 0 && m_positionUs >= m_reader.endTimeUs()) {
+        m_positionUs = m_reader.startTimeUs();
+    } else if (m_speed < 0 && m_positionUs <= m_reader.startTimeUs()) {
+        m_positionUs = m_reader.endTimeUs();
+    }
+
+    m_playing = true;
+    m_tickClock.start();
+    m_timer->start();
+    emit playingChanged();
+}
+
+void JointReplay::pause()
+{
+    if (!m_playing) return;
+
+    m_playing = false;
+    m_timer->stop();
+    emit playingChanged();
+}
+
+void JointReplay::seek(double seconds)
+{
+    if (!m_ready) return;
+
+    m_positionUs = qBound(m_reader.startTimeUs(),
+                          m_reader.startTimeUs() + qint64(seconds * 1.0e6),
+                          m_reader.endTimeUs());
+    applyPosition();
+}
+
+void JointReplay::onTick()
+{
+    const qint64 elapsedUs = m_tickClock.nsecsElapsed() / 1000;
+    m_tickClock.restart();
+
+    m_positionUs += qint64(elapsedUs * m_speed);
+    if (m_positionUs >= m_reader.endTimeUs()) {
+        m_positionUs = m_reader.endTimeUs();
+        pause();
+    } else if (m_positionUs <= m_reader.startTimeUs()) {
+        m_positionUs = m_reader.startTimeUs();
+        pause();
+    }
+    applyPosition();
+}
+
+void JointReplay::applyPosition()
+{
+    if (!m_ready || !m_scene || !m_reader.sampleAt(m_positionUs, &m_sample)) return;
+
+    const QStringList& jointNames = m_reader.header().jointNames;
+    for (int i = 0; i < jointNames.size() && i < m_sample.values.size(); ++i) {
+        m_jointValues[jointNames.at(i)] = m_sample.values.at(i);
+    }
+    m_scene->robotEntity()->setJointValues(m_jointValues, m_positionUs);
+    emit positionChanged();
+
+    // 轨迹限频重建：拖动时间轴时最多每 kTrajectoryInterval 重建一次，并保证最后一次位置会被重建
+    if (m_trajectories.isEmpty()) return;
+    if (!m_trajectoryThrottle.isValid() || m_trajectoryThrottle.elapsed() >= kTrajectoryInterval) {
+        rebuildTrajectories();
+    } else if (!m_trajectoryPending) {
+        m_trajectoryPending = true;
+        QTimer::singleShot(kTrajectoryInterval - int(m_trajectoryThrottle.elapsed()), this, [this]() {
+            m_trajectoryPending = false;
+            rebuildTrajectories();
+        });
+    }
+}
+
+void JointReplay::rebuildTrajectories()
+{
+    if (!m_ready || !m_scene || m_trajectories.isEmpty()) return;
+    m_trajectoryThrottle.start();
+
+    // 轨迹显示播放方向上刚经过的时间窗口
+    const qint64 windowUs = qint64(m_trajectoryWindow * 1.0e6);
+    const qint64 fromUs = m_speed >= 0 ? m_positionUs - windowUs : m_positionUs;
+    const qint64 toUs = m_speed >= 0 ? m_positionUs : m_positionUs + windowUs;
+    const QVector<JointLog::Sample> samples = m_reader.samplesInRange(fromUs, toUs, kTrajectoryPoints);
+
+    const QMatrix4x4 robotTransform = m_scene->robotEntity()->getRobotTransform();
+    const int poseOffset = m_reader.header().jointNames.size();
+    for (int k = 0; k < m_trajectories.size(); ++k) {
+        const int base = poseOffset + k * JointLog::kPoseComponents;
+        QVector<QVector3D> points;
+        points.reserve(samples.size());
+        for (const JointLog::Sample& sample : samples) {
+            if (base + 2 < sample.values.size()) {
+                points.append(robotTransform.map(QVector3D(sample.values.at(base),
+                                                           sample.values.at(base + 1),
+                                                           sample.values.at(base + 2))));
+            }
+        }
+        m_trajectories.at(k)->setPoints(points);
+    }
+}
+
+void JointReplay::clearTrajectories()
+{
+    for (TrajectoryEntity* trajectory : m_trajectories) {
+        trajectory->deleteLater();
+    }
+    m_trajectories.clear();
+}
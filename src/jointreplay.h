@@ -0,0 +1,112 @@
+#ifndef JOINTREPLAY_H
+#define JOINTREPLAY_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QMap>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "jointlogreader.h"
+
+class QTimer;
+class RobotScene;
+class TrajectoryEntity;
+
+/**
+ * @brief 关节记录回放：内存映射记录文件，按可调速度（含倒放）驱动RobotEntity
+ *
+ * 打开文件后在工作线程中建立稀疏时间索引，完成前不可播放；
+ * 播放和拖动都只解码当前位置所在的数据块，与文件大小无关。
+ * 记录中包含末端位姿时，按播放方向重建最近 trajectoryWindow 秒的轨迹。
+ */
+class JointReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JointReplay(QObject* parent = nullptr);
+    ~JointReplay();
+
+    void setScene(RobotScene* scene) { m_scene = scene; }
+
+    /**
+     * @brief 打开记录文件并开始建立索引（结果由ready/failed通知）
+     */
+    bool open(const QString& filePath);
+    void close();
+
+    bool isOpen() const { return m_reader.isOpen(); }
+    bool isReady() const { return m_ready; }
+    bool isPlaying() const { return m_playing; }
+    QString filePath() const { return m_filePath; }
+
+    /**
+     * @brief 记录时长与当前位置（秒，相对于第一个采样）
+     */
+    double duration() const;
+    double position() const;
+
+    /**
+     * @brief 播放速度（负数为倒放）
+     */
+    double speed() const { return m_speed; }
+    void setSpeed(double speed);
+
+    /**
+     * @brief 轨迹时间窗口（秒）
+     */
+    void setTrajectoryWindow(double seconds);
+
+    void play();
+    void pause();
+    void seek(double seconds);
+
+    QString getErrorMessage() const { return m_errorMessage; }
+
+signals:
+    void ready();
+    void failed(const QString& error);
+    void closed();
+    void positionChanged();
+    void playingChanged();
+    void speedChanged();
+
+private slots:
+    void onIndexFinished();
+    void onTick();
+
+private:
+    void applyPosition();
+    void rebuildTrajectories();
+    void clearTrajectories();
+
+    JointLogReader m_reader;
+    QString m_filePath;
+    QString m_errorMessage;
+    bool m_ready = false;
+
+    // 异步建立索引
+    QFutureWatcher<bool> m_indexWatcher;
+    std::shared_ptr<std::atomic_bool> m_cancelIndex;
+
+    // 播放状态
+    RobotScene* m_scene = nullptr;
+    QTimer* m_timer = nullptr;
+    QElapsedTimer m_tickClock;
+    qint64 m_positionUs = 0;
+    double m_speed = 1.0;
+    bool m_playing = false;
+    JointLog::Sample m_sample;
+    QMap<QString, double> m_jointValues;
+
+    // 轨迹
+    double m_trajectoryWindow = 5.0;
+    QVector<TrajectoryEntity*> m_trajectories;
+    QElapsedTimer m_trajectoryThrottle;
+    bool m_trajectoryPending = false;
+};
+
+#endif // JOINTREPLAY_H
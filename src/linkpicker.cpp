@@ -0,0 +1,549 @@
+﻿#include "linkpicker.h"
+#include "robotentity.h"
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DCore/QTransform>
+#include <Qt3DRender/QGeometryRenderer>
+#include <Qt3DRender/QGeometry>
+#include <Qt3DRender/QAttribute>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DExtras/QCuboidMesh>
+#include <Qt3DExtras/QCylinderMesh>
+#include <Qt3DExtras/QSphereMesh>
+#include <QVector4D>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const int kMaxLeafSize = 4;
+const int kMaxDepth = 48;
+const int kStackSize = 64;
+
+// 拾取用的基本几何体分段数（远低于显示用的32段，足够判断命中）
+const int kCylinderSlices = 16;
+const int kSphereRings = 8;
+const int kSphereSlices = 12;
+
+inline float safeInverse(float value)
+{
+    if (std::abs(value) < 1e-20f) {
+        return value < 0.0f ? -1e20f : 1e20f;
+    }
+    return 1.0f / value;
+}
+
+// 射线与包围盒的slab测试，返回进入距离
+inline bool rayBox(const QVector3D& origin, const QVector3D& invDir,
+                   const QVector3D& boxMin, const QVector3D& boxMax,
+                   float maxT, float* tEnter)
+{
+    float tMin = 0.0f;
+    float tMax = maxT;
+    for (int axis = 0; axis < 3; ++axis) {
+        float t1 = (boxMin[axis] - origin[axis]) * invDir[axis];
+        float t2 = (boxMax[axis] - origin[axis]) * invDir[axis];
+        if (t1 > t2) std::swap(t1, t2);
+        tMin = qMax(tMin, t1);
+        tMax = qMin(tMax, t2);
+        if (tMin > tMax) return false;
+    }
+    *tEnter = tMin;
+    return true;
+}
+
+// Möller–Trumbore 射线三角形求交（双面）
+inline bool rayTriangle(const QVector3D& origin, const QVector3D& direction,
+                        const TriangleBvh::Triangle& tri, float* t)
+{
+    const QVector3D edge1 = tri.v1 - tri.v0;
+    const QVector3D edge2 = tri.v2 - tri.v0;
+    const QVector3D p = QVector3D::crossProduct(direction, edge2);
+    const float det = QVector3D::dotProduct(edge1, p);
+    if (std::abs(det) < 1e-20f) return false;
+
+    const float invDet = 1.0f / det;
+    const QVector3D s = origin - tri.v0;
+    const float u = QVector3D::dotProduct(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    const QVector3D q = QVector3D::crossProduct(s, edge1);
+    const float v = QVector3D::dotProduct(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    const float hit = QVector3D::dotProduct(edge2, q) * invDet;
+    if (hit <= 0.0f) return false;
+
+    *t = hit;
+    return true;
+}
+
+QMatrix4x4 entityMatrix(Qt3DCore::QEntity* entity)
+{
+    const auto transforms = entity->componentsOfType<Qt3DCore::QTransform>();
+    return transforms.isEmpty() ? QMatrix4x4() : transforms.first()->matrix();
+}
+
+void appendIndexedTriangles(const QVector<QVector3D>& vertices, const QVector<int>& indices,
+                            const QMatrix4x4& toLink, QVector<TriangleBvh::Triangle>& triangles)
+{
+    for (int i = 0; i + 2 < indices.size(); i += 3) {
+        TriangleBvh::Triangle tri;
+        tri.v0 = toLink.map(vertices.at(indices.at(i)));
+        tri.v1 = toLink.map(vertices.at(indices.at(i + 1)));
+        tri.v2 = toLink.map(vertices.at(indices.at(i + 2)));
+        triangles.append(tri);
+    }
+}
+
+quint32 readIndex(const char* data, Qt3DRender::QAttribute::VertexBaseType type)
+{
+    switch (type) {
+    case Qt3DRender::QAttribute::UnsignedShort: {
+        quint16 value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case Qt3DRender::QAttribute::UnsignedByte:
+        return static_cast<quint8>(*data);
+    default: {
+        quint32 value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    }
+}
+
+int indexSize(Qt3DRender::QAttribute::VertexBaseType type)
+{
+    switch (type) {
+    case Qt3DRender::QAttribute::UnsignedShort: return 2;
+    case Qt3DRender::QAttribute::UnsignedByte: return 1;
+    default: return 4;
+    }
+}
+
+} // namespace
+
+// ==================== TriangleBvh ====================
+
+void TriangleBvh::clear()
+{
+    m_triangles.clear();
+    m_nodes.clear();
+}
+
+void TriangleBvh::build(QVector<Triangle> triangles)
+{
+    clear();
+    if (triangles.isEmpty()) return;
+
+    const int count = triangles.size();
+    QVector<QVector3D> centroids(count);
+    QVector<int> order(count);
+    for (int i = 0; i < count; ++i) {
+        const Triangle& tri = triangles.at(i);
+        centroids[i] = (tri.v0 + tri.v1 + tri.v2) / 3.0f;
+        order[i] = i;
+    }
+
+    m_nodes.reserve(2 * (count / kMaxLeafSize + 1));
+    m_nodes.append(Node());
+    buildNode(0, triangles, order, centroids, 0, count, 0);
+
+    // 按叶节点顺序重排三角形，使叶节点引用连续区间
+    m_triangles.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_triangles[i] = triangles.at(order.at(i));
+    }
+    m_nodes.squeeze();
+}
+
+void TriangleBvh::buildNode(int nodeIndex, const QVector<Triangle>& source, QVector<int>& order,
+                            const QVector<QVector3D>& centroids, int begin, int end, int depth)
+{
+    const float maxFloat = std::numeric_limits<float>::max();
+    QVector3D boundsMin(maxFloat, maxFloat, maxFloat);
+    QVector3D boundsMax(-maxFloat, -maxFloat, -maxFloat);
+    QVector3D centroidMin = boundsMin;
+    QVector3D centroidMax = boundsMax;
+
+    for (int i = begin; i < end; ++i) {
+        const Triangle& tri = source.at(order.at(i));
+        for (const QVector3D* v : { &tri.v0, &tri.v1, &tri.v2 }) {
+            for (int axis = 0; axis < 3; ++axis) {
+                boundsMin[axis] = qMin(boundsMin[axis], (*v)[axis]);
+                boundsMax[axis] = qMax(boundsMax[axis], (*v)[axis]);
+            }
+        }
+        const QVector3D& c = centroids.at(order.at(i));
+        for (int axis = 0; axis < 3; ++axis) {
+            centroidMin[axis] = qMin(centroidMin[axis], c[axis]);
+            centroidMax[axis] = qMax(centroidMax[axis], c[axis]);
+        }
+    }
+
+    m_nodes[nodeIndex].boundsMin = boundsMin;
+    m_nodes[nodeIndex].boundsMax = boundsMax;
+
+    // 按质心包围盒最长轴划分
+    const QVector3D extent = centroidMax - centroidMin;
+    int axis = 0;
+    if (extent.y() > extent[axis]) axis = 1;
+    if (extent.z() > extent[axis]) axis = 2;
+
+    const int count = end - begin;
+    if (count <= kMaxLeafSize || depth >= kMaxDepth || extent[axis] <= 0.0f) {
+        m_nodes[nodeIndex].first = begin;
+        m_nodes[nodeIndex].count = count;
+        return;
+    }
+
+    const int mid = begin + count / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [&centroids, axis](int a, int b) {
+                         return centroids.at(a)[axis] < centroids.at(b)[axis];
+                     });
+
+    // 两个子节点连续存放（注意 append 可能导致重新分配，不能持有节点引用）
+    const int leftIndex = m_nodes.size();
+    m_nodes.append(Node());
+    m_nodes.append(Node());
+    m_nodes[nodeIndex].first = leftIndex;
+    m_nodes[nodeIndex].count = 0;
+
+    buildNode(leftIndex, source, order, centroids, begin, mid, depth + 1);
+    buildNode(leftIndex + 1, source, order, centroids, mid, end, depth + 1);
+}
+
+bool TriangleBvh::intersect(const QVector3D& origin, const QVector3D& direction,
+                            float maxT, float* hitT) const
+{
+    if (m_nodes.isEmpty()) return false;
+
+    const QVector3D invDir(safeInverse(direction.x()),
+                           safeInverse(direction.y()),
+                           safeInverse(direction.z()));
+
+    float closest = maxT;
+    bool hit = false;
+
+    int stack[kStackSize];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = m_nodes.at(stack[--stackSize]);
+
+        float tEnter;
+        if (!rayBox(origin, invDir, node.boundsMin, node.boundsMax, closest, &tEnter)) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                float t;
+                if (rayTriangle(origin, direction, m_triangles.at(i), &t) && t < closest) {
+                    closest = t;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+
+        // 近的子节点后入栈、先出栈，尽早缩短 closest
+        const int left = node.first;
+        const int right = node.first + 1;
+        float tLeft, tRight;
+        const bool hitLeft = rayBox(origin, invDir, m_nodes.at(left).boundsMin,
+                                    m_nodes.at(left).boundsMax, closest, &tLeft);
+        const bool hitRight = rayBox(origin, invDir, m_nodes.at(right).boundsMin,
+                                     m_nodes.at(right).boundsMax, closest, &tRight);
+
+        if (hitLeft && hitRight) {
+            if (tLeft <= tRight) {
+                stack[stackSize++] = right;
+                stack[stackSize++] = left;
+            } else {
+                stack[stackSize++] = left;
+                stack[stackSize++] = right;
+            }
+        } else if (hitLeft) {
+            stack[stackSize++] = left;
+        } else if (hitRight) {
+            stack[stackSize++] = right;
+        }
+    }
+
+    if (hit) {
+        *hitT = closest;
+    }
+    return hit;
+}
+
+// ==================== LinkPicker ====================
+
+void LinkPicker::clear()
+{
+    m_links.clear();
+}
+
+void LinkPicker::build(RobotEntity* robot)
+{
+    clear();
+    if (!robot || !robot->getModel()) return;
+
+    int totalTriangles = 0;
+    const auto& links = robot->getModel()->links;
+    for (auto it = links.constBegin(); it != links.constEnd(); ++it) {
+        LinkEntity* linkEntity = robot->getLinkEntity(it.key());
+        if (!linkEntity || !linkEntity->visualEntity()) continue;
+
+        // 视觉实体相对Link的变换在加载后固定，三角形直接存为Link局部坐标
+        QVector<TriangleBvh::Triangle> triangles;
+        collectTriangles(linkEntity->visualEntity(), QMatrix4x4(), triangles);
+        if (triangles.isEmpty()) continue;
+
+        LinkBvh link;
+        link.linkName = it.key();
+        link.entity = linkEntity;
+        link.bvh.build(std::move(triangles));
+        totalTriangles += link.bvh.triangleCount();
+        m_links.append(std::move(link));
+    }
+
+    qDebug() << "LinkPicker: 构建完成," << m_links.size() << "个Link," << totalTriangles << "个三角形";
+}
+
+void LinkPicker::collectTriangles(Qt3DCore::QEntity* entity, const QMatrix4x4& toLink,
+                                  QVector<TriangleBvh::Triangle>& triangles)
+{
+    if (!entity || !entity->isEnabled()) return;
+
+    const QMatrix4x4 matrix = toLink * entityMatrix(entity);
+
+    const auto renderers = entity->componentsOfType<Qt3DRender::QGeometryRenderer>();
+    for (Qt3DRender::QGeometryRenderer* renderer : renderers) {
+        if (!appendBufferTriangles(renderer, matrix, triangles)) {
+            appendPrimitiveTriangles(renderer, matrix, triangles);
+        }
+    }
+
+    for (QObject* child : entity->children()) {
+        if (auto childEntity = qobject_cast<Qt3DCore::QEntity*>(child)) {
+            collectTriangles(childEntity, matrix, triangles);
+        }
+    }
+}
+
+bool LinkPicker::appendBufferTriangles(Qt3DRender::QGeometryRenderer* renderer, const QMatrix4x4& toLink,
+                                       QVector<TriangleBvh::Triangle>& triangles)
+{
+    Qt3DRender::QGeometry* geometry = renderer->geometry();
+    if (!geometry) return false;
+
+    Qt3DRender::QAttribute* positionAttribute = nullptr;
+    Qt3DRender::QAttribute* indexAttribute = nullptr;
+    for (Qt3DRender::QAttribute* attribute : geometry->attributes()) {
+        if (attribute->attributeType() == Qt3DRender::QAttribute::IndexAttribute) {
+            indexAttribute = attribute;
+        } else if (attribute->name() == Qt3DRender::QAttribute::defaultPositionAttributeName()) {
+            positionAttribute = attribute;
+        }
+    }
+
+    // 由数据生成器填充的缓冲（Qt3DExtras基本几何体）在前端没有数据
+    if (!positionAttribute || !positionAttribute->buffer()) return false;
+    const QByteArray vertexData = positionAttribute->buffer()->data();
+    if (vertexData.isEmpty()) return false;
+
+    if (renderer->primitiveType() != Qt3DRender::QGeometryRenderer::Triangles) return true;
+    if (positionAttribute->vertexBaseType() != Qt3DRender::QAttribute::Float
+        || positionAttribute->vertexSize() < 3) {
+        qWarning() << "LinkPicker: 不支持的顶点格式，跳过";
+        return true;
+    }
+
+    const int stride = positionAttribute->byteStride() > 0
+                           ? int(positionAttribute->byteStride())
+                           : int(positionAttribute->vertexSize() * sizeof(float));
+    const int offset = int(positionAttribute->byteOffset());
+    int vertexCount = int(positionAttribute->count());
+    if (vertexCount > 0) {
+        const int available = (vertexData.size() - offset - int(3 * sizeof(float))) / stride + 1;
+        vertexCount = qMin(vertexCount, qMax(0, available));
+    }
+
+    QVector<QVector3D> positions(vertexCount);
+    const char* vertexBase = vertexData.constData() + offset;
+    for (int i = 0; i < vertexCount; ++i) {
+        float xyz[3];
+        std::memcpy(xyz, vertexBase + i * stride, sizeof(xyz));
+        positions[i] = toLink.map(QVector3D(xyz[0], xyz[1], xyz[2]));
+    }
+
+    auto appendTriangle = [&](quint32 a, quint32 b, quint32 c) {
+        if (a >= quint32(vertexCount) || b >= quint32(vertexCount) || c >= quint32(vertexCount)) return;
+        TriangleBvh::Triangle tri;
+        tri.v0 = positions.at(int(a));
+        tri.v1 = positions.at(int(b));
+        tri.v2 = positions.at(int(c));
+        triangles.append(tri);
+    };
+
+    if (indexAttribute && indexAttribute->buffer()) {
+        const QByteArray indexData = indexAttribute->buffer()->data();
+        const auto type = indexAttribute->vertexBaseType();
+        const int size = indexSize(type);
+        const int indexStride = indexAttribute->byteStride() > 0 ? int(indexAttribute->byteStride()) : size;
+        const int indexOffset = int(indexAttribute->byteOffset());
+        int indexCount = renderer->vertexCount() > 0 ? renderer->vertexCount() : int(indexAttribute->count());
+        indexCount = qMin(indexCount, (indexData.size() - indexOffset) / indexStride);
+
+        const char* indexBase = indexData.constData() + indexOffset;
+        triangles.reserve(triangles.size() + indexCount / 3);
+        for (int i = 0; i + 2 < indexCount; i += 3) {
+            appendTriangle(readIndex(indexBase + i * indexStride, type),
+                           readIndex(indexBase + (i + 1) * indexStride, type),
+                           readIndex(indexBase + (i + 2) * indexStride, type));
+        }
+    } else {
+        triangles.reserve(triangles.size() + vertexCount / 3);
+        for (int i = 0; i + 2 < vertexCount; i += 3) {
+            appendTriangle(quint32(i), quint32(i + 1), quint32(i + 2));
+        }
+    }
+
+    return true;
+}
+
+bool LinkPicker::appendPrimitiveTriangles(Qt3DRender::QGeometryRenderer* renderer, const QMatrix4x4& toLink,
+                                          QVector<TriangleBvh::Triangle>& triangles)
+{
+    QVector<QVector3D> vertices;
+    QVector<int> indices;
+
+    if (auto cuboid = qobject_cast<Qt3DExtras::QCuboidMesh*>(renderer)) {
+        const QVector3D half(cuboid->xExtent() * 0.5f, cuboid->yExtent() * 0.5f, cuboid->zExtent() * 0.5f);
+        for (int i = 0; i < 8; ++i) {
+            vertices.append(QVector3D((i & 1) ? half.x() : -half.x(),
+                                      (i & 2) ? half.y() : -half.y(),
+                                      (i & 4) ? half.z() : -half.z()));
+        }
+        indices = { 0, 1, 3, 0, 3, 2,   4, 6, 7, 4, 7, 5,
+                    0, 4, 5, 0, 5, 1,   2, 3, 7, 2, 7, 6,
+                    0, 2, 6, 0, 6, 4,   1, 5, 7, 1, 7, 3 };
+    } else if (auto cylinder = qobject_cast<Qt3DExtras::QCylinderMesh*>(renderer)) {
+        // Qt3D圆柱沿Y轴、以原点为中心
+        const float radius = cylinder->radius();
+        const float halfLength = cylinder->length() * 0.5f;
+        vertices.append(QVector3D(0, -halfLength, 0));
+        vertices.append(QVector3D(0, halfLength, 0));
+        for (int i = 0; i < kCylinderSlices; ++i) {
+            const float angle = 2.0f * float(M_PI) * i / kCylinderSlices;
+            const float x = radius * qCos(angle);
+            const float z = radius * qSin(angle);
+            vertices.append(QVector3D(x, -halfLength, z));
+            vertices.append(QVector3D(x, halfLength, z));
+        }
+        for (int i = 0; i < kCylinderSlices; ++i) {
+            const int b0 = 2 + 2 * i;
+            const int t0 = b0 + 1;
+            const int b1 = 2 + 2 * ((i + 1) % kCylinderSlices);
+            const int t1 = b1 + 1;
+            indices << b0 << b1 << t1 << b0 << t1 << t0;   // 侧面
+            indices << 0 << b1 << b0;                       // 底面
+            indices << 1 << t0 << t1;                       // 顶面
+        }
+    } else if (auto sphere = qobject_cast<Qt3DExtras::QSphereMesh*>(renderer)) {
+        const float radius = sphere->radius();
+        for (int ring = 0; ring <= kSphereRings; ++ring) {
+            const float phi = float(M_PI) * ring / kSphereRings;
+            for (int slice = 0; slice <= kSphereSlices; ++slice) {
+                const float theta = 2.0f * float(M_PI) * slice / kSphereSlices;
+                vertices.append(QVector3D(radius * qSin(phi) * qCos(theta),
+                                          radius * qCos(phi),
+                                          radius * qSin(phi) * qSin(theta)));
+            }
+        }
+        const int rowLength = kSphereSlices + 1;
+        for (int ring = 0; ring < kSphereRings; ++ring) {
+            for (int slice = 0; slice < kSphereSlices; ++slice) {
+                const int a = ring * rowLength + slice;
+                const int b = a + rowLength;
+                indices << a << b << a + 1 << a + 1 << b << b + 1;
+            }
+        }
+    } else {
+        return false;
+    }
+
+    appendIndexedTriangles(vertices, indices, toLink, triangles);
+    return true;
+}
+
+QMatrix4x4 LinkPicker::worldMatrix(Qt3DCore::QEntity* entity)
+{
+    QMatrix4x4 matrix;
+    for (Qt3DCore::QEntity* current = entity; current; current = current->parentEntity()) {
+        matrix = entityMatrix(current) * matrix;
+    }
+    return matrix;
+}
+
+LinkPicker::PickResult LinkPicker::pick(const QVector3D& origin, const QVector3D& direction) const
+{
+    PickResult result;
+    float closest = std::numeric_limits<float>::max();
+
+    for (const LinkBvh& link : m_links) {
+        if (!link.entity || !link.entity->isEnabled()) continue;
+
+        // 射线变换到Link局部坐标系，t 与世界坐标系下一致
+        bool invertible = false;
+        const QMatrix4x4 toLocal = worldMatrix(link.entity).inverted(&invertible);
+        if (!invertible) continue;
+
+        const QVector3D localOrigin = toLocal.map(origin);
+        const QVector3D localDirection = toLocal.mapVector(direction);
+
+        float t;
+        if (link.bvh.intersect(localOrigin, localDirection, closest, &t)) {
+            closest = t;
+            result.linkName = link.linkName;
+        }
+    }
+
+    if (result.isValid()) {
+        result.distance = closest * direction.length();
+        result.worldPosition = origin + direction * closest;
+    }
+    return result;
+}
+
+bool LinkPicker::viewportRay(const QMatrix4x4& viewProjection, const QPointF& position,
+                             const QSizeF& viewportSize, QVector3D* origin, QVector3D* direction)
+{
+    if (viewportSize.width() <= 0 || viewportSize.height() <= 0) return false;
+
+    bool invertible = false;
+    const QMatrix4x4 inverse = viewProjection.inverted(&invertible);
+    if (!invertible) return false;
+
+    const float ndcX = float(2.0 * position.x() / viewportSize.width() - 1.0);
+    const float ndcY = float(1.0 - 2.0 * position.y() / viewportSize.height());
+
+    const QVector4D nearPoint = inverse * QVector4D(ndcX, ndcY, -1.0f, 1.0f);
+    const QVector4D farPoint = inverse * QVector4D(ndcX, ndcY, 1.0f, 1.0f);
+    if (qFuzzyIsNull(nearPoint.w()) || qFuzzyIsNull(farPoint.w())) return false;
+
+    const QVector3D nearWorld = nearPoint.toVector3DAffine();
+    const QVector3D farWorld = farPoint.toVector3DAffine();
+
+    *origin = nearWorld;
+    *direction = (farWorld - nearWorld).normalized();
+    return true;
+}
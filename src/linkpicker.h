@@ -0,0 +1,128 @@
+#ifndef LINKPICKER_H
+#define LINKPICKER_H
+
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+#include <QMatrix4x4>
+#include <QPointF>
+#include <QSizeF>
+#include <QPointer>
+
+class RobotEntity;
+class LinkEntity;
+
+namespace Qt3DCore {
+class QEntity;
+}
+
+namespace Qt3DRender {
+class QGeometryRenderer;
+}
+
+/**
+ * @brief 单个Link的三角形包围体层次（BVH）
+ * 三角形存储在Link局部坐标系中，关节运动后无需重建。
+ */
+class TriangleBvh
+{
+public:
+    struct Triangle {
+        QVector3D v0;
+        QVector3D v1;
+        QVector3D v2;
+    };
+
+    /**
+     * @brief 由三角形集合构建BVH（会重排三角形顺序）
+     */
+    void build(QVector<Triangle> triangles);
+
+    void clear();
+    bool isEmpty() const { return m_nodes.isEmpty(); }
+    int triangleCount() const { return m_triangles.size(); }
+
+    /**
+     * @brief 射线求交
+     * @param origin 射线起点
+     * @param direction 射线方向（无需单位化，t按该方向长度计）
+     * @param maxT 只接受 t < maxT 的交点
+     * @param hitT 输出最近交点参数
+     * @return 是否相交
+     */
+    bool intersect(const QVector3D& origin, const QVector3D& direction,
+                   float maxT, float* hitT) const;
+
+private:
+    struct Node {
+        QVector3D boundsMin;
+        QVector3D boundsMax;
+        int first = 0;   // 叶节点：首个三角形下标；内部节点：左子节点下标（右子节点紧随其后）
+        int count = 0;   // 叶节点三角形数量，0表示内部节点
+    };
+
+    void buildNode(int nodeIndex, const QVector<Triangle>& source, QVector<int>& order,
+                   const QVector<QVector3D>& centroids, int begin, int end, int depth);
+
+    QVector<Triangle> m_triangles;
+    QVector<Node> m_nodes;
+};
+
+/**
+ * @brief Link拾取服务
+ * 加载完成后为每个Link构建一次BVH，拾取时把视口射线变换到
+ * 各Link的局部坐标系（使用当前正运动学位姿）再求交。
+ */
+class LinkPicker
+{
+public:
+    struct PickResult {
+        QString linkName;
+        float distance = -1.0f;     // 沿世界射线方向的距离
+        QVector3D worldPosition;
+
+        bool isValid() const { return !linkName.isEmpty(); }
+    };
+
+    /**
+     * @brief 为机器人的所有Link构建BVH
+     */
+    void build(RobotEntity* robot);
+
+    void clear();
+
+    bool isEmpty() const { return m_links.isEmpty(); }
+
+    /**
+     * @brief 世界坐标射线拾取
+     */
+    PickResult pick(const QVector3D& origin, const QVector3D& direction) const;
+
+    /**
+     * @brief 由视口坐标构造世界坐标射线
+     * @param viewProjection 相机的 projection * view 矩阵
+     * @param position 视口像素坐标（左上角为原点）
+     * @param viewportSize 视口尺寸
+     */
+    static bool viewportRay(const QMatrix4x4& viewProjection, const QPointF& position,
+                            const QSizeF& viewportSize, QVector3D* origin, QVector3D* direction);
+
+private:
+    struct LinkBvh {
+        QString linkName;
+        QPointer<LinkEntity> entity;
+        TriangleBvh bvh;
+    };
+
+    static void collectTriangles(Qt3DCore::QEntity* entity, const QMatrix4x4& toLink,
+                                 QVector<TriangleBvh::Triangle>& triangles);
+    static bool appendBufferTriangles(Qt3DRender::QGeometryRenderer* renderer, const QMatrix4x4& toLink,
+                                      QVector<TriangleBvh::Triangle>& triangles);
+    static bool appendPrimitiveTriangles(Qt3DRender::QGeometryRenderer* renderer, const QMatrix4x4& toLink,
+                                         QVector<TriangleBvh::Triangle>& triangles);
+    static QMatrix4x4 worldMatrix(Qt3DCore::QEntity* entity);
+
+    QVector<LinkBvh> m_links;
+};
+
+#endif // LINKPICKER_H
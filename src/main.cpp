@@ -8,14 +8,36 @@
 #include <QSurfaceFormat>
 #include <QDebug>
 #include <Qt3DCore/QEntity>
+#include <memory>
 
 #include "robotbridge.h"
 #include "orbitcameracontroller.h"
+#include "snapshotbatch.h"
+#include "stresstest.h"
+#include "performancemonitor.h"
+#include "tracelog.h"
 
 #pragma execution_character_set("utf-8")
 
 int main(int argc, char *argv[])
 {
+    // 启动与加载阶段跟踪（--trace <file.json> 或环境变量 ROBOTVIEWER_TRACE）
+    TraceLog::startFromArguments(argc, argv);
+    
+    // 无界面批量截图模式：不创建QML界面，直接离屏渲染后退出
+    if (SnapshotBatch::isRequested(argc, argv)) {
+        const int exitCode = SnapshotBatch::run(argc, argv);
+        TraceLog::finish();
+        return exitCode;
+    }
+    
+    // 合成工作负载生成 / 压力测试模式：独立Qt3D窗口，按秒报告帧时间与内存
+    if (StressTest::isRequested(argc, argv)) {
+        const int exitCode = StressTest::run(argc, argv);
+        TraceLog::finish();
+        return exitCode;
+    }
+    
     // 启用高DPI缩放
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
@@ -30,7 +52,10 @@ int main(int argc, char *argv[])
     format.setSamples(4);
     QSurfaceFormat::setDefaultFormat(format);
     
+    const qint64 appStartUs = TraceLog::nowUs();
     QApplication app(argc, argv);
+    TraceLog::addComplete("QApplication", appStartUs, TraceLog::nowUs() - appStartUs);
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, []() { TraceLog::finish(); });
     
     // 设置应用信息
     app.setApplicationName("RobotViewer");
@@ -53,7 +78,10 @@ int main(int argc, char *argv[])
     
     // 创建机器人桥接对象
     RobotBridge robotBridge;
-    robotBridge.initialize();
+    {
+        TRACE_SCOPE("RobotBridge::initialize");
+        robotBridge.initialize();
+    }
     
     // 创建QML引擎
     QQmlApplicationEngine engine;
@@ -72,6 +100,10 @@ int main(int argc, char *argv[])
     // 注册自定义 OrbitCameraController
     qmlRegisterType<OrbitCameraController>("RobotViewer", 1, 0, "CustomOrbitCameraController");
     
+    // 注册性能监视器（通过 robotBridge.performance 访问）
+    qmlRegisterUncreatableType<PerformanceMonitor>("RobotViewer", 1, 0, "PerformanceMonitor",
+                                                   "PerformanceMonitor is provided by RobotBridge");
+    
     // 加载主QML文件
     const QUrl url(QStringLiteral("qrc:/qml/main.qml"));
     
@@ -86,12 +118,27 @@ int main(int argc, char *argv[])
         qDebug() << "QML界面加载成功";
     }, Qt::QueuedConnection);
     
-    engine.load(url);
+    {
+        TRACE_SCOPE("QQmlApplicationEngine::load");
+        engine.load(url);
+    }
     
     // 检查是否加载成功
     if (engine.rootObjects().isEmpty()) {
         qWarning() << "无法加载QML界面，请检查qml文件是否正确";
         // 仍然运行程序，让用户看到控制台输出
+    } else if (auto window = qobject_cast<QQuickWindow*>(engine.rootObjects().first())) {
+        // 测量主窗口帧时间
+        robotBridge.attachWindow(window);
+        
+        // 首帧显示（在渲染线程上记录）
+        if (TraceLog::isEnabled()) {
+            auto firstFrame = std::make_shared<QMetaObject::Connection>();
+            *firstFrame = QObject::connect(window, &QQuickWindow::frameSwapped, window, [firstFrame]() {
+                TraceLog::addInstant("first frame");
+                QObject::disconnect(*firstFrame);
+            }, Qt::DirectConnection);
+        }
     }
     
     return app.exec();
@@ -0,0 +1,35 @@
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector3D>
+
+/**
+ * @brief 导入阶段耗时（read、各后处理步骤、convert等）
+ */
+struct ImportStageTiming {
+    QString stage;
+    double msec = 0.0;
+};
+
+/**
+ * @brief 原生网格加载器的输出
+ * 顶点为交错的 位置(3f) + 法线(3f)，索引为32位无符号整数，
+ * 可直接作为Qt3D缓冲区数据，无需再逐元素转换。
+ */
+struct MeshData {
+    static const int kVertexStride = 6 * sizeof(float);
+    static const int kNormalOffset = 3 * sizeof(float);
+
+    QByteArray vertices;
+    QByteArray indices;
+    int vertexCount = 0;
+    int indexCount = 0;
+    QVector3D boundsMin;
+    QVector3D boundsMax;
+
+    bool isEmpty() const { return indexCount == 0; }
+};
+
+#endif // MESHDATA_H
@@ -0,0 +1,176 @@
+﻿#include "offscreenrenderer.h"
+
+#include <QOffscreenSurface>
+#include <QSurfaceFormat>
+#include <Qt3DCore/QAspectEngine>
+#include <Qt3DRender/QRenderAspect>
+#include <Qt3DRender/QRenderSettings>
+#include <Qt3DRender/QRenderSurfaceSelector>
+#include <Qt3DRender/QRenderTargetSelector>
+#include <Qt3DRender/QRenderTarget>
+#include <Qt3DRender/QRenderTargetOutput>
+#include <Qt3DRender/QTexture>
+#include <Qt3DRender/QViewport>
+#include <Qt3DRender/QClearBuffers>
+#include <Qt3DRender/QCameraSelector>
+#include <Qt3DRender/QCamera>
+#include <Qt3DRender/QCameraLens>
+#include <Qt3DRender/QRenderCapture>
+#include <Qt3DRender/QTechniqueFilter>
+#include <Qt3DRender/QFilterKey>
+#include <Qt3DLogic/QLogicAspect>
+#include <QDebug>
+
+OffscreenRenderer::OffscreenRenderer(const QSize& size, QObject* parent)
+    : QObject(parent)
+    , m_size(size)
+{
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    // 先让方面引擎释放场景（会销毁根实体），再销毁Surface
+    if (m_aspectEngine) {
+        m_aspectEngine->setRootEntity(Qt3DCore::QEntityPtr());
+        delete m_aspectEngine;
+        m_aspectEngine = nullptr;
+    }
+
+    delete m_surface;
+    m_surface = nullptr;
+}
+
+bool OffscreenRenderer::initialize()
+{
+    if (m_aspectEngine) return true;
+
+    // 离屏Surface，格式沿用全局默认格式（Mesa软件渲染时为3.3 Core）
+    m_surface = new QOffscreenSurface();
+    m_surface->setFormat(QSurfaceFormat::defaultFormat());
+    m_surface->create();
+    if (!m_surface->isValid()) {
+        m_errorMessage = tr("无法创建离屏Surface，请检查OpenGL驱动或 QT_QPA_PLATFORM 设置");
+        qWarning() << "OffscreenRenderer:" << m_errorMessage;
+        return false;
+    }
+
+    m_rootEntity = new Qt3DCore::QEntity();
+    m_rootEntity->setObjectName("OffscreenRoot");
+
+    m_sceneRoot = new Qt3DCore::QEntity(m_rootEntity);
+    m_sceneRoot->setObjectName("OffscreenSceneRoot");
+
+    // 与QML中的主相机保持一致的镜头参数
+    m_camera = new Qt3DRender::QCamera(m_rootEntity);
+    m_camera->lens()->setPerspectiveProjection(45.0f,
+                                               float(m_size.width()) / float(qMax(1, m_size.height())),
+                                               0.01f, 1000.0f);
+    m_camera->setPosition(QVector3D(2.0f, 1.5f, 2.0f));
+    m_camera->setUpVector(QVector3D(0.0f, 1.0f, 0.0f));
+    m_camera->setViewCenter(QVector3D(0.0f, 0.0f, 0.0f));
+
+    createFrameGraph();
+
+    m_aspectEngine = new Qt3DCore::QAspectEngine(this);
+    m_renderAspect = new Qt3DRender::QRenderAspect(Qt3DRender::QRenderAspect::Threaded);
+    m_logicAspect = new Qt3DLogic::QLogicAspect();
+    m_aspectEngine->registerAspect(m_renderAspect);
+    m_aspectEngine->registerAspect(m_logicAspect);
+    m_aspectEngine->setRootEntity(Qt3DCore::QEntityPtr(m_rootEntity));
+
+    qDebug() << "OffscreenRenderer: 初始化完成" << m_size;
+    return true;
+}
+
+void OffscreenRenderer::createFrameGraph()
+{
+    m_renderSettings = new Qt3DRender::QRenderSettings(m_rootEntity);
+    // 持续渲染：截图请求会在下一帧被满足，不依赖场景是否变脏
+    m_renderSettings->setRenderPolicy(Qt3DRender::QRenderSettings::Always);
+    m_rootEntity->addComponent(m_renderSettings);
+
+    // 帧图：Surface -> 纹理渲染目标 -> 视口 -> 清屏 -> 相机 -> 技术筛选 -> 截图
+    m_surfaceSelector = new Qt3DRender::QRenderSurfaceSelector();
+    m_surfaceSelector->setSurface(m_surface);
+    m_surfaceSelector->setExternalRenderTargetSize(m_size);
+
+    Qt3DRender::QRenderTargetSelector* targetSelector =
+        new Qt3DRender::QRenderTargetSelector(m_surfaceSelector);
+    Qt3DRender::QRenderTarget* renderTarget = new Qt3DRender::QRenderTarget(targetSelector);
+
+    Qt3DRender::QRenderTargetOutput* colorOutput = new Qt3DRender::QRenderTargetOutput(renderTarget);
+    colorOutput->setAttachmentPoint(Qt3DRender::QRenderTargetOutput::Color0);
+    Qt3DRender::QTexture2D* colorTexture = new Qt3DRender::QTexture2D(colorOutput);
+    colorTexture->setSize(m_size.width(), m_size.height());
+    colorTexture->setFormat(Qt3DRender::QAbstractTexture::RGBA8_UNorm);
+    colorTexture->setMinificationFilter(Qt3DRender::QAbstractTexture::Linear);
+    colorTexture->setMagnificationFilter(Qt3DRender::QAbstractTexture::Linear);
+    colorOutput->setTexture(colorTexture);
+    renderTarget->addOutput(colorOutput);
+
+    Qt3DRender::QRenderTargetOutput* depthOutput = new Qt3DRender::QRenderTargetOutput(renderTarget);
+    depthOutput->setAttachmentPoint(Qt3DRender::QRenderTargetOutput::Depth);
+    Qt3DRender::QTexture2D* depthTexture = new Qt3DRender::QTexture2D(depthOutput);
+    depthTexture->setSize(m_size.width(), m_size.height());
+    depthTexture->setFormat(Qt3DRender::QAbstractTexture::D24);
+    depthTexture->setMinificationFilter(Qt3DRender::QAbstractTexture::Nearest);
+    depthTexture->setMagnificationFilter(Qt3DRender::QAbstractTexture::Nearest);
+    depthOutput->setTexture(depthTexture);
+    renderTarget->addOutput(depthOutput);
+
+    targetSelector->setTarget(renderTarget);
+
+    Qt3DRender::QViewport* viewport = new Qt3DRender::QViewport(targetSelector);
+    viewport->setNormalizedRect(QRectF(0.0, 0.0, 1.0, 1.0));
+
+    m_clearBuffers = new Qt3DRender::QClearBuffers(viewport);
+    m_clearBuffers->setBuffers(Qt3DRender::QClearBuffers::ColorDepthBuffer);
+    m_clearBuffers->setClearColor(QColor(10, 10, 21));
+
+    Qt3DRender::QCameraSelector* cameraSelector = new Qt3DRender::QCameraSelector(m_clearBuffers);
+    cameraSelector->setCamera(m_camera);
+
+    // 与 ForwardRenderer 相同的技术筛选，保证Phong等默认材质选择前向渲染技术
+    Qt3DRender::QTechniqueFilter* techniqueFilter = new Qt3DRender::QTechniqueFilter(cameraSelector);
+    Qt3DRender::QFilterKey* forwardKey = new Qt3DRender::QFilterKey(techniqueFilter);
+    forwardKey->setName(QStringLiteral("renderingStyle"));
+    forwardKey->setValue(QStringLiteral("forward"));
+    techniqueFilter->addMatch(forwardKey);
+
+    m_renderCapture = new Qt3DRender::QRenderCapture(techniqueFilter);
+
+    m_renderSettings->setActiveFrameGraph(m_surfaceSelector);
+}
+
+void OffscreenRenderer::setClearColor(const QColor& color)
+{
+    if (m_clearBuffers) {
+        m_clearBuffers->setClearColor(color);
+    }
+}
+
+int OffscreenRenderer::requestCapture()
+{
+    if (!m_renderCapture) return -1;
+
+    Qt3DRender::QRenderCaptureReply* reply = m_renderCapture->requestCapture();
+    const int captureId = m_nextCaptureId++;
+    m_pendingReplies.insert(reply, captureId);
+    connect(reply, &Qt3DRender::QRenderCaptureReply::completed,
+            this, &OffscreenRenderer::onCaptureCompleted);
+    return captureId;
+}
+
+void OffscreenRenderer::onCaptureCompleted()
+{
+    Qt3DRender::QRenderCaptureReply* reply =
+        qobject_cast<Qt3DRender::QRenderCaptureReply*>(sender());
+    if (!reply) return;
+
+    const int captureId = m_pendingReplies.take(reply);
+    // 回读的图像与渲染目标格式一致，统一转换为便于保存的格式
+    const QImage image = reply->image().convertToFormat(QImage::Format_RGB32);
+    reply->deleteLater();
+
+    emit captureCompleted(captureId, image);
+}
@@ -0,0 +1,106 @@
+﻿#ifndef OFFSCREENRENDERER_H
+#define OFFSCREENRENDERER_H
+
+#include <QObject>
+#include <QSize>
+#include <QColor>
+#include <QImage>
+#include <QHash>
+#include <Qt3DCore/QEntity>
+
+class QOffscreenSurface;
+
+namespace Qt3DCore {
+class QAspectEngine;
+}
+
+namespace Qt3DRender {
+class QCamera;
+class QRenderAspect;
+class QRenderSettings;
+class QRenderCapture;
+class QRenderCaptureReply;
+class QRenderSurfaceSelector;
+class QClearBuffers;
+class QTexture2D;
+}
+
+namespace Qt3DLogic {
+class QLogicAspect;
+}
+
+/**
+ * @brief 离屏渲染器
+ * 不依赖QML/窗口，自行创建Qt3D方面引擎和离屏Surface，
+ * 场景渲染到纹理后通过QRenderCapture回读为QImage。
+ * 帧图与已加载的几何体在多次截图之间复用。
+ */
+class OffscreenRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OffscreenRenderer(const QSize& size, QObject* parent = nullptr);
+    ~OffscreenRenderer();
+
+    /**
+     * @brief 创建离屏Surface、方面引擎和帧图
+     * @return 是否成功（无可用OpenGL时失败）
+     */
+    bool initialize();
+
+    /**
+     * @brief 场景挂载点（RobotScene::setSceneRoot 的参数）
+     */
+    Qt3DCore::QEntity* sceneRoot() const { return m_sceneRoot; }
+
+    /**
+     * @brief 渲染使用的相机
+     */
+    Qt3DRender::QCamera* camera() const { return m_camera; }
+
+    QSize size() const { return m_size; }
+
+    /**
+     * @brief 设置背景色
+     */
+    void setClearColor(const QColor& color);
+
+    /**
+     * @brief 请求截取下一帧
+     * @return 截图ID，完成后通过 captureCompleted 返回
+     */
+    int requestCapture();
+
+    QString getErrorMessage() const { return m_errorMessage; }
+
+signals:
+    void captureCompleted(int captureId, const QImage& image);
+
+private slots:
+    void onCaptureCompleted();
+
+private:
+    void createFrameGraph();
+
+    QSize m_size;
+    QString m_errorMessage;
+
+    QOffscreenSurface* m_surface = nullptr;
+    Qt3DCore::QAspectEngine* m_aspectEngine = nullptr;
+    Qt3DRender::QRenderAspect* m_renderAspect = nullptr;
+    Qt3DLogic::QLogicAspect* m_logicAspect = nullptr;
+
+    Qt3DCore::QEntity* m_rootEntity = nullptr;   // 由方面引擎持有
+    Qt3DCore::QEntity* m_sceneRoot = nullptr;    // 场景内容挂载点
+    Qt3DRender::QCamera* m_camera = nullptr;
+    Qt3DRender::QRenderSettings* m_renderSettings = nullptr;
+    Qt3DRender::QRenderSurfaceSelector* m_surfaceSelector = nullptr;
+    Qt3DRender::QClearBuffers* m_clearBuffers = nullptr;
+    Qt3DRender::QRenderCapture* m_renderCapture = nullptr;
+
+    QHash<Qt3DRender::QRenderCaptureReply*, int> m_pendingReplies;
+    int m_nextCaptureId = 1;
+};
+
+#endif // OFFSCREENRENDERER_H
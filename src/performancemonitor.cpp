@@ -0,0 +1,306 @@
+﻿#include "performancemonitor.h"
+#include "robotentity.h"
+
+#include <QQuickWindow>
+#include <QTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QMutexLocker>
+#include <Qt3DCore/QEntity>
+#include <Qt3DRender/QGeometryRenderer>
+#include <Qt3DRender/QGeometry>
+#include <Qt3DRender/QAttribute>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// 已排序数组的分位数（最近秩）
+double percentile(const QVector<float>& sorted, double p)
+{
+    if (sorted.isEmpty()) return 0.0;
+    int index = static_cast<int>(p * (sorted.size() - 1) + 0.5);
+    index = qBound(0, index, sorted.size() - 1);
+    return sorted.at(index);
+}
+
+} // namespace
+
+PerformanceMonitor::PerformanceMonitor(QObject* parent)
+    : QObject(parent)
+{
+    m_frameTimes.resize(kFrameWindow);
+    m_rateClock.start();
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(kRefreshInterval);
+    connect(m_refreshTimer, &QTimer::timeout, this, &PerformanceMonitor::refresh);
+    m_refreshTimer->start();
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+}
+
+void PerformanceMonitor::attachWindow(QQuickWindow* window)
+{
+    if (!window) return;
+
+    // 线程化渲染循环下 frameSwapped 在渲染线程发出，直接连接并在回调中加锁
+    connect(window, &QQuickWindow::frameSwapped,
+            this, &PerformanceMonitor::onFrameSwapped, Qt::DirectConnection);
+}
+
+void PerformanceMonitor::attachRobot(RobotEntity* robot)
+{
+    if (!robot) return;
+
+    connect(robot, &RobotEntity::jointValuesUpdated,
+            this, &PerformanceMonitor::onJointValuesUpdated, Qt::UniqueConnection);
+    connect(robot, &RobotEntity::trajectorySampled,
+            this, &PerformanceMonitor::onTrajectorySampled, Qt::UniqueConnection);
+}
+
+void PerformanceMonitor::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+
+    if (m_enabled) {
+        refresh();
+    }
+    emit enabledChanged();
+}
+
+void PerformanceMonitor::onFrameSwapped()
+{
+    QMutexLocker locker(&m_frameMutex);
+
+    if (!m_frameClock.isValid()) {
+        m_frameClock.start();
+        return;
+    }
+
+    const qint64 nsec = m_frameClock.nsecsElapsed();
+    m_frameClock.restart();
+
+    m_frameTimes[m_frameWriteIndex] = static_cast<float>(nsec / 1.0e6);
+    m_frameWriteIndex = (m_frameWriteIndex + 1) % kFrameWindow;
+    m_frameCount = qMin(m_frameCount + 1, kFrameWindow);
+    ++m_framesSinceRefresh;
+}
+
+void PerformanceMonitor::onJointValuesUpdated()
+{
+    ++m_jointUpdates;
+}
+
+void PerformanceMonitor::onTrajectorySampled()
+{
+    ++m_trajectorySamples;
+}
+
+void PerformanceMonitor::recordOpcuaLatency(qint64 usec)
+{
+    m_opcuaLatencySum += usec;
+    m_opcuaLatencyPeak = qMax(m_opcuaLatencyPeak, usec);
+    ++m_opcuaSamples;
+}
+
+void PerformanceMonitor::refresh()
+{
+    const double seconds = qMax<qint64>(1, m_rateClock.restart()) / 1000.0;
+
+    updateFrameStats(seconds);
+
+    // 频率统计
+    m_jointUpdateRate = m_jointUpdates / seconds;
+    m_trajectorySampleRate = m_trajectorySamples / seconds;
+    m_jointUpdates = 0;
+    m_trajectorySamples = 0;
+
+    if (m_opcuaSamples > 0) {
+        m_opcuaLatency = m_opcuaLatencySum / 1000.0 / m_opcuaSamples;
+        m_opcuaLatencyMax = m_opcuaLatencyPeak / 1000.0;
+    } else {
+        m_opcuaLatency = 0.0;
+        m_opcuaLatencyMax = 0.0;
+    }
+    m_opcuaLatencySum = 0;
+    m_opcuaLatencyPeak = 0;
+    m_opcuaSamples = 0;
+
+    // 计数器在重新连接（更换连接器）后从0开始
+    const quint64 wakeups = m_opcuaWakeupCounter ? m_opcuaWakeupCounter() : 0;
+    m_opcuaWakeupRate = wakeups >= m_opcuaWakeups ? (wakeups - m_opcuaWakeups) / seconds : 0.0;
+    m_opcuaWakeups = wakeups;
+
+    // 场景遍历和历史记录只在叠加层打开时进行
+    if (m_enabled) {
+        updateSceneStats();
+        appendHistory();
+    }
+
+    emit statsChanged();
+}
+
+void PerformanceMonitor::updateFrameStats(double seconds)
+{
+    QVector<float> samples;
+    int framesSinceRefresh = 0;
+    qint64 sinceLastFrame = 0;
+    {
+        QMutexLocker locker(&m_frameMutex);
+        samples = m_frameTimes.mid(0, m_frameCount);
+        framesSinceRefresh = m_framesSinceRefresh;
+        m_framesSinceRefresh = 0;
+        sinceLastFrame = m_frameClock.isValid() ? m_frameClock.elapsed() : 0;
+    }
+
+    // 窗口长时间未刷新时（最小化/场景静止）不保留过期数据
+    if (samples.isEmpty() || sinceLastFrame > 2 * kRefreshInterval) {
+        m_fps = 0.0;
+        m_frameTimeP50 = m_frameTimeP95 = m_frameTimeP99 = m_frameTimeMax = 0.0;
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    m_frameTimeP50 = percentile(samples, 0.50);
+    m_frameTimeP95 = percentile(samples, 0.95);
+    m_frameTimeP99 = percentile(samples, 0.99);
+    m_frameTimeMax = samples.last();
+    m_fps = framesSinceRefresh / seconds;
+}
+
+void PerformanceMonitor::updateSceneStats()
+{
+    int drawCalls = 0;
+    qint64 triangles = 0;
+    qint64 vertices = 0;
+    int entities = 0;
+
+    if (m_sceneRoot) {
+        // 深度优先遍历，记录祖先是否启用（被禁用的子树不会被渲染）
+        QVector<QPair<Qt3DCore::QEntity*, bool>> stack;
+        stack.append(qMakePair(m_sceneRoot, true));
+
+        while (!stack.isEmpty()) {
+            const auto item = stack.takeLast();
+            Qt3DCore::QEntity* entity = item.first;
+            const bool active = item.second && entity->isEnabled();
+            ++entities;
+
+            for (QObject* child : entity->children()) {
+                if (auto childEntity = qobject_cast<Qt3DCore::QEntity*>(child)) {
+                    stack.append(qMakePair(childEntity, active));
+                }
+            }
+
+            if (!active) continue;
+
+            const auto renderers = entity->componentsOfType<Qt3DRender::QGeometryRenderer>();
+            for (Qt3DRender::QGeometryRenderer* renderer : renderers) {
+                Qt3DRender::QGeometry* geometry = renderer->geometry();
+                if (!renderer->isEnabled() || !geometry) continue;
+
+                Qt3DRender::QAttribute* indexAttribute = nullptr;
+                Qt3DRender::QAttribute* positionAttribute = nullptr;
+                for (Qt3DRender::QAttribute* attribute : geometry->attributes()) {
+                    if (attribute->attributeType() == Qt3DRender::QAttribute::IndexAttribute) {
+                        indexAttribute = attribute;
+                    } else if (attribute->name() == Qt3DRender::QAttribute::defaultPositionAttributeName()) {
+                        positionAttribute = attribute;
+                    }
+                }
+
+                const qint64 vertexCount = positionAttribute ? positionAttribute->count() : 0;
+                qint64 elementCount = renderer->vertexCount();
+                if (elementCount <= 0) {
+                    elementCount = indexAttribute ? indexAttribute->count() : vertexCount;
+                }
+                const int instances = qMax(1, renderer->instanceCount());
+
+                qint64 primitiveTriangles = 0;
+                switch (renderer->primitiveType()) {
+                case Qt3DRender::QGeometryRenderer::Triangles:
+                    primitiveTriangles = elementCount / 3;
+                    break;
+                case Qt3DRender::QGeometryRenderer::TriangleStrip:
+                case Qt3DRender::QGeometryRenderer::TriangleFan:
+                    primitiveTriangles = qMax<qint64>(0, elementCount - 2);
+                    break;
+                default:
+                    break;
+                }
+
+                ++drawCalls;
+                triangles += primitiveTriangles * instances;
+                vertices += vertexCount * instances;
+            }
+        }
+    }
+
+    m_drawCalls = drawCalls;
+    m_triangleCount = triangles;
+    m_vertexCount = vertices;
+    m_entityCount = entities;
+}
+
+void PerformanceMonitor::appendHistory()
+{
+    HistoryRow row;
+    row.time = QDateTime::currentDateTime();
+    row.fps = m_fps;
+    row.p50 = m_frameTimeP50;
+    row.p95 = m_frameTimeP95;
+    row.p99 = m_frameTimeP99;
+    row.drawCalls = m_drawCalls;
+    row.triangles = m_triangleCount;
+    row.vertices = m_vertexCount;
+    row.entities = m_entityCount;
+    row.jointRate = m_jointUpdateRate;
+    row.trajectoryRate = m_trajectorySampleRate;
+    row.opcuaLatency = m_opcuaLatency;
+    row.opcuaWakeupRate = m_opcuaWakeupRate;
+
+    m_history.append(row);
+    if (m_history.size() > kMaxHistory) {
+        m_history.remove(0, m_history.size() - kMaxHistory);
+    }
+}
+
+void PerformanceMonitor::clearHistory()
+{
+    m_history.clear();
+}
+
+bool PerformanceMonitor::exportCsv(const QString& filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "PerformanceMonitor: 无法写入" << filePath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "time,fps,frame_p50_ms,frame_p95_ms,frame_p99_ms,draw_calls,triangles,vertices,"
+           "entities,joint_updates_per_s,trajectory_samples_per_s,opcua_latency_ms,opcua_wakeups_per_s\n";
+
+    for (const HistoryRow& row : m_history) {
+        out << row.time.toString(Qt::ISODateWithMs) << ','
+            << QString::number(row.fps, 'f', 1) << ','
+            << QString::number(row.p50, 'f', 3) << ','
+            << QString::number(row.p95, 'f', 3) << ','
+            << QString::number(row.p99, 'f', 3) << ','
+            << row.drawCalls << ','
+            << row.triangles << ','
+            << row.vertices << ','
+            << row.entities << ','
+            << QString::number(row.jointRate, 'f', 1) << ','
+            << QString::number(row.trajectoryRate, 'f', 1) << ','
+            << QString::number(row.opcuaLatency, 'f', 3) << ','
+            << QString::number(row.opcuaWakeupRate, 'f', 1) << '\n';
+    }
+
+    return true;
+}
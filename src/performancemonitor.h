@@ -0,0 +1,188 @@
+#ifndef PERFORMANCEMONITOR_H
+#define PERFORMANCEMONITOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <functional>
+
+class QQuickWindow;
+class QTimer;
+class RobotEntity;
+
+namespace Qt3DCore {
+class QEntity;
+}
+
+/**
+ * @brief 性能监视器
+ * 统计帧时间分位数、场景规模（绘制调用/三角形/顶点/实体数）
+ * 以及关节更新、轨迹采样、OPC UA采样延迟与客户端循环唤醒次数等运行指标，
+ * 供QML性能叠加层显示并可导出为CSV。
+ */
+class PerformanceMonitor : public QObject
+{
+    Q_OBJECT
+
+    // 开启后才统计场景规模并记录历史（叠加层可见时开启）
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+
+    // 帧时间（毫秒）
+    Q_PROPERTY(double fps READ fps NOTIFY statsChanged)
+    Q_PROPERTY(double frameTimeP50 READ frameTimeP50 NOTIFY statsChanged)
+    Q_PROPERTY(double frameTimeP95 READ frameTimeP95 NOTIFY statsChanged)
+    Q_PROPERTY(double frameTimeP99 READ frameTimeP99 NOTIFY statsChanged)
+    Q_PROPERTY(double frameTimeMax READ frameTimeMax NOTIFY statsChanged)
+
+    // 场景规模
+    Q_PROPERTY(int drawCalls READ drawCalls NOTIFY statsChanged)
+    Q_PROPERTY(qint64 triangleCount READ triangleCount NOTIFY statsChanged)
+    Q_PROPERTY(qint64 vertexCount READ vertexCount NOTIFY statsChanged)
+    Q_PROPERTY(int entityCount READ entityCount NOTIFY statsChanged)
+
+    // 更新频率（次/秒）与OPC UA采样延迟（毫秒）
+    Q_PROPERTY(double jointUpdateRate READ jointUpdateRate NOTIFY statsChanged)
+    Q_PROPERTY(double trajectorySampleRate READ trajectorySampleRate NOTIFY statsChanged)
+    Q_PROPERTY(double opcuaLatency READ opcuaLatency NOTIFY statsChanged)
+    Q_PROPERTY(double opcuaLatencyMax READ opcuaLatencyMax NOTIFY statsChanged)
+    Q_PROPERTY(double opcuaWakeupRate READ opcuaWakeupRate NOTIFY statsChanged)
+
+public:
+    explicit PerformanceMonitor(QObject* parent = nullptr);
+    ~PerformanceMonitor();
+
+    /**
+     * @brief 监听窗口的帧交换信号以测量帧时间
+     */
+    void attachWindow(QQuickWindow* window);
+
+    /**
+     * @brief 设置统计场景规模的根实体
+     */
+    void setSceneRoot(Qt3DCore::QEntity* root) { m_sceneRoot = root; }
+
+    /**
+     * @brief 监听机器人实体的关节更新与轨迹采样
+     */
+    void attachRobot(RobotEntity* robot);
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    double fps() const { return m_fps; }
+    double frameTimeP50() const { return m_frameTimeP50; }
+    double frameTimeP95() const { return m_frameTimeP95; }
+    double frameTimeP99() const { return m_frameTimeP99; }
+    double frameTimeMax() const { return m_frameTimeMax; }
+
+    int drawCalls() const { return m_drawCalls; }
+    qint64 triangleCount() const { return m_triangleCount; }
+    qint64 vertexCount() const { return m_vertexCount; }
+    int entityCount() const { return m_entityCount; }
+
+    double jointUpdateRate() const { return m_jointUpdateRate; }
+    double trajectorySampleRate() const { return m_trajectorySampleRate; }
+    double opcuaLatency() const { return m_opcuaLatency; }
+    double opcuaLatencyMax() const { return m_opcuaLatencyMax; }
+    double opcuaWakeupRate() const { return m_opcuaWakeupRate; }
+
+    /**
+     * @brief 记录一次OPC UA采样耗时
+     * @param usec 微秒
+     */
+    void recordOpcuaLatency(qint64 usec);
+
+    /**
+     * @brief 设置OPC UA客户端循环累计唤醒次数的来源，刷新时换算为每秒次数
+     */
+    void setOpcuaWakeupCounter(std::function<quint64()> counter) { m_opcuaWakeupCounter = counter; }
+
+    /**
+     * @brief 导出历史记录为CSV
+     */
+    Q_INVOKABLE bool exportCsv(const QString& filePath) const;
+
+    /**
+     * @brief 清空历史记录
+     */
+    Q_INVOKABLE void clearHistory();
+
+signals:
+    void enabledChanged();
+    void statsChanged();
+
+private slots:
+    void onFrameSwapped();
+    void onJointValuesUpdated();
+    void onTrajectorySampled();
+    void refresh();
+
+private:
+    void updateFrameStats(double seconds);
+    void updateSceneStats();
+    void appendHistory();
+
+    struct HistoryRow {
+        QDateTime time;
+        double fps;
+        double p50;
+        double p95;
+        double p99;
+        int drawCalls;
+        qint64 triangles;
+        qint64 vertices;
+        int entities;
+        double jointRate;
+        double trajectoryRate;
+        double opcuaLatency;
+        double opcuaWakeupRate;
+    };
+
+    static const int kFrameWindow = 240;       // 参与分位数统计的最近帧数
+    static const int kRefreshInterval = 500;   // 刷新周期（毫秒）
+    static const int kMaxHistory = 7200;       // 历史记录上限（约1小时）
+
+    bool m_enabled = false;
+    QTimer* m_refreshTimer = nullptr;
+    Qt3DCore::QEntity* m_sceneRoot = nullptr;
+
+    // 帧时间环形缓冲（帧交换可能发生在渲染线程）
+    mutable QMutex m_frameMutex;
+    QVector<float> m_frameTimes;
+    int m_frameWriteIndex = 0;
+    int m_frameCount = 0;
+    int m_framesSinceRefresh = 0;
+    QElapsedTimer m_frameClock;
+
+    // 计数器（主线程）
+    QElapsedTimer m_rateClock;
+    int m_jointUpdates = 0;
+    int m_trajectorySamples = 0;
+    qint64 m_opcuaLatencySum = 0;
+    qint64 m_opcuaLatencyPeak = 0;
+    int m_opcuaSamples = 0;
+    std::function<quint64()> m_opcuaWakeupCounter;
+    quint64 m_opcuaWakeups = 0;
+
+    // 最近一次统计结果
+    double m_fps = 0.0;
+    double m_frameTimeP50 = 0.0;
+    double m_frameTimeP95 = 0.0;
+    double m_frameTimeP99 = 0.0;
+    double m_frameTimeMax = 0.0;
+    int m_drawCalls = 0;
+    qint64 m_triangleCount = 0;
+    qint64 m_vertexCount = 0;
+    int m_entityCount = 0;
+    double m_jointUpdateRate = 0.0;
+    double m_trajectorySampleRate = 0.0;
+    double m_opcuaLatency = 0.0;
+    double m_opcuaLatencyMax = 0.0;
+    double m_opcuaWakeupRate = 0.0;
+
+    QVector<HistoryRow> m_history;
+};
+
+#endif // PERFORMANCEMONITOR_H
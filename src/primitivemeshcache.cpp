@@ -0,0 +1,136 @@
+﻿#include "primitivemeshcache.h"
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DExtras/QCuboidMesh>
+#include <Qt3DExtras/QCylinderMesh>
+#include <Qt3DExtras/QSphereMesh>
+#include <Qt3DRender/QCamera>
+#include <Qt3DRender/QLevelOfDetail>
+
+namespace {
+
+// 各细分级别的参数，0为最精细
+const int kCylinderSlices[PrimitiveMeshCache::kLodLevels] = { 48, 24, 12 };
+const int kSphereSlices[PrimitiveMeshCache::kLodLevels] = { 48, 24, 12 };
+const int kSphereRings[PrimitiveMeshCache::kLodLevels] = { 32, 16, 8 };
+
+// 切换阈值：包围球投影面积（像素数），降序
+const QVector<qreal> kLodThresholds = { 200.0 * 200.0, 40.0 * 40.0, 0.0 };
+
+} // namespace
+
+PrimitiveMeshCache::PrimitiveMeshCache(Qt3DCore::QNode* owner)
+    : QObject(owner)
+    , m_owner(owner)
+    , m_cylinders(kLodLevels, nullptr)
+    , m_spheres(kLodLevels, nullptr)
+{
+}
+
+PrimitiveMeshCache::~PrimitiveMeshCache()
+{
+}
+
+QMatrix4x4 PrimitiveMeshCache::unitTransform(const Geometry& geometry)
+{
+    QMatrix4x4 matrix;
+    switch (geometry.type) {
+    case GeometryType::Box:
+        matrix.scale(geometry.boxSize[0], geometry.boxSize[1], geometry.boxSize[2]);
+        break;
+    case GeometryType::Cylinder:
+        // URDF圆柱体沿Z轴，Qt3D圆柱沿Y轴：先按半径/长度缩放，再绕X轴旋转
+        matrix.rotate(90.0f, 1.0f, 0.0f, 0.0f);
+        matrix.scale(geometry.cylinderRadius, geometry.cylinderLength, geometry.cylinderRadius);
+        break;
+    case GeometryType::Sphere:
+        matrix.scale(geometry.sphereRadius);
+        break;
+    default:
+        break;
+    }
+    return matrix;
+}
+
+bool PrimitiveMeshCache::attach(Qt3DCore::QEntity* entity, const Geometry& geometry)
+{
+    if (geometry.type == GeometryType::Box) {
+        entity->addComponent(mesh(GeometryType::Box, 0));
+        return true;
+    }
+    if (geometry.type != GeometryType::Cylinder && geometry.type != GeometryType::Sphere) {
+        return false;
+    }
+
+    const GeometryType type = geometry.type;
+    Qt3DRender::QGeometryRenderer* initial = mesh(type, 0);
+    entity->addComponent(initial);
+
+    // 细分级别变化时替换共享网格组件
+    Qt3DRender::QLevelOfDetail* lod = new Qt3DRender::QLevelOfDetail(entity);
+    lod->setThresholdType(Qt3DRender::QLevelOfDetail::ProjectedScreenPixelSize);
+    lod->setThresholds(kLodThresholds);
+    lod->setCamera(m_camera);
+    lod->setCurrentIndex(0);
+    entity->addComponent(lod);
+    m_lods.append(lod);
+
+    connect(lod, &Qt3DRender::QLevelOfDetail::currentIndexChanged, entity,
+            [this, entity, type](int index) {
+                Qt3DRender::QGeometryRenderer* next = mesh(type, qBound(0, index, kLodLevels - 1));
+                const auto renderers = entity->componentsOfType<Qt3DRender::QGeometryRenderer>();
+                for (Qt3DRender::QGeometryRenderer* renderer : renderers) {
+                    if (renderer != next) entity->removeComponent(renderer);
+                }
+                if (!renderers.contains(next)) entity->addComponent(next);
+            });
+    return true;
+}
+
+void PrimitiveMeshCache::setCamera(Qt3DRender::QCamera* camera)
+{
+    m_camera = camera;
+    for (const auto& lod : m_lods) {
+        if (lod) lod->setCamera(camera);
+    }
+}
+
+void PrimitiveMeshCache::clear()
+{
+    m_lods.clear();
+}
+
+Qt3DRender::QGeometryRenderer* PrimitiveMeshCache::mesh(GeometryType type, int level)
+{
+    switch (type) {
+    case GeometryType::Box:
+        if (!m_box) {
+            Qt3DExtras::QCuboidMesh* box = new Qt3DExtras::QCuboidMesh(m_owner);
+            box->setXExtent(1.0f);
+            box->setYExtent(1.0f);
+            box->setZExtent(1.0f);
+            m_box = box;
+        }
+        return m_box;
+    case GeometryType::Cylinder:
+        if (!m_cylinders[level]) {
+            Qt3DExtras::QCylinderMesh* cylinder = new Qt3DExtras::QCylinderMesh(m_owner);
+            cylinder->setRadius(1.0f);
+            cylinder->setLength(1.0f);
+            cylinder->setSlices(kCylinderSlices[level]);
+            m_cylinders[level] = cylinder;
+        }
+        return m_cylinders[level];
+    case GeometryType::Sphere:
+        if (!m_spheres[level]) {
+            Qt3DExtras::QSphereMesh* sphere = new Qt3DExtras::QSphereMesh(m_owner);
+            sphere->setRadius(1.0f);
+            sphere->setSlices(kSphereSlices[level]);
+            sphere->setRings(kSphereRings[level]);
+            m_spheres[level] = sphere;
+        }
+        return m_spheres[level];
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef PRIMITIVEMESHCACHE_H
+#define PRIMITIVEMESHCACHE_H
+
+#include <QObject>
+#include <QList>
+#include <QMatrix4x4>
+#include <QPointer>
+#include <QVector>
+
+#include "urdfparser.h"
+
+namespace Qt3DCore {
+class QEntity;
+class QNode;
+}
+
+namespace Qt3DRender {
+class QCamera;
+class QGeometryRenderer;
+class QLevelOfDetail;
+}
+
+/**
+ * @brief URDF基本几何体（box/cylinder/sphere）的共享网格
+ * 所有基本几何体共用单位尺寸的网格，尺寸通过实体变换缩放；
+ * 圆柱和球体按屏幕投影大小在几个细分级别之间切换。
+ */
+class PrimitiveMeshCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int kLodLevels = 3;
+
+    /**
+     * @param owner 共享网格的父节点（需为所有使用该网格的实体的公共祖先）
+     */
+    explicit PrimitiveMeshCache(Qt3DCore::QNode* owner);
+    ~PrimitiveMeshCache();
+
+    /**
+     * @brief 为实体添加共享网格（圆柱/球体同时添加细分级别切换）
+     * @param entity 基本几何体实体
+     * @param geometry URDF几何描述
+     * @return 是否为支持的几何类型
+     */
+    bool attach(Qt3DCore::QEntity* entity, const Geometry& geometry);
+
+    /**
+     * @brief 单位网格到URDF几何尺寸的变换（含圆柱从Y轴到Z轴的旋转）
+     */
+    static QMatrix4x4 unitTransform(const Geometry& geometry);
+
+    /**
+     * @brief 设置用于计算屏幕投影大小的相机（为空时保持最高细分）
+     */
+    void setCamera(Qt3DRender::QCamera* camera);
+
+    /**
+     * @brief 释放细分切换记录（共享网格保留，供下次加载复用）
+     */
+    void clear();
+
+private:
+    Qt3DRender::QGeometryRenderer* mesh(GeometryType type, int level);
+
+    Qt3DCore::QNode* m_owner = nullptr;
+    QPointer<Qt3DRender::QCamera> m_camera;
+    Qt3DRender::QGeometryRenderer* m_box = nullptr;
+    QVector<Qt3DRender::QGeometryRenderer*> m_cylinders;   // 按细分级别，0为最精细
+    QVector<Qt3DRender::QGeometryRenderer*> m_spheres;
+    QList<QPointer<Qt3DRender::QLevelOfDetail>> m_lods;
+};
+
+#endif // PRIMITIVEMESHCACHE_H
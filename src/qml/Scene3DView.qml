@@ -12,7 +12,8 @@ Item {
     id: root
     
     property var robotBridge: null
-    property int fps: 60
+    // 实测帧率（由C++性能监视器统计）
+    readonly property int fps: robotBridge && robotBridge.performance ? Math.round(robotBridge.performance.fps) : 0
     
     // 场景状态属性（从robotBridge同步）
     property bool showGrid: robotBridge ? robotBridge.showGrid : true
@@ -69,6 +70,40 @@ Item {
                 zoomSpeed: 0.001
             }
             
+            // Link拾取：悬停高亮、单击选中（射线求交在C++中基于每个Link的BVH完成）
+            Entity {
+                id: pickingEntity
+                components: [
+                    MouseHandler {
+                        id: pickingMouseHandler
+                        sourceDevice: MouseDevice { }
+                        
+                        property point pressPosition: Qt.point(0, 0)
+                        
+                        onPressed: {
+                            pressPosition = Qt.point(mouse.x, mouse.y)
+                            if (robotBridge) robotBridge.clearHover()
+                        }
+                        
+                        onPositionChanged: {
+                            // 拖拽旋转/平移时不做悬停拾取
+                            if (!robotBridge || mouse.buttons !== 0) return
+                            robotBridge.hoverAt(mouse.x, mouse.y, scene3d.width, scene3d.height)
+                        }
+                        
+                        onReleased: {
+                            if (!robotBridge || mouse.button !== MouseEvent.LeftButton) return
+                            var dx = mouse.x - pressPosition.x
+                            var dy = mouse.y - pressPosition.y
+                            // 移动超过阈值视为拖拽，不触发选中
+                            if (dx * dx + dy * dy <= 16) {
+                                robotBridge.pickAt(mouse.x, mouse.y, scene3d.width, scene3d.height)
+                            }
+                        }
+                    }
+                ]
+            }
+            
             // C++ 创建的 Entity 树将被挂载为 sceneRoot 的子节点
             // 通过 robotBridge.attachToSceneRoot(sceneRoot) 实现
             // 包含：worldEntity -> lights, grid, axes, robotEntity, trajectoryEntity
@@ -279,6 +314,9 @@ Item {
                 cppRoot.parent = sceneRoot
                 console.log("Scene3DView: C++ Entity树已挂载到QML Scene3D")
                 
+                // 拾取使用与渲染相同的相机
+                robotBridge.setPickingCamera(mainCamera)
+                
                 // 同步初始状态
                 root.showGrid = robotBridge.showGrid
                 root.showAxes = robotBridge.showAxes
@@ -4,119 +4,177 @@ import QtGraphicalEffects 1.15
 import "."
 
 // 加载叠加层
+// 骨架显示后切换为底部紧凑卡片，不再遮挡场景，鼠标可继续操作视角
 Rectangle {
     id: root
     
     property string message: ""
+    property string stage: ""          // 当前阶段说明
+    property real progress: -1         // 0~1，小于0时显示脉冲动画
+    property bool compact: false       // 紧凑模式（骨架已显示）
+    property bool cancelable: false
     
-    color: "#d0000000"
+    signal cancelRequested()
     
-    // 点击阻止穿透
+    color: compact ? "transparent" : "#d0000000"
+    
+    // 点击阻止穿透（紧凑模式下允许操作场景）
     MouseArea {
         anchors.fill: parent
+        enabled: !root.compact
     }
     
-    Column {
-        anchors.centerIn: parent
-        spacing: 30
+    Rectangle {
+        id: card
+        anchors.horizontalCenter: parent.horizontalCenter
+        y: root.compact ? parent.height - height - 24 : (parent.height - height) / 2
+        width: contentColumn.width + 48
+        height: contentColumn.height + (root.compact ? 32 : 0)
+        radius: 8
+        color: root.compact ? "#d0202020" : "transparent"
+        
+        // 卡片内部点击不穿透到场景
+        MouseArea {
+            anchors.fill: parent
+            enabled: root.compact
+        }
+    
+        Column {
+            id: contentColumn
+            anchors.centerIn: parent
+            spacing: root.compact ? 12 : 30
         
-        // 旋转加载环
-        Item {
-            width: 80
-            height: 80
-            anchors.horizontalCenter: parent.horizontalCenter
+            // 旋转加载环
+            Item {
+                width: 80
+                height: 80
+                visible: !root.compact
+                anchors.horizontalCenter: parent.horizontalCenter
             
-            // 外圈
-            Canvas {
-                id: spinnerCanvas
-                anchors.fill: parent
+                // 外圈
+                Canvas {
+                    id: spinnerCanvas
+                    anchors.fill: parent
                 
-                property real rotation: 0
+                    property real rotation: 0
                 
-                onPaint: {
-                    var ctx = getContext("2d")
-                    ctx.reset()
-                    ctx.translate(width/2, height/2)
-                    ctx.rotate(rotation * Math.PI / 180)
+                    onPaint: {
+                        var ctx = getContext("2d")
+                        ctx.reset()
+                        ctx.translate(width/2, height/2)
+                        ctx.rotate(rotation * Math.PI / 180)
                     
-                    var gradient = ctx.createLinearGradient(-width/2, 0, width/2, 0)
-                    gradient.addColorStop(0, "transparent")
-                    gradient.addColorStop(0.5, "#00ff88")
-                    gradient.addColorStop(1, "#00ff88")
+                        var gradient = ctx.createLinearGradient(-width/2, 0, width/2, 0)
+                        gradient.addColorStop(0, "transparent")
+                        gradient.addColorStop(0.5, "#00ff88")
+                        gradient.addColorStop(1, "#00ff88")
                     
-                    ctx.strokeStyle = gradient
-                    ctx.lineWidth = 4
-                    ctx.lineCap = "round"
-                    ctx.beginPath()
-                    ctx.arc(0, 0, 35, 0, Math.PI * 1.5)
-                    ctx.stroke()
-                }
+                        ctx.strokeStyle = gradient
+                        ctx.lineWidth = 4
+                        ctx.lineCap = "round"
+                        ctx.beginPath()
+                        ctx.arc(0, 0, 35, 0, Math.PI * 1.5)
+                        ctx.stroke()
+                    }
                 
-                NumberAnimation on rotation {
-                    from: 0
-                    to: 360
-                    duration: 1000
-                    loops: Animation.Infinite
+                    NumberAnimation on rotation {
+                        from: 0
+                        to: 360
+                        duration: 1000
+                        loops: Animation.Infinite
+                    }
+                
+                    onRotationChanged: requestPaint()
                 }
+            
+                // 内部图标
+                Text {
+                    anchors.centerIn: parent
+                    text: "⚙"
+                    font.pixelSize: FontConfig.xlarge
+                    color: "#00ff88"
                 
-                onRotationChanged: requestPaint()
+                    RotationAnimation on rotation {
+                        from: 0
+                        to: -360
+                        duration: 2000
+                        loops: Animation.Infinite
+                    }
+                }
             }
-            
-            // 内部图标
+        
+            // 加载文本
             Text {
-                anchors.centerIn: parent
-                text: "⚙"
-                font.pixelSize: FontConfig.xlarge
-                color: "#00ff88"
-                
-                RotationAnimation on rotation {
-                    from: 0
-                    to: -360
-                    duration: 2000
+                text: message
+                color: "#ffffff"
+                font.pixelSize: FontConfig.medium
+                font.weight: Font.Medium
+                anchors.horizontalCenter: parent.horizontalCenter
+            
+                SequentialAnimation on opacity {
                     loops: Animation.Infinite
+                    NumberAnimation { to: 0.5; duration: 800 }
+                    NumberAnimation { to: 1.0; duration: 800 }
                 }
             }
-        }
         
-        // 加载文本
-        Text {
-            text: message
-            color: "#ffffff"
-            font.pixelSize: FontConfig.medium
-            font.weight: Font.Medium
-            anchors.horizontalCenter: parent.horizontalCenter
-            
-            SequentialAnimation on opacity {
-                loops: Animation.Infinite
-                NumberAnimation { to: 0.5; duration: 800 }
-                NumberAnimation { to: 1.0; duration: 800 }
+            // 阶段与百分比
+            Text {
+                visible: root.stage !== ""
+                text: root.progress >= 0 ? root.stage + "  " + Math.round(root.progress * 100) + "%" : root.stage
+                color: "#a0ffffff"
+                font.pixelSize: FontConfig.normal
+                anchors.horizontalCenter: parent.horizontalCenter
             }
-        }
         
-        // 进度条（脉冲动画）
-        Rectangle {
-            width: 200
-            height: 3
-            color: "#20ffffff"
-            radius: 1.5
-            anchors.horizontalCenter: parent.horizontalCenter
-            
+            // 进度条（有进度时按比例显示，否则脉冲动画）
             Rectangle {
-                id: progressPulse
-                height: parent.height
-                radius: parent.radius
-                color: "#00ff88"
+                width: 200
+                height: 3
+                color: "#20ffffff"
+                radius: 1.5
+                anchors.horizontalCenter: parent.horizontalCenter
+            
+                Rectangle {
+                    id: progressBar
+                    visible: root.progress >= 0
+                    height: parent.height
+                    radius: parent.radius
+                    color: "#00ff88"
+                    width: parent.width * Math.max(0, Math.min(1, root.progress))
                 
-                SequentialAnimation on width {
-                    loops: Animation.Infinite
-                    NumberAnimation { from: 0; to: 200; duration: 1500; easing.type: Easing.InOutQuad }
+                    Behavior on width {
+                        NumberAnimation { duration: 150 }
+                    }
                 }
+            
+                Rectangle {
+                    id: progressPulse
+                    visible: root.progress < 0
+                    height: parent.height
+                    radius: parent.radius
+                    color: "#00ff88"
                 
-                SequentialAnimation on x {
-                    loops: Animation.Infinite
-                    NumberAnimation { from: 0; to: 0; duration: 1500 }
+                    SequentialAnimation on width {
+                        loops: Animation.Infinite
+                        NumberAnimation { from: 0; to: 200; duration: 1500; easing.type: Easing.InOutQuad }
+                    }
+                
+                    SequentialAnimation on x {
+                        loops: Animation.Infinite
+                        NumberAnimation { from: 0; to: 0; duration: 1500 }
+                    }
                 }
             }
+        
+            // 取消按钮
+            GlassButton {
+                visible: root.cancelable
+                height: 32
+                text: qsTr("取消")
+                anchors.horizontalCenter: parent.horizontalCenter
+                onClicked: root.cancelRequested()
+            }
         }
     }
     
@@ -0,0 +1,148 @@
+﻿import QtQuick 2.15
+import QtQuick.Controls 2.15
+import "."
+
+// 性能叠加层 - 帧时间、场景规模与更新频率（F3 切换）
+Item {
+    id: root
+    
+    property var robotBridge: null
+    readonly property var monitor: robotBridge ? robotBridge.performance : null
+    
+    implicitWidth: 260
+    implicitHeight: content.implicitHeight + 24
+    
+    // 帧时间超过阈值时的颜色提示
+    function frameColor(ms) {
+        if (ms <= 0) return "#80ffffff"
+        if (ms <= 17.5) return "#00ff88"
+        if (ms <= 34) return "#ffaa00"
+        return "#ff4444"
+    }
+    
+    function formatCount(n) {
+        if (n >= 1000000) return (n / 1000000).toFixed(2) + "M"
+        if (n >= 1000) return (n / 1000).toFixed(1) + "K"
+        return n.toString()
+    }
+    
+    // 单行统计项
+    component StatRow: Item {
+        property string label: ""
+        property string value: ""
+        property color valueColor: "#ffffff"
+        
+        width: parent ? parent.width : 0
+        height: 18
+        
+        Text {
+            text: parent.label
+            color: "#a0ffffff"
+            font.pixelSize: FontConfig.small
+            anchors.left: parent.left
+            anchors.verticalCenter: parent.verticalCenter
+        }
+        
+        Text {
+            text: parent.value
+            color: parent.valueColor
+            font.pixelSize: FontConfig.small
+            font.family: "Consolas"
+            anchors.right: parent.right
+            anchors.verticalCenter: parent.verticalCenter
+        }
+    }
+    
+    GlassPanel {
+        anchors.fill: parent
+        glassOpacity: 0.8
+        cornerRadius: 8
+    }
+    
+    Column {
+        id: content
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+        anchors.margins: 12
+        spacing: 4
+        
+        // 标题行
+        Item {
+            width: parent.width
+            height: 24
+            
+            Text {
+                text: qsTr("性能监视")
+                color: "#00ff88"
+                font.pixelSize: FontConfig.normal
+                font.weight: Font.Bold
+                anchors.verticalCenter: parent.verticalCenter
+            }
+            
+            GlassButton {
+                anchors.right: parent.right
+                anchors.verticalCenter: parent.verticalCenter
+                width: 24
+                height: 24
+                iconText: "⇩"
+                iconSize: 14
+                tooltipText: qsTr("导出CSV")
+                onClicked: { if (robotBridge) robotBridge.exportPerformanceCsv() }
+            }
+        }
+        
+        StatRow {
+            label: qsTr("帧率")
+            value: monitor ? monitor.fps.toFixed(1) + " fps" : "-"
+            valueColor: monitor ? frameColor(monitor.frameTimeP50) : "#ffffff"
+        }
+        StatRow {
+            label: qsTr("帧时间 P50")
+            value: monitor ? monitor.frameTimeP50.toFixed(2) + " ms" : "-"
+            valueColor: monitor ? frameColor(monitor.frameTimeP50) : "#ffffff"
+        }
+        StatRow {
+            label: qsTr("帧时间 P95")
+            value: monitor ? monitor.frameTimeP95.toFixed(2) + " ms" : "-"
+            valueColor: monitor ? frameColor(monitor.frameTimeP95) : "#ffffff"
+        }
+        StatRow {
+            label: qsTr("帧时间 P99")
+            value: monitor ? monitor.frameTimeP99.toFixed(2) + " ms" : "-"
+            valueColor: monitor ? frameColor(monitor.frameTimeP99) : "#ffffff"
+        }
+        StatRow {
+            label: qsTr("绘制调用")
+            value: monitor ? monitor.drawCalls.toString() : "-"
+        }
+        StatRow {
+            label: qsTr("三角形")
+            value: monitor ? formatCount(monitor.triangleCount) : "-"
+        }
+        StatRow {
+            label: qsTr("顶点")
+            value: monitor ? formatCount(monitor.vertexCount) : "-"
+        }
+        StatRow {
+            label: qsTr("实体数")
+            value: monitor ? monitor.entityCount.toString() : "-"
+        }
+        StatRow {
+            label: qsTr("关节更新")
+            value: monitor ? monitor.jointUpdateRate.toFixed(1) + " /s" : "-"
+        }
+        StatRow {
+            label: qsTr("轨迹采样")
+            value: monitor ? monitor.trajectorySampleRate.toFixed(1) + " /s" : "-"
+        }
+        StatRow {
+            label: qsTr("OPC UA 延迟")
+            value: monitor ? monitor.opcuaLatency.toFixed(2) + " / " + monitor.opcuaLatencyMax.toFixed(2) + " ms" : "-"
+        }
+        StatRow {
+            label: qsTr("OPC UA 唤醒")
+            value: monitor ? monitor.opcuaWakeupRate.toFixed(1) + " /s" : "-"
+        }
+    }
+}
@@ -0,0 +1,141 @@
+﻿import QtQuick 2.15
+import QtQuick.Controls 2.15
+import "."
+
+// 关节记录回放条：播放/暂停、速度（负数为倒放）、时间轴拖动
+Item {
+    id: root
+    
+    property var robotBridge: null
+    readonly property real duration: robotBridge ? robotBridge.replayDuration : 0
+    readonly property var speedOptions: ["-4×", "-2×", "-1×", "-0.5×", "0.25×", "0.5×", "1×", "2×", "4×", "10×", "60×"]
+    
+    implicitHeight: 56
+    
+    function formatTime(seconds) {
+        var s = Math.max(0, seconds)
+        var h = Math.floor(s / 3600)
+        var m = Math.floor((s % 3600) / 60)
+        var sec = (s % 60).toFixed(1)
+        var text = (m < 10 ? "0" : "") + m + ":" + (sec < 10 ? "0" : "") + sec
+        return h > 0 ? h + ":" + text : text
+    }
+    
+    function speedText(speed) {
+        return (Math.round(speed * 100) / 100) + "×"
+    }
+    
+    GlassPanel {
+        anchors.fill: parent
+        glassOpacity: 0.8
+        cornerRadius: 8
+    }
+    
+    Row {
+        anchors.fill: parent
+        anchors.margins: 6
+        anchors.leftMargin: 12
+        anchors.rightMargin: 12
+        spacing: 10
+        
+        GlassButton {
+            width: 44
+            height: 44
+            iconText: robotBridge && robotBridge.replayPlaying ? "⏸" : "▶"
+            tooltipText: robotBridge && robotBridge.replayPlaying ? qsTr("暂停") : qsTr("播放")
+            highlighted: robotBridge && robotBridge.replayPlaying
+            enabled: robotBridge && robotBridge.replayReady
+            opacity: enabled ? 1.0 : 0.5
+            onClicked: {
+                if (robotBridge.replayPlaying) {
+                    robotBridge.replayPause()
+                } else {
+                    robotBridge.replayPlay()
+                }
+            }
+        }
+        
+        GlassComboBox {
+            width: 80
+            height: 32
+            anchors.verticalCenter: parent.verticalCenter
+            model: root.speedOptions
+            currentValue: robotBridge ? root.speedText(robotBridge.replaySpeed) : "1×"
+            onValueChanged: function(value) {
+                if (robotBridge) robotBridge.replaySpeed = parseFloat(value)
+            }
+        }
+        
+        Text {
+            width: 70
+            anchors.verticalCenter: parent.verticalCenter
+            horizontalAlignment: Text.AlignRight
+            text: root.formatTime(timeline.pressed ? timeline.value
+                                                   : (robotBridge ? robotBridge.replayPosition : 0))
+            color: "#00ff88"
+            font.pixelSize: FontConfig.normal
+            font.family: "Consolas"
+        }
+        
+        // 时间轴：拖动时直接定位（只解码当前位置所在的数据块）
+        Slider {
+            id: timeline
+            width: parent.width - 44 - 80 - 70 - 70 - 44 - parent.spacing * 5
+            anchors.verticalCenter: parent.verticalCenter
+            from: 0
+            to: Math.max(root.duration, 0.001)
+            enabled: robotBridge && robotBridge.replayReady
+            live: true
+            
+            Binding on value {
+                when: !timeline.pressed
+                value: robotBridge ? robotBridge.replayPosition : 0
+            }
+            
+            onMoved: { if (robotBridge) robotBridge.replaySeek(value) }
+            
+            background: Rectangle {
+                x: timeline.leftPadding
+                y: timeline.topPadding + timeline.availableHeight / 2 - height / 2
+                width: timeline.availableWidth
+                height: 4
+                radius: 2
+                color: "#30ffffff"
+                
+                Rectangle {
+                    width: timeline.visualPosition * parent.width
+                    height: parent.height
+                    radius: 2
+                    color: "#00ff88"
+                }
+            }
+            
+            handle: Rectangle {
+                x: timeline.leftPadding + timeline.visualPosition * (timeline.availableWidth - width)
+                y: timeline.topPadding + timeline.availableHeight / 2 - height / 2
+                width: 14
+                height: 14
+                radius: 7
+                color: timeline.pressed ? "#ffffff" : "#00ff88"
+            }
+        }
+        
+        Text {
+            width: 70
+            anchors.verticalCenter: parent.verticalCenter
+            text: robotBridge && robotBridge.replayReady ? root.formatTime(root.duration) : qsTr("索引中...")
+            color: "#a0ffffff"
+            font.pixelSize: FontConfig.normal
+            font.family: "Consolas"
+        }
+        
+        GlassButton {
+            width: 44
+            height: 44
+            iconText: "✕"
+            tooltipText: qsTr("关闭回放")
+            accentColor: "#ff6b6b"
+            onClicked: { if (robotBridge) robotBridge.closeReplay() }
+        }
+    }
+}
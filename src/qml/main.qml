@@ -94,6 +94,32 @@ ApplicationWindow {
         fps: scene3d.fps
     }
     
+    // 关节记录回放条
+    ReplayBar {
+        id: replayBar
+        anchors.bottom: bottomBar.top
+        anchors.horizontalCenter: parent.horizontalCenter
+        anchors.bottomMargin: 10
+        width: Math.min(parent.width - 160, 900)
+        z: 99
+        
+        robotBridge: mainWindow.bridge
+        visible: robotBridge ? robotBridge.replayOpen : false
+    }
+    
+    // 性能叠加层（F3 切换）
+    PerformanceOverlay {
+        id: performanceOverlay
+        anchors.top: topHud.bottom
+        anchors.left: parent.left
+        anchors.topMargin: 10
+        anchors.leftMargin: 20
+        z: 99
+        
+        robotBridge: mainWindow.bridge
+        visible: robotBridge && robotBridge.performance ? robotBridge.performance.enabled : false
+    }
+    
     // 右侧滑出式设置面板
     SettingsPanel {
         id: settingsPanel
@@ -153,6 +179,14 @@ ApplicationWindow {
         onActivated: jointsPanelOpen = !jointsPanelOpen
     }
     
+    Shortcut {
+        sequence: "F3"
+        onActivated: {
+            if (robotBridge && robotBridge.performance)
+                robotBridge.performance.enabled = !robotBridge.performance.enabled
+        }
+    }
+    
     Shortcut {
         sequence: "Escape"
         onActivated: {
@@ -203,6 +237,11 @@ ApplicationWindow {
         z: 200
         visible: robotBridge ? robotBridge.isLoading : false
         message: qsTr("正在加载模型...")
+        stage: robotBridge ? robotBridge.loadStage : ""
+        progress: robotBridge ? robotBridge.loadProgress : -1
+        compact: robotBridge ? robotBridge.skeletonReady : false
+        cancelable: true
+        onCancelRequested: robotBridge.cancelLoad()
     }
     
     // 消息提示
@@ -219,5 +258,13 @@ ApplicationWindow {
         function onShowMessage(msg, isError) {
             messagePopup.show(msg, isError)
         }
+        
+        // 3D视图中选中Link：定位到控制它的关节
+        function onLinkPicked(linkName, jointName) {
+            if (jointName !== "") {
+                settingsPanelOpen = true
+                settingsPanel.focusJoint(jointName)
+            }
+        }
     }
 }
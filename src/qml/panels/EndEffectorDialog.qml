@@ -173,9 +173,10 @@ Popup {
                     
                     onClicked: {
                         if (robotBridge && robotBridge.linkNames.length > 0) {
-                            // 默认选择最后一个link（通常是末端）
+                            // 优先使用3D视图中选中的link，否则选择最后一个link（通常是末端）
                             var links = robotBridge.linkNames
-                            var defaultLink = links[links.length - 1]
+                            var defaultLink = robotBridge.selectedLink !== "" ? robotBridge.selectedLink
+                                                                               : links[links.length - 1]
                             robotBridge.addEndEffectorConfig(defaultLink, "", "")
                         } else {
                             // 没有可用链接
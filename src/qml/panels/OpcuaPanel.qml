@@ -224,21 +224,395 @@ Item {
                         }
                     }
                     
+                    // 采样平滑：显示延迟（0为关闭）和最长外推时间
+                    Row {
+                        width: parent.width
+                        spacing: 16
+                        
+                        // 显示延迟
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("平滑延迟")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: smoothingInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: smoothingInput
+                                        text: robotBridge ? robotBridge.smoothingDelay.toString() : "150"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: IntValidator { bottom: 0; top: 5000 }
+                                        selectByMouse: true
+                                        
+                                        onTextChanged: {
+                                            var val = parseInt(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.smoothingDelay = val
+                                            }
+                                        }
+                                    }
+                                    
+                                    Text {
+                                        text: "ms"
+                                        color: "#80ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        anchors.verticalCenter: parent.verticalCenter
+                                    }
+                                }
+                            }
+                        }
+                        
+                        // 最长外推
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("最长外推")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: extrapolationInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: extrapolationInput
+                                        text: robotBridge ? robotBridge.extrapolationLimit.toString() : "50"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: IntValidator { bottom: 0; top: 5000 }
+                                        selectByMouse: true
+                                        
+                                        onTextChanged: {
+                                            var val = parseInt(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.extrapolationLimit = val
+                                            }
+                                        }
+                                    }
+                                    
+                                    Text {
+                                        text: "ms"
+                                        color: "#80ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        anchors.verticalCenter: parent.verticalCenter
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    
+                    // 订阅模式：服务器推送数据变化，不再轮询；修改参数时重新订阅
+                    GlassToggle {
+                        width: parent.width
+                        text: qsTr("订阅模式")
+                        checked: robotBridge ? robotBridge.opcuaSubscription : false
+                        onToggled: function(checked) {
+                            if (robotBridge) robotBridge.opcuaSubscription = checked
+                        }
+                    }
+                    
+                    Row {
+                        width: parent.width
+                        spacing: 16
+                        visible: robotBridge && robotBridge.opcuaSubscription
+                        
+                        // 服务器发布通知的间隔
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("发布间隔")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: publishingInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: publishingInput
+                                        text: robotBridge ? robotBridge.opcuaPublishingInterval.toString() : "50"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: IntValidator { bottom: 0; top: 60000 }
+                                        selectByMouse: true
+                                        
+                                        onEditingFinished: {
+                                            var val = parseInt(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.opcuaPublishingInterval = val
+                                            }
+                                        }
+                                    }
+                                    
+                                    Text {
+                                        text: "ms"
+                                        color: "#80ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        anchors.verticalCenter: parent.verticalCenter
+                                    }
+                                }
+                            }
+                        }
+                        
+                        // 服务器端采样间隔
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("采样间隔")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: samplingInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: samplingInput
+                                        text: robotBridge ? robotBridge.opcuaSamplingInterval.toString() : "20"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: IntValidator { bottom: 0; top: 60000 }
+                                        selectByMouse: true
+                                        
+                                        onEditingFinished: {
+                                            var val = parseInt(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.opcuaSamplingInterval = val
+                                            }
+                                        }
+                                    }
+                                    
+                                    Text {
+                                        text: "ms"
+                                        color: "#80ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        anchors.verticalCenter: parent.verticalCenter
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    
+                    Row {
+                        width: parent.width
+                        spacing: 16
+                        visible: robotBridge && robotBridge.opcuaSubscription
+                        
+                        // 每个节点在服务器端缓存的通知数
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("队列长度")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: queueSizeInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: queueSizeInput
+                                        text: robotBridge ? robotBridge.opcuaQueueSize.toString() : "4"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: IntValidator { bottom: 1; top: 1000 }
+                                        selectByMouse: true
+                                        
+                                        onEditingFinished: {
+                                            var val = parseInt(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.opcuaQueueSize = val
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                        
+                        // 绝对死区，变化小于该值时服务器不通知
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("死区")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: deadbandInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: deadbandInput
+                                        text: robotBridge ? robotBridge.opcuaDeadband.toString() : "0"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: DoubleValidator { bottom: 0; top: 360 }
+                                        selectByMouse: true
+                                        
+                                        onEditingFinished: {
+                                            var val = parseFloat(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.opcuaDeadband = val
+                                            }
+                                        }
+                                    }
+                                    
+                                    Text {
+                                        text: "°"
+                                        color: "#80ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        anchors.verticalCenter: parent.verticalCenter
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    
+                    // 轮询模式的请求流水线
+                    Row {
+                        width: parent.width
+                        spacing: 16
+                        visible: robotBridge && !robotBridge.opcuaSubscription
+                        
+                        // 同时在途的读取请求数，链路延迟大时增大
+                        Column {
+                            width: (parent.width - 16) / 2
+                            spacing: 8
+                            
+                            Text {
+                                text: qsTr("并发请求")
+                                color: "#b0ffffff"
+                                font.pixelSize: FontConfig.normal
+                            }
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 44
+                                radius: 8
+                                color: "#25ffffff"
+                                border.color: pipelineDepthInput.activeFocus ? "#00ff88" : "#40ffffff"
+                                border.width: 1
+                                
+                                Row {
+                                    anchors.centerIn: parent
+                                    spacing: 6
+                                    
+                                    TextInput {
+                                        id: pipelineDepthInput
+                                        text: robotBridge ? robotBridge.opcuaPipelineDepth.toString() : "4"
+                                        color: "#ffffff"
+                                        font.pixelSize: FontConfig.normal
+                                        font.family: "Consolas"
+                                        validator: IntValidator { bottom: 1; top: 64 }
+                                        selectByMouse: true
+                                        
+                                        onEditingFinished: {
+                                            var val = parseInt(text)
+                                            if (!isNaN(val) && robotBridge) {
+                                                robotBridge.opcuaPipelineDepth = val
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    
                     // 连接按钮组
                     Row {
                         width: parent.width
                         spacing: 12
                         
                         GlassButton {
+                            // 正在连接或等待重连时可以取消
+                            property bool busy: robotBridge && (robotBridge.opcuaConnecting || robotBridge.opcuaReconnecting)
+                            
                             width: (parent.width - 12) / 2
                             height: 48
-                            text: robotBridge && robotBridge.opcuaConnected ? qsTr("断开") : qsTr("连接")
-                            iconText: robotBridge && robotBridge.opcuaConnected ? "🔌" : "🔗"
-                            highlighted: robotBridge && robotBridge.opcuaConnected
-                            accentColor: robotBridge && robotBridge.opcuaConnected ? "#ff6b6b" : "#00ff88"
+                            text: busy ? qsTr("取消") : robotBridge && robotBridge.opcuaConnected ? qsTr("断开") : qsTr("连接")
+                            iconText: busy ? "⏳" : robotBridge && robotBridge.opcuaConnected ? "🔌" : "🔗"
+                            highlighted: robotBridge && (robotBridge.opcuaConnected || busy)
+                            accentColor: busy ? "#ffaa00" : robotBridge && robotBridge.opcuaConnected ? "#ff6b6b" : "#00ff88"
                             onClicked: {
                                 if (robotBridge) {
-                                    if (robotBridge.opcuaConnected) {
+                                    if (robotBridge.opcuaConnected || busy) {
                                         robotBridge.opcuaDisconnect()
                                     } else {
                                         robotBridge.opcuaConnect()
@@ -266,6 +640,45 @@ Item {
                             }
                         }
                     }
+                    
+                    // 记录按钮：采样数据写入二进制记录文件；回放按钮打开已有记录
+                    Row {
+                        width: parent.width
+                        spacing: 12
+                        
+                        GlassButton {
+                            width: parent.width - 48 - 12
+                            height: 48
+                            text: robotBridge && robotBridge.recording
+                                  ? qsTr("停止记录 (%1 个采样, %2 KB)")
+                                        .arg(robotBridge.recordedSamples)
+                                        .arg(Math.round(robotBridge.recordedBytes / 1024))
+                                  : qsTr("开始记录")
+                            iconText: robotBridge && robotBridge.recording ? "⏹" : "⏺"
+                            highlighted: robotBridge && robotBridge.recording
+                            accentColor: "#ff6b6b"
+                            enabled: robotBridge && (robotBridge.recording || robotBridge.robotLoaded)
+                            opacity: enabled ? 1.0 : 0.5
+                            onClicked: {
+                                if (robotBridge) {
+                                    if (robotBridge.recording) {
+                                        robotBridge.stopRecording()
+                                    } else {
+                                        robotBridge.startRecording()
+                                    }
+                                }
+                            }
+                        }
+                        
+                        GlassButton {
+                            width: 48
+                            height: 48
+                            iconText: "📂"
+                            tooltipText: qsTr("回放记录")
+                            highlighted: robotBridge && robotBridge.replayOpen
+                            onClicked: { if (robotBridge) robotBridge.openReplay() }
+                        }
+                    }
                 }
             }
             
@@ -282,12 +695,14 @@ Item {
                         if (!robotBridge) return "#ff4444"
                         if (robotBridge.opcuaSampling) return "#00ff88"
                         if (robotBridge.opcuaConnected) return "#ffaa00"
+                        if (robotBridge.opcuaConnecting || robotBridge.opcuaReconnecting) return "#66aaff"
                         return "#ff4444"
                     }
                     anchors.verticalCenter: parent.verticalCenter
                     
                     SequentialAnimation on opacity {
-                        running: robotBridge && robotBridge.opcuaSampling
+                        running: robotBridge && (robotBridge.opcuaSampling || robotBridge.opcuaConnecting
+                                                 || robotBridge.opcuaReconnecting)
                         loops: Animation.Infinite
                         NumberAnimation { to: 0.3; duration: 500 }
                         NumberAnimation { to: 1.0; duration: 500 }
@@ -299,6 +714,11 @@ Item {
                         if (!robotBridge) return qsTr("未初始化")
                         if (robotBridge.opcuaSampling) return qsTr("正在采样...")
                         if (robotBridge.opcuaConnected) return qsTr("已连接，等待采样")
+                        if (robotBridge.opcuaReconnecting && robotBridge.opcuaConnecting)
+                            return qsTr("正在重连（第 %1 次）...").arg(robotBridge.opcuaReconnectAttempt)
+                        if (robotBridge.opcuaReconnecting)
+                            return qsTr("连接已断开，%1 秒后重连").arg((robotBridge.opcuaReconnectDelay / 1000).toFixed(1))
+                        if (robotBridge.opcuaConnecting) return qsTr("正在连接...")
                         return qsTr("未连接")
                     }
                     color: "#b0ffffff"
@@ -89,6 +89,49 @@ ScrollView {
             }
         }
         
+        // 网格导入配置
+        SettingsGroup {
+            title: qsTr("模型导入")
+            iconText: "📦"
+            Layout.fillWidth: true
+
+            ColumnLayout {
+                spacing: 12
+
+                RowLayout {
+                    spacing: 8
+
+                    Text {
+                        text: qsTr("导入配置")
+                        color: "#b0ffffff"
+                        font.pixelSize: FontConfig.normal
+                    }
+
+                    // preview: 快速预览 / full: 完整质量 / collision: 仅碰撞外形
+                    GlassComboBox {
+                        Layout.fillWidth: true
+                        height: 28
+                        model: robotBridge ? robotBridge.importProfiles : []
+                        currentValue: robotBridge ? robotBridge.importProfile : ""
+                        onValueChanged: function(value) {
+                            if (robotBridge && value && value !== robotBridge.importProfile) {
+                                robotBridge.importProfile = value
+                            }
+                        }
+                    }
+                }
+
+                Text {
+                    Layout.fillWidth: true
+                    visible: text !== ""
+                    text: robotBridge ? robotBridge.importSummary : ""
+                    color: "#80ffffff"
+                    font.pixelSize: FontConfig.small
+                    wrapMode: Text.WrapAnywhere
+                }
+            }
+        }
+
         // 轨迹选项
         SettingsGroup {
             title: qsTr("轨迹设置")
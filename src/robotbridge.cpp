@@ -3,13 +3,35 @@
 #include "robotentity.h"
 #include "settingsmanager.h"
 #include "communication/opcua/opcuaconnector.h"
+#include "communication/filereplay/filereplayconnector.h"
 #include "viewoptions.h"
+#include "performancemonitor.h"
+#include "jointrecorder.h"
+#include "jointreplay.h"
 
 #include <QFileDialog>
 #include <QTimer>
 #include <QFileInfo>
 #include <QFile>
+#include <QHash>
 #include <QtMath>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <algorithm>
+#include <chrono>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QQuaternion>
+#include <Qt3DRender/QCamera>
+
+namespace {
+
+const int kReconnectInitialDelay = 1000; // 断线后第一次重连的等待（毫秒），之后每次翻倍
+const int kReconnectMaxDelay = 30000;    // 重连等待的上限（毫秒）
+const qint64 kSourceClockResync = 1000000; // 源时间戳比估计的晚这么多（微秒）时重新对时
+
+} // namespace
 
 RobotBridge::RobotBridge(QObject *parent)
     : QObject(parent)
@@ -21,6 +43,11 @@ RobotBridge::~RobotBridge()
 {
     saveSettings();
     
+    // 回放轨迹挂在场景中，须在场景销毁前关闭
+    if (m_replay) {
+        m_replay->close();
+    }
+    
     if (m_sampleTimer) {
         m_sampleTimer->stop();
         delete m_sampleTimer;
@@ -39,12 +66,60 @@ void RobotBridge::initialize()
     m_scene->initialize();
     m_viewOptions.applyToScene(m_scene);
     
-    // 创建OPC UA连接器
-    m_opcuaConnector = new OPCUAConnector(this);
+    // 创建性能监视器
+    m_performanceMonitor = new PerformanceMonitor(this);
+    m_performanceMonitor->setSceneRoot(m_scene->rootEntity());
+    m_performanceMonitor->attachRobot(m_scene->robotEntity());
+    m_performanceMonitor->setOpcuaWakeupCounter([this]() -> quint64 {
+        auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector);
+        return opcua ? opcua->loopWakeups() : 0;
+    });
+    
+    // 创建关节状态记录器（写盘在其独立线程中进行）
+    m_recorder = new JointRecorder(this);
+    connect(m_recorder, &JointRecorder::writeFailed, this, [this](const QString& error) {
+        stopRecording();
+        emit showMessage(error, true);
+    });
+    
+    // 创建记录回放（索引在工作线程中建立）
+    m_replay = new JointReplay(this);
+    m_replay->setScene(m_scene);
+    m_replay->setTrajectoryWindow(m_viewOptions.state().trajectoryLifetime);
+    connect(m_replay, &JointReplay::ready, this, [this]() {
+        emit replayStateChanged();
+        emit replayPositionChanged();
+        emit showMessage(tr("记录已打开: %1").arg(m_replay->filePath()), false);
+    });
+    connect(m_replay, &JointReplay::failed, this, [this](const QString& error) {
+        emit showMessage(error, true);
+    });
+    connect(m_replay, &JointReplay::closed, this, &RobotBridge::replayStateChanged);
+    connect(m_replay, &JointReplay::playingChanged, this, &RobotBridge::replayPlayingChanged);
+    connect(m_replay, &JointReplay::positionChanged, this, &RobotBridge::replayPositionChanged);
+    connect(m_replay, &JointReplay::speedChanged, this, &RobotBridge::replaySpeedChanged);
     
-    // 创建采样定时器
+    // 创建采样定时器（轮询其它连接器；OPC UA由快照通知驱动）
     m_sampleTimer = new QTimer(this);
     connect(m_sampleTimer, &QTimer::timeout, this, &RobotBridge::onSampleTimerTimeout);
+    connect(this, &RobotBridge::opcuaBindingsChanged, this, [this]() {
+        m_sampleReadListDirty = true;
+        // 订阅模式和OPC UA采样流在绑定变化后要重新开始
+        if (m_opcuaSampling && (m_opcuaSubscription || qobject_cast<OPCUAConnector*>(m_opcuaConnector))) {
+            restartSampling();
+        }
+    });
+    
+    // 断线重连
+    m_reconnectTimer = new QTimer(this);
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &RobotBridge::onReconnectTimeout);
+    
+    // 采样平滑按显示帧率刷新
+    m_smoothingTimer = new QTimer(this);
+    m_smoothingTimer->setTimerType(Qt::PreciseTimer);
+    m_smoothingTimer->setInterval(16);
+    connect(m_smoothingTimer, &QTimer::timeout, this, &RobotBridge::onSmoothingTick);
     
     // 设置连接
     setupConnections();
@@ -55,6 +130,13 @@ void RobotBridge::initialize()
     });
 }
 
+void RobotBridge::attachWindow(QQuickWindow* window)
+{
+    if (m_performanceMonitor) {
+        m_performanceMonitor->attachWindow(window);
+    }
+}
+
 Qt3DCore::QEntity* RobotBridge::sceneRoot() const
 {
     return m_scene ? m_scene->rootEntity() : nullptr;
@@ -73,6 +155,9 @@ void RobotBridge::setupConnections()
     // 场景信号连接
     connect(m_scene, &RobotScene::robotLoaded, this, &RobotBridge::onRobotLoaded);
     connect(m_scene, &RobotScene::loadError, this, &RobotBridge::onLoadError);
+    connect(m_scene, &RobotScene::loadCanceled, this, &RobotBridge::onLoadCanceled);
+    connect(m_scene, &RobotScene::loadProgressChanged, this, &RobotBridge::onLoadProgressChanged);
+    connect(m_scene, &RobotScene::skeletonReady, this, &RobotBridge::onSkeletonReady);
     // 信号直连：RobotScene::fitCameraRequested -> RobotBridge::fitCameraRequested
     connect(m_scene, &RobotScene::fitCameraRequested, this, &RobotBridge::fitCameraRequested);
 }
@@ -95,35 +180,132 @@ void RobotBridge::loadRobot(const QString& filePath)
 {
     if (filePath.isEmpty()) return;
     
+    // 关节集合即将变化，结束当前记录
+    stopRecording();
+    m_jitterBuffer.setJoints({});
+    
+    // 旧模型的Link即将销毁，先清理拾取数据
+    m_linkPicker.clear();
+    clearHover();
+    if (!m_selectedLink.isEmpty()) {
+        m_selectedLink.clear();
+        emit selectedLinkChanged();
+    }
+    
+    // 使用该URDF保存的导入配置
+    const QString savedProfile = SettingsManager::instance().getImportProfile(filePath);
+    if (!savedProfile.isEmpty() && savedProfile != m_importProfile) {
+        m_importProfile = savedProfile;
+        emit importProfileChanged();
+    }
+    if (auto robotEntity = robot()) {
+        robotEntity->setImportProfile(ImportProfile::byName(m_importProfile));
+    }
+    
+    m_loadingUrdfPath = filePath;
     m_isLoading = true;
     emit isLoadingChanged();
     
     m_statusMessage = tr("正在加载: %1").arg(filePath);
     emit statusMessageChanged();
     
-    if (m_scene->loadRobot(filePath)) {
-        m_lastUrdfPath = filePath;
-        m_robotName = QFileInfo(filePath).baseName();
-        emit robotNameChanged();
-        
-        m_statusMessage = tr("已加载: %1").arg(filePath);
-        emit statusMessageChanged();
+    // 异步加载：结果由onRobotLoaded / onLoadError / onLoadCanceled处理
+    m_scene->loadRobotAsync(filePath);
+}
+
+void RobotBridge::cancelLoad()
+{
+    if (m_isLoading) {
+        m_scene->cancelLoad();
+    }
+}
+
+void RobotBridge::onLoadProgressChanged(const QString& stage, double progress)
+{
+    static const QHash<QString, QString> stageNames = {
+        { "parse", tr("解析URDF") },
+        { "resolve", tr("解析网格路径") },
+        { "import", tr("导入网格") },
+        { "build", tr("构建场景") },
+    };
+    
+    m_loadProgress = progress;
+    m_loadStage = stageNames.value(stage, stage);
+    if (stage.isEmpty() || stage == "parse") {
+        m_skeletonReady = false;
     }
+    emit loadProgressChanged();
+}
+
+void RobotBridge::onSkeletonReady()
+{
+    // 骨架出现后关节即可拖动，网格随后逐个显示
+    m_skeletonReady = true;
+    emit loadProgressChanged();
     
+    updateJointInfoList();
+    updateLinkNames();
+}
+
+void RobotBridge::onLoadCanceled()
+{
     m_isLoading = false;
     emit isLoadingChanged();
+    
+    m_robotLoaded = false;
+    emit robotLoadedChanged();
+    updateJointInfoList();
+    updateLinkNames();
+    
+    m_statusMessage = tr("已取消加载: %1").arg(m_loadingUrdfPath);
+    emit statusMessageChanged();
+    
+    emit showMessage(tr("已取消加载"), false);
 }
 
 void RobotBridge::onRobotLoaded()
 {
+    if (m_isLoading) {
+        m_lastUrdfPath = m_loadingUrdfPath;
+        m_robotName = QFileInfo(m_loadingUrdfPath).baseName();
+        emit robotNameChanged();
+        
+        m_statusMessage = tr("已加载: %1").arg(m_loadingUrdfPath);
+        emit statusMessageChanged();
+        
+        m_isLoading = false;
+        emit isLoadingChanged();
+    }
+    
     m_robotLoaded = true;
     emit robotLoadedChanged();
     
     updateJointInfoList();
     updateLinkNames();
+    resetJitterBuffer();
     
     auto robot = m_scene->robotEntity();
     if (robot) {
+        // 构建拾取用的BVH（每个Link一次）
+        QElapsedTimer pickerTimer;
+        pickerTimer.start();
+        m_linkPicker.build(robot);
+        qDebug() << "RobotBridge: 拾取BVH构建耗时" << pickerTimer.elapsed() << "ms";
+        
+        // 导入耗时摘要（按耗时降序）
+        auto timings = robot->importStageTotals();
+        std::sort(timings.begin(), timings.end(),
+                  [](const ImportStageTiming& a, const ImportStageTiming& b) { return a.msec > b.msec; });
+        double totalMsec = 0.0;
+        QStringList stages;
+        for (const auto& timing : timings) {
+            totalMsec += timing.msec;
+            stages << QString("%1 %2 ms").arg(timing.stage).arg(timing.msec, 0, 'f', 1);
+        }
+        m_importSummary = timings.isEmpty() ? QString()
+                : tr("网格导入 %1 ms：%2").arg(totalMsec, 0, 'f', 1).arg(stages.join(", "));
+        emit importSummaryChanged();
+        
         // 连接末端位置信号
         connect(robot, &RobotEntity::endEffectorPositionChanged,
                 this, &RobotBridge::onEndEffectorPositionChanged);
@@ -303,6 +485,77 @@ RobotEntity* RobotBridge::robot() const
     return m_scene ? m_scene->robotEntity() : nullptr;
 }
 
+// Link拾取
+void RobotBridge::setPickingCamera(QObject* camera)
+{
+    m_pickingCamera = qobject_cast<Qt3DRender::QCamera*>(camera);
+    if (camera && !m_pickingCamera) {
+        qWarning() << "RobotBridge::setPickingCamera: 参数不是 Qt3D Camera";
+    }
+    
+    // 同一相机也用于基本几何体的细分级别切换
+    if (robot()) {
+        robot()->setLodCamera(m_pickingCamera);
+    }
+}
+
+LinkPicker::PickResult RobotBridge::pickLink(qreal x, qreal y,
+                                             qreal viewportWidth, qreal viewportHeight) const
+{
+    if (!m_pickingCamera || m_linkPicker.isEmpty()) return LinkPicker::PickResult();
+    
+    const QMatrix4x4 viewProjection = m_pickingCamera->projectionMatrix() * m_pickingCamera->viewMatrix();
+    QVector3D origin, direction;
+    if (!LinkPicker::viewportRay(viewProjection, QPointF(x, y),
+                                 QSizeF(viewportWidth, viewportHeight), &origin, &direction)) {
+        return LinkPicker::PickResult();
+    }
+    
+    return m_linkPicker.pick(origin, direction);
+}
+
+QString RobotBridge::hoverAt(qreal x, qreal y, qreal viewportWidth, qreal viewportHeight)
+{
+    const QString linkName = pickLink(x, y, viewportWidth, viewportHeight).linkName;
+    if (linkName != m_hoveredLink) {
+        m_hoveredLink = linkName;
+        if (auto robot = this->robot()) {
+            robot->setHighlightedLink(m_hoveredLink);
+        }
+        emit hoveredLinkChanged();
+    }
+    return linkName;
+}
+
+void RobotBridge::clearHover()
+{
+    if (m_hoveredLink.isEmpty()) return;
+    
+    m_hoveredLink.clear();
+    if (auto robot = this->robot()) {
+        robot->setHighlightedLink(QString());
+    }
+    emit hoveredLinkChanged();
+}
+
+QString RobotBridge::pickAt(qreal x, qreal y, qreal viewportWidth, qreal viewportHeight)
+{
+    const QString linkName = pickLink(x, y, viewportWidth, viewportHeight).linkName;
+    if (linkName != m_selectedLink) {
+        m_selectedLink = linkName;
+        emit selectedLinkChanged();
+    }
+    
+    if (!linkName.isEmpty()) {
+        auto robot = this->robot();
+        const QString jointName = robot ? robot->getControllingJoint(linkName) : QString();
+        m_statusMessage = tr("已选中Link: %1").arg(linkName);
+        emit statusMessageChanged();
+        emit linkPicked(linkName, jointName);
+    }
+    return linkName;
+}
+
 void RobotBridge::addEndEffectorConfig(const QString& linkName,
                                         const QString& displayName,
                                         const QString& colorHex)
@@ -379,6 +632,25 @@ void RobotBridge::setColoredLinks(bool colored)
     emit coloredLinksChanged();
 }
 
+void RobotBridge::setImportProfile(const QString& profile)
+{
+    const QString name = ImportProfile::byName(profile).name;
+    if (m_importProfile == name) return;
+    
+    m_importProfile = name;
+    emit importProfileChanged();
+    
+    if (auto robotEntity = robot()) {
+        robotEntity->setImportProfile(ImportProfile::byName(name));
+    }
+    
+    // 保存到当前URDF并重新加载以生效
+    if (m_robotLoaded && !m_lastUrdfPath.isEmpty()) {
+        SettingsManager::instance().setImportProfile(m_lastUrdfPath, name);
+        loadRobot(m_lastUrdfPath);
+    }
+}
+
 void RobotBridge::setZUpEnabled(bool enabled)
 {
     if (!m_viewOptions.setZUpEnabled(enabled, m_scene)) return;
@@ -400,6 +672,9 @@ void RobotBridge::setShowTrajectory(bool show)
 void RobotBridge::setTrajectoryLifetime(double seconds)
 {
     if (!m_viewOptions.setTrajectoryLifetime(seconds, m_scene)) return;
+    if (m_replay) {
+        m_replay->setTrajectoryWindow(m_viewOptions.state().trajectoryLifetime);
+    }
     emit trajectoryLifetimeChanged();
 }
 
@@ -422,51 +697,296 @@ void RobotBridge::setOpcuaSampleInterval(int ms)
 {
     if (m_opcuaSampleInterval == ms) return;
     m_opcuaSampleInterval = ms;
-    if (m_sampleTimer && m_sampleTimer->isActive()) {
+    if (qobject_cast<OPCUAConnector*>(m_opcuaConnector)) {
+        // 读取周期由连接器的采样流控制
+        restartSampling();
+    } else if (m_sampleTimer && m_sampleTimer->isActive()) {
         m_sampleTimer->setInterval(ms);
     }
     emit opcuaSampleIntervalChanged();
 }
 
+void RobotBridge::setOpcuaSubscription(bool enabled)
+{
+    if (m_opcuaSubscription == enabled) return;
+    
+    const bool sampling = m_opcuaSampling;
+    if (sampling) {
+        opcuaStopSampling();
+    }
+    m_opcuaSubscription = enabled;
+    if (auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector)) {
+        opcua->setSubscriptionEnabled(enabled);
+    }
+    if (sampling) {
+        opcuaStartSampling();
+    }
+    emit opcuaSubscriptionChanged();
+}
+
+void RobotBridge::setOpcuaPublishingInterval(int ms)
+{
+    ms = qBound(0, ms, 60000);
+    if (m_opcuaPublishingInterval == ms) return;
+    m_opcuaPublishingInterval = ms;
+    if (m_opcuaSubscription) restartSampling();
+    emit opcuaSubscriptionChanged();
+}
+
+void RobotBridge::setOpcuaSamplingInterval(int ms)
+{
+    ms = qBound(0, ms, 60000);
+    if (m_opcuaSamplingInterval == ms) return;
+    m_opcuaSamplingInterval = ms;
+    if (m_opcuaSubscription) restartSampling();
+    emit opcuaSubscriptionChanged();
+}
+
+void RobotBridge::setOpcuaQueueSize(int size)
+{
+    size = qBound(1, size, 1000);
+    if (m_opcuaQueueSize == size) return;
+    m_opcuaQueueSize = size;
+    if (m_opcuaSubscription) restartSampling();
+    emit opcuaSubscriptionChanged();
+}
+
+void RobotBridge::setOpcuaDeadband(double degrees)
+{
+    degrees = qMax(0.0, degrees);
+    if (qFuzzyCompare(m_opcuaDeadband + 1.0, degrees + 1.0)) return;
+    m_opcuaDeadband = degrees;
+    if (m_opcuaSubscription) restartSampling();
+    emit opcuaSubscriptionChanged();
+}
+
+void RobotBridge::setOpcuaPipelineDepth(int depth)
+{
+    depth = qBound(1, depth, 64);
+    if (m_opcuaPipelineDepth == depth) return;
+    m_opcuaPipelineDepth = depth;
+    if (auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector)) {
+        opcua->setPipelineDepth(m_opcuaPipelineDepth);
+    }
+    emit opcuaPipelineDepthChanged();
+}
+
+void RobotBridge::setSmoothingDelay(int ms)
+{
+    ms = qBound(0, ms, 5000);
+    if (m_smoothingDelay == ms) return;
+    m_smoothingDelay = ms;
+    if (m_opcuaSampling && m_smoothingTimer) {
+        if (ms > 0) {
+            m_smoothingTimer->start();
+        } else {
+            m_smoothingTimer->stop();
+        }
+    }
+    emit smoothingDelayChanged();
+}
+
+void RobotBridge::setExtrapolationLimit(int ms)
+{
+    ms = qBound(0, ms, 5000);
+    if (m_extrapolationLimit == ms) return;
+    m_extrapolationLimit = ms;
+    m_jitterBuffer.setExtrapolationLimit(qint64(ms) * 1000);
+    emit extrapolationLimitChanged();
+}
+
 void RobotBridge::setOpcuaNamespace(int ns)
 {
     if (m_opcuaNamespace == ns) return;
     m_opcuaNamespace = ns;
+    applyOpcuaNamespace();
     emit opcuaNamespaceChanged();
 }
 
 // OPC UA 操作
 void RobotBridge::opcuaConnect()
 {
-    if (!m_opcuaConnector) return;
+    // 用户发起的连接：取消正在等待的重连，失败时不自动重试
+    stopReconnect();
+    m_resumeSampling = false;
+    startOpcuaConnect();
+}
+
+void RobotBridge::startOpcuaConnect()
+{
+    // 地址为 file:// 或 .csv 时从CSV关节日志回放，其余按OPC UA服务器连接
+    const bool fileSource = FileReplayConnector::isFileSource(m_opcuaServerUrl);
+    if (m_opcuaConnector && fileSource != (qobject_cast<FileReplayConnector*>(m_opcuaConnector) != nullptr)) {
+        opcuaDisconnect();
+        delete m_opcuaConnector;
+        m_opcuaConnector = nullptr;
+    }
+    if (!m_opcuaConnector) {
+        if (fileSource) {
+            m_opcuaConnector = new FileReplayConnector(this);
+        } else {
+            auto opcua = new OPCUAConnector(this);
+            connect(opcua, &OPCUAConnector::connectFinished, this, &RobotBridge::onOpcuaConnectFinished);
+            connect(opcua, &OPCUAConnector::snapshotReady, this, &RobotBridge::onOpcuaSnapshotReady);
+            m_opcuaConnector = opcua;
+        }
+        connect(m_opcuaConnector, &BaseConnector::valueChanged, this, &RobotBridge::onOpcuaValueChanged);
+        connect(m_opcuaConnector, &BaseConnector::stateChanged, this, &RobotBridge::onOpcuaStateChanged);
+    }
+    
+    auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector);
+    if (opcua && opcua->isConnecting()) return;
+    
+    // 命名空间在连接前设置，连接时按它注册变量
+    applyOpcuaNamespace();
     
     QStringList paramList;
     paramList << m_opcuaServerUrl << m_opcuaPrefix;
-    if (m_opcuaConnector->init(paramList) == 0) {
+    if (opcua) {
+        // 绑定的变量在连接时一次注册，之后的采样都用服务器返回的句柄
+        rebuildSampleReadList();
+        QStringList nodeIds;
+        for (const auto& unit : m_sampleReadList) {
+            nodeIds << unit.path;
+        }
+        opcua->registerNodes(nodeIds);
+        
+        // 连接和读取服务器参数在后台进行，结果由 onOpcuaConnectFinished 处理
+        if (opcua->connectAsync(paramList) == 0) {
+            m_opcuaConnecting = true;
+            emit opcuaConnectionStateChanged();
+        }
+        return;
+    }
+    
+    // 文件回放只打开本地文件，直接初始化
+    onOpcuaConnectFinished(m_opcuaConnector->init(paramList));
+}
+
+void RobotBridge::onOpcuaConnectFinished(int ret)
+{
+    const bool fileSource = qobject_cast<FileReplayConnector*>(m_opcuaConnector) != nullptr;
+    const bool reconnecting = m_opcuaReconnecting;
+    m_opcuaConnecting = false;
+    
+    if (ret == 0) {
         m_opcuaConnected = true;
+        m_opcuaReconnecting = false;
+        m_reconnectAttempt = 0;
         emit opcuaConnectedChanged();
-        emit showMessage(tr("OPC UA 连接成功"), false);
-    } else {
-        emit showMessage(tr("OPC UA 连接失败"), true);
+        emit opcuaConnectionStateChanged();
+        emit showMessage(fileSource ? tr("文件回放已开始")
+                                    : reconnecting ? tr("OPC UA 已重新连接") : tr("OPC UA 连接成功"), false);
+        
+        // 断线前在采样的话继续采样：重新开始采样流，订阅模式下重新建立监听
+        if (m_resumeSampling) {
+            m_resumeSampling = false;
+            opcuaStartSampling();
+        }
+        return;
+    }
+    
+    if (reconnecting) {
+        scheduleReconnect();
+        return;
     }
+    
+    emit opcuaConnectionStateChanged();
+    emit showMessage(fileSource ? tr("无法打开回放文件") : tr("OPC UA 连接失败"), true);
+}
+
+void RobotBridge::onOpcuaStateChanged()
+{
+    // 只处理已建立的OPC UA连接被动断开（服务器关机、网络中断），连接器此时已自行释放
+    if (!m_opcuaConnected || !qobject_cast<OPCUAConnector*>(m_opcuaConnector)
+            || m_opcuaConnector->state() == 1) {
+        return;
+    }
+    
+    m_resumeSampling = m_opcuaSampling;
+    opcuaStopSampling();
+    m_opcuaConnected = false;
+    m_opcuaReconnecting = true;
+    m_reconnectAttempt = 0;
+    emit opcuaConnectedChanged();
+    emit showMessage(tr("OPC UA 连接已断开，正在重连"), true);
+    scheduleReconnect();
+}
+
+void RobotBridge::scheduleReconnect()
+{
+    // 指数退避：1s、2s、4s……最长30s，加上最多20%的随机抖动，避免多个客户端同时重连
+    const int baseDelay = qMin(kReconnectMaxDelay, kReconnectInitialDelay << qMin(m_reconnectAttempt, 5));
+    m_reconnectDelay = baseDelay + QRandomGenerator::global()->bounded(baseDelay / 5 + 1);
+    ++m_reconnectAttempt;
+    m_reconnectTimer->start(m_reconnectDelay);
+    emit opcuaConnectionStateChanged();
+}
+
+void RobotBridge::stopReconnect()
+{
+    if (m_reconnectTimer) {
+        m_reconnectTimer->stop();
+    }
+    m_opcuaReconnecting = false;
+    m_reconnectAttempt = 0;
+    m_reconnectDelay = 0;
+}
+
+void RobotBridge::onReconnectTimeout()
+{
+    if (!m_opcuaReconnecting) return;
+    startOpcuaConnect();
 }
 
 void RobotBridge::opcuaDisconnect()
 {
     if (!m_opcuaConnector) return;
     
+    const bool active = m_opcuaConnected || m_opcuaConnecting || m_opcuaReconnecting;
+    stopReconnect();
+    m_resumeSampling = false;
     opcuaStopSampling();
-    m_opcuaConnector->disconnect();
+    
+    // 先清除连接标记，release引起的状态变化不会被当作断线重连
     m_opcuaConnected = false;
+    m_opcuaConnecting = false;
+    m_opcuaConnector->release();
     emit opcuaConnectedChanged();
-    emit showMessage(tr("OPC UA 已断开"), false);
+    emit opcuaConnectionStateChanged();
+    if (active) {
+        emit showMessage(tr("OPC UA 已断开"), false);
+    }
 }
 
 void RobotBridge::opcuaStartSampling()
 {
     if (!m_opcuaConnected || !m_sampleTimer) return;
     
-    m_sampleTimer->start(m_opcuaSampleInterval);
+    // 实时数据与回放不能同时驱动机器人
+    if (m_replay) {
+        m_replay->pause();
+    }
+    
+    resetJitterBuffer();
+    if (auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector)) {
+        // 读取和订阅都在连接器的I/O线程中进行，发布快照时通知GUI线程从邮箱取最新的一份，
+        // 不用轮询定时器，没有新数据时GUI线程不会被唤醒
+        rebuildSampleReadList();
+        opcua->setSubscriptionEnabled(m_opcuaSubscription);
+        opcua->setSubscriptionParameters(m_opcuaPublishingInterval, m_opcuaSamplingInterval,
+                                         quint32(m_opcuaQueueSize), m_opcuaDeadband);
+        opcua->setPipelineDepth(m_opcuaPipelineDepth);
+        opcua->startSampleStream(m_sampleReadList, m_opcuaSampleInterval);
+    } else if (m_opcuaSubscription) {
+        // 订阅模式：值变化时由 onOpcuaValueChanged 直接更新关节
+        if (!startSubscription()) return;
+    } else {
+        m_sampleTimer->start(m_opcuaSampleInterval);
+    }
+    if (m_smoothingDelay > 0) {
+        m_smoothingTimer->start();
+    }
     m_opcuaSampling = true;
     emit opcuaSamplingChanged();
 }
@@ -476,6 +996,17 @@ void RobotBridge::opcuaStopSampling()
     if (m_sampleTimer) {
         m_sampleTimer->stop();
     }
+    if (m_smoothingTimer) {
+        m_smoothingTimer->stop();
+    }
+    if (auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector)) {
+        if (m_opcuaSampling) {
+            opcua->stopSampleStream();
+        }
+    } else if (m_opcuaSampling && m_opcuaSubscription && m_opcuaConnector) {
+        m_opcuaConnector->clearMonitor();
+    }
+    m_pendingJointValues.clear();
     m_opcuaSampling = false;
     emit opcuaSamplingChanged();
 }
@@ -489,40 +1020,199 @@ void RobotBridge::onSampleTimerTimeout()
     
     QMap<QString, double> jointValues;
     
-    // qDebug() << "OPC UA sampling, bindings count:" << m_opcuaBindings.rows().length();
+    if (m_sampleReadListDirty) {
+        rebuildSampleReadList();
+    }
+    if (m_sampleReadList.isEmpty()) return;
     
-    for (const auto& binding : m_opcuaBindings.rows()) {
-        if (!binding.enabled) {
-            qDebug() << "  Binding disabled:" << binding.jointName;
-            continue;
-        }
-        
-        const QString& jointName = binding.jointName;
-        const QString& nodeId = binding.nodeId;
-        
-        if (jointName.isEmpty() || nodeId.isEmpty()) {
-            qDebug() << "  Binding empty:" << jointName << nodeId;
-            continue;
-        }
-        
-        m_opcuaConnector->setNamespaceIndex(m_opcuaNamespace);
-        QVariant var;
-        if (m_opcuaConnector->readValue(nodeId, var) == 0) {
-            double degValue = var.toDouble();
-            double radValue = qDegreesToRadians(degValue);
-            jointValues[jointName] = radValue;
-            // qDebug() << "  Read:" << nodeId << "=" << degValue << "deg (" << radValue << "rad)";
-        } else {
-            // qDebug() << "  Failed to read:" << nodeId;
+    QElapsedTimer latencyTimer;
+    latencyTimer.start();
+    
+    // 所有启用的绑定一次批量读取（连接器内部按服务器的MaxNodesPerRead分批）
+    m_opcuaConnector->readValueList(m_sampleReadList);
+    collectJointValues(m_sampleReadList, &jointValues);
+
+    if (m_performanceMonitor) {
+        m_performanceMonitor->recordOpcuaLatency(latencyTimer.nsecsElapsed() / 1000);
+    }
+
+    applySampledJointValues(robot, jointValues, m_streamClock.nsecsElapsed() / 1000);
+}
+
+void RobotBridge::onOpcuaSnapshotReady()
+{
+    auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector);
+    if (!opcua) return;
+    
+    // 不加锁、不等待；收到通知总要取一次，连接器才会通知下一个快照
+    const OPCUAConnector::Snapshot* snapshot = opcua->takeSnapshot();
+    auto robot = this->robot();
+    if (!snapshot || !robot || !m_opcuaSampling || snapshot->dataList.size() != m_sampleJointNames.size()) return;
+    
+    QMap<QString, double> jointValues;
+    collectJointValues(snapshot->dataList, &jointValues);
+    if (m_performanceMonitor && snapshot->latencyUs > 0) {
+        m_performanceMonitor->recordOpcuaLatency(snapshot->latencyUs);
+    }
+    
+    // 数据到达I/O线程的时刻，不受GUI线程处理通知的延迟影响
+    const qint64 nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch()).count();
+    const qint64 ageUs = qMax<qint64>(0, nowUs - snapshot->timeUs);
+    const qint64 arrivalUs = m_streamClock.nsecsElapsed() / 1000 - ageUs;
+    
+    // 有源时间戳时按服务器采样的时刻排列，网络抖动不影响采样间隔；否则用到达时刻
+    applySampledJointValues(robot, jointValues, snapshot->sourceTimeUs > 0
+                            ? sourceToStreamTime(snapshot->sourceTimeUs, arrivalUs) : arrivalUs);
+}
+
+void RobotBridge::collectJointValues(const QList<BaseConnector::DataUnit>& dataList, QMap<QString, double>* jointValues) const
+{
+    // 个别节点读取失败时其值为无效，其余关节照常更新
+    for (int i = 0; i < dataList.size() && i < m_sampleJointNames.size(); ++i) {
+        const QVariant& var = dataList.at(i).value;
+        if (var.isValid()) {
+            // 数据源为角度，转换为弧度
+            (*jointValues)[m_sampleJointNames.at(i)] = qDegreesToRadians(var.toDouble());
         }
     }
+}
 
-    if (!jointValues.isEmpty()) {
+void RobotBridge::applySampledJointValues(RobotEntity* robot, const QMap<QString, double>& jointValues, qint64 timeUs)
+{
+    if (jointValues.isEmpty()) return;
+    
+    if (m_smoothingDelay > 0) {
+        // 由 onSmoothingTick 按帧插值驱动机器人
+        m_jitterBuffer.push(timeUs, jointValues);
+    } else {
         // setJointValues 会触发 jointValueChanged 信号
         // jointValueChanged 信号会被 onJointValueChanged 处理
         // onJointValueChanged 会发出 jointValueUpdated 信号给 QML
-        robot->setJointValues(jointValues);
+        robot->setJointValues(jointValues, timeUs);
+    }
+    
+    // 记录收到的采样本身（平滑时机器人显示的是延迟后的插值状态）
+    if (m_recorder && m_recorder->isRecording()) {
+        recordSample(robot, jointValues, timeUs);
+    }
+}
+
+qint64 RobotBridge::sourceToStreamTime(qint64 sourceTimeUs, qint64 arrivalUs)
+{
+    // 服务器时钟与本机时钟的偏移取观察到的最小值（即最短传输延迟），只会变小；
+    // 服务器时钟跳变或时间戳停滞导致偏移明显变大时重新对时
+    const qint64 offset = arrivalUs - sourceTimeUs;
+    if (!m_sourceClockValid || offset < m_sourceClockOffset
+            || offset - m_sourceClockOffset > kSourceClockResync) {
+        m_sourceClockOffset = offset;
+        m_sourceClockValid = true;
     }
+    return sourceTimeUs + m_sourceClockOffset;
+}
+
+void RobotBridge::onOpcuaValueChanged(const QString& path, const QVariant& value)
+{
+    if (!m_opcuaSampling || !m_opcuaSubscription || !value.isValid()) return;
+    
+    auto it = m_nodeJoints.constFind(path);
+    if (it == m_nodeJoints.constEnd()) return;
+    
+    // 数据源为角度，转换为弧度
+    const double radValue = qDegreesToRadians(value.toDouble());
+    for (const QString& jointName : it.value()) {
+        m_pendingJointValues[jointName] = radValue;
+    }
+    
+    // 同一次发布中的通知是连续排队的，排在它们之后统一应用
+    if (!m_flushPending) {
+        m_flushPending = true;
+        QMetaObject::invokeMethod(this, &RobotBridge::flushSubscribedValues, Qt::QueuedConnection);
+    }
+}
+
+void RobotBridge::flushSubscribedValues()
+{
+    m_flushPending = false;
+    QMap<QString, double> jointValues;
+    jointValues.swap(m_pendingJointValues);
+    
+    auto robot = this->robot();
+    if (!robot || !m_opcuaSampling) return;
+    
+    applySampledJointValues(robot, jointValues, m_streamClock.nsecsElapsed() / 1000);
+}
+
+bool RobotBridge::startSubscription()
+{
+    rebuildSampleReadList();
+    
+    m_opcuaConnector->clearMonitor();
+    
+    QString error;
+    const int ret = m_opcuaConnector->monitorValues(m_nodeJoints.keys(), &error);
+    if (ret == -2) {
+        emit showMessage(tr("部分变量订阅失败: %1").arg(error), true);
+    } else if (ret != 0) {
+        emit showMessage(tr("OPC UA 订阅失败"), true);
+        return false;
+    }
+    return true;
+}
+
+void RobotBridge::restartSampling()
+{
+    if (!m_opcuaSampling) return;
+    opcuaStopSampling();
+    opcuaStartSampling();
+}
+
+void RobotBridge::rebuildSampleReadList()
+{
+    // 采样请求只在绑定变化后重建，每个采样周期复用
+    m_sampleReadList.clear();
+    m_sampleJointNames.clear();
+    m_nodeJoints.clear();
+    for (const auto& binding : m_opcuaBindings.rows()) {
+        if (!binding.enabled || binding.jointName.isEmpty() || binding.nodeId.isEmpty()) continue;
+        
+        BaseConnector::DataUnit unit;
+        unit.path = binding.nodeId;
+        unit.type = BaseConnector::DOUBLE;
+        m_sampleReadList.append(unit);
+        m_sampleJointNames.append(binding.jointName);
+        m_nodeJoints[binding.nodeId].append(binding.jointName);
+    }
+    m_sampleReadListDirty = false;
+}
+
+void RobotBridge::applyOpcuaNamespace()
+{
+    if (auto opcua = qobject_cast<OPCUAConnector*>(m_opcuaConnector)) {
+        opcua->setNamespaceIndex(m_opcuaNamespace);
+    }
+}
+
+void RobotBridge::onSmoothingTick()
+{
+    auto robot = this->robot();
+    if (!robot || m_jitterBuffer.isEmpty()) return;
+    
+    QMap<QString, double> jointValues;
+    const qint64 displayUs = m_streamClock.nsecsElapsed() / 1000 - qint64(m_smoothingDelay) * 1000;
+    if (m_jitterBuffer.sample(displayUs, &jointValues) && !jointValues.isEmpty()) {
+        robot->setJointValues(jointValues, displayUs);
+    }
+}
+
+void RobotBridge::resetJitterBuffer()
+{
+    auto robot = this->robot();
+    m_jitterBuffer.setJoints(robot && robot->getModel() ? robot->getModel()->getMovableJoints()
+                                                         : QVector<std::shared_ptr<URDFJoint>>());
+    m_jitterBuffer.setExtrapolationLimit(qint64(m_extrapolationLimit) * 1000);
+    m_streamClock.start();
+    m_sourceClockValid = false;
 }
 
 void RobotBridge::addOpcuaBinding()
@@ -544,6 +1234,226 @@ void RobotBridge::updateOpcuaBinding(int index, const QString& jointName,
     emit opcuaBindingsChanged();
 }
 
+void RobotBridge::exportPerformanceCsv()
+{
+    if (!m_performanceMonitor) return;
+    
+    const QString defaultName = QString("performance_%1.csv")
+                                    .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    const QString defaultDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    
+    QString filename = QFileDialog::getSaveFileName(
+        nullptr,
+        tr("导出性能数据"),
+        QDir(defaultDir).filePath(defaultName),
+        tr("CSV文件 (*.csv)")
+    );
+    
+    if (filename.isEmpty()) return;
+    
+    if (m_performanceMonitor->exportCsv(filename)) {
+        emit showMessage(tr("性能数据已导出: %1").arg(filename), false);
+    } else {
+        emit showMessage(tr("性能数据导出失败: %1").arg(filename), true);
+    }
+}
+
+// 关节状态记录
+bool RobotBridge::recording() const
+{
+    return m_recorder && m_recorder->isRecording();
+}
+
+QString RobotBridge::recordingFile() const
+{
+    return recording() ? m_recorder->filePath() : QString();
+}
+
+qint64 RobotBridge::recordedSamples() const
+{
+    return m_recorder ? m_recorder->sampleCount() : 0;
+}
+
+qint64 RobotBridge::recordedBytes() const
+{
+    return m_recorder ? m_recorder->bytesWritten() : 0;
+}
+
+void RobotBridge::startRecording(const QString& filePath)
+{
+    if (!m_recorder || !m_robotLoaded) {
+        emit showMessage(tr("请先加载机器人"), true);
+        return;
+    }
+    
+    QString path = filePath;
+    if (path.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+        path = QDir(dir).filePath(QString("recording_%1.rvlog")
+                                  .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")));
+    }
+    
+    // 记录全部关节，以及已启用的末端执行器位姿
+    m_recordJoints = m_jointNames;
+    m_recordPoseLinks.clear();
+    for (const auto& config : m_endEffectorConfigs.rows()) {
+        if (config.enabled && !config.linkName.isEmpty() && !m_recordPoseLinks.contains(config.linkName)) {
+            m_recordPoseLinks << config.linkName;
+        }
+    }
+    
+    if (!m_recorder->start(path, m_recordJoints, m_recordPoseLinks)) {
+        emit showMessage(m_recorder->getErrorMessage(), true);
+        return;
+    }
+    
+    m_recordStartUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    m_lastRecordUs = m_recordStartUs;
+    m_recordClock.start();
+    m_recordStatsTimer.start();
+    emit recordingChanged();
+    emit recordingStatsChanged();
+    emit showMessage(tr("开始记录: %1").arg(path), false);
+}
+
+void RobotBridge::stopRecording()
+{
+    if (!recording()) return;
+    
+    const QString path = m_recorder->filePath();
+    m_recorder->stop();
+    emit recordingChanged();
+    emit recordingStatsChanged();
+    emit showMessage(tr("记录已保存: %1（%2 个采样）").arg(path).arg(m_recorder->sampleCount()), false);
+}
+
+void RobotBridge::recordSample(RobotEntity* robot, const QMap<QString, double>& jointValues, qint64 timeUs)
+{
+    QVector<double> values;
+    values.reserve(m_recordJoints.size() + m_recordPoseLinks.size() * JointLog::kPoseComponents);
+    
+    // 采样中没有的关节（未绑定）取当前值，位姿按采样的关节值计算
+    for (const QString& jointName : m_recordJoints) {
+        values.append(jointValues.value(jointName, robot->getJointValue(jointName)));
+    }
+    for (const QString& linkName : m_recordPoseLinks) {
+        const QMatrix4x4 pose = robot->getLinkWorldTransform(linkName, jointValues);
+        const QQuaternion rotation = QQuaternion::fromRotationMatrix(pose.toGenericMatrix<3, 3>());
+        values << pose(0, 3) << pose(1, 3) << pose(2, 3)
+               << rotation.scalar() << rotation.x() << rotation.y() << rotation.z();
+    }
+    
+    // timeUs 以 m_streamClock 计时，按采样的时间差换算到记录时间轴
+    const qint64 ageUs = qMax<qint64>(0, m_streamClock.nsecsElapsed() / 1000 - timeUs);
+    m_lastRecordUs = qMax(m_lastRecordUs, m_recordStartUs + m_recordClock.nsecsElapsed() / 1000 - ageUs);
+    m_recorder->append(m_lastRecordUs, values);
+    
+    if (m_recordStatsTimer.elapsed() >= 500) {
+        m_recordStatsTimer.restart();
+        emit recordingStatsChanged();
+    }
+}
+
+// 记录回放
+bool RobotBridge::replayOpen() const
+{
+    return m_replay && m_replay->isOpen();
+}
+
+bool RobotBridge::replayReady() const
+{
+    return m_replay && m_replay->isReady();
+}
+
+QString RobotBridge::replayFile() const
+{
+    return m_replay ? m_replay->filePath() : QString();
+}
+
+double RobotBridge::replayDuration() const
+{
+    return m_replay ? m_replay->duration() : 0.0;
+}
+
+bool RobotBridge::replayPlaying() const
+{
+    return m_replay && m_replay->isPlaying();
+}
+
+double RobotBridge::replayPosition() const
+{
+    return m_replay ? m_replay->position() : 0.0;
+}
+
+double RobotBridge::replaySpeed() const
+{
+    return m_replay ? m_replay->speed() : 1.0;
+}
+
+void RobotBridge::setReplaySpeed(double speed)
+{
+    if (m_replay) {
+        m_replay->setSpeed(speed);
+    }
+}
+
+void RobotBridge::openReplay()
+{
+    const QString defaultDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    const QString filename = QFileDialog::getOpenFileName(
+        nullptr,
+        tr("打开关节记录"),
+        defaultDir,
+        tr("关节记录 (*.rvlog);;所有文件 (*.*)")
+    );
+    
+    if (!filename.isEmpty()) {
+        openReplayFile(filename);
+    }
+}
+
+void RobotBridge::openReplayFile(const QString& filePath)
+{
+    if (!m_replay || filePath.isEmpty()) return;
+    
+    if (m_opcuaSampling) {
+        opcuaStopSampling();
+    }
+    
+    if (!m_replay->open(filePath)) {
+        emit showMessage(m_replay->getErrorMessage(), true);
+    }
+    emit replayStateChanged();
+}
+
+void RobotBridge::closeReplay()
+{
+    if (m_replay) {
+        m_replay->close();
+    }
+}
+
+void RobotBridge::replayPlay()
+{
+    if (m_replay) {
+        m_replay->play();
+    }
+}
+
+void RobotBridge::replayPause()
+{
+    if (m_replay) {
+        m_replay->pause();
+    }
+}
+
+void RobotBridge::replaySeek(double seconds)
+{
+    if (m_replay) {
+        m_replay->seek(seconds);
+    }
+}
+
 // 设置管理
 void RobotBridge::loadSettings()
 {
@@ -570,6 +1480,14 @@ void RobotBridge::loadSettings()
     setOpcuaPrefix(settings.getOpcuaPrefix());
     setOpcuaSampleInterval(settings.getOpcuaSampleInterval());
     setOpcuaNamespace(settings.getOpcuaNamespaceIndex());
+    setSmoothingDelay(settings.getSmoothingDelay());
+    setOpcuaSubscription(settings.getOpcuaSubscription());
+    setOpcuaPublishingInterval(settings.getOpcuaPublishingInterval());
+    setOpcuaSamplingInterval(settings.getOpcuaSamplingInterval());
+    setOpcuaQueueSize(settings.getOpcuaQueueSize());
+    setOpcuaDeadband(settings.getOpcuaDeadband());
+    setOpcuaPipelineDepth(settings.getOpcuaPipelineDepth());
+    setExtrapolationLimit(settings.getExtrapolationLimit());
     
     // 加载OPC UA绑定
     m_opcuaBindings.fromSettings(settings.getOpcuaBindings());
@@ -595,6 +1513,14 @@ void RobotBridge::saveSettings()
     settings.setOpcuaPrefix(m_opcuaPrefix);
     settings.setOpcuaSampleInterval(m_opcuaSampleInterval);
     settings.setOpcuaNamespaceIndex(m_opcuaNamespace);
+    settings.setSmoothingDelay(m_smoothingDelay);
+    settings.setOpcuaSubscription(m_opcuaSubscription);
+    settings.setOpcuaPublishingInterval(m_opcuaPublishingInterval);
+    settings.setOpcuaSamplingInterval(m_opcuaSamplingInterval);
+    settings.setOpcuaQueueSize(m_opcuaQueueSize);
+    settings.setOpcuaDeadband(m_opcuaDeadband);
+    settings.setOpcuaPipelineDepth(m_opcuaPipelineDepth);
+    settings.setExtrapolationLimit(m_extrapolationLimit);
     
     // 保存OPC UA绑定
     settings.setOpcuaBindings(m_opcuaBindings.toSettings());
@@ -1,4 +1,4 @@
-#ifndef ROBOTBRIDGE_H
+﻿#ifndef ROBOTBRIDGE_H
 #define ROBOTBRIDGE_H
 
 #include <QObject>
@@ -12,14 +12,28 @@
 #include "commontypes.h"
 #include "viewoptions.h"
 #include "opcuabindingmodel.h"
+#include "jointjitterbuffer.h"
+#include "communication/baseconnector.h"
 #include "endeffectorconfigmodel.h"
+#include "performancemonitor.h"
+#include "linkpicker.h"
+#include "assimpmodelloader.h"
+
+#include <QPointer>
+#include <QElapsedTimer>
 
 #pragma execution_character_set("utf-8")
 
 class RobotScene;
 class RobotEntity;
-class OPCUAConnector;
+class JointRecorder;
+class JointReplay;
 class QTimer;
+class QQuickWindow;
+
+namespace Qt3DRender {
+class QCamera;
+}
 
 /**
  * @brief RobotBridge - QML与C++机器人逻辑的桥接类
@@ -41,6 +55,9 @@ class RobotBridge : public QObject
     Q_PROPERTY(QString robotName READ robotName NOTIFY robotNameChanged)
     Q_PROPERTY(bool robotLoaded READ robotLoaded NOTIFY robotLoadedChanged)
     Q_PROPERTY(bool isLoading READ isLoading NOTIFY isLoadingChanged)
+    Q_PROPERTY(double loadProgress READ loadProgress NOTIFY loadProgressChanged)
+    Q_PROPERTY(QString loadStage READ loadStage NOTIFY loadProgressChanged)
+    Q_PROPERTY(bool skeletonReady READ skeletonReady NOTIFY loadProgressChanged)
     Q_PROPERTY(QString statusMessage READ statusMessage NOTIFY statusMessageChanged)
     
     // 末端执行器位置
@@ -70,8 +87,47 @@ class RobotBridge : public QObject
     Q_PROPERTY(int opcuaSampleInterval READ opcuaSampleInterval WRITE setOpcuaSampleInterval NOTIFY opcuaSampleIntervalChanged)
     Q_PROPERTY(int opcuaNamespace READ opcuaNamespace WRITE setOpcuaNamespace NOTIFY opcuaNamespaceChanged)
     Q_PROPERTY(bool opcuaConnected READ opcuaConnected NOTIFY opcuaConnectedChanged)
+    Q_PROPERTY(bool opcuaConnecting READ opcuaConnecting NOTIFY opcuaConnectionStateChanged)
+    Q_PROPERTY(bool opcuaReconnecting READ opcuaReconnecting NOTIFY opcuaConnectionStateChanged)
+    Q_PROPERTY(int opcuaReconnectAttempt READ opcuaReconnectAttempt NOTIFY opcuaConnectionStateChanged)
+    Q_PROPERTY(int opcuaReconnectDelay READ opcuaReconnectDelay NOTIFY opcuaConnectionStateChanged)
     Q_PROPERTY(bool opcuaSampling READ opcuaSampling NOTIFY opcuaSamplingChanged)
     Q_PROPERTY(QVariantList opcuaBindings READ opcuaBindings NOTIFY opcuaBindingsChanged)
+    Q_PROPERTY(bool opcuaSubscription READ opcuaSubscription WRITE setOpcuaSubscription NOTIFY opcuaSubscriptionChanged)
+    Q_PROPERTY(int opcuaPublishingInterval READ opcuaPublishingInterval WRITE setOpcuaPublishingInterval NOTIFY opcuaSubscriptionChanged)
+    Q_PROPERTY(int opcuaSamplingInterval READ opcuaSamplingInterval WRITE setOpcuaSamplingInterval NOTIFY opcuaSubscriptionChanged)
+    Q_PROPERTY(int opcuaQueueSize READ opcuaQueueSize WRITE setOpcuaQueueSize NOTIFY opcuaSubscriptionChanged)
+    Q_PROPERTY(double opcuaDeadband READ opcuaDeadband WRITE setOpcuaDeadband NOTIFY opcuaSubscriptionChanged)
+    Q_PROPERTY(int opcuaPipelineDepth READ opcuaPipelineDepth WRITE setOpcuaPipelineDepth NOTIFY opcuaPipelineDepthChanged)
+    Q_PROPERTY(int smoothingDelay READ smoothingDelay WRITE setSmoothingDelay NOTIFY smoothingDelayChanged)
+    Q_PROPERTY(int extrapolationLimit READ extrapolationLimit WRITE setExtrapolationLimit NOTIFY extrapolationLimitChanged)
+    
+    // 关节状态记录
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    Q_PROPERTY(QString recordingFile READ recordingFile NOTIFY recordingChanged)
+    Q_PROPERTY(qint64 recordedSamples READ recordedSamples NOTIFY recordingStatsChanged)
+    Q_PROPERTY(qint64 recordedBytes READ recordedBytes NOTIFY recordingStatsChanged)
+    
+    // 记录回放
+    Q_PROPERTY(bool replayOpen READ replayOpen NOTIFY replayStateChanged)
+    Q_PROPERTY(bool replayReady READ replayReady NOTIFY replayStateChanged)
+    Q_PROPERTY(QString replayFile READ replayFile NOTIFY replayStateChanged)
+    Q_PROPERTY(double replayDuration READ replayDuration NOTIFY replayStateChanged)
+    Q_PROPERTY(bool replayPlaying READ replayPlaying NOTIFY replayPlayingChanged)
+    Q_PROPERTY(double replayPosition READ replayPosition NOTIFY replayPositionChanged)
+    Q_PROPERTY(double replaySpeed READ replaySpeed WRITE setReplaySpeed NOTIFY replaySpeedChanged)
+    
+    // 性能监视
+    Q_PROPERTY(PerformanceMonitor* performance READ performance CONSTANT)
+    
+    // Link拾取
+    Q_PROPERTY(QString hoveredLink READ hoveredLink NOTIFY hoveredLinkChanged)
+    Q_PROPERTY(QString selectedLink READ selectedLink NOTIFY selectedLinkChanged)
+    
+    // 网格导入配置
+    Q_PROPERTY(QString importProfile READ importProfile WRITE setImportProfile NOTIFY importProfileChanged)
+    Q_PROPERTY(QStringList importProfiles READ importProfiles CONSTANT)
+    Q_PROPERTY(QString importSummary READ importSummary NOTIFY importSummaryChanged)
     
 public:
     explicit RobotBridge(QObject *parent = nullptr);
@@ -86,6 +142,22 @@ public:
     // 获取3D场景根实体（用于QML Scene3D挂载）
     Qt3DCore::QEntity* sceneRoot() const;
     
+    // 性能监视器
+    PerformanceMonitor* performance() const { return m_performanceMonitor; }
+    
+    // 绑定主窗口以测量帧时间
+    void attachWindow(QQuickWindow* window);
+    
+    // Link拾取
+    QString hoveredLink() const { return m_hoveredLink; }
+    QString selectedLink() const { return m_selectedLink; }
+    
+    // 网格导入配置（按URDF文件保存，切换后重新加载当前机器人）
+    QString importProfile() const { return m_importProfile; }
+    void setImportProfile(const QString& profile);
+    QStringList importProfiles() const { return ImportProfile::names(); }
+    QString importSummary() const { return m_importSummary; }
+    
     // 版本
     QString version() const { return "0.1.0"; }
     
@@ -93,6 +165,9 @@ public:
     QString robotName() const { return m_robotName; }
     bool robotLoaded() const { return m_robotLoaded; }
     bool isLoading() const { return m_isLoading; }
+    double loadProgress() const { return m_loadProgress; }
+    QString loadStage() const { return m_loadStage; }
+    bool skeletonReady() const { return m_skeletonReady; }
     QString statusMessage() const { return m_statusMessage; }
     
     // 末端位置
@@ -132,19 +207,56 @@ public:
     int opcuaSampleInterval() const { return m_opcuaSampleInterval; }
     int opcuaNamespace() const { return m_opcuaNamespace; }
     bool opcuaConnected() const { return m_opcuaConnected; }
+    bool opcuaConnecting() const { return m_opcuaConnecting; }
+    bool opcuaReconnecting() const { return m_opcuaReconnecting; }
+    int opcuaReconnectAttempt() const { return m_reconnectAttempt; }
+    int opcuaReconnectDelay() const { return m_reconnectDelay; }
     bool opcuaSampling() const { return m_opcuaSampling; }
     QVariantList opcuaBindings() const { return m_opcuaBindings.toVariantList(); }
+    bool opcuaSubscription() const { return m_opcuaSubscription; }
+    int opcuaPublishingInterval() const { return m_opcuaPublishingInterval; }
+    int opcuaSamplingInterval() const { return m_opcuaSamplingInterval; }
+    int opcuaQueueSize() const { return m_opcuaQueueSize; }
+    double opcuaDeadband() const { return m_opcuaDeadband; }
+    int opcuaPipelineDepth() const { return m_opcuaPipelineDepth; }
+    int smoothingDelay() const { return m_smoothingDelay; }
+    int extrapolationLimit() const { return m_extrapolationLimit; }
     
     // OPC UA Setters
     void setOpcuaServerUrl(const QString& url);
     void setOpcuaPrefix(const QString& prefix);
     void setOpcuaSampleInterval(int ms);
     void setOpcuaNamespace(int ns);
+    void setOpcuaSubscription(bool enabled);
+    void setOpcuaPublishingInterval(int ms);
+    void setOpcuaSamplingInterval(int ms);
+    void setOpcuaQueueSize(int size);
+    void setOpcuaDeadband(double degrees);
+    void setOpcuaPipelineDepth(int depth);
+    void setSmoothingDelay(int ms);
+    void setExtrapolationLimit(int ms);
+    
+    // 关节状态记录
+    bool recording() const;
+    QString recordingFile() const;
+    qint64 recordedSamples() const;
+    qint64 recordedBytes() const;
+    
+    // 记录回放
+    bool replayOpen() const;
+    bool replayReady() const;
+    QString replayFile() const;
+    double replayDuration() const;
+    bool replayPlaying() const;
+    double replayPosition() const;
+    double replaySpeed() const;
+    void setReplaySpeed(double speed);
     
 public slots:
     // 文件操作
     void openURDF();
     void loadRobot(const QString& filePath);
+    Q_INVOKABLE void cancelLoad();
     
     // 相机控制
     Q_INVOKABLE void resetCamera();
@@ -153,6 +265,12 @@ public slots:
     // 将C++场景挂载到QML的Scene3D根节点
     Q_INVOKABLE void attachToSceneRoot(Qt3DCore::QEntity* qmlSceneRoot);
     
+    // Link拾取（坐标为3D视图内的像素坐标）
+    Q_INVOKABLE void setPickingCamera(QObject* camera);
+    Q_INVOKABLE QString hoverAt(qreal x, qreal y, qreal viewportWidth, qreal viewportHeight);
+    Q_INVOKABLE QString pickAt(qreal x, qreal y, qreal viewportWidth, qreal viewportHeight);
+    Q_INVOKABLE void clearHover();
+    
     // 关节控制
     void setJointValue(const QString& jointName, double value);
     void resetAllJoints();
@@ -177,11 +295,27 @@ public slots:
     void updateOpcuaBinding(int index, const QString& jointName, 
                            const QString& nodeId, bool enabled);
     
+    // 关节状态记录（采样时追加关节值和已启用末端的位姿；文件路径为空时写到文档目录）
+    Q_INVOKABLE void startRecording(const QString& filePath = QString());
+    Q_INVOKABLE void stopRecording();
+    
+    // 记录回放（打开时停止OPC UA采样）
+    Q_INVOKABLE void openReplay();
+    Q_INVOKABLE void openReplayFile(const QString& filePath);
+    Q_INVOKABLE void closeReplay();
+    Q_INVOKABLE void replayPlay();
+    Q_INVOKABLE void replayPause();
+    Q_INVOKABLE void replaySeek(double seconds);
+    
+    // 性能数据导出
+    Q_INVOKABLE void exportPerformanceCsv();
+    
 signals:
     // 机器人状态信号
     void robotNameChanged();
     void robotLoadedChanged();
     void isLoadingChanged();
+    void loadProgressChanged();
     void statusMessageChanged();
     void endEffectorPositionChanged();
     void jointInfoListChanged();
@@ -208,8 +342,23 @@ signals:
     void opcuaSampleIntervalChanged();
     void opcuaNamespaceChanged();
     void opcuaConnectedChanged();
+    void opcuaConnectionStateChanged();
     void opcuaSamplingChanged();
     void opcuaBindingsChanged();
+    void opcuaSubscriptionChanged();
+    void opcuaPipelineDepthChanged();
+    void smoothingDelayChanged();
+    void extrapolationLimitChanged();
+    
+    // 记录信号
+    void recordingChanged();
+    void recordingStatsChanged();
+    
+    // 回放信号
+    void replayStateChanged();
+    void replayPlayingChanged();
+    void replayPositionChanged();
+    void replaySpeedChanged();
     
     // 消息提示信号
     void showMessage(const QString& message, bool isError);
@@ -218,12 +367,30 @@ signals:
     void resetCameraRequested();
     void fitCameraRequested(const QVector3D& center, const QVector3D& position);
     
+    // Link拾取信号
+    void hoveredLinkChanged();
+    void selectedLinkChanged();
+    void linkPicked(const QString& linkName, const QString& jointName);
+    
+    // 网格导入信号
+    void importProfileChanged();
+    void importSummaryChanged();
+    
 private slots:
     void onRobotLoaded();
     void onLoadError(const QString& error);
+    void onLoadCanceled();
+    void onLoadProgressChanged(const QString& stage, double progress);
+    void onSkeletonReady();
     void onJointValueChanged(const QString& jointName, double value);
     void onEndEffectorPositionChanged(const QVector3D& position);
     void onSampleTimerTimeout();
+    void onOpcuaSnapshotReady();
+    void onSmoothingTick();
+    void onOpcuaConnectFinished(int ret);
+    void onOpcuaStateChanged();
+    void onReconnectTimeout();
+    void onOpcuaValueChanged(const QString& path, const QVariant& value);
     
 private:
     void updateJointInfoList();
@@ -231,7 +398,21 @@ private:
     void saveSettings();
     void setupConnections();
     void updateLinkNames();
+    void recordSample(RobotEntity* robot, const QMap<QString, double>& jointValues, qint64 timeUs);
+    void resetJitterBuffer();
+    void startOpcuaConnect();
+    void scheduleReconnect();
+    void stopReconnect();
+    void rebuildSampleReadList();
+    void collectJointValues(const QList<BaseConnector::DataUnit>& dataList, QMap<QString, double>* jointValues) const;
+    void applySampledJointValues(RobotEntity* robot, const QMap<QString, double>& jointValues, qint64 timeUs);
+    qint64 sourceToStreamTime(qint64 sourceTimeUs, qint64 arrivalUs);
+    bool startSubscription();
+    void flushSubscribedValues();
+    void restartSampling();
+    void applyOpcuaNamespace();
     RobotEntity* robot() const;
+    LinkPicker::PickResult pickLink(qreal x, qreal y, qreal viewportWidth, qreal viewportHeight) const;
     
     // 场景
     RobotScene* m_scene = nullptr;
@@ -240,8 +421,12 @@ private:
     QString m_robotName;
     bool m_robotLoaded = false;
     bool m_isLoading = false;
+    double m_loadProgress = 0.0;
+    QString m_loadStage;
+    bool m_skeletonReady = false;
     QString m_statusMessage;
     QString m_lastUrdfPath;
+    QString m_loadingUrdfPath;  // 正在异步加载的URDF
     
     // 末端位置
     QVector3D m_endEffectorPosition;
@@ -257,8 +442,8 @@ private:
     // 视图选项
     ViewOptions m_viewOptions;
     
-    // OPC UA
-    OPCUAConnector* m_opcuaConnector = nullptr;
+    // OPC UA（服务器地址为CSV文件时改用文件回放连接器）
+    BaseConnector* m_opcuaConnector = nullptr;
     QTimer* m_sampleTimer = nullptr;
     QString m_opcuaServerUrl = "opc.tcp://localhost:4840";
     QString m_opcuaPrefix;
@@ -267,6 +452,63 @@ private:
     bool m_opcuaConnected = false;
     bool m_opcuaSampling = false;
     OpcuaBindingModel m_opcuaBindings;
+    QList<BaseConnector::DataUnit> m_sampleReadList;   // 启用的绑定，批量读取时复用
+    QStringList m_sampleJointNames;                     // 与 m_sampleReadList 一一对应
+    bool m_sampleReadListDirty = true;
+    
+    // 订阅模式：数据变化由服务器推送，直接更新关节，不使用采样定时器
+    // opcuaSampleInterval 只用于轮询模式；opcuaSamplingInterval 是服务器端的采样间隔
+    bool m_opcuaSubscription = false;
+    int m_opcuaPublishingInterval = 50;
+    int m_opcuaSamplingInterval = 20;
+    int m_opcuaQueueSize = 4;
+    double m_opcuaDeadband = 0.0;       // 角度
+    int m_opcuaPipelineDepth = 4;       // 轮询模式同时在途的读取请求数
+    QHash<QString, QStringList> m_nodeJoints;   // 节点 -> 绑定的关节
+    QMap<QString, double> m_pendingJointValues; // 同一次发布的通知合并后一次应用
+    bool m_flushPending = false;
+    
+    // 连接在后台进行；连接建立后被动断开时按指数退避自动重连，恢复后继续采样
+    bool m_opcuaConnecting = false;
+    bool m_opcuaReconnecting = false;
+    bool m_resumeSampling = false;
+    int m_reconnectAttempt = 0;
+    int m_reconnectDelay = 0;           // 本次重连前的等待（毫秒）
+    QTimer* m_reconnectTimer = nullptr;
+    
+    // 采样平滑：采样按接收时间进入抖动缓冲，显示滞后 m_smoothingDelay 毫秒按帧插值
+    JointJitterBuffer m_jitterBuffer;
+    QTimer* m_smoothingTimer = nullptr;
+    QElapsedTimer m_streamClock;
+    qint64 m_sourceClockOffset = 0;     // 源时间戳（服务器UTC）到 m_streamClock 的偏移
+    bool m_sourceClockValid = false;
+    int m_smoothingDelay = 150;         // 0 表示不平滑，采样直接驱动机器人
+    int m_extrapolationLimit = 50;
+    
+    // 关节状态记录
+    JointRecorder* m_recorder = nullptr;
+    QStringList m_recordJoints;
+    QStringList m_recordPoseLinks;
+    QElapsedTimer m_recordClock;        // 微秒时间戳 = 开始时的UTC时间 + 单调时钟
+    qint64 m_recordStartUs = 0;
+    qint64 m_lastRecordUs = 0;          // 回放按时间二分查找，时间戳不能倒退
+    QElapsedTimer m_recordStatsTimer;   // 限制统计信号的频率
+    
+    // 记录回放
+    JointReplay* m_replay = nullptr;
+    
+    // 性能监视
+    PerformanceMonitor* m_performanceMonitor = nullptr;
+    
+    // Link拾取
+    LinkPicker m_linkPicker;
+    QPointer<Qt3DRender::QCamera> m_pickingCamera;
+    QString m_hoveredLink;
+    QString m_selectedLink;
+    
+    // 网格导入
+    QString m_importProfile = ImportProfile::fullQuality().name;
+    QString m_importSummary;
 };
 
 #endif // ROBOTBRIDGE_H
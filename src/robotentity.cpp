@@ -1,17 +1,21 @@
 ﻿#include "robotentity.h"
-#include "assimpmodelloader.h"
 #include "trajectoryentity.h"
+#include "texturecache.h"
+#include "primitivemeshcache.h"
+#include "tracelog.h"
 
-#include <Qt3DExtras/QCuboidMesh>
-#include <Qt3DExtras/QCylinderMesh>
-#include <Qt3DExtras/QSphereMesh>
 #include <Qt3DExtras/QPhongMaterial>
 #include <Qt3DRender/QGeometry>
 #include <Qt3DRender/QGeometryRenderer>
 #include <Qt3DRender/QAttribute>
 #include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QAbstractTexture>
 #include <QtMath>
 #include <QDebug>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <algorithm>
 #include <limits>
 
 // ==================== LinkEntity ====================
@@ -211,8 +215,8 @@ RobotEntity::RobotEntity(Qt3DCore::QEntity* parent)
     m_robotTransform = new Qt3DCore::QTransform(this);
     addComponent(m_robotTransform);
     
-    m_trajectoryTimer = new QTimer(this);
-    connect(m_trajectoryTimer, &QTimer::timeout, this, &RobotEntity::sampleTrajectory);
+    m_textureCache = new TextureCache(this);
+    m_primitiveCache = new PrimitiveMeshCache(this);
 }
 
 RobotEntity::~RobotEntity()
@@ -222,7 +226,17 @@ RobotEntity::~RobotEntity()
 
 void RobotEntity::clear()
 {
-    m_trajectoryTimer->stop();
+    // 作废进行中的异步加载（工作线程结果按代数丢弃）
+    if (m_loadCancel) {
+        *m_loadCancel = true;
+        m_loadCancel.reset();
+    }
+    ++m_loadGeneration;
+    m_pendingMeshes.clear();
+    m_meshSizes.clear();
+    m_meshesRemaining = 0;
+    m_skeletonParts.clear();
+    m_deferMeshes = false;
     
     // 删除所有实体
     for (auto entity : m_linkEntities) {
@@ -237,6 +251,11 @@ void RobotEntity::clear()
     
     // 清除材质信息
     m_linkMaterials.clear();
+    m_textureCache->clear();
+    m_primitiveCache->clear();
+    m_primitiveMaterials.clear();
+    m_importStageTotals.clear();
+    m_highlightedLink.clear();
     
     m_model.reset();
     m_endEffectorLink.clear();
@@ -250,6 +269,9 @@ void RobotEntity::clear()
 
 bool RobotEntity::loadFromURDF(const QString& urdfFile)
 {
+    TRACE_SCOPE_DETAIL("RobotEntity::loadFromURDF", urdfFile);
+    
+    cancelLoad();
     clear();
     
     if (!m_parser.loadFromFile(urdfFile)) {
@@ -263,21 +285,284 @@ bool RobotEntity::loadFromURDF(const QString& urdfFile)
         return false;
     }
     
+    // 导入耗时汇总
+    if (!m_importStageTotals.isEmpty()) {
+        QStringList stages;
+        for (const auto& timing : m_importStageTotals) {
+            stages << QString("%1 %2ms").arg(timing.stage).arg(timing.msec, 0, 'f', 1);
+        }
+        qDebug() << "Mesh import totals [" << m_importProfile.name << "]:" << stages.join(", ");
+    }
+    
     // 自动检测末端执行器
     findEndEffectorLink();
     
-    // 启动轨迹采样
-    if (m_trajectoryEnabled && m_trajectoryEntity) {
-        m_trajectoryTimer->start(50); // 50ms采样间隔
+    emit robotLoaded();
+    
+    return true;
+}
+
+void RobotEntity::loadFromURDFAsync(const QString& urdfFile)
+{
+    clear();
+    
+    m_loadCancel = std::make_shared<std::atomic_bool>(false);
+    const int generation = m_loadGeneration;
+    setLoadStage("parse", 0.0);
+    
+    // 解析在工作线程进行（使用独立的解析器副本）
+    // 工作线程不访问本对象，结果与阶段切换都经QFutureWatcher回到GUI线程
+    auto* watcher = new QFutureWatcher<ParseResult>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_loadGeneration) return;
+        const ParseResult result = watcher->result();
+        if (!result.ok) {
+            onParseFinished(result);
+            return;
+        }
+        resolveMeshesAsync(result);
+    });
+    watcher->setFuture(QtConcurrent::run([urdfFile]() {
+        TRACE_SCOPE_DETAIL("RobotEntity::parseAsync", urdfFile);
+        ParseResult result;
+        result.ok = result.parser.loadFromFile(urdfFile);
+        return result;
+    }));
+}
+
+void RobotEntity::resolveMeshesAsync(const ParseResult& parsed)
+{
+    const int generation = m_loadGeneration;
+    setLoadStage("resolve", 0.1);
+    
+    auto cancel = m_loadCancel;
+    auto* watcher = new QFutureWatcher<ParseResult>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_loadGeneration) return;
+        onParseFinished(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([parsed, cancel]() {
+        TRACE_SCOPE("RobotEntity::resolveMeshes");
+        ParseResult result = parsed;
+        
+        // 解析网格路径并统计文件大小（用于按字节估算导入进度）
+        auto model = result.parser.getModel();
+        for (const auto& link : model->links) {
+            for (const auto& visual : link->visuals) {
+                if (*cancel) return result;
+                if (visual.geometry.type != GeometryType::Mesh) continue;
+                const QString meshPath = result.parser.resolveMeshPath(visual.geometry.meshFilename);
+                if (!result.meshSizes.contains(meshPath)) {
+                    result.meshSizes.insert(meshPath, QFileInfo(meshPath).size());
+                }
+            }
+        }
+        return result;
+    }));
+}
+
+void RobotEntity::cancelLoad()
+{
+    if (!isLoading()) return;
+    
+    qDebug() << "Robot load canceled at stage" << m_loadStage;
+    clear();
+    setLoadStage(QString(), 0.0);
+    emit loadCanceled();
+}
+
+void RobotEntity::onParseFinished(const ParseResult& result)
+{
+    TRACE_SCOPE("RobotEntity::onParseFinished");
+    
+    if (!result.ok) {
+        m_errorMessage = result.parser.getErrorMessage();
+        m_loadCancel.reset();
+        setLoadStage(QString(), 0.0);
+        emit loadFailed(m_errorMessage);
+        return;
+    }
+    
+    m_parser = result.parser;
+    m_model = m_parser.getModel();
+    m_meshSizes = result.meshSizes;
+    
+    // 创建Link/关节树与基本几何体，网格只记录不导入
+    m_deferMeshes = true;
+    const bool built = buildRobotTree();
+    m_deferMeshes = false;
+    if (!built) {
+        const QString error = m_errorMessage;
+        clear();
+        setLoadStage(QString(), 0.0);
+        emit loadFailed(error);
+        return;
+    }
+    
+    createSkeleton();
+    findEndEffectorLink();
+    setLoadStage("import", 0.15);
+    TraceLog::addInstant("skeleton ready");
+    emit skeletonReady();
+    
+    // 所有网格同时提交到全局线程池（由线程池限制并发数）
+    const QList<PendingMesh> pending = m_pendingMeshes;
+    m_pendingMeshes.clear();
+    m_meshesRemaining = pending.size();
+    m_meshBytesTotal = 0;
+    m_meshBytesDone = 0;
+    for (const auto& mesh : pending) {
+        m_meshBytesTotal += qMax<qint64>(mesh.fileSize, 1);
+    }
+    
+    if (pending.isEmpty()) {
+        finishAsyncLoad();
+        return;
+    }
+    for (const auto& mesh : pending) {
+        startMeshImport(mesh);
+    }
+}
+
+void RobotEntity::startMeshImport(const PendingMesh& pending)
+{
+    // 加载器在主线程配置，prepare()在工作线程执行，build()回到主线程创建Qt3D节点
+    auto loader = std::make_shared<AssimpModelLoader>();
+    configureLoader(*loader, pending.visual);
+    
+    const int generation = m_loadGeneration;
+    auto cancel = m_loadCancel;
+    auto* watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, loader, pending, generation]() {
+        watcher->deleteLater();
+        if (generation != m_loadGeneration) return;
+        onMeshImported(pending, loader.get(), watcher->result());
+    });
+    const QString meshPath = pending.meshPath;
+    watcher->setFuture(QtConcurrent::run([loader, meshPath, cancel]() {
+        if (*cancel) return false;
+        return loader->prepare(meshPath);
+    }));
+}
+
+void RobotEntity::onMeshImported(const PendingMesh& pending, AssimpModelLoader* loader, bool prepared)
+{
+    if (!prepared) {
+        qWarning() << "Failed to load mesh:" << pending.meshPath;
+        qWarning() << "Error:" << loader->getErrorMessage();
+    } else if (pending.container) {
+        attachMeshVisual(*loader, pending.visual, pending.meshPath, pending.container, pending.linkIndex);
+        
+        // 新到的材质跟随当前着色/高亮状态
+        if (m_coloredLinksEnabled) {
+            applyLinkColors(true);
+        }
+        if (!m_highlightedLink.isEmpty()) {
+            applyLinkHighlight(m_highlightedLink, true);
+        }
+    }
+    
+    m_meshBytesDone += qMax<qint64>(pending.fileSize, 1);
+    const double fraction = m_meshBytesTotal > 0 ? double(m_meshBytesDone) / m_meshBytesTotal : 1.0;
+    setLoadStage("import", 0.15 + 0.8 * fraction);
+    
+    if (--m_meshesRemaining == 0) {
+        finishAsyncLoad();
+    }
+}
+
+void RobotEntity::finishAsyncLoad()
+{
+    setLoadStage("build", 0.95);
+    removeSkeleton();
+    m_loadCancel.reset();
+    
+    // 导入耗时汇总
+    if (!m_importStageTotals.isEmpty()) {
+        QStringList stages;
+        for (const auto& timing : m_importStageTotals) {
+            stages << QString("%1 %2ms").arg(timing.stage).arg(timing.msec, 0, 'f', 1);
+        }
+        qDebug() << "Mesh import totals [" << m_importProfile.name << "]:" << stages.join(", ");
     }
     
+    setLoadStage(QString(), 1.0);
+    TraceLog::addInstant("robot loaded");
     emit robotLoaded();
+}
+
+void RobotEntity::createSkeleton()
+{
+    if (!m_skeletonMaterial) {
+        m_skeletonMaterial = new Qt3DExtras::QPhongMaterial(this);
+        m_skeletonMaterial->setDiffuse(QColor(0, 200, 140));
+        m_skeletonMaterial->setAmbient(QColor(0, 120, 84));
+    }
     
-    return true;
+    // 骨架粗细按最长关节偏移估算
+    float longest = 0.0f;
+    for (auto jointEntity : m_jointEntities) {
+        longest = qMax(longest, jointEntity->joint()->origin.position().length());
+    }
+    const float radius = qMax(0.002f, longest * 0.03f);
+    
+    auto addPart = [this](Qt3DCore::QEntity* parent, const Geometry& geometry, const QMatrix4x4& matrix) {
+        Qt3DCore::QEntity* part = new Qt3DCore::QEntity(parent);
+        m_primitiveCache->attach(part, geometry);
+        Qt3DCore::QTransform* transform = new Qt3DCore::QTransform(part);
+        transform->setMatrix(matrix * PrimitiveMeshCache::unitTransform(geometry));
+        part->addComponent(transform);
+        part->addComponent(m_skeletonMaterial);
+        m_skeletonParts.append(part);
+    };
+    
+    // Link原点标记
+    Geometry marker;
+    marker.type = GeometryType::Sphere;
+    marker.sphereRadius = radius * 2.0f;
+    for (auto linkEntity : m_linkEntities) {
+        addPart(linkEntity, marker, QMatrix4x4());
+    }
+    
+    // 父Link原点到关节原点的连线（关节实体是父Link实体的子节点）
+    for (auto jointEntity : m_jointEntities) {
+        const QVector3D offset = jointEntity->joint()->origin.position();
+        const float length = offset.length();
+        if (length < 1e-6f) continue;
+        
+        Geometry bone;
+        bone.type = GeometryType::Cylinder;
+        bone.cylinderRadius = radius;
+        bone.cylinderLength = length;
+        
+        QMatrix4x4 matrix;
+        matrix.translate(offset * 0.5f);
+        matrix.rotate(QQuaternion::rotationTo(QVector3D(0, 0, 1), offset / length));
+        addPart(jointEntity->parentEntity(), bone, matrix);
+    }
+}
+
+void RobotEntity::removeSkeleton()
+{
+    for (const auto& part : m_skeletonParts) {
+        if (part) part->deleteLater();
+    }
+    m_skeletonParts.clear();
+}
+
+void RobotEntity::setLoadStage(const QString& stage, double progress)
+{
+    m_loadStage = stage;
+    m_loadProgress = qBound(0.0, progress, 1.0);
+    emit loadProgressChanged(m_loadStage, m_loadProgress);
 }
 
 bool RobotEntity::buildRobotTree()
 {
+    TRACE_SCOPE("RobotEntity::buildRobotTree");
+    
     if (!m_model || m_model->rootLink.isEmpty()) {
         m_errorMessage = "Invalid model or no root link";
         return false;
@@ -338,121 +623,181 @@ Qt3DCore::QEntity* RobotEntity::createLinkVisual(std::shared_ptr<URDFLink> link,
     Qt3DCore::QEntity* visualContainer = new Qt3DCore::QEntity();
     
     for (const auto& visual : link->visuals) {
-        Qt3DCore::QEntity* visualEntity = nullptr;
-        
         if (visual.geometry.type == GeometryType::Mesh) {
-            // 使用Assimp加载网格文件
             QString meshPath = m_parser.resolveMeshPath(visual.geometry.meshFilename);
             
-            QColor color = QColor::fromRgbF(
-                visual.material.color[0],
-                visual.material.color[1],
-                visual.material.color[2],
-                visual.material.color[3]
-            );
-            
-            QVector3D scale(
-                visual.geometry.meshScale[0],
-                visual.geometry.meshScale[1],
-                visual.geometry.meshScale[2]
-            );
-            
-            AssimpModelLoader loader;
-            visualEntity = loader.loadModel(meshPath, visualContainer, color, scale);
-            
-            if (!visualEntity) {
-                qWarning() << "Failed to load mesh:" << meshPath;
-                qWarning() << "Error:" << loader.getErrorMessage();
+            if (m_deferMeshes) {
+                // 异步加载：先记录，骨架显示后在工作线程导入
+                PendingMesh pending;
+                pending.linkIndex = linkIndex;
+                pending.visual = visual;
+                pending.meshPath = meshPath;
+                pending.fileSize = m_meshSizes.value(meshPath);
+                pending.container = visualContainer;
+                m_pendingMeshes.append(pending);
                 continue;
             }
             
-            // 收集加载的模型中的材质
-            QList<Qt3DExtras::QPhongMaterial*> materials = visualEntity->findChildren<Qt3DExtras::QPhongMaterial*>();
-            for (auto* mat : materials) {
-                LinkMaterialInfo info;
-                info.material = mat;
-                info.originalColor = mat->diffuse();
-                info.linkIndex = linkIndex;
-                m_linkMaterials.append(info);
-            }
+            // 使用Assimp加载网格文件
+            AssimpModelLoader loader;
+            configureLoader(loader, visual);
+            loader.prepare(meshPath);
+            attachMeshVisual(loader, visual, meshPath, visualContainer, linkIndex);
         } else {
-            // 创建基本几何体
-            visualEntity = createPrimitiveGeometry(visual.geometry, visual.material);
+            // 创建基本几何体（材质在createPrimitiveGeometry中收集，变换已包含视觉原点）
+            Qt3DCore::QEntity* visualEntity = createPrimitiveGeometry(visual, linkIndex);
             if (visualEntity) {
                 visualEntity->setParent(visualContainer);
-                
-                // 收集基本几何体的材质
-                Qt3DExtras::QPhongMaterial* mat = visualEntity->findChild<Qt3DExtras::QPhongMaterial*>();
-                if (mat) {
-                    LinkMaterialInfo info;
-                    info.material = mat;
-                    info.originalColor = mat->diffuse();
-                    info.linkIndex = linkIndex;
-                    m_linkMaterials.append(info);
-                }
             }
         }
+    }
+    
+    return visualContainer;
+}
+
+void RobotEntity::configureLoader(AssimpModelLoader& loader, const Visual& visual) const
+{
+    loader.setImportProfile(m_importProfile);
+    loader.setTextureCache(m_textureCache);
+    if (!visual.material.textureFilename.isEmpty()) {
+        loader.setOverrideTexture(m_parser.resolveTexturePath(visual.material.textureFilename));
+    }
+}
+
+bool RobotEntity::attachMeshVisual(AssimpModelLoader& loader, const Visual& visual, const QString& meshPath,
+                                   Qt3DCore::QEntity* container, int linkIndex)
+{
+    QColor color = QColor::fromRgbF(
+        visual.material.color[0],
+        visual.material.color[1],
+        visual.material.color[2],
+        visual.material.color[3]
+    );
+    
+    QVector3D scale(
+        visual.geometry.meshScale[0],
+        visual.geometry.meshScale[1],
+        visual.geometry.meshScale[2]
+    );
+    
+    Qt3DCore::QEntity* visualEntity = loader.build(container, color, scale);
+    
+    // 按阶段累计导入耗时
+    QStringList fileStages;
+    for (const auto& timing : loader.stageTimings()) {
+        fileStages << QString("%1 %2ms").arg(timing.stage).arg(timing.msec, 0, 'f', 2);
         
-        if (visualEntity) {
-            // 添加视觉原点变换
-            Qt3DCore::QTransform* visualTransform = new Qt3DCore::QTransform(visualEntity);
-            visualTransform->setMatrix(visual.origin.toMatrix());
-            visualEntity->addComponent(visualTransform);
+        auto it = std::find_if(m_importStageTotals.begin(), m_importStageTotals.end(),
+                               [&](const ImportStageTiming& total) { return total.stage == timing.stage; });
+        if (it != m_importStageTotals.end()) {
+            it->msec += timing.msec;
+        } else {
+            m_importStageTotals.append(timing);
         }
     }
+    qDebug() << "Mesh import:" << QFileInfo(meshPath).fileName() << fileStages.join(", ");
     
-    return visualContainer;
+    if (!visualEntity) {
+        qWarning() << "Failed to load mesh:" << meshPath;
+        qWarning() << "Error:" << loader.getErrorMessage();
+        return false;
+    }
+    
+    // 收集加载的模型中的材质
+    QList<Qt3DExtras::QPhongMaterial*> materials = visualEntity->findChildren<Qt3DExtras::QPhongMaterial*>();
+    for (auto* mat : materials) {
+        LinkMaterialInfo info;
+        info.material = mat;
+        info.originalColor = mat->diffuse();
+        info.linkIndex = linkIndex;
+        m_linkMaterials.append(info);
+    }
+    
+    // 收集纹理材质（着色模式下临时替换为纯色）
+    const auto texturedMaterials = visualEntity->findChildren<Qt3DExtras::QDiffuseSpecularMaterial*>();
+    for (auto* mat : texturedMaterials) {
+        LinkMaterialInfo info;
+        info.texturedMaterial = mat;
+        info.originalTexture = mat->diffuse().value<Qt3DRender::QAbstractTexture*>();
+        info.linkIndex = linkIndex;
+        m_linkMaterials.append(info);
+    }
+    
+    // 添加视觉原点变换
+    Qt3DCore::QTransform* visualTransform = new Qt3DCore::QTransform(visualEntity);
+    visualTransform->setMatrix(visual.origin.toMatrix());
+    visualEntity->addComponent(visualTransform);
+    
+    return true;
 }
 
-Qt3DCore::QEntity* RobotEntity::createPrimitiveGeometry(const Geometry& geom, const Material& mat)
+Qt3DCore::QEntity* RobotEntity::createPrimitiveGeometry(const Visual& visual, int linkIndex)
 {
-    Qt3DCore::QEntity* entity = new Qt3DCore::QEntity();
+    const Geometry& geom = visual.geometry;
+    const Material& mat = visual.material;
     
-    // 材质
-    Qt3DExtras::QPhongMaterial* material = new Qt3DExtras::QPhongMaterial(entity);
-    QColor color = QColor::fromRgbF(mat.color[0], mat.color[1], mat.color[2], mat.color[3]);
-    material->setDiffuse(color);
-    material->setAmbient(color.darker(150));
-    entity->addComponent(material);
+    Qt3DCore::QEntity* entity = new Qt3DCore::QEntity();
     
-    switch (geom.type) {
-    case GeometryType::Box: {
-        Qt3DExtras::QCuboidMesh* mesh = new Qt3DExtras::QCuboidMesh(entity);
-        mesh->setXExtent(geom.boxSize[0]);
-        mesh->setYExtent(geom.boxSize[1]);
-        mesh->setZExtent(geom.boxSize[2]);
-        entity->addComponent(mesh);
-        break;
-    }
-    case GeometryType::Cylinder: {
-        Qt3DExtras::QCylinderMesh* mesh = new Qt3DExtras::QCylinderMesh(entity);
-        mesh->setRadius(geom.cylinderRadius);
-        mesh->setLength(geom.cylinderLength);
-        mesh->setSlices(32);
-        entity->addComponent(mesh);
-        
-        // URDF圆柱体默认沿Z轴，Qt3D默认沿Y轴，需要旋转
-        Qt3DCore::QTransform* rotateTransform = new Qt3DCore::QTransform(entity);
-        rotateTransform->setRotationX(90);
-        entity->addComponent(rotateTransform);
-        break;
-    }
-    case GeometryType::Sphere: {
-        Qt3DExtras::QSphereMesh* mesh = new Qt3DExtras::QSphereMesh(entity);
-        mesh->setRadius(geom.sphereRadius);
-        mesh->setSlices(32);
-        mesh->setRings(32);
-        entity->addComponent(mesh);
-        break;
-    }
-    default:
+    // 共享单位网格，尺寸与视觉原点合成为同一个变换
+    if (!m_primitiveCache->attach(entity, geom)) {
         delete entity;
         return nullptr;
     }
     
+    Qt3DCore::QTransform* transform = new Qt3DCore::QTransform(entity);
+    transform->setMatrix(visual.origin.toMatrix() * PrimitiveMeshCache::unitTransform(geom));
+    entity->addComponent(transform);
+    
+    // 材质（URDF指定了纹理且文件存在时使用纹理材质）
+    Qt3DRender::QAbstractTexture* texture = nullptr;
+    if (!mat.textureFilename.isEmpty()) {
+        QString texturePath = m_parser.resolveTexturePath(mat.textureFilename);
+        if (texturePath.isEmpty()) {
+            qWarning() << "Texture not found:" << mat.textureFilename;
+        } else {
+            texture = m_textureCache->texture(texturePath);
+        }
+    }
+    
+    if (texture) {
+        Qt3DExtras::QDiffuseSpecularMaterial* material = new Qt3DExtras::QDiffuseSpecularMaterial(entity);
+        material->setDiffuse(QVariant::fromValue(texture));
+        entity->addComponent(material);
+        
+        LinkMaterialInfo info;
+        info.texturedMaterial = material;
+        info.originalTexture = texture;
+        info.linkIndex = linkIndex;
+        m_linkMaterials.append(info);
+        return entity;
+    }
+    
+    // 纯色材质在同一Link内按颜色共享（着色/高亮按Link修改，不会影响其他Link）
+    QColor color = QColor::fromRgbF(mat.color[0], mat.color[1], mat.color[2], mat.color[3]);
+    const QPair<int, QRgb> key(linkIndex, color.rgba());
+    Qt3DExtras::QPhongMaterial* material = m_primitiveMaterials.value(key);
+    if (!material) {
+        material = new Qt3DExtras::QPhongMaterial(entity);
+        material->setDiffuse(color);
+        material->setAmbient(color.darker(150));
+        m_primitiveMaterials.insert(key, material);
+        
+        LinkMaterialInfo info;
+        info.material = material;
+        info.originalColor = color;
+        info.linkIndex = linkIndex;
+        m_linkMaterials.append(info);
+    }
+    entity->addComponent(material);
+    
     return entity;
 }
 
+void RobotEntity::setLodCamera(Qt3DRender::QCamera* camera)
+{
+    m_primitiveCache->setCamera(camera);
+}
+
 void RobotEntity::findEndEffectorLink()
 {
     if (!m_model) return;
@@ -494,19 +839,27 @@ QMap<QString, double> RobotEntity::getAllJointValues() const
     return values;
 }
 
-void RobotEntity::setJointValue(const QString& jointName, double value)
+void RobotEntity::setJointValue(const QString& jointName, double value, qint64 sourceTimeUs)
 {
     auto it = m_jointEntities.find(jointName);
     if (it != m_jointEntities.end()) {
         it.value()->setJointValue(value);
+        sampleTrajectory(sourceTimeUs);
     }
 }
 
-void RobotEntity::setJointValues(const QMap<QString, double>& jointValues)
+void RobotEntity::setJointValues(const QMap<QString, double>& jointValues, qint64 sourceTimeUs)
 {
     for (auto it = jointValues.begin(); it != jointValues.end(); ++it) {
-        setJointValue(it.key(), it.value());
+        auto joint = m_jointEntities.find(it.key());
+        if (joint != m_jointEntities.end()) {
+            joint.value()->setJointValue(it.value());
+        }
     }
+    emit jointValuesUpdated();
+    
+    // 整批应用后只采样一次轨迹
+    sampleTrajectory(sourceTimeUs);
 }
 
 void RobotEntity::resetJoints()
@@ -544,6 +897,35 @@ QMatrix4x4 RobotEntity::getLinkWorldTransform(const QString& linkName) const
     return computeLinkTransform(linkName);
 }
 
+QMatrix4x4 RobotEntity::getLinkWorldTransform(const QString& linkName, const QMap<QString, double>& jointValues) const
+{
+    QMatrix4x4 transform;
+    transform.setToIdentity();
+    
+    if (!m_model) return transform;
+    
+    // 沿父关节向上累积，与JointEntity的变换相同（关节原点 * 关节运动）
+    QString current = linkName;
+    while (!current.isEmpty()) {
+        auto joint = m_model->getParentJoint(current);
+        if (!joint) break;
+        
+        double value = jointValues.value(joint->name, getJointValue(joint->name));
+        if (joint->type == JointType::Revolute || joint->type == JointType::Prismatic) {
+            value = qBound(joint->limits.lower, value, joint->limits.upper);
+        }
+        transform = joint->origin.toMatrix() * joint->getTransform(value) * transform;
+        current = joint->parentLink;
+    }
+    
+    return transform;
+}
+
+QMatrix4x4 RobotEntity::getRobotTransform() const
+{
+    return m_robotTransform ? m_robotTransform->matrix() : QMatrix4x4();
+}
+
 LinkEntity* RobotEntity::getLinkEntity(const QString& linkName) const
 {
     return m_linkEntities.value(linkName, nullptr);
@@ -655,6 +1037,7 @@ void RobotEntity::addEndEffector(const QString& linkName, TrajectoryEntity* traj
     info.linkName = linkName;
     info.displayName = name.isEmpty() ? linkName : name;
     info.trajectory = trajectory;
+    applyTrajectorySpacing(trajectory);
     
     m_endEffectors[linkName] = info;
     
@@ -678,31 +1061,35 @@ QStringList RobotEntity::getEndEffectorLinks() const
 
 void RobotEntity::setTrajectorySampleInterval(int msec)
 {
-    if (m_trajectoryTimer->isActive()) {
-        m_trajectoryTimer->setInterval(msec);
+    m_trajectoryMinInterval = qMax(0, msec);
+    applyTrajectorySpacing(m_trajectoryEntity);
+    for (const EndEffectorInfo& info : m_endEffectors) {
+        applyTrajectorySpacing(info.trajectory);
     }
 }
 
-void RobotEntity::setTrajectoryEnabled(bool enabled)
+void RobotEntity::setTrajectoryMinDistance(float distance)
 {
-    m_trajectoryEnabled = enabled;
-    
-    // 处理单个轨迹（向后兼容）
-    if (enabled && m_trajectoryEntity && m_model) {
-        m_trajectoryTimer->start(50);
-    } else if (!enabled && m_endEffectors.isEmpty()) {
-        // 只有在没有多末端执行器时才停止定时器
-        m_trajectoryTimer->stop();
+    m_trajectoryMinDistance = qMax(0.0f, distance);
+    applyTrajectorySpacing(m_trajectoryEntity);
+    for (const EndEffectorInfo& info : m_endEffectors) {
+        applyTrajectorySpacing(info.trajectory);
     }
-    
-    // 处理多末端执行器
-    if (enabled && !m_endEffectors.isEmpty() && m_model) {
-        m_trajectoryTimer->start(50);
-    } else if (!enabled && m_endEffectors.isEmpty() && !m_trajectoryEntity) {
-        m_trajectoryTimer->stop();
+}
+
+void RobotEntity::applyTrajectorySpacing(TrajectoryEntity* trajectory) const
+{
+    if (trajectory) {
+        trajectory->setMinSpacing(m_trajectoryMinDistance, m_trajectoryMinInterval);
     }
 }
 
+void RobotEntity::setTrajectoryEnabled(bool enabled)
+{
+    // 轨迹随关节值更新采样，关闭时不再计算末端位置
+    m_trajectoryEnabled = enabled;
+}
+
 void RobotEntity::setJointAxesVisible(bool visible)
 {
     m_jointAxesVisible = visible;
@@ -721,13 +1108,19 @@ void RobotEntity::setJointAxesVisible(bool visible)
     }
 }
 
-void RobotEntity::sampleTrajectory()
+void RobotEntity::sampleTrajectory(qint64 sourceTimeUs)
 {
+    if (!m_trajectoryEnabled || !m_model) return;
+    
+    bool sampled = false;
+    
     // 处理单个轨迹（向后兼容）
     if (m_trajectoryEntity && !m_endEffectorLink.isEmpty()) {
         QVector3D position = getEndEffectorPosition();
-        m_trajectoryEntity->addPoint(position);
-        emit endEffectorPositionChanged(position);
+        if (m_trajectoryEntity->addPoint(position, sourceTimeUs)) {
+            sampled = true;
+            emit endEffectorPositionChanged(position);
+        }
     }
     
     // 处理多末端执行器轨迹
@@ -735,10 +1128,14 @@ void RobotEntity::sampleTrajectory()
         const EndEffectorInfo& info = it.value();
         if (info.trajectory) {
             QVector3D position = getEndEffectorPosition(info.linkName);
-            info.trajectory->addPoint(position);
+            sampled = info.trajectory->addPoint(position, sourceTimeUs) || sampled;
             // 可以为每个末端执行器发出信号（如果需要）
         }
     }
+    
+    if (sampled) {
+        emit trajectorySampled();
+    }
 }
 
 void RobotEntity::setColoredLinksEnabled(bool enabled)
@@ -749,11 +1146,70 @@ void RobotEntity::setColoredLinksEnabled(bool enabled)
     {
         m_coloredLinksEnabled = enabled;
     }
+    
+    // 切换颜色会重置环境光，重新应用高亮
+    applyLinkHighlight(m_highlightedLink, true);
+}
+
+void RobotEntity::setHighlightedLink(const QString& linkName)
+{
+    if (m_highlightedLink == linkName) return;
+    
+    applyLinkHighlight(m_highlightedLink, false);
+    m_highlightedLink = linkName;
+    applyLinkHighlight(m_highlightedLink, true);
+}
+
+void RobotEntity::applyLinkHighlight(const QString& linkName, bool highlighted)
+{
+    LinkEntity* linkEntity = getLinkEntity(linkName);
+    if (!linkEntity || !linkEntity->visualEntity()) return;
+    
+    // 通过环境光分量叠加高亮色，不改变漫反射颜色；取消时恢复为漫反射的暗色（与创建时一致）
+    const auto materials = linkEntity->visualEntity()->findChildren<Qt3DExtras::QPhongMaterial*>();
+    for (auto* material : materials) {
+        material->setAmbient(highlighted ? QColor(0, 160, 90) : material->diffuse().darker(150));
+    }
+    
+    // 纹理材质：着色模式下漫反射为纯色，否则恢复为材质的默认环境光
+    const auto texturedMaterials = linkEntity->visualEntity()->findChildren<Qt3DExtras::QDiffuseSpecularMaterial*>();
+    for (auto* material : texturedMaterials) {
+        const QVariant diffuse = material->diffuse();
+        QColor ambient = diffuse.canConvert<QColor>() ? diffuse.value<QColor>().darker(150)
+                                                      : QColor::fromRgbF(0.05, 0.05, 0.05);
+        material->setAmbient(highlighted ? QColor(0, 160, 90) : ambient);
+    }
+}
+
+QString RobotEntity::getControllingJoint(const QString& linkName) const
+{
+    if (!m_model) return QString();
+    
+    QString current = linkName;
+    while (!current.isEmpty()) {
+        auto joint = m_model->getParentJoint(current);
+        if (!joint) break;
+        if (joint->isMovable()) return joint->name;
+        current = joint->parentLink;
+    }
+    return QString();
 }
 
 bool RobotEntity::applyLinkColors(bool enable)
 {
     for (auto& info : m_linkMaterials) {
+        if (info.texturedMaterial) {
+            if (enable) {
+                QColor linkColor = getLinkColor(info.linkIndex);
+                info.texturedMaterial->setDiffuse(linkColor);
+                info.texturedMaterial->setAmbient(linkColor.darker(150));
+            } else {
+                info.texturedMaterial->setDiffuse(QVariant::fromValue(info.originalTexture));
+                info.texturedMaterial->setAmbient(QColor::fromRgbF(0.05, 0.05, 0.05));
+            }
+            continue;
+        }
+        
         if (!info.material) continue;
         
         if (enable) {
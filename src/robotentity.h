@@ -4,16 +4,28 @@
 #include <Qt3DCore/QEntity>
 #include <Qt3DCore/QTransform>
 #include <Qt3DExtras/QPhongMaterial>
+#include <Qt3DExtras/QDiffuseSpecularMaterial>
 #include <QMap>
+#include <QHash>
+#include <QPair>
 #include <QVector>
 #include <QVector3D>
 #include <QColor>
 #include <QTimer>
+#include <QPointer>
+#include <atomic>
 #include <memory>
 
 #include "urdfparser.h"
+#include "assimpmodelloader.h"
 
 class TrajectoryEntity;
+class TextureCache;
+class PrimitiveMeshCache;
+
+namespace Qt3DRender {
+class QCamera;
+}
 
 /**
  * @brief 链接实体
@@ -96,6 +108,34 @@ public:
      */
     bool loadFromURDF(const QString& urdfFile);
     
+    /**
+     * @brief 异步加载机器人（解析、路径解析、网格导入在工作线程进行）
+     * 解析完成后立即显示Link/关节骨架（skeletonReady），网格导入完成一个显示一个，
+     * 全部完成后发出robotLoaded；失败发出loadFailed，取消发出loadCanceled。
+     * @param urdfFile URDF文件路径
+     */
+    void loadFromURDFAsync(const QString& urdfFile);
+    
+    /**
+     * @brief 取消进行中的异步加载（已导入的部分一并清除）
+     */
+    void cancelLoad();
+    
+    /**
+     * @brief 是否有异步加载正在进行
+     */
+    bool isLoading() const { return !m_loadStage.isEmpty(); }
+    
+    /**
+     * @brief 当前加载阶段（parse、resolve、import、build，空表示未在加载）
+     */
+    QString loadStage() const { return m_loadStage; }
+    
+    /**
+     * @brief 当前加载进度（0~1）
+     */
+    double loadProgress() const { return m_loadProgress; }
+    
     /**
      * @brief 获取URDF模型
      */
@@ -131,6 +171,17 @@ public:
      */
     QMatrix4x4 getLinkWorldTransform(const QString& linkName) const;
     
+    /**
+     * @brief 按给定的关节值计算链接的变换，不改变当前显示的状态
+     * @param jointValues 关节值（弧度或米），未给出的关节使用当前值
+     */
+    QMatrix4x4 getLinkWorldTransform(const QString& linkName, const QMap<QString, double>& jointValues) const;
+    
+    /**
+     * @brief 机器人自身的变换（缩放），把getLinkWorldTransform的结果映射到场景世界节点坐标
+     */
+    QMatrix4x4 getRobotTransform() const;
+    
     /**
      * @brief 获取指定名称的链接实体
      * @param linkName 链接名称
@@ -170,13 +221,20 @@ public:
     /**
      * @brief 设置轨迹实体（单个轨迹，保留向后兼容）
      */
-    void setTrajectoryEntity(TrajectoryEntity* trajectory) { m_trajectoryEntity = trajectory; }
+    void setTrajectoryEntity(TrajectoryEntity* trajectory) { m_trajectoryEntity = trajectory; applyTrajectorySpacing(trajectory); }
     
     /**
-     * @brief 设置轨迹采样间隔（毫秒）
+     * @brief 设置轨迹点的最小时间间隔（毫秒，按数据源时间戳）
+     *
+     * 轨迹在关节值更新时采样，不再按固定周期采样；间隔和距离都不足的更新被跳过。
      */
     void setTrajectorySampleInterval(int msec);
     
+    /**
+     * @brief 设置轨迹点的最小距离
+     */
+    void setTrajectoryMinDistance(float distance);
+    
     /**
      * @brief 启用/禁用轨迹显示
      */
@@ -195,6 +253,34 @@ public:
     void setColoredLinksEnabled(bool enabled);
     bool isColoredLinksEnabled() const { return m_coloredLinksEnabled; }
     
+    /**
+     * @brief 高亮指定Link（悬停/选中反馈），传空字符串取消高亮
+     */
+    void setHighlightedLink(const QString& linkName);
+    QString highlightedLink() const { return m_highlightedLink; }
+    
+    /**
+     * @brief 获取Link所属的最近可动关节（沿父关节向上查找）
+     * @return 关节名称，没有可动关节时返回空字符串
+     */
+    QString getControllingJoint(const QString& linkName) const;
+    
+    /**
+     * @brief 设置网格导入配置（下次加载时生效）
+     */
+    void setImportProfile(const ImportProfile& profile) { m_importProfile = profile; }
+    ImportProfile importProfile() const { return m_importProfile; }
+    
+    /**
+     * @brief 设置用于基本几何体细分级别切换的相机（按屏幕投影大小选择圆柱/球体的细分）
+     */
+    void setLodCamera(Qt3DRender::QCamera* camera);
+    
+    /**
+     * @brief 最近一次加载中所有网格文件各导入阶段的累计耗时
+     */
+    QVector<ImportStageTiming> importStageTotals() const { return m_importStageTotals; }
+    
     /**
      * @brief 计算模型包围盒
      * @param minPoint 输出最小点
@@ -223,14 +309,16 @@ public slots:
      * @brief 设置关节值
      * @param jointName 关节名称
      * @param value 关节值（弧度或米）
+     * @param sourceTimeUs 数据源时间戳（微秒），-1表示使用接收时间
      */
-    void setJointValue(const QString& jointName, double value);
+    void setJointValue(const QString& jointName, double value, qint64 sourceTimeUs = -1);
     
     /**
      * @brief 设置多个关节值
      * @param jointValues 关节名称到值的映射
+     * @param sourceTimeUs 数据源时间戳（微秒），用于轨迹去重和间距，-1表示使用接收时间
      */
-    void setJointValues(const QMap<QString, double>& jointValues);
+    void setJointValues(const QMap<QString, double>& jointValues, qint64 sourceTimeUs = -1);
     
     /**
      * @brief 重置所有关节到初始位置
@@ -248,31 +336,123 @@ signals:
      */
     void robotLoaded();
     
+    /**
+     * @brief 异步加载进度信号
+     * @param stage 阶段（parse、resolve、import、build）
+     * @param progress 总进度（0~1）
+     */
+    void loadProgressChanged(const QString& stage, double progress);
+    
+    /**
+     * @brief 异步加载中Link/关节骨架已创建（网格仍在导入）
+     */
+    void skeletonReady();
+    
+    /**
+     * @brief 异步加载失败信号
+     */
+    void loadFailed(const QString& error);
+    
+    /**
+     * @brief 异步加载被取消信号
+     */
+    void loadCanceled();
+    
     /**
      * @brief 末端位置改变信号
      */
     void endEffectorPositionChanged(const QVector3D& position);
     
-private slots:
-    void sampleTrajectory();
+    /**
+     * @brief 一批关节值应用完成信号（用于统计关节更新频率）
+     */
+    void jointValuesUpdated();
+    
+    /**
+     * @brief 完成一次轨迹采样信号
+     */
+    void trajectorySampled();
     
 private:
+    void sampleTrajectory(qint64 sourceTimeUs);
+    void applyTrajectorySpacing(TrajectoryEntity* trajectory) const;
+    
+private:
+    /**
+     * @brief 异步加载中等待导入的网格视觉元素
+     */
+    struct PendingMesh {
+        int linkIndex = 0;
+        Visual visual;
+        QString meshPath;
+        qint64 fileSize = 0;
+        QPointer<Qt3DCore::QEntity> container;
+    };
+    
+    /**
+     * @brief 工作线程的解析结果
+     */
+    struct ParseResult {
+        URDFParser parser;
+        bool ok = false;
+        QHash<QString, qint64> meshSizes;  // 已解析的网格路径 -> 文件大小
+    };
+    
     void clear();
     bool buildRobotTree();
+    void onParseFinished(const ParseResult& result);
+    void resolveMeshesAsync(const ParseResult& parsed);
+    void startMeshImport(const PendingMesh& pending);
+    void onMeshImported(const PendingMesh& pending, AssimpModelLoader* loader, bool prepared);
+    void finishAsyncLoad();
+    void createSkeleton();
+    void removeSkeleton();
+    void setLoadStage(const QString& stage, double progress);
+    void configureLoader(AssimpModelLoader& loader, const Visual& visual) const;
+    bool attachMeshVisual(AssimpModelLoader& loader, const Visual& visual, const QString& meshPath,
+                          Qt3DCore::QEntity* container, int linkIndex);
     void buildLinkEntity(const QString& linkName, Qt3DCore::QEntity* parent, int& linkIndex);
     Qt3DCore::QEntity* createLinkVisual(std::shared_ptr<URDFLink> link, int linkIndex);
-    Qt3DCore::QEntity* createPrimitiveGeometry(const Geometry& geom, const Material& mat);
+    Qt3DCore::QEntity* createPrimitiveGeometry(const Visual& visual, int linkIndex);
     void findEndEffectorLink();
     void updateJointTransform(JointEntity* jointEntity);
     QMatrix4x4 computeLinkTransform(const QString& linkName) const;
     QVector3D getLinkGeometryCenter(const QString& linkName) const;  // 计算链接几何中心
     bool applyLinkColors(bool enable);
+    void applyLinkHighlight(const QString& linkName, bool highlighted);
     QColor getLinkColor(int index) const;
     
     std::shared_ptr<URDFModel> m_model;
     URDFParser m_parser;
     QString m_errorMessage;
     
+    // 纹理缓存（同一图片在各Link间共享）
+    TextureCache* m_textureCache = nullptr;
+    
+    // 基本几何体共享网格，以及同一Link内按颜色共享的材质
+    PrimitiveMeshCache* m_primitiveCache = nullptr;
+    QHash<QPair<int, QRgb>, Qt3DExtras::QPhongMaterial*> m_primitiveMaterials;
+    
+    // 网格导入配置与耗时统计
+    ImportProfile m_importProfile = ImportProfile::fullQuality();
+    QVector<ImportStageTiming> m_importStageTotals;
+    
+    // 异步加载状态（代数用于丢弃已取消/过期加载的回调）
+    QString m_loadStage;
+    double m_loadProgress = 0.0;
+    int m_loadGeneration = 0;
+    std::shared_ptr<std::atomic_bool> m_loadCancel;
+    bool m_deferMeshes = false;                 // 构建Link树时只记录网格，不立即导入
+    QList<PendingMesh> m_pendingMeshes;
+    QHash<QString, qint64> m_meshSizes;
+    int m_meshesRemaining = 0;
+    qint64 m_meshBytesTotal = 0;
+    qint64 m_meshBytesDone = 0;
+    
+    // 加载过程中显示的骨架（Link原点与关节连线）
+    QList<QPointer<Qt3DCore::QEntity>> m_skeletonParts;
+    Qt3DExtras::QPhongMaterial* m_skeletonMaterial = nullptr;
+    
     // 整体变换（用于缩放）
     Qt3DCore::QTransform* m_robotTransform = nullptr;
     float m_scale = 1.0f;
@@ -284,7 +464,9 @@ private:
     // Link材质映射（用于着色模式切换）
     struct LinkMaterialInfo {
         Qt3DExtras::QPhongMaterial* material = nullptr;
+        Qt3DExtras::QDiffuseSpecularMaterial* texturedMaterial = nullptr;  // 纹理材质（与material二选一）
         QColor originalColor;
+        Qt3DRender::QAbstractTexture* originalTexture = nullptr;
         int linkIndex = 0;
     };
     QList<LinkMaterialInfo> m_linkMaterials;
@@ -301,10 +483,12 @@ private:
     };
     QMap<QString, EndEffectorInfo> m_endEffectors;  // linkName -> EndEffectorInfo
     
-    QTimer* m_trajectoryTimer = nullptr;
+    int m_trajectoryMinInterval = 16;           // 毫秒
+    float m_trajectoryMinDistance = 0.0005f;
     bool m_trajectoryEnabled = true;
     bool m_jointAxesVisible = false;
     bool m_coloredLinksEnabled = false;
+    QString m_highlightedLink;
 };
 
 #endif // ROBOTENTITY_H
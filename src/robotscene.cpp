@@ -1,6 +1,7 @@
 ﻿#include "robotscene.h"
 #include "robotentity.h"
 #include "trajectoryentity.h"
+#include "tracelog.h"
 
 #include <Qt3DRender/QCamera>
 #include <Qt3DRender/QCameraLens>
@@ -59,6 +60,15 @@ void RobotScene::initialize()
     m_robotEntity->setTrajectoryEntity(m_trajectoryEntity);
     
     connect(m_robotEntity, &RobotEntity::robotLoaded, this, &RobotScene::robotLoaded);
+    connect(m_robotEntity, &RobotEntity::loadProgressChanged, this, &RobotScene::loadProgressChanged);
+    connect(m_robotEntity, &RobotEntity::loadFailed, this, &RobotScene::loadError);
+    connect(m_robotEntity, &RobotEntity::loadCanceled, this, &RobotScene::loadCanceled);
+    
+    // 异步加载：骨架出现时即缩放并适配视角（包围盒由Link位置与URDF几何估算，不依赖网格）
+    connect(m_robotEntity, &RobotEntity::skeletonReady, this, [this]() {
+        applyLoadedRobotSettings();
+        emit skeletonReady();
+    });
     
     // 默认保持Y轴朝上
     setZUpEnabled(false);
@@ -298,31 +308,14 @@ void RobotScene::createAxes()
 
 bool RobotScene::loadRobot(const QString& urdfFile)
 {
+    TRACE_SCOPE_DETAIL("RobotScene::loadRobot", urdfFile);
+    
     if (!m_robotEntity) return false;
     
     bool success = m_robotEntity->loadFromURDF(urdfFile);
     
     if (success) {
-        // 自动缩放模型
-        if (m_autoScaleEnabled) {
-            float modelSize = m_robotEntity->getModelSize();
-            if (modelSize > 0.001f) {  // 避免除零
-                float scale = m_targetModelSize / modelSize;
-                m_robotEntity->setScale(scale);
-                qDebug() << "Model size:" << modelSize << "Scale factor:" << scale;
-            }
-        }
-        
-        // 加载成功后适配相机视角
-        fitCameraToRobot();
-
-        qDebug() << "load completed";
-        // 应用各种显示设置
-        setGridVisible(m_gridVisible);
-        setAxesVisible(m_axesVisible);
-        setJointAxesVisible(m_jointAxesVisible);
-        setColoredLinksEnabled(m_coloredLinksEnabled);
-        // setZUpEnabled(m_zUpEnabled);
+        applyLoadedRobotSettings();
     } else {
         emit loadError(m_robotEntity->getErrorMessage());
     }
@@ -330,6 +323,47 @@ bool RobotScene::loadRobot(const QString& urdfFile)
     return success;
 }
 
+void RobotScene::loadRobotAsync(const QString& urdfFile)
+{
+    TRACE_SCOPE_DETAIL("RobotScene::loadRobotAsync", urdfFile);
+    
+    if (!m_robotEntity) return;
+    m_robotEntity->loadFromURDFAsync(urdfFile);
+}
+
+void RobotScene::cancelLoad()
+{
+    if (m_robotEntity) {
+        m_robotEntity->cancelLoad();
+    }
+}
+
+void RobotScene::applyLoadedRobotSettings()
+{
+    TRACE_SCOPE("RobotScene::applyLoadedRobotSettings");
+    
+    // 自动缩放模型
+    if (m_autoScaleEnabled) {
+        float modelSize = m_robotEntity->getModelSize();
+        if (modelSize > 0.001f) {  // 避免除零
+            float scale = m_targetModelSize / modelSize;
+            m_robotEntity->setScale(scale);
+            qDebug() << "Model size:" << modelSize << "Scale factor:" << scale;
+        }
+    }
+    
+    // 加载成功后适配相机视角
+    fitCameraToRobot();
+
+    qDebug() << "load completed";
+    // 应用各种显示设置
+    setGridVisible(m_gridVisible);
+    setAxesVisible(m_axesVisible);
+    setJointAxesVisible(m_jointAxesVisible);
+    setColoredLinksEnabled(m_coloredLinksEnabled);
+    // setZUpEnabled(m_zUpEnabled);
+}
+
 void RobotScene::setGridVisible(bool visible)
 {
     m_gridVisible = visible;
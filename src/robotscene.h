@@ -59,6 +59,17 @@ public:
      */
     bool loadRobot(const QString& urdfFile);
     
+    /**
+     * @brief 异步加载URDF机器人（骨架先显示，网格逐个出现）
+     * 结果通过robotLoaded / loadError / loadCanceled信号通知
+     */
+    void loadRobotAsync(const QString& urdfFile);
+    
+    /**
+     * @brief 取消进行中的异步加载
+     */
+    void cancelLoad();
+    
     /**
      * @brief 设置网格可见性
      */
@@ -152,9 +163,13 @@ public:
 signals:
     void robotLoaded();
     void loadError(const QString& error);
+    void loadCanceled();
+    void loadProgressChanged(const QString& stage, double progress);
+    void skeletonReady();
     void fitCameraRequested(const QVector3D& center, const QVector3D& position);
     
 private:
+    void applyLoadedRobotSettings();
     void createGrid();
     void createAxes();
     void createLights();
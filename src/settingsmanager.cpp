@@ -1,6 +1,20 @@
 ﻿#include "settingsmanager.h"
 #include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
+#include <QCryptographicHash>
+
+namespace {
+
+// 文件路径中的分隔符不能直接作为INI键，使用路径哈希
+QString importProfileKey(const QString& urdfFile)
+{
+    const QString path = QFileInfo(urdfFile).absoluteFilePath();
+    return "ImportProfiles/" + QString::fromLatin1(
+                QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+} // namespace
 
 SettingsManager& SettingsManager::instance()
 {
@@ -68,6 +82,94 @@ int SettingsManager::getOpcuaSampleInterval() const
     return m_settings.value("OPCUA/SampleInterval", 100).toInt();
 }
 
+void SettingsManager::setSmoothingDelay(int ms)
+{
+    m_settings.setValue("OPCUA/SmoothingDelay", ms);
+    m_settings.sync();
+}
+
+int SettingsManager::getSmoothingDelay() const
+{
+    return m_settings.value("OPCUA/SmoothingDelay", 150).toInt();
+}
+
+void SettingsManager::setExtrapolationLimit(int ms)
+{
+    m_settings.setValue("OPCUA/ExtrapolationLimit", ms);
+    m_settings.sync();
+}
+
+int SettingsManager::getExtrapolationLimit() const
+{
+    return m_settings.value("OPCUA/ExtrapolationLimit", 50).toInt();
+}
+
+void SettingsManager::setOpcuaSubscription(bool value)
+{
+    m_settings.setValue("OPCUA/Subscription", value);
+    m_settings.sync();
+}
+
+bool SettingsManager::getOpcuaSubscription() const
+{
+    return m_settings.value("OPCUA/Subscription", false).toBool();
+}
+
+void SettingsManager::setOpcuaPublishingInterval(int value)
+{
+    m_settings.setValue("OPCUA/PublishingInterval", value);
+    m_settings.sync();
+}
+
+int SettingsManager::getOpcuaPublishingInterval() const
+{
+    return m_settings.value("OPCUA/PublishingInterval", 50).toInt();
+}
+
+void SettingsManager::setOpcuaSamplingInterval(int value)
+{
+    m_settings.setValue("OPCUA/SamplingInterval", value);
+    m_settings.sync();
+}
+
+int SettingsManager::getOpcuaSamplingInterval() const
+{
+    return m_settings.value("OPCUA/SamplingInterval", 20).toInt();
+}
+
+void SettingsManager::setOpcuaQueueSize(int value)
+{
+    m_settings.setValue("OPCUA/QueueSize", value);
+    m_settings.sync();
+}
+
+int SettingsManager::getOpcuaQueueSize() const
+{
+    return m_settings.value("OPCUA/QueueSize", 4).toInt();
+}
+
+void SettingsManager::setOpcuaDeadband(double value)
+{
+    m_settings.setValue("OPCUA/Deadband", value);
+    m_settings.sync();
+}
+
+double SettingsManager::getOpcuaDeadband() const
+{
+    return m_settings.value("OPCUA/Deadband", 0.0).toDouble();
+}
+
+void SettingsManager::setOpcuaPipelineDepth(int value)
+{
+    m_settings.setValue("OPCUA/PipelineDepth", value);
+    m_settings.sync();
+}
+
+int SettingsManager::getOpcuaPipelineDepth() const
+{
+    return m_settings.value("OPCUA/PipelineDepth", 4).toInt();
+}
+
 void SettingsManager::setOpcuaBindings(const QList<OpcuaBinding>& bindings)
 {
     m_settings.beginWriteArray("OPCUA/Bindings");
@@ -141,6 +243,17 @@ bool SettingsManager::getShowTrajectory() const
     return m_settings.value("View/ShowTrajectory", true).toBool();
 }
 
+void SettingsManager::setImportProfile(const QString& urdfFile, const QString& profile)
+{
+    m_settings.setValue(importProfileKey(urdfFile), profile);
+    m_settings.sync();
+}
+
+QString SettingsManager::getImportProfile(const QString& urdfFile) const
+{
+    return m_settings.value(importProfileKey(urdfFile), "").toString();
+}
+
 void SettingsManager::setColoredLinks(bool enabled)
 {
     m_settings.setValue("View/ColoredLinks", enabled);
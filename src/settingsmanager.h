@@ -39,6 +39,39 @@ public:
     void setOpcuaSampleInterval(int ms);
     int getOpcuaSampleInterval() const;
 
+    /**
+     * @brief 保存/加载采样平滑的显示延迟与最长外推时间（毫秒）
+     */
+    void setSmoothingDelay(int ms);
+    int getSmoothingDelay() const;
+
+    void setExtrapolationLimit(int ms);
+    int getExtrapolationLimit() const;
+
+    /**
+     * @brief 保存/加载OPC UA订阅模式及其参数
+     */
+    void setOpcuaSubscription(bool enabled);
+    bool getOpcuaSubscription() const;
+
+    void setOpcuaPublishingInterval(int ms);
+    int getOpcuaPublishingInterval() const;
+
+    void setOpcuaSamplingInterval(int ms);
+    int getOpcuaSamplingInterval() const;
+
+    void setOpcuaQueueSize(int size);
+    int getOpcuaQueueSize() const;
+
+    void setOpcuaDeadband(double deadband);
+    double getOpcuaDeadband() const;
+
+    /**
+     * @brief 保存/加载OPC UA轮询时同时在途的请求数
+     */
+    void setOpcuaPipelineDepth(int depth);
+    int getOpcuaPipelineDepth() const;
+
     /**
      * @brief 保存/加载OPC UA变量绑定
      */
@@ -72,6 +105,12 @@ public:
     void setTrajectoryLifetime(double seconds);
     double getTrajectoryLifetime() const;
 
+    /**
+     * @brief 保存/加载网格导入配置（按URDF文件分别保存）
+     */
+    void setImportProfile(const QString& urdfFile, const QString& profile);
+    QString getImportProfile(const QString& urdfFile) const;
+
     /**
      * @brief 保存/加载末端执行器配置
      */
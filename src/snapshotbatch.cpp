@@ -0,0 +1,410 @@
+﻿#include "snapshotbatch.h"
+#include "offscreenrenderer.h"
+#include "robotscene.h"
+#include "robotentity.h"
+
+#include <Qt3DRender/QCamera>
+
+#include <QGuiApplication>
+#include <QSurfaceFormat>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtMath>
+#include <QDebug>
+
+namespace {
+
+const char* kSnapshotOption = "--snapshot";
+const char* kSoftwareGLOption = "--software-gl";
+
+QString argumentValue(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc - 1; ++i) {
+        if (qstrcmp(argv[i], name) == 0) {
+            return QString::fromLocal8Bit(argv[i + 1]);
+        }
+    }
+    return QString();
+}
+
+bool hasArgument(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QVector3D toVector3D(const QJsonValue& value, bool* ok)
+{
+    const QJsonArray array = value.toArray();
+    *ok = (array.size() == 3);
+    if (!*ok) return QVector3D();
+    return QVector3D(float(array.at(0).toDouble()),
+                     float(array.at(1).toDouble()),
+                     float(array.at(2).toDouble()));
+}
+
+QString sanitizeFileName(const QString& name)
+{
+    QString result = name;
+    result.replace(QRegularExpression("[^A-Za-z0-9_\\-]"), "_");
+    return result;
+}
+
+} // namespace
+
+SnapshotBatch::SnapshotBatch(QObject* parent)
+    : QObject(parent)
+{
+}
+
+SnapshotBatch::~SnapshotBatch()
+{
+    for (QFuture<bool>& future : m_pendingWrites) {
+        future.waitForFinished();
+    }
+
+    // 场景实体树挂在渲染器的根实体下，必须先于渲染器销毁场景对象
+    delete m_scene;
+    m_scene = nullptr;
+    delete m_renderer;
+    m_renderer = nullptr;
+}
+
+bool SnapshotBatch::isRequested(int argc, char* argv[])
+{
+    return hasArgument(argc, argv, kSnapshotOption);
+}
+
+int SnapshotBatch::run(int argc, char* argv[])
+{
+    const QString jobFile = argumentValue(argc, argv, kSnapshotOption);
+    if (jobFile.isEmpty()) {
+        qCritical() << "用法: RobotViewer --snapshot <job.json> [--software-gl]";
+        return 2;
+    }
+
+#ifdef Q_OS_LINUX
+    // 构建服务器上通常没有显示服务，默认使用offscreen平台插件
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")
+        && qEnvironmentVariableIsEmpty("DISPLAY")
+        && qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+#endif
+
+    // 无GPU时强制使用Mesa llvmpipe软件渲染
+    if (hasArgument(argc, argv, kSoftwareGLOption)) {
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+        QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
+    }
+
+    // 软件渲染器普遍只保证3.3 Core，离屏渲染也不需要多重采样的默认帧缓冲
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+    format.setStencilBufferSize(8);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName("RobotViewer");
+    app.setOrganizationName("RobotViewer");
+
+    SnapshotBatch batch;
+    if (!batch.loadJob(jobFile) || !batch.start()) {
+        qCritical() << "批量截图失败:" << batch.getErrorMessage();
+        return 1;
+    }
+
+    QObject::connect(&batch, &SnapshotBatch::finished, &app, [](int exitCode) {
+        QCoreApplication::exit(exitCode);
+    });
+
+    return app.exec();
+}
+
+bool SnapshotBatch::loadJob(const QString& jobFile)
+{
+    QFile file(jobFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorMessage = tr("无法打开任务文件: %1").arg(jobFile);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        m_errorMessage = tr("任务文件解析失败: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    const QJsonObject job = doc.object();
+    const QDir jobDir = QFileInfo(jobFile).absoluteDir();
+
+    m_urdfFile = job.value("urdf").toString();
+    if (m_urdfFile.isEmpty()) {
+        m_errorMessage = tr("任务文件缺少 urdf 字段");
+        return false;
+    }
+    m_urdfFile = jobDir.absoluteFilePath(m_urdfFile);
+
+    m_outputDir = jobDir.absoluteFilePath(job.value("output").toString("snapshots"));
+    m_imageFormat = job.value("format").toString("png").toLower();
+    m_imageSize = QSize(job.value("width").toInt(512), job.value("height").toInt(512));
+    if (m_imageSize.isEmpty()) {
+        m_errorMessage = tr("无效的图片尺寸");
+        return false;
+    }
+    if (job.contains("background")) {
+        m_background = QColor(job.value("background").toString());
+    }
+    m_jointsInDegrees = (job.value("jointUnits").toString("deg") != "rad");
+    m_showGrid = job.value("showGrid").toBool(false);
+    m_showAxes = job.value("showAxes").toBool(false);
+    m_zUp = job.value("zUp").toBool(false);
+    m_coloredLinks = job.value("coloredLinks").toBool(false);
+    m_importProfile = job.value("importProfile").toString("full");
+
+    // 相机预设，缺省时使用与界面相同的自适应视角
+    m_cameras.clear();
+    const QJsonArray cameras = job.value("cameras").toArray();
+    for (int i = 0; i < cameras.size(); ++i) {
+        const QJsonObject obj = cameras.at(i).toObject();
+        CameraPreset preset;
+        preset.name = obj.value("name").toString(QString("cam%1").arg(i));
+        if (obj.contains("azimuth") || obj.contains("elevation") || obj.contains("distance")) {
+            preset.hasOrbit = true;
+            preset.azimuth = float(obj.value("azimuth").toDouble(45.0));
+            preset.elevation = float(obj.value("elevation").toDouble(30.0));
+            preset.distanceScale = float(obj.value("distance").toDouble(1.0));
+        }
+        if (obj.contains("position")) {
+            preset.position = toVector3D(obj.value("position"), &preset.hasPosition);
+        }
+        if (obj.contains("viewCenter")) {
+            preset.viewCenter = toVector3D(obj.value("viewCenter"), &preset.hasViewCenter);
+        }
+        m_cameras.append(preset);
+    }
+    if (m_cameras.isEmpty()) {
+        CameraPreset preset;
+        preset.name = "default";
+        m_cameras.append(preset);
+    }
+
+    // 关节姿态，缺省时渲染零位
+    m_poses.clear();
+    const QJsonArray poses = job.value("poses").toArray();
+    for (int i = 0; i < poses.size(); ++i) {
+        const QJsonObject obj = poses.at(i).toObject();
+        Pose pose;
+        pose.name = obj.value("name").toString(QString("pose%1").arg(i, 5, 10, QChar('0')));
+        const QJsonObject joints = obj.value("joints").toObject();
+        for (auto it = joints.constBegin(); it != joints.constEnd(); ++it) {
+            pose.joints.insert(it.key(), it.value().toDouble());
+        }
+        m_poses.append(pose);
+    }
+    if (m_poses.isEmpty()) {
+        Pose pose;
+        pose.name = "zero";
+        m_poses.append(pose);
+    }
+
+    qInfo() << "SnapshotBatch: 任务加载完成," << m_poses.size() << "个姿态 ×"
+            << m_cameras.size() << "个相机 ->" << m_outputDir;
+    return true;
+}
+
+bool SnapshotBatch::start()
+{
+    if (!QDir().mkpath(m_outputDir)) {
+        m_errorMessage = tr("无法创建输出目录: %1").arg(m_outputDir);
+        return false;
+    }
+
+    m_renderer = new OffscreenRenderer(m_imageSize);
+    if (!m_renderer->initialize()) {
+        m_errorMessage = m_renderer->getErrorMessage();
+        return false;
+    }
+    m_renderer->setClearColor(m_background);
+    connect(m_renderer, &OffscreenRenderer::captureCompleted,
+            this, &SnapshotBatch::onCaptureCompleted);
+
+    // 与界面共用同一个场景实现，只是挂载到离屏渲染器的根节点下
+    m_scene = new RobotScene();
+    m_scene->initialize();
+    m_scene->setSceneRoot(m_renderer->sceneRoot());
+    m_scene->setGridVisible(m_showGrid);
+    m_scene->setAxesVisible(m_showAxes);
+    m_scene->setZUpEnabled(m_zUp);
+    m_scene->setColoredLinksEnabled(m_coloredLinks);
+    m_scene->setTrajectoryVisible(false);
+    connect(m_scene, &RobotScene::fitCameraRequested,
+            this, &SnapshotBatch::onFitCameraRequested);
+
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    m_scene->robotEntity()->setImportProfile(ImportProfile::byName(m_importProfile));
+    m_scene->robotEntity()->setLodCamera(m_renderer->camera());
+    if (!m_scene->loadRobot(m_urdfFile)) {
+        m_errorMessage = tr("加载URDF失败: %1").arg(m_scene->robotEntity()->getErrorMessage());
+        return false;
+    }
+    m_scene->robotEntity()->setTrajectoryEnabled(false);
+    qInfo() << "SnapshotBatch: 机器人加载耗时" << loadTimer.elapsed() << "ms";
+
+    // 首帧包含着色器编译和缓冲上传，作为预热帧丢弃，不计入吞吐统计
+    applyPose(m_poses.first());
+    applyCamera(m_cameras.first());
+    m_warmupCaptureId = m_renderer->requestCapture();
+    return true;
+}
+
+void SnapshotBatch::onFitCameraRequested(const QVector3D& center, const QVector3D& position)
+{
+    m_fitCenter = center;
+    m_fitPosition = position;
+}
+
+void SnapshotBatch::applyPose(const Pose& pose)
+{
+    RobotEntity* robot = m_scene->robotEntity();
+    auto model = robot->getModel();
+
+    // 未指定的关节回到零位，保证每张图只由任务文件决定
+    robot->resetJoints();
+
+    QMap<QString, double> values;
+    for (auto it = pose.joints.constBegin(); it != pose.joints.constEnd(); ++it) {
+        double value = it.value();
+        if (m_jointsInDegrees && model && model->joints.contains(it.key())) {
+            const JointType type = model->joints[it.key()]->type;
+            if (type == JointType::Revolute || type == JointType::Continuous) {
+                value = qDegreesToRadians(value);
+            }
+        }
+        values.insert(it.key(), value);
+    }
+    robot->setJointValues(values);
+}
+
+void SnapshotBatch::applyCamera(const CameraPreset& preset)
+{
+    Qt3DRender::QCamera* camera = m_renderer->camera();
+
+    QVector3D center = preset.hasViewCenter ? preset.viewCenter : m_fitCenter;
+    QVector3D position = m_fitPosition;
+
+    if (preset.hasPosition) {
+        position = preset.position;
+    } else if (preset.hasOrbit) {
+        // 与 RobotScene::fitCameraToRobot 相同的球坐标约定（Y轴朝上）
+        const float distance = (m_fitPosition - m_fitCenter).length() * preset.distanceScale;
+        const float azimuth = qDegreesToRadians(preset.azimuth);
+        const float elevation = qDegreesToRadians(preset.elevation);
+        position.setX(center.x() + distance * qCos(elevation) * qSin(azimuth));
+        position.setY(center.y() + distance * qSin(elevation));
+        position.setZ(center.z() + distance * qCos(elevation) * qCos(azimuth));
+    }
+
+    camera->setUpVector(QVector3D(0.0f, 1.0f, 0.0f));
+    camera->setPosition(position);
+    camera->setViewCenter(center);
+}
+
+QString SnapshotBatch::outputFilePath(const Pose& pose, const CameraPreset& camera) const
+{
+    const QString fileName = QString("%1_%2.%3")
+                                 .arg(sanitizeFileName(pose.name),
+                                      sanitizeFileName(camera.name),
+                                      m_imageFormat);
+    return QDir(m_outputDir).filePath(fileName);
+}
+
+void SnapshotBatch::captureNext()
+{
+    const int total = m_poses.size() * m_cameras.size();
+    if (m_current >= total) {
+        finish();
+        return;
+    }
+
+    const int poseIndex = m_current / m_cameras.size();
+    const int cameraIndex = m_current % m_cameras.size();
+
+    // 同一姿态下切换相机时不必重复设置关节
+    if (cameraIndex == 0) {
+        applyPose(m_poses.at(poseIndex));
+    }
+    applyCamera(m_cameras.at(cameraIndex));
+    m_renderer->requestCapture();
+}
+
+void SnapshotBatch::onCaptureCompleted(int captureId, const QImage& image)
+{
+    if (captureId == m_warmupCaptureId) {
+        m_warmupCaptureId = -1;
+        m_timer.start();
+        captureNext();
+        return;
+    }
+
+    const int poseIndex = m_current / m_cameras.size();
+    const int cameraIndex = m_current % m_cameras.size();
+    writeImage(image, outputFilePath(m_poses.at(poseIndex), m_cameras.at(cameraIndex)));
+
+    ++m_current;
+    if (m_current % 100 == 0) {
+        qInfo() << "SnapshotBatch: 已完成" << m_current << "/"
+                << m_poses.size() * m_cameras.size();
+    }
+    captureNext();
+}
+
+void SnapshotBatch::writeImage(const QImage& image, const QString& filePath)
+{
+    // 图片编码放到线程池，与下一帧渲染并行；限制排队数量以控制内存
+    const int maxPending = qMax(2, QThreadPool::globalInstance()->maxThreadCount() * 2);
+    while (m_pendingWrites.size() >= maxPending) {
+        QFuture<bool> oldest = m_pendingWrites.takeFirst();
+        oldest.waitForFinished();
+        if (!oldest.result()) ++m_failedCount;
+    }
+
+    const QByteArray format = m_imageFormat.toLatin1();
+    m_pendingWrites.append(QtConcurrent::run([image, filePath, format]() {
+        return image.save(filePath, format.constData());
+    }));
+    ++m_imageCount;
+}
+
+void SnapshotBatch::finish()
+{
+    for (QFuture<bool>& future : m_pendingWrites) {
+        future.waitForFinished();
+        if (!future.result()) ++m_failedCount;
+    }
+    m_pendingWrites.clear();
+
+    const double seconds = qMax<qint64>(1, m_timer.elapsed()) / 1000.0;
+    qInfo().noquote() << QString("SnapshotBatch: %1 张图片, 耗时 %2 s, %3 images/s, 失败 %4")
+                             .arg(m_imageCount)
+                             .arg(seconds, 0, 'f', 2)
+                             .arg(m_imageCount / seconds, 0, 'f', 1)
+                             .arg(m_failedCount);
+
+    emit finished(m_failedCount > 0 ? 1 : 0);
+}
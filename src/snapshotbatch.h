@@ -0,0 +1,130 @@
+﻿#ifndef SNAPSHOTBATCH_H
+#define SNAPSHOTBATCH_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QSize>
+#include <QColor>
+#include <QVector3D>
+#include <QImage>
+#include <QFuture>
+#include <QElapsedTimer>
+
+class OffscreenRenderer;
+class RobotScene;
+
+/**
+ * @brief 无界面批量截图任务
+ * 读取JSON任务文件，对每个关节姿态 × 相机预设渲染一张图片。
+ * 机器人只加载一次，渲染器与几何体在所有截图之间复用。
+ *
+ * 任务文件示例：
+ * {
+ *   "urdf": "robot/robot.urdf",
+ *   "output": "thumbs",
+ *   "width": 512, "height": 512,
+ *   "background": "#0a0a15",
+ *   "format": "png",
+ *   "jointUnits": "deg",
+ *   "importProfile": "preview",
+ *   "cameras": [ { "name": "iso" },
+ *                { "name": "front", "azimuth": 0, "elevation": 10, "distance": 1.2 },
+ *                { "name": "top", "position": [0, 3, 0.01], "viewCenter": [0, 0, 0] } ],
+ *   "poses": [ { "name": "home", "joints": { "joint1": 0, "joint2": -45 } } ]
+ * }
+ */
+class SnapshotBatch : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct CameraPreset {
+        QString name;
+        bool hasOrbit = false;          // 使用方位角/仰角（围绕自适应中心）
+        float azimuth = 45.0f;          // 度
+        float elevation = 30.0f;        // 度
+        float distanceScale = 1.0f;     // 相对自适应距离的倍数
+        bool hasPosition = false;       // 显式指定相机位置
+        QVector3D position;
+        bool hasViewCenter = false;
+        QVector3D viewCenter;
+    };
+
+    struct Pose {
+        QString name;
+        QMap<QString, double> joints;   // 任务文件中的原始值（单位见 jointUnits）
+    };
+
+    explicit SnapshotBatch(QObject* parent = nullptr);
+    ~SnapshotBatch();
+
+    /**
+     * @brief 解析任务文件
+     */
+    bool loadJob(const QString& jobFile);
+
+    /**
+     * @brief 创建离屏渲染器、加载机器人并开始截图
+     */
+    bool start();
+
+    QString getErrorMessage() const { return m_errorMessage; }
+
+    /**
+     * @brief 命令行中是否请求了批量截图模式（--snapshot <job.json>）
+     */
+    static bool isRequested(int argc, char* argv[]);
+
+    /**
+     * @brief 批量截图模式入口，替代正常的QML界面启动流程
+     * @return 进程退出码
+     */
+    static int run(int argc, char* argv[]);
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void onCaptureCompleted(int captureId, const QImage& image);
+    void onFitCameraRequested(const QVector3D& center, const QVector3D& position);
+
+private:
+    void captureNext();
+    void applyPose(const Pose& pose);
+    void applyCamera(const CameraPreset& preset);
+    void writeImage(const QImage& image, const QString& filePath);
+    void finish();
+    QString outputFilePath(const Pose& pose, const CameraPreset& camera) const;
+
+    QString m_errorMessage;
+
+    // 任务参数
+    QString m_urdfFile;
+    QString m_outputDir;
+    QString m_imageFormat = "png";
+    QSize m_imageSize = QSize(512, 512);
+    QColor m_background = QColor(10, 10, 21);
+    bool m_jointsInDegrees = true;
+    bool m_showGrid = false;
+    bool m_showAxes = false;
+    bool m_zUp = false;
+    bool m_coloredLinks = false;
+    QString m_importProfile = "full";  // 网格导入配置，见 ImportProfile::names()
+    QList<CameraPreset> m_cameras;
+    QList<Pose> m_poses;
+
+    // 运行状态
+    OffscreenRenderer* m_renderer = nullptr;
+    RobotScene* m_scene = nullptr;
+    QVector3D m_fitCenter;
+    QVector3D m_fitPosition;
+    int m_current = 0;                 // 当前截图序号（姿态 × 相机）
+    int m_warmupCaptureId = -1;        // 预热帧，不计入统计也不保存
+    int m_imageCount = 0;
+    int m_failedCount = 0;
+    QList<QFuture<bool>> m_pendingWrites;
+    QElapsedTimer m_timer;
+};
+
+#endif // SNAPSHOTBATCH_H
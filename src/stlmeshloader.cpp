@@ -0,0 +1,502 @@
+﻿#include "stlmeshloader.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <QtMath>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+const qint64 kBinaryHeaderSize = 84;
+const qint64 kBinaryTriangleSize = 50;
+// 输出顶点缓冲最坏情况每个三角形72字节（3个顶点 × 位置+法线），需放得进QByteArray
+const qint64 kMaxTriangles = std::numeric_limits<int>::max() / 72;
+
+// 将 [0, count) 切块后并行执行 function(begin, end)
+template <typename Function>
+void parallelFor(int count, const Function& function)
+{
+    const int minChunk = 16384;
+    const int chunkCount = qMin(qMax(1, QThread::idealThreadCount()) * 4, (count + minChunk - 1) / minChunk);
+    if (chunkCount <= 1) {
+        function(0, count);
+        return;
+    }
+
+    QVector<QPair<int, int>> ranges;
+    ranges.reserve(chunkCount);
+    const int chunkSize = (count + chunkCount - 1) / chunkCount;
+    for (int begin = 0; begin < count; begin += chunkSize) {
+        ranges.append(qMakePair(begin, qMin(count, begin + chunkSize)));
+    }
+    QtConcurrent::blockingMap(ranges, [&function](const QPair<int, int>& range) {
+        function(range.first, range.second);
+    });
+}
+
+// ===== 顶点合并用的键 =====
+
+struct PositionKey {
+    quint32 x;
+    quint32 y;
+    quint32 z;
+
+    bool operator==(const PositionKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+// 位置 + 法线（硬边角点按面法线区分）
+struct CornerKey {
+    quint32 positionId;
+    quint32 nx;
+    quint32 ny;
+    quint32 nz;
+
+    bool operator==(const CornerKey& other) const {
+        return positionId == other.positionId && nx == other.nx && ny == other.ny && nz == other.nz;
+    }
+};
+
+inline quint32 floatBits(float value)
+{
+    if (value == 0.0f) value = 0.0f;   // -0.0 与 0.0 视为同一位置
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline quint32 mix(quint32 h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+inline PositionKey makeKey(const float* p)
+{
+    return { floatBits(p[0]), floatBits(p[1]), floatBits(p[2]) };
+}
+
+inline quint32 hashKey(const PositionKey& key)
+{
+    return mix(key.x * 0x9e3779b1u ^ mix(key.y + 0x7f4a7c15u) ^ mix(key.z * 0x632be5abu));
+}
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const { return hashKey(key); }
+};
+
+struct CornerKeyHash {
+    size_t operator()(const CornerKey& key) const {
+        return mix(key.positionId * 0x9e3779b1u ^ mix(key.nx) ^ mix(key.ny * 0x85ebca6bu) ^ mix(key.nz + 0x27d4eb2du));
+    }
+};
+
+/**
+ * 并行顶点合并：按哈希高位把角点分到若干分区，每个分区由一个线程独立建表，
+ * 分区之间没有共享写入；最后按分区前缀和得到全局顶点编号。
+ * @return 不重复的位置数量
+ */
+int weldPositions(const float* positions, int cornerCount,
+                  std::vector<quint32>& positionIds, std::vector<float>& uniquePositions)
+{
+    const int partitionCount = qBound(1, QThread::idealThreadCount(), 64);
+
+    std::vector<quint8> partitionOf(cornerCount);
+    parallelFor(cornerCount, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const quint32 hash = hashKey(makeKey(positions + 3 * i));
+            partitionOf[i] = static_cast<quint8>((quint64(hash) * partitionCount) >> 32);
+        }
+    });
+
+    QVector<int> partitions(partitionCount);
+    std::iota(partitions.begin(), partitions.end(), 0);
+
+    std::vector<std::vector<quint32>> firstCorners(partitionCount);
+    QtConcurrent::blockingMap(partitions, [&](const int& partition) {
+        std::unordered_map<PositionKey, quint32, PositionKeyHash> table;
+        // 封闭网格中每个位置平均被约6个角点共享
+        table.reserve(cornerCount / partitionCount / 4 + 16);
+
+        std::vector<quint32>& first = firstCorners[partition];
+        for (int i = 0; i < cornerCount; ++i) {
+            if (partitionOf[i] != partition) continue;
+            auto result = table.emplace(makeKey(positions + 3 * i), quint32(first.size()));
+            if (result.second) {
+                first.push_back(quint32(i));
+            }
+            positionIds[i] = result.first->second;
+        }
+    });
+
+    std::vector<quint32> base(partitionCount);
+    quint32 total = 0;
+    for (int p = 0; p < partitionCount; ++p) {
+        base[p] = total;
+        total += quint32(firstCorners[p].size());
+    }
+
+    parallelFor(cornerCount, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            positionIds[i] += base[partitionOf[i]];
+        }
+    });
+
+    uniquePositions.resize(size_t(total) * 3);
+    QtConcurrent::blockingMap(partitions, [&](const int& partition) {
+        const std::vector<quint32>& first = firstCorners[partition];
+        float* out = uniquePositions.data() + size_t(base[partition]) * 3;
+        for (size_t k = 0; k < first.size(); ++k) {
+            std::memcpy(out + 3 * k, positions + 3 * size_t(first[k]), 3 * sizeof(float));
+        }
+    });
+
+    return int(total);
+}
+
+inline void normalize3(float* v)
+{
+    const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0.0f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+inline bool isSpace(uchar c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// 与区域设置无关的浮点数解析（ASCII STL）
+const uchar* parseFloat(const uchar* p, const uchar* end, float* value)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    bool hasDigits = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        mantissa = mantissa * 10.0 + (*p - '0');
+        hasDigits = true;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10.0 + (*p - '0');
+            --exponent;
+            hasDigits = true;
+            ++p;
+        }
+    }
+    if (!hasDigits) return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = (*p == '-');
+            ++p;
+        }
+        int e = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            e = qMin(e * 10 + (*p - '0'), 1000);
+            ++p;
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+
+    const double result = exponent == 0 ? mantissa : mantissa * std::pow(10.0, exponent);
+    *value = static_cast<float>(negative ? -result : result);
+    return p;
+}
+
+} // namespace
+
+bool StlMeshLoader::isStlFile(const QString& filename)
+{
+    return QFileInfo(filename).suffix().compare("stl", Qt::CaseInsensitive) == 0;
+}
+
+bool StlMeshLoader::load(const QString& filename, MeshData& mesh, const Options& options)
+{
+    m_errorMessage.clear();
+    m_stageTimings.clear();
+    mesh = MeshData();
+
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorMessage = QString("Cannot open file: %1").arg(filename);
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < 15) {
+        m_errorMessage = QString("File too small to be STL: %1").arg(filename);
+        return false;
+    }
+
+    uchar* data = file.map(0, size);
+    if (!data) {
+        m_errorMessage = QString("Cannot map file: %1").arg(file.errorString());
+        return false;
+    }
+    recordStage("map", stageTimer.nsecsElapsed());
+
+    // 二进制STL的文件头也可能以"solid"开头，以三角形数量与文件大小是否吻合为准
+    stageTimer.restart();
+    const bool startsWithSolid = std::memcmp(data, "solid", 5) == 0;
+    bool binary = false;
+    if (size >= kBinaryHeaderSize) {
+        const quint32 triangleCount = qFromLittleEndian<quint32>(data + 80);
+        const qint64 expectedSize = kBinaryHeaderSize + qint64(triangleCount) * kBinaryTriangleSize;
+        binary = (expectedSize == size) || (!startsWithSolid && expectedSize <= size);
+    }
+
+    std::vector<float> corners;
+    bool ok = false;
+    if (binary) {
+        ok = parseBinary(data, size, corners);
+    } else if (startsWithSolid) {
+        ok = parseAscii(data, size, corners);
+    } else {
+        m_errorMessage = QString("Not a valid STL file: %1").arg(filename);
+    }
+    file.unmap(data);
+
+    if (!ok) return false;
+    if (corners.empty()) {
+        m_errorMessage = QString("STL contains no triangles: %1").arg(filename);
+        return false;
+    }
+    recordStage("parse", stageTimer.nsecsElapsed());
+
+    buildMesh(corners, options, mesh);
+    return true;
+}
+
+bool StlMeshLoader::parseBinary(const uchar* data, qint64 size, std::vector<float>& corners)
+{
+    const quint32 triangleCount = qFromLittleEndian<quint32>(data + 80);
+    if (kBinaryHeaderSize + qint64(triangleCount) * kBinaryTriangleSize > size) {
+        m_errorMessage = "Truncated binary STL";
+        return false;
+    }
+    if (triangleCount > kMaxTriangles) {
+        m_errorMessage = "STL has too many triangles";
+        return false;
+    }
+
+    // 每个三角形记录：法线(12) + 三个顶点(36) + 属性(2)，文件中的法线不可靠，忽略后重新计算。
+    // 顶点为小端IEEE浮点，与支持的平台字节序一致，直接拷贝。
+    corners.resize(size_t(triangleCount) * 9);
+    float* out = corners.data();
+    parallelFor(int(triangleCount), [&](int begin, int end) {
+        for (int t = begin; t < end; ++t) {
+            const uchar* record = data + kBinaryHeaderSize + qint64(t) * kBinaryTriangleSize + 12;
+            std::memcpy(out + size_t(t) * 9, record, 9 * sizeof(float));
+        }
+    });
+    return true;
+}
+
+bool StlMeshLoader::parseAscii(const uchar* data, qint64 size, std::vector<float>& corners)
+{
+    const uchar* p = data;
+    const uchar* end = data + size;
+
+    // 粗略预估：每个三角形约250字节文本
+    corners.reserve(size_t(size / 250) * 9);
+
+    while (p < end) {
+        while (p < end && isSpace(*p)) ++p;
+
+        if (end - p > 6 && std::memcmp(p, "vertex", 6) == 0 && isSpace(p[6])) {
+            p += 6;
+            for (int axis = 0; axis < 3; ++axis) {
+                float value = 0.0f;
+                p = parseFloat(p, end, &value);
+                if (!p) {
+                    m_errorMessage = "Malformed vertex in ASCII STL";
+                    return false;
+                }
+                corners.push_back(value);
+            }
+        }
+
+        while (p < end && *p != '\n') ++p;
+    }
+
+    if (corners.size() % 9 != 0) {
+        m_errorMessage = "ASCII STL has incomplete facets";
+        return false;
+    }
+    if (qint64(corners.size() / 9) > kMaxTriangles) {
+        m_errorMessage = "STL has too many triangles";
+        return false;
+    }
+    return true;
+}
+
+void StlMeshLoader::buildMesh(const std::vector<float>& corners, const Options& options, MeshData& mesh)
+{
+    const int cornerCount = int(corners.size() / 3);
+    const int triangleCount = cornerCount / 3;
+    const float* positions = corners.data();
+
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+
+    // ===== 顶点合并 =====
+    std::vector<quint32> positionIds(cornerCount);
+    std::vector<float> weldedPositions;
+    const float* uniquePositions = positions;
+    int uniqueCount = cornerCount;
+    if (options.weldVertices) {
+        uniqueCount = weldPositions(positions, cornerCount, positionIds, weldedPositions);
+        uniquePositions = weldedPositions.data();
+    } else {
+        std::iota(positionIds.begin(), positionIds.end(), 0u);
+    }
+    recordStage("weld", stageTimer.nsecsElapsed());
+
+    // ===== 法线 =====
+    stageTimer.restart();
+
+    // 面法线（未归一化的叉积，长度与面积成正比，作为平滑时的权重）
+    std::vector<float> faceNormals(size_t(triangleCount) * 3);
+    parallelFor(triangleCount, [&](int begin, int end) {
+        for (int t = begin; t < end; ++t) {
+            const float* a = positions + size_t(t) * 9;
+            const float* b = a + 3;
+            const float* c = a + 6;
+            const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            float* n = faceNormals.data() + size_t(t) * 3;
+            n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        }
+    });
+
+    // 按位置累加面积加权的面法线
+    const bool smooth = options.smoothNormals && options.weldVertices;
+    std::vector<float> smoothNormals;
+    if (smooth) {
+        smoothNormals.assign(size_t(uniqueCount) * 3, 0.0f);
+        for (int i = 0; i < cornerCount; ++i) {
+            const float* n = faceNormals.data() + size_t(i / 3) * 3;
+            float* s = smoothNormals.data() + size_t(positionIds[i]) * 3;
+            s[0] += n[0];
+            s[1] += n[1];
+            s[2] += n[2];
+        }
+        parallelFor(uniqueCount, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) normalize3(smoothNormals.data() + size_t(i) * 3);
+        });
+    }
+    parallelFor(triangleCount, [&](int begin, int end) {
+        for (int t = begin; t < end; ++t) normalize3(faceNormals.data() + size_t(t) * 3);
+    });
+
+    // 与平均法线夹角在折痕角内的角点共享平滑顶点，其余角点按 (位置, 面法线) 合并为硬边顶点
+    const float cosCrease = std::cos(qDegreesToRadians(options.creaseAngle));
+    const quint32 unassigned = std::numeric_limits<quint32>::max();
+    std::vector<quint32> smoothVertexOf(smooth ? uniqueCount : 0, unassigned);
+    std::unordered_map<CornerKey, quint32, CornerKeyHash> hardVertices;
+
+    std::vector<float> vertices;
+    vertices.reserve(size_t(uniqueCount) * 6);
+    mesh.indices.resize(cornerCount * int(sizeof(quint32)));
+    quint32* indices = reinterpret_cast<quint32*>(mesh.indices.data());
+    quint32 vertexCount = 0;
+
+    auto appendVertex = [&](quint32 positionId, const float* normal) {
+        const float* p = uniquePositions + size_t(positionId) * 3;
+        vertices.insert(vertices.end(), { p[0], p[1], p[2], normal[0], normal[1], normal[2] });
+        return vertexCount++;
+    };
+
+    for (int i = 0; i < cornerCount; ++i) {
+        const quint32 positionId = positionIds[i];
+        const float* faceNormal = faceNormals.data() + size_t(i / 3) * 3;
+
+        if (smooth) {
+            const float* s = smoothNormals.data() + size_t(positionId) * 3;
+            const float cosAngle = faceNormal[0] * s[0] + faceNormal[1] * s[1] + faceNormal[2] * s[2];
+            const bool degenerate = faceNormal[0] == 0.0f && faceNormal[1] == 0.0f && faceNormal[2] == 0.0f;
+            if (degenerate || cosAngle >= cosCrease) {
+                quint32& vertex = smoothVertexOf[positionId];
+                if (vertex == unassigned) vertex = appendVertex(positionId, s);
+                indices[i] = vertex;
+                continue;
+            }
+        }
+
+        // 未合并顶点时每个角点独立，无需查表
+        if (!options.weldVertices) {
+            indices[i] = appendVertex(positionId, faceNormal);
+            continue;
+        }
+        
+        const CornerKey key = { positionId, floatBits(faceNormal[0]), floatBits(faceNormal[1]), floatBits(faceNormal[2]) };
+        auto found = hardVertices.find(key);
+        if (found != hardVertices.end()) {
+            indices[i] = found->second;
+        } else {
+            const quint32 vertex = appendVertex(positionId, faceNormal);
+            hardVertices.emplace(key, vertex);
+            indices[i] = vertex;
+        }
+    }
+
+    mesh.vertices = QByteArray(reinterpret_cast<const char*>(vertices.data()), int(vertices.size() * sizeof(float)));
+    mesh.vertexCount = int(vertexCount);
+    mesh.indexCount = cornerCount;
+
+    // 包围盒
+    QVector3D boundsMin(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    QVector3D boundsMax(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+    for (int i = 0; i < uniqueCount; ++i) {
+        const float* p = uniquePositions + size_t(i) * 3;
+        boundsMin = QVector3D(qMin(boundsMin.x(), p[0]), qMin(boundsMin.y(), p[1]), qMin(boundsMin.z(), p[2]));
+        boundsMax = QVector3D(qMax(boundsMax.x(), p[0]), qMax(boundsMax.y(), p[1]), qMax(boundsMax.z(), p[2]));
+    }
+    mesh.boundsMin = boundsMin;
+    mesh.boundsMax = boundsMax;
+
+    recordStage("normals", stageTimer.nsecsElapsed());
+}
+
+void StlMeshLoader::recordStage(const QString& stage, qint64 nsec)
+{
+    ImportStageTiming timing;
+    timing.stage = stage;
+    timing.msec = nsec / 1.0e6;
+    m_stageTimings.append(timing);
+}
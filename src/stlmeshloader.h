@@ -0,0 +1,59 @@
+#ifndef STLMESHLOADER_H
+#define STLMESHLOADER_H
+
+#include <QString>
+#include <QVector>
+#include <vector>
+
+#include "meshdata.h"
+
+/**
+ * @brief STL网格快速加载器
+ * 内存映射文件（二进制/ASCII），以分区哈希并行合并相同位置的顶点，
+ * 按折痕角生成平滑法线（超过折痕角的角点使用面法线），直接输出Qt3D可用的顶点/索引缓冲。
+ */
+class StlMeshLoader
+{
+public:
+    struct Options {
+        bool weldVertices = true;       // 合并相同位置的顶点
+        bool smoothNormals = true;      // 生成平滑法线（false时为面法线）
+        float creaseAngle = 45.0f;      // 折痕角（度），相邻面夹角超过该值时保持硬边
+    };
+
+    /**
+     * @brief 加载STL文件
+     * @param filename 文件路径
+     * @param mesh 输出网格数据
+     * @param options 加载选项
+     * @return 是否成功
+     */
+    bool load(const QString& filename, MeshData& mesh, const Options& options);
+    bool load(const QString& filename, MeshData& mesh) { return load(filename, mesh, Options()); }
+
+    /**
+     * @brief 最近一次加载各阶段耗时（map、parse、weld、normals）
+     */
+    QVector<ImportStageTiming> stageTimings() const { return m_stageTimings; }
+
+    /**
+     * @brief 获取错误信息
+     */
+    QString getErrorMessage() const { return m_errorMessage; }
+
+    /**
+     * @brief 是否为STL文件（按扩展名判断）
+     */
+    static bool isStlFile(const QString& filename);
+
+private:
+    bool parseBinary(const uchar* data, qint64 size, std::vector<float>& corners);
+    bool parseAscii(const uchar* data, qint64 size, std::vector<float>& corners);
+    void buildMesh(const std::vector<float>& corners, const Options& options, MeshData& mesh);
+    void recordStage(const QString& stage, qint64 nsec);
+
+    QString m_errorMessage;
+    QVector<ImportStageTiming> m_stageTimings;
+};
+
+#endif // STLMESHLOADER_H
@@ -0,0 +1,404 @@
+﻿#include "stresstest.h"
+#include "syntheticrobot.h"
+#include "robotscene.h"
+#include "robotentity.h"
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DExtras/Qt3DWindow>
+#include <Qt3DExtras/QForwardRenderer>
+#include <Qt3DLogic/QFrameAction>
+#include <Qt3DRender/QCamera>
+
+#include <QGuiApplication>
+#include <QSurfaceFormat>
+#include <QTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* kGenerateOption = "--generate-robot";
+const char* kStressOption = "--stress";
+const int kReportInterval = 1000;     // 报告周期（毫秒）
+const int kMaxRowsPerTick = 5000;     // 单次最多回放的行数，落后更多时跳过
+
+QString argumentValue(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc - 1; ++i) {
+        if (qstrcmp(argv[i], name) == 0) {
+            return QString::fromLocal8Bit(argv[i + 1]);
+        }
+    }
+    return QString();
+}
+
+QStringList argumentList(int argc, char* argv[])
+{
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments << QString::fromLocal8Bit(argv[i]);
+    }
+    return arguments;
+}
+
+/**
+ * @brief 当前进程的常驻内存（字节），不支持的平台返回0
+ */
+qint64 residentMemory()
+{
+#if defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+    return 0;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+double percentile(QVector<double> values, double fraction)
+{
+    if (values.isEmpty()) return 0.0;
+    const int index = qBound(0, int(std::ceil(fraction * values.size())) - 1, values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values.at(index);
+}
+
+} // namespace
+
+StressTest::StressTest(QObject* parent)
+    : QObject(parent)
+{
+}
+
+StressTest::~StressTest()
+{
+    delete m_window;
+    m_window = nullptr;
+    delete m_scene;
+    m_scene = nullptr;
+}
+
+bool StressTest::isRequested(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], kGenerateOption) == 0 || qstrcmp(argv[i], kStressOption) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int StressTest::run(int argc, char* argv[])
+{
+    const QStringList arguments = argumentList(argc, argv);
+
+    // 只生成，不运行
+    const QString generateDir = argumentValue(argc, argv, kGenerateOption);
+    if (!generateDir.isEmpty()) {
+        QString error;
+        if (!SyntheticRobot::generate(SyntheticRobot::optionsFromArguments(arguments), generateDir, &error)) {
+            qCritical() << "生成失败:" << error;
+            return 1;
+        }
+        return 0;
+    }
+
+    QString workload = argumentValue(argc, argv, kStressOption);
+    if (workload.isEmpty()) {
+        qCritical() << "用法: RobotViewer --stress <dir|workload.json> [--report stress.csv] [--duration s]";
+        qCritical() << "      RobotViewer --generate-robot <dir> [--links N] [--branching N] [--mesh-triangles N]"
+                       " [--primitives N] [--unique-meshes] [--end-effectors N] [--rate Hz] [--duration s]";
+        return 2;
+    }
+
+    // 目录中还没有工作负载时先生成
+    if (QFileInfo(workload).isDir() && !QFileInfo::exists(QDir(workload).filePath("workload.json"))) {
+        QString error;
+        if (!SyntheticRobot::generate(SyntheticRobot::optionsFromArguments(arguments), workload, &error)) {
+            qCritical() << "生成失败:" << error;
+            return 1;
+        }
+    }
+
+    QSurfaceFormat format;
+    format.setVersion(4, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+    format.setStencilBufferSize(8);
+    format.setSamples(4);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName("RobotViewer");
+    app.setOrganizationName("RobotViewer");
+
+    StressTest test;
+    test.setReportFile(argumentValue(argc, argv, "--report"));
+    test.setDuration(argumentValue(argc, argv, "--duration").toDouble());
+    if (!test.loadWorkload(workload) || !test.start()) {
+        qCritical() << "压力测试失败:" << test.getErrorMessage();
+        return 1;
+    }
+
+    QObject::connect(&test, &StressTest::finished, &app, [](int exitCode) {
+        QCoreApplication::exit(exitCode);
+    });
+
+    return app.exec();
+}
+
+bool StressTest::loadWorkload(const QString& path)
+{
+    const QString workloadFile = QFileInfo(path).isDir() ? QDir(path).filePath("workload.json") : path;
+    QFile file(workloadFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorMessage = tr("无法打开工作负载: %1").arg(workloadFile);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        m_errorMessage = tr("工作负载解析失败: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    const QJsonObject workload = doc.object();
+    const QDir baseDir = QFileInfo(workloadFile).absoluteDir();
+    m_urdfFile = baseDir.absoluteFilePath(workload.value("urdf").toString("robot.urdf"));
+    m_jointsFile = baseDir.absoluteFilePath(workload.value("joints").toString("joints.csv"));
+    m_rateHz = qMax(1.0, workload.value("rateHz").toDouble(100.0));
+    m_durationSec = workload.value("durationSec").toDouble(60.0);
+
+    m_endEffectors.clear();
+    for (const QJsonValue& value : workload.value("endEffectors").toArray()) {
+        m_endEffectors << value.toString();
+    }
+    return true;
+}
+
+bool StressTest::start()
+{
+    if (!openJointStream()) {
+        return false;
+    }
+
+    m_window = new Qt3DExtras::Qt3DWindow();
+    m_window->setTitle("RobotViewer - Stress");
+    m_window->resize(1280, 720);
+    m_window->defaultFrameGraph()->setClearColor(QColor(10, 10, 21));
+
+    Qt3DRender::QCamera* camera = m_window->camera();
+    camera->lens()->setPerspectiveProjection(45.0f, 16.0f / 9.0f, 0.01f, 1000.0f);
+
+    Qt3DCore::QEntity* root = new Qt3DCore::QEntity();
+    m_window->setRootEntity(root);
+
+    // 每个Qt3D帧回调一次，用于统计帧时间
+    Qt3DLogic::QFrameAction* frameAction = new Qt3DLogic::QFrameAction(root);
+    root->addComponent(frameAction);
+    connect(frameAction, &Qt3DLogic::QFrameAction::triggered, this, &StressTest::onFrame);
+
+    m_scene = new RobotScene();
+    m_scene->initialize();
+    m_scene->setSceneRoot(root);
+    connect(m_scene, &RobotScene::fitCameraRequested, this,
+            [camera](const QVector3D& center, const QVector3D& position) {
+                camera->setViewCenter(center);
+                camera->setPosition(position);
+                camera->setUpVector(QVector3D(0, 1, 0));
+            });
+    m_scene->robotEntity()->setLodCamera(camera);
+
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    if (!m_scene->loadRobot(m_urdfFile)) {
+        m_errorMessage = tr("加载URDF失败: %1").arg(m_scene->robotEntity()->getErrorMessage());
+        return false;
+    }
+    const qint64 loadMsec = loadTimer.elapsed();
+
+    for (const QString& linkName : m_endEffectors) {
+        m_scene->addEndEffectorTrajectory(linkName);
+    }
+
+    if (!m_reportPath.isEmpty()) {
+        m_report.setFileName(m_reportPath);
+        if (!m_report.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            m_errorMessage = tr("无法写入报告: %1").arg(m_reportPath);
+            return false;
+        }
+        m_report.write("elapsed_s,fps,frame_p50_ms,frame_p95_ms,frame_max_ms,rss_mb,joint_updates_per_s\n");
+    }
+
+    qDebug().noquote() << QString("压力测试: %1 个Link, %2 个关节列, %3 Hz, %4 个末端轨迹, 加载 %5 ms, 内存 %6 MB")
+                          .arg(m_scene->robotEntity()->getModel()->links.size())
+                          .arg(m_jointColumns.size())
+                          .arg(m_rateHz)
+                          .arg(m_endEffectors.size())
+                          .arg(loadMsec)
+                          .arg(residentMemory() / 1048576.0, 0, 'f', 1);
+
+    m_window->show();
+
+    // 按工作负载频率回放（定时器最小1ms，高于1kHz时每次回放多行）
+    m_driveTimer = new QTimer(this);
+    m_driveTimer->setTimerType(Qt::PreciseTimer);
+    m_driveTimer->setInterval(qMax(1, int(1000.0 / m_rateHz)));
+    connect(m_driveTimer, &QTimer::timeout, this, &StressTest::applyDueRows);
+
+    m_reportTimer = new QTimer(this);
+    m_reportTimer->setInterval(kReportInterval);
+    connect(m_reportTimer, &QTimer::timeout, this, &StressTest::report);
+
+    m_clock.start();
+    m_driveTimer->start();
+    m_reportTimer->start();
+    return true;
+}
+
+bool StressTest::openJointStream()
+{
+    m_jointStream.setFileName(m_jointsFile);
+    if (!m_jointStream.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_errorMessage = tr("无法打开关节数据: %1").arg(m_jointsFile);
+        return false;
+    }
+
+    const QString header = QString::fromUtf8(m_jointStream.readLine()).trimmed();
+    m_jointColumns = header.split(',');
+    if (m_jointColumns.size() < 2) {
+        m_errorMessage = tr("关节数据缺少关节列: %1").arg(m_jointsFile);
+        return false;
+    }
+    m_jointColumns.removeFirst();   // time
+    return true;
+}
+
+bool StressTest::readRow(double* time)
+{
+    const QByteArray line = m_jointStream.readLine().trimmed();
+    if (line.isEmpty()) {
+        m_streamEnded = true;
+        return false;
+    }
+
+    const QList<QByteArray> fields = line.split(',');
+    *time = fields.value(0).toDouble();
+    const int count = qMin(fields.size() - 1, m_jointColumns.size());
+    for (int i = 0; i < count; ++i) {
+        m_jointValues[m_jointColumns.at(i)] = fields.at(i + 1).toDouble();
+    }
+    return true;
+}
+
+void StressTest::applyDueRows()
+{
+    const double elapsed = m_clock.nsecsElapsed() / 1.0e9;
+    const double duration = m_durationOverride > 0.0 ? m_durationOverride : m_durationSec;
+    if (elapsed >= duration || m_streamEnded) {
+        finish();
+        return;
+    }
+
+    // 按时间补齐到期的行，每行都作为一次独立的关节更新
+    const qint64 due = qint64(elapsed * m_rateHz) + 1 - m_rowsApplied - m_rowsSkipped;
+    const qint64 skip = qMax<qint64>(0, due - kMaxRowsPerTick);
+    double time = 0.0;
+    for (qint64 i = 0; i < skip && readRow(&time); ++i) {
+        ++m_rowsSkipped;
+    }
+    for (qint64 i = skip; i < due; ++i) {
+        if (!readRow(&time)) break;
+        m_scene->robotEntity()->setJointValues(m_jointValues);
+        ++m_rowsApplied;
+        ++m_intervalUpdates;
+    }
+}
+
+void StressTest::onFrame(float dt)
+{
+    const double msec = dt * 1000.0;
+    m_intervalFrames.append(msec);
+    m_allFrames.append(msec);
+}
+
+void StressTest::report()
+{
+    const double elapsed = m_clock.elapsed() / 1000.0;
+    const double seconds = kReportInterval / 1000.0;
+    const qint64 rss = residentMemory();
+    m_peakRss = qMax(m_peakRss, rss);
+
+    const double fps = m_intervalFrames.size() / seconds;
+    const double p50 = percentile(m_intervalFrames, 0.50);
+    const double p95 = percentile(m_intervalFrames, 0.95);
+    const double maxFrame = m_intervalFrames.isEmpty() ? 0.0
+            : *std::max_element(m_intervalFrames.cbegin(), m_intervalFrames.cend());
+    const double updates = m_intervalUpdates / seconds;
+
+    const QString row = QString("%1,%2,%3,%4,%5,%6,%7")
+            .arg(elapsed, 0, 'f', 1)
+            .arg(fps, 0, 'f', 1)
+            .arg(p50, 0, 'f', 2)
+            .arg(p95, 0, 'f', 2)
+            .arg(maxFrame, 0, 'f', 2)
+            .arg(rss / 1048576.0, 0, 'f', 1)
+            .arg(updates, 0, 'f', 0);
+    if (m_report.isOpen()) {
+        m_report.write(row.toUtf8() + '\n');
+        m_report.flush();
+    }
+    qDebug().noquote() << QString("[%1 s] %2 fps  p50 %3 ms  p95 %4 ms  max %5 ms  内存 %6 MB  关节更新 %7/s")
+                          .arg(elapsed, 5, 'f', 1).arg(fps, 0, 'f', 1).arg(p50, 0, 'f', 2).arg(p95, 0, 'f', 2)
+                          .arg(maxFrame, 0, 'f', 2).arg(rss / 1048576.0, 0, 'f', 1).arg(updates, 0, 'f', 0);
+
+    m_intervalFrames.clear();
+    m_intervalUpdates = 0;
+}
+
+void StressTest::finish()
+{
+    m_driveTimer->stop();
+    m_reportTimer->stop();
+    report();
+
+    const double elapsed = m_clock.elapsed() / 1000.0;
+    qDebug().noquote() << QString("压力测试完成: %1 s, %2 帧 (p50 %3 ms, p95 %4 ms, p99 %5 ms), "
+                                  "关节更新 %6 次, 跳过 %7 行, 峰值内存 %8 MB")
+                          .arg(elapsed, 0, 'f', 1)
+                          .arg(m_allFrames.size())
+                          .arg(percentile(m_allFrames, 0.50), 0, 'f', 2)
+                          .arg(percentile(m_allFrames, 0.95), 0, 'f', 2)
+                          .arg(percentile(m_allFrames, 0.99), 0, 'f', 2)
+                          .arg(m_rowsApplied)
+                          .arg(m_rowsSkipped)
+                          .arg(m_peakRss / 1048576.0, 0, 'f', 1);
+
+    m_report.close();
+    emit finished(0);
+}
@@ -0,0 +1,114 @@
+#ifndef STRESSTEST_H
+#define STRESSTEST_H
+
+#include <QObject>
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
+
+class QTimer;
+class RobotScene;
+
+namespace Qt3DExtras {
+class Qt3DWindow;
+}
+
+/**
+ * @brief 压力测试：在完整的RobotScene中回放合成工作负载，按秒记录帧时间与内存
+ *
+ * 命令行：
+ *   RobotViewer --generate-robot <dir> [--links N] [--branching N] [--mesh-triangles N]
+ *               [--primitives N] [--unique-meshes] [--end-effectors N] [--rate Hz] [--duration s]
+ *   RobotViewer --stress <dir|workload.json> [--report stress.csv] [--duration s]
+ * --stress 指向的目录中没有workload.json时，先按上述生成参数生成。
+ * 报告CSV每秒一行：elapsed_s, fps, frame_p50_ms, frame_p95_ms, frame_max_ms, rss_mb, joint_updates_per_s
+ */
+class StressTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StressTest(QObject* parent = nullptr);
+    ~StressTest();
+
+    /**
+     * @brief 读取工作负载描述（目录或workload.json）
+     */
+    bool loadWorkload(const QString& path);
+
+    /**
+     * @brief 设置报告文件（CSV）
+     */
+    void setReportFile(const QString& filePath) { m_reportPath = filePath; }
+
+    /**
+     * @brief 覆盖工作负载时长（秒，<=0表示使用工作负载中的时长）
+     */
+    void setDuration(double seconds) { m_durationOverride = seconds; }
+
+    /**
+     * @brief 创建窗口、加载机器人并开始回放
+     */
+    bool start();
+
+    QString getErrorMessage() const { return m_errorMessage; }
+
+    /**
+     * @brief 命令行中是否请求了生成或压力测试模式（--generate-robot / --stress）
+     */
+    static bool isRequested(int argc, char* argv[]);
+
+    /**
+     * @brief 生成/压力测试模式入口，替代正常的QML界面启动流程
+     * @return 进程退出码
+     */
+    static int run(int argc, char* argv[]);
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void onFrame(float dt);
+    void applyDueRows();
+    void report();
+
+private:
+    bool openJointStream();
+    bool readRow(double* time);
+    void finish();
+
+    QString m_errorMessage;
+
+    // 工作负载
+    QString m_urdfFile;
+    QString m_jointsFile;
+    QStringList m_endEffectors;
+    double m_rateHz = 100.0;
+    double m_durationSec = 60.0;
+    double m_durationOverride = 0.0;
+    QString m_reportPath;
+
+    // 运行状态
+    Qt3DExtras::Qt3DWindow* m_window = nullptr;
+    RobotScene* m_scene = nullptr;
+    QTimer* m_driveTimer = nullptr;
+    QTimer* m_reportTimer = nullptr;
+    QElapsedTimer m_clock;
+    QFile m_jointStream;
+    QStringList m_jointColumns;
+    QMap<QString, double> m_jointValues;
+    bool m_streamEnded = false;
+    qint64 m_rowsApplied = 0;
+    qint64 m_rowsSkipped = 0;
+    int m_intervalUpdates = 0;
+
+    // 统计
+    QVector<double> m_intervalFrames;   // 本周期帧时间（毫秒）
+    QVector<double> m_allFrames;
+    qint64 m_peakRss = 0;
+    QFile m_report;
+};
+
+#endif // STRESSTEST_H
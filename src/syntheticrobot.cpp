@@ -0,0 +1,275 @@
+﻿#include "syntheticrobot.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QtEndian>
+#include <QtMath>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace {
+
+const double kLinkLength = 0.12;     // 父Link原点到关节原点的距离（米）
+const int kSharedMeshFiles = 4;      // 共享网格模式下的网格文件数
+
+QString argumentValue(const QStringList& arguments, const QString& name)
+{
+    const int index = arguments.indexOf(name);
+    return (index >= 0 && index + 1 < arguments.size()) ? arguments.at(index + 1) : QString();
+}
+
+QString number(double value)
+{
+    return QString::number(value, 'g', 6);
+}
+
+} // namespace
+
+SyntheticRobot::Options SyntheticRobot::optionsFromArguments(const QStringList& arguments)
+{
+    Options options;
+    auto intValue = [&](const char* name, int fallback) {
+        const QString value = argumentValue(arguments, name);
+        return value.isEmpty() ? fallback : value.toInt();
+    };
+    auto doubleValue = [&](const char* name, double fallback) {
+        const QString value = argumentValue(arguments, name);
+        return value.isEmpty() ? fallback : value.toDouble();
+    };
+
+    options.links = qMax(1, intValue("--links", options.links));
+    options.branching = qMax(1, intValue("--branching", options.branching));
+    options.meshTriangles = qMax(0, intValue("--mesh-triangles", options.meshTriangles));
+    options.primitivesPerLink = qMax(0, intValue("--primitives", options.primitivesPerLink));
+    options.uniqueMeshes = arguments.contains("--unique-meshes");
+    options.endEffectors = qMax(0, intValue("--end-effectors", options.endEffectors));
+    options.rateHz = qMax(1.0, doubleValue("--rate", options.rateHz));
+    options.durationSec = qMax(0.1, doubleValue("--duration", options.durationSec));
+    options.seed = quint32(intValue("--seed", int(options.seed)));
+    return options;
+}
+
+bool SyntheticRobot::generate(const Options& options, const QString& outputDir, QString* errorMessage)
+{
+    auto fail = [errorMessage](const QString& message) {
+        if (errorMessage) *errorMessage = message;
+        qWarning() << message;
+        return false;
+    };
+
+    QDir dir(outputDir);
+    if (!dir.mkpath("meshes")) {
+        return fail(QString("无法创建输出目录: %1").arg(outputDir));
+    }
+
+    const int linkCount = qMax(1, options.links);
+    const int branching = qMax(1, options.branching);
+    const bool useMeshes = options.meshTriangles > 0;
+
+    // ===== 网格文件 =====
+    const int meshFiles = useMeshes ? (options.uniqueMeshes ? linkCount : qMin(linkCount, kSharedMeshFiles)) : 0;
+    for (int i = 0; i < meshFiles; ++i) {
+        const float majorRadius = 0.025f + 0.002f * (i % kSharedMeshFiles);
+        if (!writeTorusStl(dir.filePath(QString("meshes/part_%1.stl").arg(i)),
+                           options.meshTriangles, majorRadius, 0.01f)) {
+            return fail(QString("无法写入网格文件: %1").arg(dir.filePath(QString("meshes/part_%1.stl").arg(i))));
+        }
+    }
+
+    // ===== URDF：完全k叉树，Link i 的父Link为 (i-1)/k =====
+    QFile urdfFile(dir.filePath("robot.urdf"));
+    if (!urdfFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return fail(QString("无法写入: %1").arg(urdfFile.fileName()));
+    }
+
+    QTextStream urdf(&urdfFile);
+    urdf << "<?xml version=\"1.0\"?>\n"
+         << "<robot name=\"synthetic_" << linkCount << "_" << branching << "\">\n";
+
+    static const char* const kPrimitiveTypes[] = { "box", "cylinder", "sphere" };
+    for (int i = 0; i < linkCount; ++i) {
+        urdf << "  <link name=\"link_" << i << "\">\n";
+        if (useMeshes) {
+            urdf << "    <visual>\n"
+                 << "      <origin xyz=\"0 0 " << number(kLinkLength * 0.5) << "\" rpy=\"0 0 0\"/>\n"
+                 << "      <geometry><mesh filename=\"meshes/part_" << (i % meshFiles) << ".stl\"/></geometry>\n"
+                 << "      <material name=\"mesh_" << (i % 8) << "\"><color rgba=\""
+                 << number(0.3 + 0.08 * (i % 8)) << " 0.5 " << number(0.9 - 0.08 * (i % 8)) << " 1\"/></material>\n"
+                 << "    </visual>\n";
+        }
+        for (int p = 0; p < options.primitivesPerLink; ++p) {
+            const char* type = kPrimitiveTypes[p % 3];
+            const double z = kLinkLength * (p + 1) / (options.primitivesPerLink + 1);
+            urdf << "    <visual>\n"
+                 << "      <origin xyz=\"0 0 " << number(z) << "\" rpy=\"0 0 0\"/>\n"
+                 << "      <geometry>";
+            if (p % 3 == 0) {
+                urdf << "<box size=\"0.04 0.04 0.02\"/>";
+            } else if (p % 3 == 1) {
+                urdf << "<cylinder radius=\"0.012\" length=\"" << number(kLinkLength * 0.8) << "\"/>";
+            } else {
+                urdf << "<sphere radius=\"0.018\"/>";
+            }
+            urdf << "</geometry>\n"
+                 << "      <material name=\"" << type << "\"><color rgba=\"0.7 0.7 0.7 1\"/></material>\n"
+                 << "    </visual>\n";
+        }
+        urdf << "  </link>\n";
+
+        if (i == 0) continue;
+
+        // 兄弟Link绕父Link的Z轴均匀分布
+        const int parent = (i - 1) / branching;
+        const int sibling = (i - 1) % branching;
+        const double angle = 2.0 * M_PI * sibling / branching;
+        const double radial = branching > 1 ? 0.06 : 0.0;
+        urdf << "  <joint name=\"joint_" << i << "\" type=\"revolute\">\n"
+             << "    <parent link=\"link_" << parent << "\"/>\n"
+             << "    <child link=\"link_" << i << "\"/>\n"
+             << "    <origin xyz=\"" << number(radial * std::cos(angle)) << " " << number(radial * std::sin(angle))
+             << " " << number(kLinkLength) << "\" rpy=\"0 " << (i % 2 ? "0.15" : "-0.15") << " "
+             << number(angle) << "\"/>\n"
+             << "    <axis xyz=\"" << (i % 3 == 0 ? "0 0 1" : (i % 3 == 1 ? "0 1 0" : "1 0 0")) << "\"/>\n"
+             << "    <limit lower=\"-1.57\" upper=\"1.57\" effort=\"10\" velocity=\"2\"/>\n"
+             << "  </joint>\n";
+    }
+    urdf << "</robot>\n";
+    urdf.flush();
+    urdfFile.close();
+
+    // ===== 关节运动：每个关节独立频率和相位的正弦 =====
+    QFile csvFile(dir.filePath("joints.csv"));
+    if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return fail(QString("无法写入: %1").arg(csvFile.fileName()));
+    }
+
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> frequencyDist(0.05, 0.5);
+    std::uniform_real_distribution<double> phaseDist(0.0, 2.0 * M_PI);
+    const int jointCount = linkCount - 1;
+    QVector<double> frequencies(jointCount);
+    QVector<double> phases(jointCount);
+    for (int j = 0; j < jointCount; ++j) {
+        frequencies[j] = frequencyDist(random);
+        phases[j] = phaseDist(random);
+    }
+
+    QTextStream csv(&csvFile);
+    csv << "time";
+    for (int j = 0; j < jointCount; ++j) {
+        csv << ",joint_" << (j + 1);
+    }
+    csv << "\n";
+
+    const qint64 rows = qint64(options.durationSec * options.rateHz) + 1;
+    for (qint64 row = 0; row < rows; ++row) {
+        const double t = row / options.rateHz;
+        csv << QString::number(t, 'f', 6);
+        for (int j = 0; j < jointCount; ++j) {
+            csv << ',' << QString::number(1.2 * std::sin(2.0 * M_PI * frequencies[j] * t + phases[j]), 'f', 5);
+        }
+        csv << '\n';
+    }
+    csv.flush();
+    csvFile.close();
+
+    // ===== 工作负载描述：叶子Link作为末端执行器 =====
+    QStringList leaves;
+    for (int i = 0; i < linkCount; ++i) {
+        if (qint64(i) * branching + 1 >= linkCount) {
+            leaves << QString("link_%1").arg(i);
+        }
+    }
+    QJsonArray endEffectors;
+    const int wanted = options.endEffectors > 0 ? qMin(options.endEffectors, leaves.size()) : leaves.size();
+    for (int k = 0; k < wanted; ++k) {
+        endEffectors.append(leaves.at(int(qint64(k) * leaves.size() / wanted)));
+    }
+
+    QJsonObject generator;
+    generator["links"] = linkCount;
+    generator["branching"] = branching;
+    generator["meshTriangles"] = options.meshTriangles;
+    generator["primitivesPerLink"] = options.primitivesPerLink;
+    generator["uniqueMeshes"] = options.uniqueMeshes;
+    generator["seed"] = qint64(options.seed);
+
+    QJsonObject workload;
+    workload["urdf"] = "robot.urdf";
+    workload["joints"] = "joints.csv";
+    workload["rateHz"] = options.rateHz;
+    workload["durationSec"] = options.durationSec;
+    workload["endEffectors"] = endEffectors;
+    workload["generator"] = generator;
+
+    QFile workloadFile(dir.filePath("workload.json"));
+    if (!workloadFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail(QString("无法写入: %1").arg(workloadFile.fileName()));
+    }
+    workloadFile.write(QJsonDocument(workload).toJson());
+
+    qDebug().noquote() << QString("合成机器人: %1 个Link, 分支 %2, 网格 %3 个 × %4 三角形, 末端 %5 个, 关节数据 %6 行")
+                          .arg(linkCount).arg(branching).arg(meshFiles).arg(options.meshTriangles)
+                          .arg(endEffectors.size()).arg(rows);
+    return true;
+}
+
+bool SyntheticRobot::writeTorusStl(const QString& filePath, int triangles, float majorRadius, float minorRadius)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    // 2 × 环向段数 × 截面段数 ≈ 三角形数（截面段数取环向的一半）
+    const int ring = qMax(6, int(std::sqrt(triangles)));
+    const int section = qMax(3, ring / 2);
+    const quint32 count = quint32(2 * ring * section);
+
+    QByteArray header(80, ' ');
+    header.replace(0, 9, "synthetic");
+    file.write(header);
+    const quint32 countLe = qToLittleEndian(count);
+    file.write(reinterpret_cast<const char*>(&countLe), 4);
+
+    // 取模保证接缝处的顶点与起点逐位相同（与CAD导出的STL一致）
+    auto vertex = [&](int i, int j, float* v) {
+        const double u = 2.0 * M_PI * (i % ring) / ring;
+        const double w = 2.0 * M_PI * (j % section) / section;
+        v[0] = float((majorRadius + minorRadius * std::cos(w)) * std::cos(u));
+        v[1] = float((majorRadius + minorRadius * std::cos(w)) * std::sin(u));
+        v[2] = float(minorRadius * std::sin(w));
+    };
+
+    QByteArray row(section * 2 * 50, 0);
+    for (int i = 0; i < ring; ++i) {
+        char* record = row.data();
+        for (int j = 0; j < section; ++j) {
+            float quad[4][3];
+            vertex(i, j, quad[0]);
+            vertex(i + 1, j, quad[1]);
+            vertex(i + 1, j + 1, quad[2]);
+            vertex(i, j + 1, quad[3]);
+
+            const int faces[2][3] = { {0, 1, 2}, {0, 2, 3} };
+            for (const auto& face : faces) {
+                std::memset(record, 0, 50);   // 法线置零（加载器会重新计算）
+                for (int k = 0; k < 3; ++k) {
+                    std::memcpy(record + 12 + k * 12, quad[face[k]], 12);
+                }
+                record += 50;
+            }
+        }
+        if (file.write(row) != row.size()) {
+            return false;
+        }
+    }
+    return true;
+}
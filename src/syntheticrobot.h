@@ -0,0 +1,50 @@
+#ifndef SYNTHETICROBOT_H
+#define SYNTHETICROBOT_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 合成机器人与关节运动工作负载生成器（用于压力测试，无需客户模型）
+ *
+ * 输出目录结构：
+ *   robot.urdf        Link数、分支数、网格复杂度、基本几何体数可配置
+ *   meshes/*.stl      二进制STL（环面），三角形数由 meshTriangles 指定
+ *   joints.csv        关节运动：time,关节1,关节2,...（秒、弧度）
+ *   workload.json     上述文件、更新频率、时长和需要显示轨迹的末端Link
+ */
+class SyntheticRobot
+{
+public:
+    struct Options {
+        int links = 50;              // Link总数
+        int branching = 1;           // 每个Link的子Link数（1为串联机械臂）
+        int meshTriangles = 5000;    // 每个网格的三角形数（0表示不使用网格）
+        int primitivesPerLink = 1;   // 每个Link附加的基本几何体数（box/cylinder/sphere轮换）
+        bool uniqueMeshes = false;   // 每个Link使用独立网格文件（否则在少量文件间共享）
+        int endEffectors = 0;        // 显示轨迹的末端数（0表示所有叶子Link）
+        double rateHz = 100.0;       // 关节更新频率
+        double durationSec = 60.0;   // 工作负载时长
+        quint32 seed = 1;            // 关节运动相位/频率的随机种子
+    };
+
+    /**
+     * @brief 生成机器人与工作负载
+     * @param options 生成参数
+     * @param outputDir 输出目录（不存在时创建）
+     * @param errorMessage 失败时的错误信息
+     * @return 是否成功
+     */
+    static bool generate(const Options& options, const QString& outputDir, QString* errorMessage = nullptr);
+
+    /**
+     * @brief 按命令行参数填充生成参数（--links、--branching、--mesh-triangles、--primitives、
+     *        --unique-meshes、--end-effectors、--rate、--duration、--seed）
+     */
+    static Options optionsFromArguments(const QStringList& arguments);
+
+private:
+    static bool writeTorusStl(const QString& filePath, int triangles, float majorRadius, float minorRadius);
+};
+
+#endif // SYNTHETICROBOT_H
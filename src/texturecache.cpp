@@ -0,0 +1,437 @@
+﻿#include "texturecache.h"
+
+#include <Qt3DCore/QNode>
+#include <Qt3DRender/QTexture>
+#include <Qt3DRender/QTextureWrapMode>
+#include <QtConcurrent>
+#include <QImage>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const int kCacheVersion = 1;          // 压缩格式或编码器变化时递增，使旧缓存失效
+const int kMaxTextureSize = 4096;     // 超过该尺寸的图片先缩小再压缩
+
+// DDS 文件头常量
+const quint32 kDdsMagic = 0x20534444;           // "DDS "
+const quint32 kDdsdCaps = 0x1;
+const quint32 kDdsdHeight = 0x2;
+const quint32 kDdsdWidth = 0x4;
+const quint32 kDdsdPixelFormat = 0x1000;
+const quint32 kDdsdMipmapCount = 0x20000;
+const quint32 kDdsdLinearSize = 0x80000;
+const quint32 kDdpfFourCC = 0x4;
+const quint32 kDdsCapsComplex = 0x8;
+const quint32 kDdsCapsTexture = 0x1000;
+const quint32 kDdsCapsMipmap = 0x400000;
+const quint32 kFourCCDxt1 = 0x31545844;         // "DXT1"
+const quint32 kFourCCDxt5 = 0x35545844;         // "DXT5"
+
+typedef quint8 BlockPixels[16][4];
+
+// 2x2 盒式滤波下采样（RGBA8888），奇数尺寸时边缘像素重复
+QImage downsample(const QImage& source)
+{
+    const int width = qMax(1, source.width() / 2);
+    const int height = qMax(1, source.height() / 2);
+    const int lastX = source.width() - 1;
+    const int lastY = source.height() - 1;
+
+    QImage result(width, height, QImage::Format_RGBA8888);
+    for (int y = 0; y < height; ++y) {
+        const uchar* row0 = source.constScanLine(qMin(2 * y, lastY));
+        const uchar* row1 = source.constScanLine(qMin(2 * y + 1, lastY));
+        uchar* out = result.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const int x0 = qMin(2 * x, lastX) * 4;
+            const int x1 = qMin(2 * x + 1, lastX) * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[x * 4 + c] = static_cast<uchar>(
+                    (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+bool isOpaque(const QImage& image)
+{
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar* line = image.constScanLine(y);
+        for (int x = 0; x < image.width(); ++x) {
+            if (line[x * 4 + 3] != 255) return false;
+        }
+    }
+    return true;
+}
+
+// 读取4x4像素块，超出图片的部分重复边缘像素
+void fetchBlock(const QImage& image, int blockX, int blockY, BlockPixels pixels)
+{
+    for (int y = 0; y < 4; ++y) {
+        const uchar* line = image.constScanLine(qMin(blockY * 4 + y, image.height() - 1));
+        for (int x = 0; x < 4; ++x) {
+            const uchar* p = line + qMin(blockX * 4 + x, image.width() - 1) * 4;
+            std::memcpy(pixels[y * 4 + x], p, 4);
+        }
+    }
+}
+
+quint16 toRgb565(int r, int g, int b)
+{
+    return static_cast<quint16>((((r * 31 + 127) / 255) << 11)
+                                | (((g * 63 + 127) / 255) << 5)
+                                | ((b * 31 + 127) / 255));
+}
+
+void fromRgb565(quint16 color, int rgb[3])
+{
+    const int r = (color >> 11) & 31;
+    const int g = (color >> 5) & 63;
+    const int b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ * 颜色块编码（BC1/BC3共用，始终使用4色模式）
+ * 端点取包围盒对角线，按各通道与绿色通道的协方差符号选择对角方向，并向内收缩1/16以减小量化误差。
+ */
+void encodeColorBlock(const BlockPixels pixels, uchar* out)
+{
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            minColor[c] = qMin(minColor[c], int(pixels[i][c]));
+            maxColor[c] = qMax(maxColor[c], int(pixels[i][c]));
+            mean[c] += pixels[i][c];
+        }
+    }
+    for (int c = 0; c < 3; ++c) mean[c] = (mean[c] + 8) / 16;
+
+    // 红、蓝通道与绿色负相关时翻转对角方向
+    int covariance[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i) {
+        const int dg = pixels[i][1] - mean[1];
+        covariance[0] += (pixels[i][0] - mean[0]) * dg;
+        covariance[2] += (pixels[i][2] - mean[2]) * dg;
+    }
+    for (int c : {0, 2}) {
+        if (covariance[c] < 0) qSwap(minColor[c], maxColor[c]);
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        const int inset = (maxColor[c] - minColor[c]) / 16;
+        maxColor[c] -= inset;
+        minColor[c] += inset;
+    }
+
+    quint16 color0 = toRgb565(maxColor[0], maxColor[1], maxColor[2]);
+    quint16 color1 = toRgb565(minColor[0], minColor[1], minColor[2]);
+    if (color0 < color1) qSwap(color0, color1);
+
+    quint32 indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        fromRgb565(color0, palette[0]);
+        fromRgb565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int bestDistance = std::numeric_limits<int>::max();
+            for (int p = 0; p < 4; ++p) {
+                int distance = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const int d = pixels[i][c] - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= quint32(best) << (2 * i);
+        }
+    }
+
+    out[0] = color0 & 0xff;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xff;
+    out[3] = color1 >> 8;
+    out[4] = indices & 0xff;
+    out[5] = (indices >> 8) & 0xff;
+    out[6] = (indices >> 16) & 0xff;
+    out[7] = (indices >> 24) & 0xff;
+}
+
+// BC3 透明度块编码（8级插值模式）
+void encodeAlphaBlock(const BlockPixels pixels, uchar* out)
+{
+    int alpha0 = 0;
+    int alpha1 = 255;
+    for (int i = 0; i < 16; ++i) {
+        alpha0 = qMax(alpha0, int(pixels[i][3]));
+        alpha1 = qMin(alpha1, int(pixels[i][3]));
+    }
+
+    quint64 indices = 0;
+    if (alpha0 != alpha1) {
+        int palette[8];
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+        for (int p = 2; p < 8; ++p) {
+            palette[p] = ((8 - p) * alpha0 + (p - 1) * alpha1 + 3) / 7;
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int bestDistance = 256;
+            for (int p = 0; p < 8; ++p) {
+                const int distance = qAbs(pixels[i][3] - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= quint64(best) << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<uchar>(alpha0);
+    out[1] = static_cast<uchar>(alpha1);
+    for (int b = 0; b < 6; ++b) {
+        out[2 + b] = (indices >> (8 * b)) & 0xff;
+    }
+}
+
+QByteArray compressLevel(const QImage& image, bool withAlpha)
+{
+    const int blocksX = (image.width() + 3) / 4;
+    const int blocksY = (image.height() + 3) / 4;
+    const int blockSize = withAlpha ? 16 : 8;
+
+    QByteArray data(blocksX * blocksY * blockSize, Qt::Uninitialized);
+    uchar* out = reinterpret_cast<uchar*>(data.data());
+
+    BlockPixels pixels;
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            fetchBlock(image, bx, by, pixels);
+            if (withAlpha) {
+                encodeAlphaBlock(pixels, out);
+                out += 8;
+            }
+            encodeColorBlock(pixels, out);
+            out += 8;
+        }
+    }
+    return data;
+}
+
+void writeDdsHeader(QDataStream& stream, int width, int height, int mipCount,
+                    quint32 fourCC, quint32 topLevelSize)
+{
+    stream << kDdsMagic;
+
+    // DDS_HEADER
+    stream << quint32(124);
+    stream << quint32(kDdsdCaps | kDdsdHeight | kDdsdWidth | kDdsdPixelFormat
+                      | kDdsdMipmapCount | kDdsdLinearSize);
+    stream << quint32(height) << quint32(width);
+    stream << topLevelSize;
+    stream << quint32(0);                       // depth
+    stream << quint32(mipCount);
+    for (int i = 0; i < 11; ++i) stream << quint32(0);
+
+    // DDS_PIXELFORMAT
+    stream << quint32(32) << kDdpfFourCC << fourCC;
+    for (int i = 0; i < 5; ++i) stream << quint32(0);
+
+    stream << quint32(kDdsCapsTexture | kDdsCapsComplex | kDdsCapsMipmap);
+    stream << quint32(0) << quint32(0) << quint32(0);   // caps2~caps4
+    stream << quint32(0);                               // reserved2
+}
+
+} // namespace
+
+TextureCache::TextureCache(Qt3DCore::QNode* owner)
+    : QObject(owner)
+    , m_owner(owner)
+{
+}
+
+TextureCache::~TextureCache()
+{
+}
+
+Qt3DRender::QAbstractTexture* TextureCache::texture(const QString& imagePath)
+{
+    QFileInfo fileInfo(imagePath);
+    if (!fileInfo.exists()) {
+        qWarning() << "TextureCache: 纹理文件不存在" << imagePath;
+        return nullptr;
+    }
+
+    const QString key = fileInfo.absoluteFilePath();
+    if (Qt3DRender::QTextureLoader* existing = m_textures.value(key)) {
+        return existing;
+    }
+
+    Qt3DRender::QTextureLoader* texture = new Qt3DRender::QTextureLoader(m_owner);
+    m_textures.insert(key, texture);
+
+    const QString ddsPath = cachedFilePath(key);
+    if (QFileInfo::exists(ddsPath)) {
+        configureTexture(texture, ddsPath, true);
+        return texture;
+    }
+
+    // 缓存未命中：先加载原图（Qt3D在其工作线程解码），同时在后台生成压缩缓存
+    configureTexture(texture, key, false);
+
+    QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, &TextureCache::onCompressFinished);
+    m_pending.insert(watcher, key);
+    watcher->setFuture(QtConcurrent::run([key, ddsPath]() {
+        QString error;
+        const bool ok = buildCompressedTexture(key, ddsPath, &error);
+        if (!ok) {
+            qWarning() << "TextureCache: 压缩纹理失败" << key << error;
+        }
+        return ok;
+    }));
+
+    return texture;
+}
+
+void TextureCache::clear()
+{
+    for (Qt3DRender::QTextureLoader* texture : qAsConst(m_textures)) {
+        texture->deleteLater();
+    }
+    m_textures.clear();
+}
+
+void TextureCache::onCompressFinished()
+{
+    QFutureWatcher<bool>* watcher = static_cast<QFutureWatcher<bool>*>(sender());
+    const QString key = m_pending.take(watcher);
+    const bool ok = watcher->result();
+    watcher->deleteLater();
+
+    Qt3DRender::QTextureLoader* texture = m_textures.value(key);
+    if (!ok || !texture) return;
+
+    const QString ddsPath = cachedFilePath(key);
+    if (!QFileInfo::exists(ddsPath)) return;   // 压缩期间源文件被修改
+
+    configureTexture(texture, ddsPath, true);
+    emit textureCompressed(key);
+}
+
+void TextureCache::configureTexture(Qt3DRender::QTextureLoader* texture, const QString& source, bool compressed)
+{
+    // 模型加载时已翻转UV（aiProcess_FlipUVs），图片首行对应 v=0，不再镜像
+    texture->setMirrored(false);
+    // 压缩纹理自带完整Mipmap链，原图由GPU生成
+    texture->setGenerateMipMaps(!compressed);
+    texture->setMinificationFilter(Qt3DRender::QAbstractTexture::LinearMipMapLinear);
+    texture->setMagnificationFilter(Qt3DRender::QAbstractTexture::Linear);
+    texture->wrapMode()->setX(Qt3DRender::QTextureWrapMode::Repeat);
+    texture->wrapMode()->setY(Qt3DRender::QTextureWrapMode::Repeat);
+    texture->setSource(QUrl::fromLocalFile(source));
+}
+
+QString TextureCache::cacheDirectory()
+{
+    QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (base.isEmpty()) {
+        base = QDir::tempPath() + "/RobotViewer";
+    }
+    return base + "/textures";
+}
+
+QString TextureCache::cachedFilePath(const QString& imagePath)
+{
+    QFileInfo fileInfo(imagePath);
+    const QString identity = QString("%1|%2|%3|%4")
+            .arg(fileInfo.absoluteFilePath())
+            .arg(fileInfo.size())
+            .arg(fileInfo.lastModified().toMSecsSinceEpoch())
+            .arg(kCacheVersion);
+
+    const QByteArray hash = QCryptographicHash::hash(identity.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDirectory() + "/" + QString::fromLatin1(hash) + ".dds";
+}
+
+bool TextureCache::buildCompressedTexture(const QString& imagePath, const QString& ddsPath,
+                                          QString* errorMessage)
+{
+    QImageReader reader(imagePath);
+    reader.setAutoTransform(true);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        if (errorMessage) *errorMessage = reader.errorString();
+        return false;
+    }
+
+    if (image.width() > kMaxTextureSize || image.height() > kMaxTextureSize) {
+        image = image.scaled(kMaxTextureSize, kMaxTextureSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+
+    // 完全不透明的图片使用BC1（4bpp），否则使用BC3（8bpp）
+    const bool withAlpha = !isOpaque(image);
+
+    QVector<QByteArray> levels;
+    QImage level = image;
+    while (true) {
+        levels.append(compressLevel(level, withAlpha));
+        if (level.width() == 1 && level.height() == 1) break;
+        level = downsample(level);
+    }
+
+    if (!QDir().mkpath(QFileInfo(ddsPath).absolutePath())) {
+        if (errorMessage) *errorMessage = QString("无法创建缓存目录: %1").arg(QFileInfo(ddsPath).absolutePath());
+        return false;
+    }
+
+    // 先写临时文件再原子替换，避免其他进程读到不完整的缓存
+    QSaveFile file(ddsPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorMessage) *errorMessage = file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    writeDdsHeader(stream, image.width(), image.height(), levels.size(),
+                   withAlpha ? kFourCCDxt5 : kFourCCDxt1, quint32(levels.first().size()));
+    for (const QByteArray& data : qAsConst(levels)) {
+        stream.writeRawData(data.constData(), data.size());
+    }
+
+    if (!file.commit()) {
+        if (errorMessage) *errorMessage = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QFutureWatcher>
+
+namespace Qt3DCore {
+class QNode;
+}
+
+namespace Qt3DRender {
+class QAbstractTexture;
+class QTextureLoader;
+}
+
+/**
+ * @brief 纹理缓存
+ * 同一图片在一个机器人内只创建一个纹理对象，由多个材质共享。
+ * 图片的解码、Mipmap生成与BC1/BC3压缩在工作线程完成，结果以DDS格式
+ * 写入磁盘缓存目录；再次加载时直接读取压缩纹理（GPU直接使用，显存约为RGBA8的1/8~1/4）。
+ * 缓存未命中时先由Qt3D在后台加载原图，压缩完成后自动切换为缓存纹理。
+ */
+class TextureCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param owner 纹理节点的父节点（需为所有使用该纹理的实体的公共祖先）
+     */
+    explicit TextureCache(Qt3DCore::QNode* owner);
+    ~TextureCache();
+
+    /**
+     * @brief 获取图片对应的共享纹理
+     * @param imagePath 图片文件路径
+     * @return 纹理对象，文件不存在时返回nullptr
+     */
+    Qt3DRender::QAbstractTexture* texture(const QString& imagePath);
+
+    /**
+     * @brief 释放所有纹理（后台压缩任务会继续完成并写入磁盘缓存）
+     */
+    void clear();
+
+    /**
+     * @brief 磁盘缓存目录
+     */
+    static QString cacheDirectory();
+
+    /**
+     * @brief 图片对应的缓存文件路径（由路径、大小、修改时间决定）
+     */
+    static QString cachedFilePath(const QString& imagePath);
+
+    /**
+     * @brief 解码图片、生成Mipmap并压缩写入DDS文件（可在工作线程调用）
+     * @param imagePath 源图片
+     * @param ddsPath 输出文件
+     * @param errorMessage 失败时的错误信息
+     * @return 是否成功
+     */
+    static bool buildCompressedTexture(const QString& imagePath, const QString& ddsPath,
+                                       QString* errorMessage = nullptr);
+
+signals:
+    /**
+     * @brief 纹理已切换为磁盘缓存中的压缩版本
+     */
+    void textureCompressed(const QString& imagePath);
+
+private slots:
+    void onCompressFinished();
+
+private:
+    void configureTexture(Qt3DRender::QTextureLoader* texture, const QString& source, bool compressed);
+
+    Qt3DCore::QNode* m_owner = nullptr;
+    QHash<QString, Qt3DRender::QTextureLoader*> m_textures;   // 规范化路径 -> 纹理
+    QHash<QFutureWatcher<bool>*, QString> m_pending;          // 后台压缩任务 -> 规范化路径
+};
+
+#endif // TEXTURECACHE_H
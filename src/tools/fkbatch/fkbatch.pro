@@ -0,0 +1,22 @@
+# 无界面正运动学批处理：关节CSV -> Link位姿CSV（只依赖URDF解析，不链接QML/Qt3D）
+# 用法：fkbatch <robot.urdf> <joints.csv|-> [-o poses.csv] [--links a,b,...] [--chunk 行数] [--threads N]
+
+QT       += core gui xml concurrent
+CONFIG   += c++17 console
+CONFIG   -= app_bundle
+
+TARGET = fkbatch
+
+SRC_DIR = $$PWD/../..
+INCLUDEPATH += $$SRC_DIR
+
+SOURCES += \
+    $$SRC_DIR/fkbatch_main.cpp \
+    $$SRC_DIR/fkbatch.cpp \
+    $$SRC_DIR/urdfparser.cpp \
+    $$SRC_DIR/tracelog.cpp
+
+HEADERS += \
+    $$SRC_DIR/fkbatch.h \
+    $$SRC_DIR/urdfparser.h \
+    $$SRC_DIR/tracelog.h
@@ -0,0 +1,196 @@
+﻿#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+#include <vector>
+
+std::atomic_bool TraceLog::s_enabled(false);
+
+namespace {
+
+const char* const kTraceOption = "--trace";
+const char* const kTraceEnvironment = "ROBOTVIEWER_TRACE";
+
+/**
+ * @brief 单个跟踪事件
+ */
+struct TraceEvent {
+    const char* name = nullptr;
+    char phase = 'X';
+    qint64 timestampUs = 0;
+    qint64 durationUs = 0;
+    int threadId = 0;
+    QString detail;
+};
+
+/**
+ * @brief 线程编号与名称（Chrome trace要求整数tid）
+ */
+struct TraceThread {
+    int id = 0;
+    QString name;
+};
+
+QMutex g_mutex;
+QElapsedTimer g_clock;
+QString g_outputFile;
+std::vector<TraceEvent> g_events;
+std::vector<TraceThread> g_threads;
+Qt::HANDLE g_mainThread = nullptr;
+std::atomic_int g_nextThreadId(1);
+
+// 每个线程首次记录时分配编号，调用方已持有g_mutex
+int currentThreadId()
+{
+    thread_local int threadId = 0;
+    if (threadId == 0) {
+        threadId = g_nextThreadId++;
+
+        TraceThread thread;
+        thread.id = threadId;
+        const QString objectName = QThread::currentThread()->objectName();
+        if (QThread::currentThreadId() == g_mainThread) {
+            thread.name = "main";
+        } else if (!objectName.isEmpty()) {
+            thread.name = objectName;
+        } else {
+            thread.name = QString("worker %1").arg(threadId);
+        }
+        g_threads.push_back(thread);
+    }
+    return threadId;
+}
+
+} // namespace
+
+bool TraceLog::startFromArguments(int argc, char* argv[])
+{
+    QString outputFile;
+    for (int i = 1; i < argc - 1; ++i) {
+        if (qstrcmp(argv[i], kTraceOption) == 0) {
+            outputFile = QString::fromLocal8Bit(argv[i + 1]);
+            break;
+        }
+    }
+    if (outputFile.isEmpty()) {
+        outputFile = qEnvironmentVariable(kTraceEnvironment);
+    }
+    if (outputFile.isEmpty()) {
+        return false;
+    }
+
+    start(outputFile);
+    return true;
+}
+
+void TraceLog::start(const QString& outputFile)
+{
+    QMutexLocker locker(&g_mutex);
+    g_outputFile = outputFile;
+    g_events.clear();
+    g_events.reserve(4096);
+    g_mainThread = QThread::currentThreadId();
+    g_clock.start();
+    s_enabled = true;
+}
+
+bool TraceLog::finish()
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    s_enabled = false;
+
+    QMutexLocker locker(&g_mutex);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+
+    // 线程名称元数据
+    for (const TraceThread& thread : g_threads) {
+        QJsonObject event;
+        event["name"] = "thread_name";
+        event["ph"] = "M";
+        event["pid"] = pid;
+        event["tid"] = thread.id;
+        event["args"] = QJsonObject{ { "name", thread.name } };
+        events.append(event);
+    }
+
+    for (const TraceEvent& traceEvent : g_events) {
+        QJsonObject event;
+        event["name"] = QString::fromUtf8(traceEvent.name);
+        event["cat"] = "robotviewer";
+        event["ph"] = QString(QChar(traceEvent.phase));
+        event["ts"] = traceEvent.timestampUs;
+        event["pid"] = pid;
+        event["tid"] = traceEvent.threadId;
+        if (traceEvent.phase == 'X') {
+            event["dur"] = traceEvent.durationUs;
+        } else {
+            event["s"] = "t";
+        }
+        if (!traceEvent.detail.isEmpty()) {
+            event["args"] = QJsonObject{ { "detail", traceEvent.detail } };
+        }
+        events.append(event);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(g_outputFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入跟踪文件:" << g_outputFile << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qDebug() << "跟踪已写入:" << g_outputFile << "(" << g_events.size() << "个事件)";
+
+    g_events.clear();
+    return true;
+}
+
+void TraceLog::addComplete(const char* name, qint64 startUs, qint64 durationUs, const QString& detail)
+{
+    if (!isEnabled()) return;
+
+    QMutexLocker locker(&g_mutex);
+    TraceEvent event;
+    event.name = name;
+    event.phase = 'X';
+    event.timestampUs = startUs;
+    event.durationUs = durationUs;
+    event.threadId = currentThreadId();
+    event.detail = detail;
+    g_events.push_back(event);
+}
+
+void TraceLog::addInstant(const char* name, const QString& detail)
+{
+    if (!isEnabled()) return;
+
+    const qint64 timestampUs = nowUs();
+    QMutexLocker locker(&g_mutex);
+    TraceEvent event;
+    event.name = name;
+    event.phase = 'i';
+    event.timestampUs = timestampUs;
+    event.threadId = currentThreadId();
+    event.detail = detail;
+    g_events.push_back(event);
+}
+
+qint64 TraceLog::nowUs()
+{
+    return g_clock.nsecsElapsed() / 1000;
+}
@@ -0,0 +1,106 @@
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief 启动与加载阶段的跟踪记录，导出为Chrome trace-event JSON
+ * （可在 chrome://tracing 或 Perfetto 中打开）。
+ * 通过命令行 --trace <file.json> 或环境变量 ROBOTVIEWER_TRACE=<file.json> 开启；
+ * 未开启时每个跟踪点只有一次原子读取。
+ */
+class TraceLog
+{
+public:
+    /**
+     * @brief 是否正在记录
+     */
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 按命令行参数或环境变量开启记录（需在创建QApplication之前调用，以便包含启动耗时）
+     * @return 是否已开启
+     */
+    static bool startFromArguments(int argc, char* argv[]);
+
+    /**
+     * @brief 开启记录
+     * @param outputFile 结束时写入的JSON文件
+     */
+    static void start(const QString& outputFile);
+
+    /**
+     * @brief 停止记录并写出JSON文件（未开启时什么也不做）
+     * @return 是否写出成功
+     */
+    static bool finish();
+
+    /**
+     * @brief 记录一个完整区间事件（ph "X"）
+     * @param name 事件名（需为静态字符串）
+     * @param startUs 开始时间（微秒，见nowUs）
+     * @param durationUs 持续时间（微秒）
+     * @param detail 附加说明（写入args.detail，可为空）
+     */
+    static void addComplete(const char* name, qint64 startUs, qint64 durationUs,
+                            const QString& detail = QString());
+
+    /**
+     * @brief 记录一个瞬时事件（ph "i"），如首帧显示
+     */
+    static void addInstant(const char* name, const QString& detail = QString());
+
+    /**
+     * @brief 自开启记录以来的时间（微秒）
+     */
+    static qint64 nowUs();
+
+private:
+    static std::atomic_bool s_enabled;
+};
+
+/**
+ * @brief 作用域跟踪：构造时计时，析构时记录完整区间事件
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+        : m_name(TraceLog::isEnabled() ? name : nullptr)
+        , m_startUs(m_name ? TraceLog::nowUs() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (m_name) {
+            TraceLog::addComplete(m_name, m_startUs, TraceLog::nowUs() - m_startUs, m_detail);
+        }
+    }
+
+    bool isActive() const { return m_name != nullptr; }
+    void setDetail(const QString& detail) { m_detail = detail; }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startUs;
+    QString m_detail;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// 跟踪当前作用域
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+// 跟踪当前作用域并附加说明（说明表达式只在开启时求值）
+#define TRACE_SCOPE_DETAIL(name, detail) \
+    TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name); \
+    if (TRACE_CONCAT(traceScope_, __LINE__).isActive()) TRACE_CONCAT(traceScope_, __LINE__).setDetail(detail)
+
+#endif // TRACELOG_H
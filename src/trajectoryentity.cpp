@@ -41,7 +41,9 @@ TrajectoryEntity::TrajectoryEntity(Qt3DCore::QEntity* parent)
     
     // 定时更新（清除过期点）
     QTimer* updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &TrajectoryEntity::updateGeometry);
+    connect(updateTimer, &QTimer::timeout, this, [this]() {
+        if (!m_frozen) updateGeometry();
+    });
     updateTimer->start(50); // 50ms更新一次
 }
 
@@ -49,12 +51,36 @@ TrajectoryEntity::~TrajectoryEntity()
 {
 }
 
-void TrajectoryEntity::addPoint(const QVector3D& point)
+bool TrajectoryEntity::addPoint(const QVector3D& point, qint64 sourceTimeUs)
 {
+    if (m_frozen) {
+        m_frozen = false;
+        m_points.clear();
+    }
+    
+    const qint64 now = m_timer.elapsed();
+    if (sourceTimeUs < 0) {
+        sourceTimeUs = now * 1000;
+    }
+    
+    // 去重与最小间距（回放倒放时数据源时间递减，按绝对值计算）
+    if (!m_points.isEmpty()) {
+        const TrajectoryPoint& last = m_points.last();
+        const qint64 dtUs = qAbs(sourceTimeUs - last.sourceTimeUs);
+        const float distance = (point - last.position).length();
+        if (dtUs == 0 || distance == 0.0f) {
+            return false;
+        }
+        if (distance < m_minDistance || dtUs < qint64(m_minInterval) * 1000) {
+            return false;
+        }
+    }
+    
     // 添加新点
     TrajectoryPoint tp;
     tp.position = point;
-    tp.timestamp = m_timer.elapsed();
+    tp.timestamp = now;
+    tp.sourceTimeUs = sourceTimeUs;
     m_points.enqueue(tp);
     
     // 移除过期点
@@ -67,19 +93,41 @@ void TrajectoryEntity::addPoint(const QVector3D& point)
     
     // 更新几何体
     updateGeometry();
+    return true;
 }
 
 void TrajectoryEntity::clear()
 {
+    m_frozen = false;
+    m_points.clear();
+    updateGeometry();
+}
+
+void TrajectoryEntity::setPoints(const QVector<QVector3D>& points)
+{
+    m_frozen = true;
     m_points.clear();
+    
+    const qint64 now = m_timer.elapsed();
+    for (const QVector3D& point : points) {
+        m_points.enqueue({ point, now });
+    }
+    
     updateGeometry();
 }
 
 void TrajectoryEntity::setLifetime(int msec)
 {
     m_lifetime = msec;
-    // 根据50ms采样间隔计算最大点数
-    m_maxPoints = msec / 50 + 1;
+    // 根据最小采样间隔计算最大点数
+    m_maxPoints = msec / qMax(m_minInterval, 10) + 1;
+}
+
+void TrajectoryEntity::setMinSpacing(float distance, int msec)
+{
+    m_minDistance = qMax(0.0f, distance);
+    m_minInterval = qMax(0, msec);
+    m_maxPoints = m_lifetime / qMax(m_minInterval, 10) + 1;
 }
 
 void TrajectoryEntity::setMaxPoints(int maxPoints)
@@ -111,6 +159,8 @@ void TrajectoryEntity::setLineWidth(float width)
 
 void TrajectoryEntity::removeExpiredPoints()
 {
+    if (m_frozen) return;
+    
     qint64 currentTime = m_timer.elapsed();
     
     while (!m_points.isEmpty()) {
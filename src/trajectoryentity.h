@@ -8,6 +8,7 @@
 #include <Qt3DRender/QAttribute>
 #include <QVector3D>
 #include <QQueue>
+#include <QVector>
 #include <QElapsedTimer>
 #include <QPair>
 #include <QColor>
@@ -27,14 +28,22 @@ public:
     /**
      * @brief 添加轨迹点
      * @param point 空间点坐标
+     * @param sourceTimeUs 数据源时间戳（微秒），-1表示使用接收时间
+     * @return 与上一点重复或间距不足而被丢弃时返回false
      */
-    void addPoint(const QVector3D& point);
+    bool addPoint(const QVector3D& point, qint64 sourceTimeUs = -1);
     
     /**
      * @brief 清除轨迹
      */
     void clear();
     
+    /**
+     * @brief 一次性替换全部轨迹点（回放时间窗口），这些点不随时间过期；
+     *        之后调用addPoint()或clear()恢复实时模式
+     */
+    void setPoints(const QVector<QVector3D>& points);
+    
     /**
      * @brief 设置轨迹生命周期（毫秒）
      * @param msec 生命周期毫秒数
@@ -48,6 +57,13 @@ public:
     void setMaxPoints(int maxPoints);
     int maxPoints() const { return m_maxPoints; }
     
+    /**
+     * @brief 设置相邻轨迹点的最小间距，两个条件都满足才加入新点（0表示不限制）
+     * @param distance 最小距离
+     * @param msec 最小时间间隔（按数据源时间戳）
+     */
+    void setMinSpacing(float distance, int msec);
+    
     /**
      * @brief 设置轨迹颜色
      */
@@ -65,17 +81,21 @@ private slots:
 private:
     void removeExpiredPoints();
     
-    // 轨迹点数据：位置 + 时间戳
+    // 轨迹点数据：位置 + 时间戳（接收时间用于过期，数据源时间用于去重和间距）
     struct TrajectoryPoint {
         QVector3D position;
         qint64 timestamp;
+        qint64 sourceTimeUs = -1;
     };
     
     QQueue<TrajectoryPoint> m_points;
+    bool m_frozen = false;      // setPoints()设置的固定点，不过期
     
     // 参数
     int m_lifetime = 2000;      // 默认2秒
-    int m_maxPoints = 100;      // 最大点数 = lifetime / sampleInterval
+    int m_maxPoints = 126;      // 最大点数 = lifetime / minInterval
+    float m_minDistance = 0.0005f;
+    int m_minInterval = 16;     // 毫秒
     QColor m_color = QColor(255, 255, 0); // 默认黄色
     float m_lineWidth = 2.0f;
     
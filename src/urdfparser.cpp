@@ -1,4 +1,5 @@
 ﻿#include "urdfparser.h"
+#include "tracelog.h"
 #include <QFile>
 #include <QDomDocument>
 #include <QFileInfo>
@@ -125,6 +126,8 @@ URDFParser::~URDFParser()
 
 bool URDFParser::loadFromFile(const QString& filename)
 {
+    TRACE_SCOPE_DETAIL("URDFParser::loadFromFile", filename);
+    
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         m_errorMessage = QString("Cannot open file: %1").arg(filename);
@@ -142,6 +145,8 @@ bool URDFParser::loadFromFile(const QString& filename)
 
 bool URDFParser::loadFromString(const QString& content, const QString& basePath)
 {
+    TRACE_SCOPE("URDFParser::loadFromString");
+    
     m_basePath = basePath;
     m_model = std::make_shared<URDFModel>();
     m_materials.clear();
@@ -166,6 +171,8 @@ bool URDFParser::loadFromString(const QString& content, const QString& basePath)
 
 bool URDFParser::parseRobot(const QDomElement& element)
 {
+    TRACE_SCOPE("URDFParser::parseRobot");
+    
     m_model->name = element.attribute("name");
     
     // 首先解析全局材质定义
@@ -254,6 +261,9 @@ bool URDFParser::parseLink(const QDomElement& element)
                             visual.material.color[j] = globalMat.color[j];
                         }
                     }
+                    if (visual.material.textureFilename.isEmpty()) {
+                        visual.material.textureFilename = globalMat.textureFilename;
+                    }
                 }
             }
             
@@ -592,3 +602,28 @@ QString URDFParser::resolveMeshPath(const QString& meshPath) const
     // 规范化路径
     return QDir::cleanPath(path);
 }
+
+QString URDFParser::resolveTexturePath(const QString& texturePath) const
+{
+    if (texturePath.isEmpty()) {
+        return QString();
+    }
+    
+    // 与网格路径一致，只取文件名，在URDF目录下的常见位置查找
+    const QString fileName = QFileInfo(texturePath).fileName();
+    const QStringList searchDirs = {
+        m_basePath + "/textures",
+        m_basePath + "/materials/textures",
+        m_basePath + "/meshes",
+        m_basePath
+    };
+    
+    for (const QString& dir : searchDirs) {
+        QString candidate = QDir::cleanPath(dir + "/" + fileName);
+        if (QFileInfo::exists(candidate)) {
+            return candidate;
+        }
+    }
+    
+    return QString();
+}
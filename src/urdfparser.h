@@ -1,4 +1,4 @@
-#ifndef URDFPARSER_H
+﻿#ifndef URDFPARSER_H
 #define URDFPARSER_H
 
 #include <QString>
@@ -225,6 +225,14 @@ public:
      * @return 实际文件路径
      */
     QString resolveMeshPath(const QString& meshPath) const;
+    
+    /**
+     * @brief 解析纹理文件路径
+     * 依次在URDF目录下的 textures、materials/textures、meshes 及URDF所在目录中按文件名查找
+     * @param texturePath 原始路径（可能包含package://）
+     * @return 实际文件路径，找不到时返回空字符串
+     */
+    QString resolveTexturePath(const QString& texturePath) const;
 
 private:
     bool parseRobot(const class QDomElement& element);